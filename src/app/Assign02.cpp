@@ -114,12 +114,24 @@ int main(int argc, char **argv) {
     int windowWidth = 800;
     int windowHeight = 600;
 
-    // Create GLFW window
-    GLFWwindow* window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+    // Optional headless run (--headless N): render N frames offscreen, then exit
+    int headlessFrames = getHeadlessFrameCount(argc, argv);
+    bool headless = (headlessFrames > 0);
 
-    // Setup up Vulkan via vk-bootstrap
+    GLFWwindow* window = nullptr;
     VulkanInitData vkInitData;
-    initVulkanBootstrap(appName, window, vkInitData);
+
+    if (headless) {
+        // Setup up Vulkan via vk-bootstrap (offscreen swapchain)
+        initVulkanBootstrapHeadless(appName, windowWidth, windowHeight, vkInitData);
+    }
+    else {
+        // Create GLFW window
+        window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+
+        // Setup up Vulkan via vk-bootstrap
+        initVulkanBootstrap(appName, window, vkInitData);
+    }
 
     // Assign 02
     string modelPath = "sampleModels/sphere.obj";
@@ -212,12 +224,15 @@ int main(int argc, char **argv) {
     float fpsCalcWindow = 5.0f;
                                        
     // Main render loop
-    while (!glfwWindowShouldClose(window)) {
+    int framesLeft = headlessFrames;
+    while (headless ? (framesLeft-- > 0) : !glfwWindowShouldClose(window)) {
         // Get start time        
         auto startTime = getTime();
 
         // Poll events for window
-        glfwPollEvents();  
+        if (!headless) {
+            glfwPollEvents();  
+        }
 
         // Draw frame
         renderEngine->drawFrame(&sceneData);
@@ -252,7 +267,9 @@ int main(int argc, char **argv) {
 
     delete renderEngine;
     cleanupVulkanBootstrap(vkInitData);
-    cleanupGLFWWindow(window);
+    if (!headless) {
+        cleanupGLFWWindow(window);
+    }
     
     cout << "FORGING DONE!!!" << endl;
     return 0;
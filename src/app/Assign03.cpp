@@ -210,15 +210,27 @@ int main(int argc, char **argv) {
     int windowWidth = 800;
     int windowHeight = 600;
 
-    // Create GLFW window
-    GLFWwindow* window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+    // Optional headless run (--headless N): render N frames offscreen, then exit
+    int headlessFrames = getHeadlessFrameCount(argc, argv);
+    bool headless = (headlessFrames > 0);
 
-    // Key callback
-    glfwSetKeyCallback(window, keyCallback);
-
-    // Setup up Vulkan via vk-bootstrap
+    GLFWwindow* window = nullptr;
     VulkanInitData vkInitData;
-    initVulkanBootstrap(appName, window, vkInitData);
+
+    if (headless) {
+        // Setup up Vulkan via vk-bootstrap (offscreen swapchain)
+        initVulkanBootstrapHeadless(appName, windowWidth, windowHeight, vkInitData);
+    }
+    else {
+        // Create GLFW window
+        window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+
+        // Key callback
+        glfwSetKeyCallback(window, keyCallback);
+
+        // Setup up Vulkan via vk-bootstrap
+        initVulkanBootstrap(appName, window, vkInitData);
+    }
 
     // Assign 02
     string modelPath = "sampleModels/sphere.obj";
@@ -311,12 +323,15 @@ int main(int argc, char **argv) {
     float fpsCalcWindow = 5.0f;
                                        
     // Main render loop
-    while (!glfwWindowShouldClose(window)) {
+    int framesLeft = headlessFrames;
+    while (headless ? (framesLeft-- > 0) : !glfwWindowShouldClose(window)) {
         // Get start time        
         auto startTime = getTime();
 
         // Poll events for window
-        glfwPollEvents();  
+        if (!headless) {
+            glfwPollEvents();  
+        }
 
         // Draw frame
         renderEngine->drawFrame(&sceneData);
@@ -351,7 +366,9 @@ int main(int argc, char **argv) {
 
     delete renderEngine;
     cleanupVulkanBootstrap(vkInitData);
-    cleanupGLFWWindow(window);
+    if (!headless) {
+        cleanupGLFWWindow(window);
+    }
     
     cout << "FORGING DONE!!!" << endl;
     return 0;
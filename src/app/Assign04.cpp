@@ -425,26 +425,38 @@ int main(int argc, char **argv) {
     int windowWidth = 800;
     int windowHeight = 600;
 
-    // Create GLFW window
-    GLFWwindow* window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+    // Optional headless run (--headless N): render N frames offscreen, then exit
+    int headlessFrames = getHeadlessFrameCount(argc, argv);
+    bool headless = (headlessFrames > 0);
 
-    // Key callback
-    glfwSetKeyCallback(window, keyCallback);
+    GLFWwindow* window = nullptr;
+    VulkanInitData vkInitData;
 
-    // Get initial mouse position
-    double mx, my;
-    glfwGetCursorPos(window, &mx, &my);
-    sceneData.mousePos = glm::vec2(mx, my);
-    
-    // Set mouse callback
-    glfwSetCursorPosCallback(window, mouse_position_callback);
-    
-    // Hide cursor
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (headless) {
+        // Setup up Vulkan via vk-bootstrap (offscreen swapchain)
+        initVulkanBootstrapHeadless(appName, windowWidth, windowHeight, vkInitData);
+    }
+    else {
+        // Create GLFW window
+        window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
 
-    // Setup up Vulkan via vk-bootstrap
-    VulkanInitData vkInitData;
-    initVulkanBootstrap(appName, window, vkInitData);
+        // Key callback
+        glfwSetKeyCallback(window, keyCallback);
+
+        // Get initial mouse position
+        double mx, my;
+        glfwGetCursorPos(window, &mx, &my);
+        sceneData.mousePos = glm::vec2(mx, my);
+        
+        // Set mouse callback
+        glfwSetCursorPosCallback(window, mouse_position_callback);
+        
+        // Hide cursor
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        // Setup up Vulkan via vk-bootstrap
+        initVulkanBootstrap(appName, window, vkInitData);
+    }
 
     // Assign 02
     string modelPath = "sampleModels/sphere.obj";
@@ -537,12 +549,15 @@ int main(int argc, char **argv) {
     float fpsCalcWindow = 5.0f;
                                        
     // Main render loop
-    while (!glfwWindowShouldClose(window)) {
+    int framesLeft = headlessFrames;
+    while (headless ? (framesLeft-- > 0) : !glfwWindowShouldClose(window)) {
         // Get start time        
         auto startTime = getTime();
 
         // Poll events for window
-        glfwPollEvents();  
+        if (!headless) {
+            glfwPollEvents();  
+        }
 
         // Update view matrix
         sceneData.viewMat = glm::lookAt(
@@ -552,8 +567,10 @@ int main(int argc, char **argv) {
         );
 
         // Calculate aspect ratio and update projection matrix
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
+        int width = windowWidth, height = windowHeight;
+        if (!headless) {
+            glfwGetFramebufferSize(window, &width, &height);
+        }
         float aspect = (width > 0 && height > 0) ? 
             static_cast<float>(width) / static_cast<float>(height) : 1.0f;
         
@@ -597,7 +614,9 @@ int main(int argc, char **argv) {
 
     delete renderEngine;
     cleanupVulkanBootstrap(vkInitData);
-    cleanupGLFWWindow(window);
+    if (!headless) {
+        cleanupGLFWWindow(window);
+    }
     
     cout << "FORGING DONE!!!" << endl;
     return 0;
@@ -5,6 +5,7 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include "MeshData.hpp"
+#include "MeshUtility.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/transform.hpp"
@@ -12,6 +13,30 @@
 #include "glm/gtc/type_ptr.hpp"
 #include "VKUtility.hpp"
 #include "VKUniform.hpp"
+#include "VKInstance.hpp"
+#include "VKRenderQueue.hpp"
+#include "SceneGraph.hpp"
+#include "BatchTransform.hpp"
+#include "LightClusters.hpp"
+#include "VKShadow.hpp"
+#include "VKCompute.hpp"
+#include "VKHiZ.hpp"
+#include "Meshlets.hpp"
+#include "MeshSimplify.hpp"
+#include "VKDynamicResolution.hpp"
+#include "VKMultiview.hpp"
+#include "VKPushDescriptor.hpp"
+#include "VKBindless.hpp"
+#include "VKGPUProfiler.hpp"
+#include "CPUProfiler.hpp"
+#include "ChromeTrace.hpp"
+#include "VKObjectTracker.hpp"
+#include "VKFrameCapture.hpp"
+#include "VKOverlay.hpp"
+#include <random>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
 
 
 struct Vertex {
@@ -20,16 +45,17 @@ struct Vertex {
     glm::vec3 normal;
 };
 
-struct UPushVertex {
-    glm::vec3 pos;
-    glm::vec4 color;
-    alignas(16) glm::mat4 modelMat;
-    alignas(16) glm::mat4 normMat;
+// One camera of a (multiview) pass; shaders pick theirs with gl_ViewIndex.
+// Lighting is done in view 0's space, so eyePos is where THIS camera sits
+// in view 0's space (origin for view 0).
+struct ViewData {
+    alignas(16) glm::mat4 viewMat;
+    alignas(16) glm::mat4 projMat;
+    alignas(16) glm::vec4 eyePos;
 };
 
 struct UBOVertex {
-    alignas(16) glm::mat4 viewMat;
-    alignas(16) glm::mat4 projMat;
+    ViewData views[MAX_VIEWS];
 };
 
 struct PointLight {
@@ -39,14 +65,87 @@ struct PointLight {
 };
 
 struct UBOFragment {
-    PointLight light;
+    alignas(16) glm::uvec4 clusterDims;     // Tiles in x/y, slices in z, light count in w
+    alignas(16) glm::vec4 clusterParams;    // Slice scale, slice bias, unused, unused
     alignas(4) float metallic;
     alignas(4) float roughness;
+    alignas(16) glm::mat4 invViewMat;       // View -> world (shadow cube lookups)
+    alignas(16) glm::vec4 shadowParams;     // Far plane, bias, enabled
+};
+
+// Capacity of clustered light buffers
+const unsigned int MAX_LIGHTS = 4096;
+const unsigned int MAX_CLUSTER_LIGHT_INDICES = 256*1024;
+
+// GPU occlusion culling (cycle with C)
+// - SINGLE: cull against the PREVIOUS frame's Hi-Z (can pop for a frame
+//   when things disocclude quickly)
+// - TWO_PHASE: draw last frame's visible set, build Hi-Z from that, then
+//   test everything else against it and draw what became visible
+enum CullMode { CULL_OFF, CULL_SINGLE, CULL_TWO_PHASE, CULL_MODE_CNT };
+const char *CULL_MODE_NAMES[] = { "OFF", "SINGLE", "TWO_PHASE" };
+
+// CPU meshlet (cluster) culling (cycle with G); cone = back-facing clusters
+// (only used while GPU culling is OFF)
+enum ClusterCullMode { CLUSTER_CULL_OFF, CLUSTER_CULL_FRUSTUM, CLUSTER_CULL_FRUSTUM_CONE, CLUSTER_CULL_MODE_CNT };
+const char *CLUSTER_CULL_MODE_NAMES[] = { "OFF", "FRUSTUM", "FRUSTUM+CONE" };
+const unsigned int MAX_CLUSTER_DRAWS = 65536;
+
+// Level of detail (cycle with L: AUTO, then each level forced)
+// - AUTO picks the coarsest LOD whose simplification error, projected at
+//   the node's distance, stays under lodPixelError pixels (halve/double
+//   with , and .)
+const int LOD_AUTO = -1;
+const float DEFAULT_LOD_PIXEL_ERROR = 1.0f;
+
+// Material binding (cycle with T); materials live in set 1
+// - SINGLE: every node uses material 0 (one pooled set)
+// - POOLED: nodes cycle through MAX_MATERIALS materials, each with its own
+//   pre-allocated descriptor set
+// - PUSH: same materials, pushed into the command buffer on every material
+//   change (VK_KHR_push_descriptor; shading pipelines use a push layout)
+// - BINDLESS: same tints (plus textures) as rows of the bindless material
+//   table (set 2), picked per instance; every node shares ONE queue
+//   material, so draws are merged across materials. Skipped without
+//   descriptor indexing (pipelines then use shader_nobindless.frag, which
+//   has no set 2)
+enum MaterialMode { MATERIAL_SINGLE, MATERIAL_POOLED, MATERIAL_PUSH, MATERIAL_BINDLESS, MATERIAL_MODE_CNT };
+const char *MATERIAL_MODE_NAMES[] = { "SINGLE", "POOLED", "PUSH", "BINDLESS" };
+const unsigned int MAX_MATERIALS = 64;
+const unsigned int BINDLESS_TEXTURE_CAPACITY = 1024;
+const unsigned int PATTERN_TEXTURE_CNT = 4;
+
+// Matches MaterialUBO in shader.frag
+struct MaterialParams {
+    alignas(16) glm::vec4 baseColor;        // Multiplies vertex color
+};
+
+// More queued instances than this fall back to drawing everything
+const unsigned int MAX_CULL_OBJECTS = 65536;
+const unsigned int CULL_GROUP_SIZE = 64;
+
+// Matches CullParams in cull.comp
+struct UBOCull {
+    alignas(16) glm::mat4 hizViewProj;      // View-projection the Hi-Z was built with
+    alignas(16) glm::vec4 planes[6];        // World-space frustum planes
+    alignas(16) glm::vec4 hizSize;          // Width, height, mip count
+};
+
+// Matches push constants in cull.comp
+struct CullPushConstants {
+    unsigned int instanceCnt;
+    unsigned int runCnt;
+    unsigned int phase;     // 0 = all, 1 = two-phase early, 2 = two-phase late
+    unsigned int useHiZ;
 };
 
 struct SceneData {
     vector<VulkanMesh> allMeshes;
+    vector<glm::vec4> meshBounds;   // Object-space bounding spheres (culling)
+    vector<vector<Meshlet>> meshMeshlets;
+    vector<vector<MeshLOD>> meshLODs;
     const aiScene *scene = nullptr;
+    FlatSceneGraph graph;
     float rotAngle = 0.0f;
 
     glm::vec3 eye = glm::vec3(0.0f, 0.0f, 1.0f);
@@ -64,10 +163,88 @@ struct SceneData {
     
     float metallic = 0.0f;
     float roughness = 0.1f;
+
+    // Additional small point lights (change count with [ and ])
+    vector<PointLight> extraLights;
+    float extraLightRadius = 0.5f;
+
+    // Depth-only pre-pass before shading (toggle with P)
+    bool depthPrepass = false;
+
+    // Stress test: draw gridCnt x gridCnt copies of the scene
+    int gridCnt = 1;
+    float gridSpacing = 2.0f;
+
+    // Shadows from the main light (toggle with H)
+    bool shadows = true;
+
+    // First grid copy is a DYNAMIC shadow caster (spin it with O);
+    // everything else is static and cached in the shadow map
+    int dynamicRoot = -1;
+    glm::mat4 dynamicRootMat = glm::mat4(1.0f);
+    bool animateDynamic = false;
+    float spinAngle = 0.0f;
+
+    // GPU occlusion culling mode (cycle with C)
+    int cullMode = CULL_OFF;
+
+    // CPU meshlet culling mode (cycle with G)
+    int clusterCullMode = CLUSTER_CULL_OFF;
+
+    // LOD selection (cycle with L; threshold with , and .)
+    int lodMode = LOD_AUTO;
+    float lodPixelError = DEFAULT_LOD_PIXEL_ERROR;
+
+    // Dynamic resolution (toggle with R; GPU frame time target with - and =)
+    bool dynamicResolution = false;
+    float targetFrameTime = 0.016f;
+
+    // Stereo (toggle with X): 2 views side by side from ONE multiview pass;
+    // the second eye sits stereoSeparation to the right of the first
+    int viewCnt = 1;
+    float stereoSeparation = 0.05f;
+
+    // How materials are bound (cycle with T)
+    int materialMode = MATERIAL_SINGLE;
+    bool bindlessSupported = false;
+
+    // Chrome trace capture (toggle with F, or set FORGE_TRACE=<file> to
+    // trace the whole run); written when the capture stops
+    bool tracing = false;
+    string tracePath = "Assign05_trace.json";
+
+    // Pipeline statistics of the shadow/main passes (toggle with Q)
+    bool pipelineStats = false;
+
+    // Frame capture: F12 saves the next frame as PNG, F9 starts/stops a JPG
+    // sequence; files are written by encoder threads a few frames later
+    bool screenshotRequested = false;
+    bool recordingFrames = false;
+    string capturePrefix = "Assign05";
+
+    // On-screen performance overlay (toggle with F1)
+    bool overlay = false;
+};
+
+// Per LOD level, for the last frame (before culling)
+struct LODStats {
+    unsigned int instanceCnt[MESH_MAX_LODS] = {};
+    unsigned int triangleCnt[MESH_MAX_LODS] = {};
 };
 
 SceneData sceneData;
 
+struct Assign05RenderParams : public VulkanInitRenderParams {
+    string depthVertSPVFilename;
+    string shadowVertSPVFilename;
+    string shadowFragSPVFilename;
+    string hizCompSPVFilename;
+    string cullCompSPVFilename;
+    string overlayVertSPVFilename;
+    string overlayFragSPVFilename;
+    string noBindlessFragSPVFilename;   // Replaces fragSPVFilename without descriptor indexing
+};
+
 glm::mat4 makeRotateZ(float rotAngle, glm::vec3 offset) {
     float radAngle = glm::radians(rotAngle);
 
@@ -88,6 +265,25 @@ glm::mat4 makeLocalRotate(glm::vec3 offset, glm::vec3 axis, float angle) {
     return translate2 * rotate * translate1;
 }
 
+// World-space frustum planes for Vulkan clip space (0 <= z <= w)
+void extractFrustumPlanes(const glm::mat4 &viewProj, glm::vec4 planes[6]) {
+    glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+    planes[0] = row3 + row0;    // Left
+    planes[1] = row3 - row0;    // Right
+    planes[2] = row3 + row1;    // Bottom/top
+    planes[3] = row3 - row1;
+    planes[4] = row2;           // Near
+    planes[5] = row3 - row2;    // Far
+
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
 static void mouse_position_callback(GLFWwindow* window, double xpos, double ypos) {
     // Calculate relative mouse motion
     glm::vec2 relMouse = glm::vec2(xpos, ypos) - sceneData.mousePos;
@@ -138,21 +334,244 @@ static void mouse_position_callback(GLFWwindow* window, double xpos, double ypos
     sceneData.mousePos = glm::vec2(xpos, ypos);
 }
 
+// Procedural RGBA8 texture (no texture files ship with the models):
+// 0 = checker, 1 = stripes, 2 = dots, 3 = grid
+vector<unsigned char> makePatternTexture(unsigned int size, unsigned int pattern) {
+    vector<unsigned char> texels(size * size * 4);
+    for (unsigned int y = 0; y < size; y++) {
+        for (unsigned int x = 0; x < size; x++) {
+            float u = float(x) / size;
+            float v = float(y) / size;
+            bool on = false;
+            switch (pattern % PATTERN_TEXTURE_CNT) {
+                case 0: on = ((x / (size / 8)) + (y / (size / 8))) % 2 == 0; break;
+                case 1: on = (x / (size / 16)) % 2 == 0; break;
+                case 2: on = glm::length(glm::fract(glm::vec2(u, v) * 8.0f) - 0.5f) < 0.3f; break;
+                default: on = (x % (size / 8)) < 4 || (y % (size / 8)) < 4; break;
+            }
+            unsigned char value = on ? 255 : 96;
+            unsigned char *texel = &texels[(y * size + x) * 4];
+            texel[0] = texel[1] = texel[2] = value;
+            texel[3] = 255;
+        }
+    }
+    return texels;
+}
+
 class Assign05RenderEngine : public VulkanRenderEngine {
     protected:
     UBOVertex hostUBOVert;
     UBOData deviceUBOVert;
     UBOFragment hostUBOFrag;
     UBOData deviceUBOFrag;
+    vector<ClusterLight> hostLights;
+    LightClusterGrid lightGrid;
+    UBOData deviceLights;
+    UBOData deviceClusterRanges;
+    UBOData deviceLightIndices;
     vk::DescriptorPool descriptorPool;
     vector<vk::DescriptorSet> descriptorSets;
+    VulkanInstanceBuffer deviceInstances;
+    VulkanRenderQueue renderQueue;
+    VulkanPipelineData depthPipelineData;       // Depth pre-pass (position only)
+    VulkanPipelineData shadeEqualPipelineData;  // Shading after pre-pass (eEqual, no depth writes)
+    unsigned int shadePipelineID = 0;
+    unsigned int depthPipelineID = 0;
+    unsigned int shadeEqualPipelineID = 0;
+    vector<vector<unsigned int>> meshIDs;       // Per mesh, per LOD level
+    vector<vector<VulkanMesh>> lodMeshes;       // Index-range views (share buffers)
+    vector<const vector<MeshLOD>*> meshLODs;
+    LODStats lodStats;
+    const unsigned int INSTANCE_BINDING = 1;
+
+    // Point light shadows (static casters cached, dynamic casters per frame)
+    VulkanShadowCube shadowCube;
+    VulkanPipelineData shadowPipelineData;
+    VulkanRenderQueue staticShadowQueue;
+    VulkanRenderQueue dynamicShadowQueue;
+    VulkanInstanceBuffer staticShadowInstances;
+    VulkanInstanceBuffer dynamicShadowInstances;
+    unsigned int staticShadowPipelineID = 0;
+    unsigned int dynamicShadowPipelineID = 0;
+    glm::vec3 lastShadowLightPos = glm::vec3(0.0f);
+    float lastShadowRotAngle = 0.0f;
+
+    // GPU occlusion culling
+    // - Render queue sorts as usual; cull.comp fills one indirect command per
+    //   run (early at [0, runCnt), late at [runCnt, 2*runCnt)) and compacts
+    //   surviving instances (early at [0, N), late at [N, 2N))
+    // - earlyRenderPass/lateRenderPass are compatible with renderPass
+    //   (same framebuffers and pipelines)
+    string hizCompSPVFilename;
+    VulkanHiZ hiz;
+    vk::RenderPass earlyRenderPass;             // Clear, keep depth, don't present
+    vk::RenderPass lateRenderPass;              // Load, keep depth, don't present
+    VulkanComputePipelineData cullPipelineData;
+    vk::DescriptorSetLayout cullSetLayout;
+    vk::DescriptorPool cullDescriptorPool;
+    vector<vk::DescriptorSet> cullDescriptorSets;
+    UBOData deviceUBOCull;
+    UBOData deviceCullInfo;
+    UBOData deviceRunBounds;
+    UBOData deviceIndirect;
+    UBOData deviceVisibility;                   // Persistent (one buffer)
+    VulkanInstanceBuffer culledInstances;
+    glm::mat4 currentViewProj = glm::mat4(1.0f);
+    glm::mat4 lastHiZViewProj = glm::mat4(1.0f);
+    vk::Extent2D lastHiZExtent;                 // Region the Hi-Z depth was rendered at
+    vector<unsigned int> lastCullRunCnt;        // Per frame in flight (stats)
+    vector<unsigned int> lastCullInstanceCnt;
+    unsigned int cullVisibleCnt = 0;
+    unsigned int cullTotalCnt = 0;
+    int lastCullMode = CULL_OFF;                // Visibility is stale after a mode switch
+
+    // CPU meshlet culling: surviving ranges as indirect commands (per frame)
+    UBOData deviceClusterCommands;
+    unsigned int maxDrawIndirectCnt = 1;        // 1: no multiDrawIndirect (direct draws)
+    MeshletCullStats clusterStats;
+
+    // Dynamic resolution: every scene pass renders into dynamicRes.color
+    // (single framebuffer), limited to renderExtent; upscaled at the end
+    VulkanDynamicResolution dynamicRes;
+    vk::Extent2D renderExtent;
+    chrono::steady_clock::time_point lastFrameStart = getTime();
+    float lastGPUFrameTime = 0.0f;              // Seconds ("frame" scope; 0 until known)
+
+    // Stereo: one multiview pass renders both eyes into the layers of
+    // multiviewTarget (each eye gets renderExtent of a half-width target);
+    // pipelines must be built against the multiview pass
+    const unsigned int STEREO_VIEWS = 2;
+    vk::RenderPass multiviewRenderPass;
+    VulkanMultiviewTarget multiviewTarget;
+    VulkanPipelineData multiviewPipelineData;
+    VulkanPipelineData multiviewDepthPipelineData;
+    VulkanPipelineData multiviewShadeEqualPipelineData;
+    unsigned int multiviewShadePipelineID = 0;
+    unsigned int multiviewDepthPipelineID = 0;
+    unsigned int multiviewShadeEqualPipelineID = 0;
+    bool multiviewActive = false;               // This frame
+
+    // Materials (set 1 = one MaterialParams slot of deviceMaterials)
+    // - Pooled: one pre-allocated set per material (pipelineData layout)
+    // - Push: same writes pushed per material change; needs pipelines built
+    //   with a push layout for set 1 (only the shading ones read it)
+    // - Set 0 is bound once per pass (beginMainPass())
+    VulkanPushDescriptors pushDescriptors;
+    bool pushMaterialLayout = false;            // For the next getDescriptorSetLayouts()
+    UBOData deviceMaterials;
+    vk::DeviceSize materialStride = 0;
+    vk::DescriptorPool materialDescriptorPool;
+    vector<unsigned int> pooledMaterialIDs;     // Per material slot
+    vector<unsigned int> pushMaterialIDs;
+    VulkanPipelineData pushPipelineData;
+    VulkanPipelineData pushShadeEqualPipelineData;
+    unsigned int pushShadePipelineID = 0;
+    unsigned int pushShadeEqualPipelineID = 0;
+    bool pushMaterialsActive = false;           // This frame
+
+    // Bindless textures/materials (set 2, bound once per pass); material 0
+    // is untextured white (what non-bindless modes use). Not created (and
+    // no set 2) without descriptor indexing
+    VulkanBindlessTable bindless;
+    bool bindlessSupported = false;
+    float lastRecordTime = 0.0f;                // CPU seconds in recordCommandBuffer()
+
+    // GPU time per pass (scopes around the passes, never inside the
+    // multiview one)
+    VulkanGPUProfiler gpuProfiler;
+
+    // Copies the final image out after the last pass when asked to
+    VulkanFrameCapture frameCapture;
+
+    // Stats drawn on the swapchain image after the upscale (before capture)
+    VulkanOverlay overlay;
+
+    // Cached (rotated) model matrices of nodes with meshes (SoA, in node
+    // order); entries are only patched where something changed
+    vector<unsigned int> meshNodes;
+    unsigned int meshNodesGraphSize = 0;        // Node count meshNodes was built for
+    Mat4SoA modelMats;
+    Mat4SoA modelViewMats;
+    Mat4SoA normalMats;
+    float lastRotAngle = 0.0f;
+    glm::mat4 lastViewMat = glm::mat4(1.0f);
+    vector<glm::uvec2> updatedNodeRanges;       // This frame's recomputed subtrees
+    vector<glm::uvec2> changedMeshRanges;       // ... as ranges of meshNodes
 
     public:
         Assign05RenderEngine(VulkanInitData & vkInitData) :
-        VulkanRenderEngine(vkInitData) {};
+        VulkanRenderEngine(vkInitData) {
+            // Depth is sampled to build the Hi-Z pyramid
+            depthImageUsage = vk::ImageUsageFlagBits::eSampled;
+        };
 
         virtual bool initialize(VulkanInitRenderParams *params) override {
+            // Hi-Z is (re)created with the framebuffers
+            Assign05RenderParams *assignParams = static_cast<Assign05RenderParams*>(params);
+            hizCompSPVFilename = assignParams->hizCompSPVFilename;
+
+            // Before any pipeline (decides the set 1 layout flags and set 2
+            // size, or that there is no set 2: then every shading pipeline
+            // gets the fragment shader without it)
+            pushDescriptors = createVulkanPushDescriptors(vkInitData);
+            bindlessSupported = isVulkanBindlessSupported(vkInitData);
+            maxDrawIndirectCnt = getVulkanMaxDrawIndirectCount(vkInitData);
+            if (bindlessSupported) {
+                bindless = createVulkanBindlessTable(vkInitData, BINDLESS_TEXTURE_CAPACITY, MAX_MATERIALS);
+            }
+            else {
+                params->fragSPVFilename = assignParams->noBindlessFragSPVFilename;
+            }
+
             if(!VulkanRenderEngine::initialize(params)) { return false; }
+
+            gpuProfiler = createVulkanGPUProfiler(vkInitData, MAX_FRAMES_IN_FLIGHT);
+            frameCapture = createVulkanFrameCapture(vkInitData);
+            overlay = createVulkanOverlay(vkInitData, this->commandPool, MAX_FRAMES_IN_FLIGHT,
+                                          assignParams->overlayVertSPVFilename,
+                                          assignParams->overlayFragSPVFilename);
+
+            // Create depth pre-pass pipelines
+
+            VulkanPipelineOptions depthOptions;
+            depthOptions.colorWrite = false;
+            depthPipelineData = createVulkanPipelineData(
+                renderPass, assignParams->depthVertSPVFilename, "", depthOptions);
+
+            VulkanPipelineOptions equalOptions;
+            equalOptions.depthCompare = vk::CompareOp::eEqual;
+            equalOptions.depthWrite = false;
+            shadeEqualPipelineData = createVulkanPipelineData(
+                renderPass, params->vertSPVFilename, params->fragSPVFilename, equalOptions);
+
+            // Same three pipelines for the (stereo) multiview pass
+            multiviewPipelineData = createVulkanPipelineData(
+                multiviewRenderPass, params->vertSPVFilename, params->fragSPVFilename, VulkanPipelineOptions());
+            multiviewDepthPipelineData = createVulkanPipelineData(
+                multiviewRenderPass, assignParams->depthVertSPVFilename, "", depthOptions);
+            multiviewShadeEqualPipelineData = createVulkanPipelineData(
+                multiviewRenderPass, params->vertSPVFilename, params->fragSPVFilename, equalOptions);
+
+            // Shading pipelines whose material set is pushed
+            if (pushDescriptors.supported) {
+                pushMaterialLayout = true;
+                pushPipelineData = createVulkanPipelineData(
+                    renderPass, params->vertSPVFilename, params->fragSPVFilename, VulkanPipelineOptions());
+                pushShadeEqualPipelineData = createVulkanPipelineData(
+                    renderPass, params->vertSPVFilename, params->fragSPVFilename, equalOptions);
+                pushMaterialLayout = false;
+            }
+
+            // Create shadow cube and its depth-only pipeline
+            // (cache and dynamic render passes are compatible, so one pipeline serves both)
+            shadowCube = createVulkanShadowCube(vkInitData, 512, 0.01f, 50.0f);
+
+            VulkanPipelineOptions shadowOptions;
+            shadowOptions.colorWrite = false;
+            shadowOptions.colorAttachmentCnt = 0;
+            shadowPipelineData = createVulkanPipelineData(
+                shadowCube.cachePass, assignParams->shadowVertSPVFilename, 
+                assignParams->shadowFragSPVFilename, shadowOptions);
             
             // Create UBO for vertex shader
             deviceUBOVert = createVulkanUniformBufferData(
@@ -169,6 +588,40 @@ class Assign05RenderEngine : public VulkanRenderEngine {
                 sizeof(UBOFragment),
                 MAX_FRAMES_IN_FLIGHT
             );
+
+            // Create clustered lighting SSBOs
+            deviceLights = createVulkanStorageBufferData(
+                vkInitData.device, 
+                vkInitData.physicalDevice,
+                sizeof(ClusterLight) * MAX_LIGHTS,
+                MAX_FRAMES_IN_FLIGHT
+            );
+
+            deviceClusterRanges = createVulkanStorageBufferData(
+                vkInitData.device, 
+                vkInitData.physicalDevice,
+                sizeof(glm::uvec2) * getClusterCount(lightGrid),
+                MAX_FRAMES_IN_FLIGHT
+            );
+
+            deviceLightIndices = createVulkanStorageBufferData(
+                vkInitData.device, 
+                vkInitData.physicalDevice,
+                sizeof(unsigned int) * MAX_CLUSTER_LIGHT_INDICES,
+                MAX_FRAMES_IN_FLIGHT
+            );
+
+            // Create per-instance buffers (grows on demand)
+            deviceInstances = createVulkanInstanceBuffer(
+                vkInitData.device,
+                vkInitData.physicalDevice,
+                64,
+                MAX_FRAMES_IN_FLIGHT
+            );
+            staticShadowInstances = createVulkanInstanceBuffer(
+                vkInitData.device, vkInitData.physicalDevice, 64, MAX_FRAMES_IN_FLIGHT);
+            dynamicShadowInstances = createVulkanInstanceBuffer(
+                vkInitData.device, vkInitData.physicalDevice, 64, MAX_FRAMES_IN_FLIGHT);
             
             // Create descriptor pool
             vector<vk::DescriptorPoolSize> poolSizes;
@@ -176,12 +629,20 @@ class Assign05RenderEngine : public VulkanRenderEngine {
                 vk::DescriptorType::eUniformBuffer,
                 2 * MAX_FRAMES_IN_FLIGHT  // Changed to include both vertex and fragment UBOs
             ));
+            poolSizes.push_back(vk::DescriptorPoolSize(
+                vk::DescriptorType::eStorageBuffer,
+                3 * MAX_FRAMES_IN_FLIGHT  // Lights, cluster ranges, light indices
+            ));
+            poolSizes.push_back(vk::DescriptorPoolSize(
+                vk::DescriptorType::eCombinedImageSampler,
+                MAX_FRAMES_IN_FLIGHT      // Shadow cube
+            ));
             
             vk::DescriptorPoolCreateInfo poolCreateInfo;
             poolCreateInfo.setPoolSizes(poolSizes);
             poolCreateInfo.setMaxSets(MAX_FRAMES_IN_FLIGHT);
             
-            descriptorPool = vkInitData.device.createDescriptorPool(poolCreateInfo);
+            descriptorPool = createVulkanDescriptorPool(vkInitData.device, poolCreateInfo);
             
             // Create descriptor sets
             vector<vk::DescriptorSetLayout> localLayoutList;
@@ -231,28 +692,315 @@ class Assign05RenderEngine : public VulkanRenderEngine {
                 descFragWrites.setBufferInfo(bufferFragInfo);
                 
                 writes.push_back(descFragWrites);
+
+                // Clustered lighting SSBO descriptors
+                vk::DescriptorBufferInfo bufferLightInfo(deviceLights.bufferData[i].buffer, 0, VK_WHOLE_SIZE);
+                vk::DescriptorBufferInfo bufferRangeInfo(deviceClusterRanges.bufferData[i].buffer, 0, VK_WHOLE_SIZE);
+                vk::DescriptorBufferInfo bufferIndexInfo(deviceLightIndices.bufferData[i].buffer, 0, VK_WHOLE_SIZE);
+
+                writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 2, 0, 
+                                    vk::DescriptorType::eStorageBuffer, {}, bufferLightInfo));
+                writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 3, 0, 
+                                    vk::DescriptorType::eStorageBuffer, {}, bufferRangeInfo));
+                writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 4, 0, 
+                                    vk::DescriptorType::eStorageBuffer, {}, bufferIndexInfo));
+
+                // Shadow cube (comparison sampler)
+                vk::DescriptorImageInfo shadowInfo(shadowCube.sampler, shadowCube.image.view, 
+                                                   vk::ImageLayout::eShaderReadOnlyOptimal);
+                writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 5, 0, 
+                                    vk::DescriptorType::eCombinedImageSampler, shadowInfo));
                 
                 vkInitData.device.updateDescriptorSets(writes, {});
             }
+
+            // Register state with render queue
+            shadePipelineID = renderQueue.addPipeline(pipelineData.graphicsPipeline);
+            depthPipelineID = renderQueue.addPipeline(depthPipelineData.graphicsPipeline);
+            shadeEqualPipelineID = renderQueue.addPipeline(shadeEqualPipelineData.graphicsPipeline);
+            multiviewShadePipelineID = renderQueue.addPipeline(multiviewPipelineData.graphicsPipeline);
+            multiviewDepthPipelineID = renderQueue.addPipeline(multiviewDepthPipelineData.graphicsPipeline);
+            multiviewShadeEqualPipelineID = renderQueue.addPipeline(
+                multiviewShadeEqualPipelineData.graphicsPipeline);
+
+            if (pushDescriptors.supported) {
+                pushShadePipelineID = renderQueue.addPipeline(pushPipelineData.graphicsPipeline);
+                pushShadeEqualPipelineID = renderQueue.addPipeline(pushShadeEqualPipelineData.graphicsPipeline);
+            }
+
+            initializeMaterials();
+
+            renderQueue.setDepthRange(0.01f, 50.0f);
+
+            // Shadow queues (no descriptor sets; everything comes from push constants)
+            staticShadowPipelineID = staticShadowQueue.addPipeline(shadowPipelineData.graphicsPipeline);
+            dynamicShadowPipelineID = dynamicShadowQueue.addPipeline(shadowPipelineData.graphicsPipeline);
+            staticShadowQueue.addMaterial(VulkanQueueMaterial());
+            dynamicShadowQueue.addMaterial(VulkanQueueMaterial());
+
+            initializeCulling(assignParams);
             return true;
         };
 
+        // Material 0 is white (scene as before); the others get random tints
+        // (bindless ones also get a pattern texture)
+        void initializeMaterials() {
+            vk::Device &device = vkInitData.device;
+
+            // Slots must start at a legal dynamic/uniform offset
+            vk::DeviceSize alignment = vkInitData.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment;
+            materialStride = sizeof(MaterialParams);
+            if (alignment > 0) {
+                materialStride = (materialStride + alignment - 1) / alignment * alignment;
+            }
+            deviceMaterials = createVulkanUniformBufferData(
+                device, vkInitData.physicalDevice, materialStride * MAX_MATERIALS, 1);
+            vk::Buffer materialBuffer = deviceMaterials.bufferData[0].buffer;
+
+            default_random_engine generator(7);
+            uniform_real_distribution<float> tintDist(0.3f, 1.0f);
+            unsigned char *mapped = static_cast<unsigned char*>(deviceMaterials.mapped[0]);
+            for (unsigned int i = 0; i < MAX_MATERIALS; i++) {
+                MaterialParams params;
+                params.baseColor = (i == 0) ? glm::vec4(1.0f)
+                                 : glm::vec4(tintDist(generator), tintDist(generator), tintDist(generator), 1.0f);
+                memcpy(mapped + i * materialStride, &params, sizeof(params));
+            }
+
+            if (bindlessSupported) {
+                for (unsigned int t = 0; t < PATTERN_TEXTURE_CNT; t++) {
+                    const unsigned int size = 256;
+                    vector<unsigned char> texels = makePatternTexture(size, t);
+                    addBindlessTexture(vkInitData, bindless, 
+                                       createVulkanTexture(vkInitData, commandPool, size, size, texels.data()));
+                }
+                for (unsigned int i = 0; i < MAX_MATERIALS; i++) {
+                    BindlessMaterial material;
+                    if (i > 0) {
+                        memcpy(&material.baseColor, mapped + i * materialStride, sizeof(glm::vec4));
+                        material.textureIndex = i % PATTERN_TEXTURE_CNT;
+                        material.textureScale = 4.0f;
+                    }
+                    addBindlessMaterial(bindless, material);
+                }
+            }
+
+            // Pooled: one set per material (contents never change, so one
+            // serves every frame in flight)
+            vector<vk::DescriptorPoolSize> poolSizes = {
+                vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, MAX_MATERIALS)
+            };
+            materialDescriptorPool = createVulkanDescriptorPool(
+                device, vk::DescriptorPoolCreateInfo({}, MAX_MATERIALS, poolSizes));
+
+            vector<vk::DescriptorSetLayout> layouts(MAX_MATERIALS, pipelineData.descriptorSetLayouts[1]);
+            vector<vk::DescriptorSet> materialSets = device.allocateDescriptorSets(
+                vk::DescriptorSetAllocateInfo(materialDescriptorPool, layouts));
+
+            for (unsigned int i = 0; i < MAX_MATERIALS; i++) {
+                vk::DescriptorBufferInfo bufferInfo(materialBuffer, i * materialStride, sizeof(MaterialParams));
+                device.updateDescriptorSets(vk::WriteDescriptorSet(
+                    materialSets[i], 0, 0, vk::DescriptorType::eUniformBuffer, {}, bufferInfo), {});
+
+                VulkanQueueMaterial pooled;
+                pooled.pipelineLayout = pipelineData.pipelineLayout;
+                pooled.firstSet = 1;
+                pooled.descriptorSets = { materialSets[i] };
+                pooledMaterialIDs.push_back(renderQueue.addMaterial(pooled));
+
+                // Push: nothing to allocate, just remember what to write
+                if (pushDescriptors.supported) {
+                    VulkanQueueMaterial pushed;
+                    pushed.pipelineLayout = pushPipelineData.pipelineLayout;
+                    pushed.firstSet = 1;
+                    pushed.pushDescriptors = &pushDescriptors;
+                    pushed.pushWrites = { { makePushBufferWrite(0, vk::DescriptorType::eUniformBuffer, 
+                                                                materialBuffer, i * materialStride, 
+                                                                sizeof(MaterialParams)) } };
+                    pushMaterialIDs.push_back(renderQueue.addMaterial(pushed));
+                }
+            }
+        }
+
+        void initializeCulling(Assign05RenderParams *assignParams) {
+            vk::Device &device = vkInitData.device;
+
+            // Two-phase passes (compatible with the main render pass)
+            VulkanRenderPassOptions earlyOptions;
+            earlyOptions.storeDepth = true;
+            earlyOptions.present = false;
+            earlyRenderPass = VulkanRenderEngine::createVulkanRenderPass(depthImage, earlyOptions);
+
+            VulkanRenderPassOptions lateOptions;
+            lateOptions.loadContents = true;
+            lateOptions.storeDepth = true;
+            lateOptions.present = false;
+            lateRenderPass = VulkanRenderEngine::createVulkanRenderPass(depthImage, lateOptions);
+
+            // Buffers (fixed capacity, except the compacted instances)
+            deviceUBOCull = createVulkanUniformBufferData(
+                device, vkInitData.physicalDevice, sizeof(UBOCull), MAX_FRAMES_IN_FLIGHT);
+            deviceCullInfo = createVulkanStorageBufferData(
+                device, vkInitData.physicalDevice, sizeof(CullInstanceInfo) * MAX_CULL_OBJECTS, MAX_FRAMES_IN_FLIGHT);
+            deviceRunBounds = createVulkanStorageBufferData(
+                device, vkInitData.physicalDevice, sizeof(glm::vec4) * MAX_CULL_OBJECTS, MAX_FRAMES_IN_FLIGHT);
+            deviceIndirect = createVulkanIndirectBufferData(
+                device, vkInitData.physicalDevice, 
+                2 * sizeof(vk::DrawIndexedIndirectCommand) * MAX_CULL_OBJECTS, MAX_FRAMES_IN_FLIGHT);
+            deviceVisibility = createVulkanStorageBufferData(
+                device, vkInitData.physicalDevice, sizeof(unsigned int) * MAX_CULL_OBJECTS, 1);
+            culledInstances = createVulkanInstanceBuffer(
+                device, vkInitData.physicalDevice, 128, MAX_FRAMES_IN_FLIGHT);
+            deviceClusterCommands = createVulkanIndirectBufferData(
+                device, vkInitData.physicalDevice, 
+                sizeof(vk::DrawIndexedIndirectCommand) * MAX_CLUSTER_DRAWS, MAX_FRAMES_IN_FLIGHT);
+
+            // Everything starts out visible (first two-phase frame draws all of it early)
+            unsigned int *visibility = static_cast<unsigned int*>(deviceVisibility.mapped[0]);
+            for (unsigned int i = 0; i < MAX_CULL_OBJECTS; i++) {
+                visibility[i] = 1;
+            }
+
+            lastCullRunCnt.assign(MAX_FRAMES_IN_FLIGHT, 0);
+            lastCullInstanceCnt.assign(MAX_FRAMES_IN_FLIGHT, 0);
+
+            // Descriptor layout: UBO, 6 SSBOs, Hi-Z
+            vector<vk::DescriptorSetLayoutBinding> bindings;
+            bindings.push_back(vk::DescriptorSetLayoutBinding(
+                0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr));
+            for (unsigned int b = 1; b <= 6; b++) {
+                bindings.push_back(vk::DescriptorSetLayoutBinding(
+                    b, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr));
+            }
+            bindings.push_back(vk::DescriptorSetLayoutBinding(
+                7, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, nullptr));
+            cullSetLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, bindings));
+
+            vector<vk::PushConstantRange> pushRanges = {
+                vk::PushConstantRange(vk::ShaderStageFlagBits::eCompute, 0, sizeof(CullPushConstants))
+            };
+            cullPipelineData = createVulkanComputePipelineData(
+                device, assignParams->cullCompSPVFilename, { cullSetLayout }, pushRanges);
+
+            vector<vk::DescriptorPoolSize> poolSizes = {
+                vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, MAX_FRAMES_IN_FLIGHT),
+                vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 6 * MAX_FRAMES_IN_FLIGHT),
+                vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, MAX_FRAMES_IN_FLIGHT)
+            };
+            cullDescriptorPool = createVulkanDescriptorPool(
+                device, vk::DescriptorPoolCreateInfo({}, MAX_FRAMES_IN_FLIGHT, poolSizes));
+
+            vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, cullSetLayout);
+            cullDescriptorSets = device.allocateDescriptorSets(
+                vk::DescriptorSetAllocateInfo(cullDescriptorPool, layouts));
+        }
+
         virtual ~Assign05RenderEngine() {
-            vkInitData.device.destroyDescriptorPool(descriptorPool);
+            cleanupVulkanDescriptorPool(vkInitData.device, descriptorPool);
             cleanupVulkanUniformBufferData(vkInitData.device, deviceUBOVert);
             cleanupVulkanUniformBufferData(vkInitData.device, deviceUBOFrag);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceLights);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceClusterRanges);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceLightIndices);
+            cleanupVulkanInstanceBuffer(vkInitData.device, deviceInstances);
+            cleanupVulkanPipelineData(depthPipelineData);
+            cleanupVulkanPipelineData(shadeEqualPipelineData);
+            cleanupVulkanInstanceBuffer(vkInitData.device, staticShadowInstances);
+            cleanupVulkanInstanceBuffer(vkInitData.device, dynamicShadowInstances);
+            cleanupVulkanPipelineData(shadowPipelineData);
+            cleanupVulkanShadowCube(vkInitData, shadowCube);
+
+            cleanupVulkanDescriptorPool(vkInitData.device, cullDescriptorPool);
+            cleanupVulkanComputePipelineData(vkInitData.device, cullPipelineData);
+            vkInitData.device.destroyDescriptorSetLayout(cullSetLayout);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceUBOCull);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceCullInfo);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceRunBounds);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceIndirect);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceVisibility);
+            cleanupVulkanInstanceBuffer(vkInitData.device, culledInstances);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceClusterCommands);
+            cleanupVulkanRenderPass(earlyRenderPass);
+            cleanupVulkanRenderPass(lateRenderPass);
+            cleanupVulkanHiZ(vkInitData, hiz);
+            cleanupVulkanDynamicResolution(vkInitData, dynamicRes);
+            cleanupVulkanPipelineData(multiviewPipelineData);
+            cleanupVulkanPipelineData(multiviewDepthPipelineData);
+            cleanupVulkanPipelineData(multiviewShadeEqualPipelineData);
+            cleanupVulkanMultiviewTarget(vkInitData, multiviewTarget);
+            cleanupVulkanRenderPass(multiviewRenderPass);
+            cleanupVulkanDescriptorPool(vkInitData.device, materialDescriptorPool);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceMaterials);
+            if (pushDescriptors.supported) {
+                cleanupVulkanPipelineData(pushPipelineData);
+                cleanupVulkanPipelineData(pushShadeEqualPipelineData);
+            }
+            if (bindlessSupported) {
+                cleanupVulkanBindlessTable(vkInitData, bindless);
+            }
+            cleanupVulkanGPUProfiler(vkInitData, gpuProfiler);
+            cleanupVulkanFrameCapture(vkInitData, frameCapture);
+            cleanupVulkanOverlay(vkInitData, overlay);
         };
 
-        virtual vector<vk::PushConstantRange> getPushConstantRanges() override {
-            vector<vk::PushConstantRange> ranges;
+        // Main pass keeps depth so it can be reduced into the Hi-Z pyramid;
+        // color stays an attachment (it is blitted to the swapchain afterwards)
+        virtual vk::RenderPass createVulkanRenderPass(VulkanImage &depthImage) override {
+            VulkanRenderPassOptions options;
+            options.storeDepth = true;
+            options.present = false;
+            return VulkanRenderEngine::createVulkanRenderPass(depthImage, options);
+        }
+
+        // Hi-Z and the offscreen color target match the depth image, so
+        // rebuild them with the framebuffers. The scene always renders into
+        // the offscreen target, so ONE framebuffer serves every swapchain image.
+        // The stereo target (half width per eye) is rebuilt here too; its
+        // pass is created on first use (this runs during initialize()).
+        virtual vector<vk::Framebuffer> createVulkanFramebuffers(   vk::RenderPass &renderPass,
+                                                                    VulkanImage &depthImage) override {
+            vk::Extent2D extent = vkInitData.swapchain.extent;
+
+            if (hiz.mipCnt > 0) {
+                cleanupVulkanHiZ(vkInitData, hiz);
+            }
+            hiz = createVulkanHiZ(vkInitData, depthImage, extent.width, extent.height, hizCompSPVFilename);
+
+            // Keep the controller state across resizes
+            VulkanDynamicResolution oldRes = dynamicRes;
+            if (oldRes.width > 0) {
+                cleanupVulkanDynamicResolution(vkInitData, dynamicRes);
+            }
+            dynamicRes = createVulkanDynamicResolution(vkInitData, extent.width, extent.height, 
+                                                       oldRes.settings);
+            if (oldRes.width > 0) {
+                dynamicRes.enabled = oldRes.enabled;
+                dynamicRes.scale = oldRes.scale;
+                dynamicRes.adjustCnt = oldRes.adjustCnt;
+            }
 
-            vk::PushConstantRange range;
-            range.setStageFlags(vk::ShaderStageFlagBits::eVertex);
-            range.setOffset(0);
-            range.setSize(sizeof(UPushVertex));
-            ranges.push_back(range);
+            if (!multiviewRenderPass) {
+                VulkanRenderPassOptions multiviewOptions;
+                multiviewOptions.present = false;
+                multiviewOptions.viewCnt = STEREO_VIEWS;
+                multiviewRenderPass = VulkanRenderEngine::createVulkanRenderPass(depthImage, multiviewOptions);
+            }
+            if (multiviewTarget.viewCnt > 0) {
+                cleanupVulkanMultiviewTarget(vkInitData, multiviewTarget);
+            }
+            multiviewTarget = createVulkanMultiviewTarget(vkInitData, multiviewRenderPass,
+                                                          extent.width / STEREO_VIEWS, extent.height,
+                                                          STEREO_VIEWS, vkInitData.swapchain.format,
+                                                          depthImage.format);
+
+            // Overlay draws straight into the swapchain images
+            if (overlay.renderPass) {
+                recreateVulkanOverlayFramebuffers(vkInitData, overlay);
+            }
 
-            return ranges;
+            vector<vk::ImageView> attachments = { dynamicRes.color.view, depthImage.view };
+            return { vkInitData.device.createFramebuffer(vk::FramebufferCreateInfo(
+                        {}, renderPass, attachments, extent.width, extent.height, 1)) };
         }
 
         virtual vector<vk::DescriptorSetLayout> getDescriptorSetLayouts() override {
@@ -276,12 +1024,49 @@ class Assign05RenderEngine : public VulkanRenderEngine {
             
             allBindings.push_back(uboVertBinding);
             allBindings.push_back(uboFragBinding);
+
+            // Clustered lighting SSBOs (lights, cluster ranges, light indices)
+            for (unsigned int b = 2; b <= 4; b++) {
+                allBindings.push_back(vk::DescriptorSetLayoutBinding(
+                    b, vk::DescriptorType::eStorageBuffer, 1, 
+                    vk::ShaderStageFlagBits::eFragment, nullptr));
+            }
+
+            // Shadow cube
+            allBindings.push_back(vk::DescriptorSetLayoutBinding(
+                5, vk::DescriptorType::eCombinedImageSampler, 1, 
+                vk::ShaderStageFlagBits::eFragment, nullptr));
             
             vk::DescriptorSetLayout layout = vkInitData.device.createDescriptorSetLayout(
                 vk::DescriptorSetLayoutCreateInfo({}, allBindings)
             );
+
+            // Set 1: material parameters (pushed or pooled)
+            vk::DescriptorSetLayoutBinding materialBinding(
+                0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eFragment, nullptr);
+            vk::DescriptorSetLayoutCreateFlags materialFlags;
+            if (pushMaterialLayout) {
+                materialFlags = getPushDescriptorLayoutFlags(pushDescriptors);
+            }
+            vk::DescriptorSetLayout materialLayout = vkInitData.device.createDescriptorSetLayout(
+                vk::DescriptorSetLayoutCreateInfo(materialFlags, materialBinding)
+            );
+
+            // Set 2: bindless textures and material table (if supported)
+            if (!bindlessSupported) {
+                return vector<vk::DescriptorSetLayout>{layout, materialLayout};
+            }
+            vk::DescriptorSetLayout bindlessLayout = createVulkanBindlessSetLayout(
+                vkInitData.device, bindless.textureCapacity, vk::ShaderStageFlagBits::eFragment);
             
-            return vector<vk::DescriptorSetLayout>{layout};
+            return vector<vk::DescriptorSetLayout>{layout, materialLayout, bindlessLayout};
+        }
+
+        virtual vector<vk::PushConstantRange> getPushConstantRanges() override {
+            // Used by shadow passes only (harmless for the others)
+            return { vk::PushConstantRange(
+                vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
+                0, sizeof(ShadowPushConstants)) };
         }
         
         virtual AttributeDescData getAttributeDescData() override {
@@ -315,103 +1100,530 @@ class Assign05RenderEngine : public VulkanRenderEngine {
                     2, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, normal)
                 )
             );
+
+            // Per-instance model matrix, normal matrix, and color
+            addInstanceAttributeDesc(attribDescData, INSTANCE_BINDING, 3);
             
             return attribDescData;
         }
         
+        // Every LOD level is its own queue mesh (same IDs in all queues);
+        // meshlets only cover LOD 0
+        void registerMeshes(vector<VulkanMesh> &allMeshes, vector<glm::vec4> &meshBounds,
+                            vector<vector<Meshlet>> &meshMeshlets, vector<vector<MeshLOD>> &allLODs) {
+            meshIDs.clear();
+            meshLODs.clear();
+            lodMeshes.assign(allMeshes.size(), vector<VulkanMesh>());
+            for (unsigned int i = 0; i < allMeshes.size(); i++) {
+                for (auto &lod : allLODs.at(i)) {
+                    lodMeshes[i].push_back(getVulkanMeshRange(allMeshes[i], lod.firstIndex, lod.indexCnt));
+                }
+            }
+
+            for (unsigned int i = 0; i < allMeshes.size(); i++) {
+                meshIDs.push_back(vector<unsigned int>());
+                meshLODs.push_back(&allLODs.at(i));
+                for (auto &lodMesh : lodMeshes[i]) {
+                    meshIDs[i].push_back(renderQueue.addMesh(&lodMesh, meshBounds.at(i)));
+                    staticShadowQueue.addMesh(&lodMesh);
+                    dynamicShadowQueue.addMesh(&lodMesh);
+                }
+                renderQueue.setMeshMeshlets(meshIDs[i][0], &meshMeshlets.at(i));
+            }
+        }
+
+        // LOD level for one mesh of one node
+        unsigned int selectLOD(SceneData *sceneData, unsigned int meshIndex, 
+                               const glm::mat4 &modelViewMat, float pixelsPerUnitAtOne) {
+            const vector<MeshLOD> &lods = *meshLODs.at(meshIndex);
+            if (sceneData->lodMode != LOD_AUTO) {
+                return min((unsigned int)sceneData->lodMode, (unsigned int)lods.size() - 1);
+            }
+
+            // Distance to the nearest point of the bounding sphere
+            glm::vec4 bounds = sceneData->meshBounds.at(meshIndex);
+            float scale = max(max(glm::length(glm::vec3(modelViewMat[0])), 
+                                  glm::length(glm::vec3(modelViewMat[1]))),
+                              glm::length(glm::vec3(modelViewMat[2])));
+            glm::vec3 viewCenter = glm::vec3(modelViewMat * glm::vec4(glm::vec3(bounds), 1.0f));
+            float distance = glm::length(viewCenter) - max(bounds.w, 0.0f) * scale;
+
+            return selectMeshLOD(lods, distance, scale, pixelsPerUnitAtOne, sceneData->lodPixelError);
+        }
+
+        // Nodes cycle through the materials (except in SINGLE mode; in
+        // BINDLESS mode the instance picks the material instead)
+        unsigned int getNodeMaterialID(SceneData *sceneData, unsigned int meshNodeIndex) {
+            if (sceneData->materialMode == MATERIAL_SINGLE || sceneData->materialMode == MATERIAL_BINDLESS) {
+                return pooledMaterialIDs.at(0);
+            }
+            unsigned int slot = meshNodeIndex % MAX_MATERIALS;
+            return pushMaterialsActive ? pushMaterialIDs.at(slot) : pooledMaterialIDs.at(slot);
+        }
+
+        bool isPushDescriptorSupported() {
+            return pushDescriptors.supported;
+        }
+
+        bool isBindlessSupported() {
+            return bindlessSupported;
+        }
+
+        unsigned int getMaterialBindCount() {
+            return renderQueue.getMaterialBindCount();
+        }
+
+        unsigned int getDrawCount() {
+            return renderQueue.getDrawCount();
+        }
+
+        float getRecordTime() {
+            return lastRecordTime;
+        }
+
+        LODStats getLODStats() {
+            return lodStats;
+        }
+
         virtual void updateUniformBuffers(SceneData *sceneData, vk::CommandBuffer &commandBuffer) {
-            // Update vertex UBO
-            hostUBOVert.viewMat = sceneData->viewMat;
-            hostUBOVert.projMat = sceneData->projMat;
+            // Update vertex UBO (view 0 is the camera)
+            ViewData &mainView = hostUBOVert.views[0];
+            mainView.viewMat = sceneData->viewMat;
+            mainView.projMat = sceneData->projMat;
+            mainView.eyePos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
             
             // Invert Y for projection matrix
-            hostUBOVert.projMat[1][1] *= -1;
+            mainView.projMat[1][1] *= -1;
+
+            // Further views: cameras shifted right (stereo)
+            for (unsigned int v = 1; v < MAX_VIEWS; v++) {
+                glm::vec3 offset = glm::vec3(sceneData->stereoSeparation * v, 0.0f, 0.0f);
+                hostUBOVert.views[v].viewMat = glm::translate(-offset) * mainView.viewMat;
+                hostUBOVert.views[v].projMat = mainView.projMat;
+                hostUBOVert.views[v].eyePos = glm::vec4(offset, 1.0f);
+            }
             
             // Copy UBO vertex host data to device
             memcpy(deviceUBOVert.mapped[this->currentImage], &hostUBOVert, sizeof(hostUBOVert));
+            currentViewProj = mainView.projMat * mainView.viewMat;
             
-            // Update fragment UBO
-            hostUBOFrag.light = sceneData->light;
+            // Gather lights in view space (main light reaches everything)
+            hostLights.clear();
+            hostLights.push_back({ glm::vec4(glm::vec3(sceneData->light.vpos), 1000.0f), 
+                                   sceneData->light.color });
+            for (auto &light : sceneData->extraLights) {
+                if (hostLights.size() >= MAX_LIGHTS) {
+                    break;
+                }
+                glm::vec4 vpos = sceneData->viewMat * light.pos;
+                hostLights.push_back({ glm::vec4(glm::vec3(vpos), sceneData->extraLightRadius), 
+                                       light.color });
+            }
+
+            // Bin lights into clusters (CPU job)
+            lightGrid.nearZ = 0.01f;
+            lightGrid.farZ = 50.0f;
+            buildLightClusters(lightGrid, hostLights, mainView.projMat, MAX_CLUSTER_LIGHT_INDICES);
+
+            memcpy(deviceLights.mapped[this->currentImage], hostLights.data(), 
+                   sizeof(ClusterLight) * hostLights.size());
+            memcpy(deviceClusterRanges.mapped[this->currentImage], lightGrid.ranges.data(), 
+                   sizeof(glm::uvec2) * lightGrid.ranges.size());
+            memcpy(deviceLightIndices.mapped[this->currentImage], lightGrid.indices.data(), 
+                   sizeof(unsigned int) * lightGrid.indices.size());
+
+            // Update fragment UBO (tiles come from view 0's NDC, so they 
+            // don't depend on the rendered region or the view)
+            glm::vec2 sliceScaleBias = getClusterSliceScaleBias(lightGrid);
+            hostUBOFrag.clusterDims = glm::uvec4(lightGrid.dimX, lightGrid.dimY, lightGrid.dimZ, 
+                                                 hostLights.size());
+            hostUBOFrag.clusterParams = glm::vec4(sliceScaleBias.x, sliceScaleBias.y, 0.0f, 0.0f);
             hostUBOFrag.metallic = sceneData->metallic;
             hostUBOFrag.roughness = sceneData->roughness;
+            hostUBOFrag.invViewMat = glm::inverse(sceneData->viewMat);
+            hostUBOFrag.shadowParams = glm::vec4(shadowCube.farPlane, 0.002f, 
+                                                 sceneData->shadows ? 1.0f : 0.0f, 0.0f);
             
             // Copy UBO fragment host data to device
             memcpy(deviceUBOFrag.mapped[this->currentImage], &hostUBOFrag, sizeof(hostUBOFrag));
-            
-            // Bind descriptor sets
-            commandBuffer.bindDescriptorSets(
-                vk::PipelineBindPoint::eGraphics,
-                pipelineData.pipelineLayout,
-                0,
-                descriptorSets[currentImage],
-                {}
-            );
+
+            // NOTE: Descriptor sets are bound by the render queue
         }
 
-        void renderScene(vk::CommandBuffer &commandBuffer, SceneData *sceneData, 
-                         aiNode *node, glm::mat4 parentMat, int level) {
-            // Get transformation for current node and convert                
-            aiMatrix4x4 aiNodeT = node->mTransformation;
-            glm::mat4 nodeT;
-            aiMatToGLM4(aiNodeT, nodeT);
+        // Rotated model matrices of meshNodes[first, last)
+        void updateModelMats(SceneData *sceneData, unsigned int first, unsigned int last) {
+            FlatSceneGraph &graph = sceneData->graph;
+            for (unsigned int k = first; k < last; k++) {
+                glm::mat4 &worldMat = graph.worldMat[meshNodes[k]];
 
-            // Compute current model matrix
-            glm::mat4 modelMat = parentMat * nodeT;
+                // Location of current node
+                glm::vec3 pos = glm::vec3(worldMat[3]);
 
-            // Location of current node
-            glm::vec3 pos = glm::vec3(modelMat[3]);
+                // Temporary model matrix
+                glm::mat4 R = makeRotateZ(sceneData->rotAngle, pos);
+                modelMats.set(k, R * worldMat);
+            }
+        }
 
-            // Temporary model matrix
-            glm::mat4 R = makeRotateZ(sceneData->rotAngle, pos);
-            glm::mat4 tmpModel = R * modelMat;
-            
-            // Calculate normal matrix
-            glm::mat4 normalMat = glm::transpose(glm::inverse(glm::mat4(sceneData->viewMat * tmpModel)));
-
-            // Create instance of UPushVertex and store matrices
-            UPushVertex pushVertex; 
-            pushVertex.modelMat = tmpModel;
-            pushVertex.normMat = normalMat;
-
-            // Push UPushVertex data
-            commandBuffer.pushConstants(
-                this->pipelineData.pipelineLayout,
-                vk::ShaderStageFlagBits::eVertex,
-                0,
-                sizeof(UPushVertex),
-                &pushVertex
-            );
+        void renderScene(SceneData *sceneData) {
+            FlatSceneGraph &graph = sceneData->graph;
+
+            // Recompute world matrices for dirty subtrees only
+            updatedNodeRanges.clear();
+            updateSceneGraphWorldMats(graph, &updatedNodeRanges);
+
+            // Nodes with meshes only change with the graph itself
+            bool rebuild = (graph.worldMat.size() != meshNodesGraphSize);
+            if (rebuild) {
+                meshNodes.clear();
+                for (unsigned int i = 0; i < graph.worldMat.size(); i++) {
+                    if (graph.meshCnt[i] > 0) {
+                        meshNodes.push_back(i);
+                    }
+                }
+                modelMats.resize(meshNodes.size());
+                meshNodesGraphSize = graph.worldMat.size();
+            }
 
-            // Draw Meshes
-            for (int i = 0; i < node->mNumMeshes; i++) {
-                int index = node->mMeshes[i];
-                recordDrawVulkanMesh(commandBuffer, sceneData->allMeshes.at(index));
+            // The rotation touches every model matrix; otherwise only the
+            // meshes inside recomputed subtrees (a subtree is a contiguous
+            // node range, and meshNodes is sorted, so it maps to ONE range)
+            bool allModels = rebuild || (sceneData->rotAngle != lastRotAngle);
+            changedMeshRanges.clear();
+            if (allModels) {
+                updateModelMats(sceneData, 0, meshNodes.size());
+                lastRotAngle = sceneData->rotAngle;
+            }
+            else {
+                for (auto &range : updatedNodeRanges) {
+                    unsigned int first = lower_bound(meshNodes.begin(), meshNodes.end(), range.x) - meshNodes.begin();
+                    unsigned int last = lower_bound(meshNodes.begin(), meshNodes.end(), range.y) - meshNodes.begin();
+                    if (first < last) {
+                        updateModelMats(sceneData, first, last);
+                        changedMeshRanges.push_back(glm::uvec2(first, last));
+                    }
+                }
             }
 
-            // Children
-            for (int i = 0; i < node->mNumChildren; i++) {
-                renderScene(commandBuffer, sceneData, node->mChildren[i], modelMat, level + 1);
+            // Model-view/normal matrices: all at once when the camera moved
+            // (or every model did), else just the patched ranges (often none)
+            if (allModels || sceneData->viewMat != lastViewMat) {
+                computeBatchTransforms(sceneData->viewMat, modelMats, modelViewMats, normalMats);
+                lastViewMat = sceneData->viewMat;
+            }
+            else {
+                for (auto &range : changedMeshRanges) {
+                    computeBatchTransformsRange(sceneData->viewMat, modelMats, modelViewMats, normalMats,
+                                                range.x, range.y);
+                }
+            }
+
+            // Static casters only need queuing when the cache gets rebuilt
+            bool cacheShadows = sceneData->shadows && shadowCube.cacheDirty;
+            int dynamicBegin = sceneData->dynamicRoot;
+            int dynamicEnd = (dynamicBegin >= 0) ? graph.subtreeEnd[dynamicBegin] : -1;
+
+            // Pixels covered by one unit at distance one (LOD selection)
+            float pixelsPerUnitAtOne = 0.5f * renderExtent.height * sceneData->projMat[1][1];
+            lodStats = LODStats();
+
+            // Materials pushed this frame? (multiview pipelines only have the pooled layout)
+            pushMaterialsActive = (sceneData->materialMode == MATERIAL_PUSH) && pushDescriptors.supported 
+                                  && !multiviewActive;
+            unsigned int shadeID = pushMaterialsActive ? pushShadePipelineID : shadePipelineID;
+
+            // Linear pass over nodes with meshes
+            for (unsigned int k = 0; k < meshNodes.size(); k++) {
+                unsigned int i = meshNodes[k];
+
+                // Store matrices for this instance
+                InstanceData instance;
+                instance.modelMat = modelMats.get(k);
+                instance.normMat = normalMats.get(k);
+                if (sceneData->materialMode == MATERIAL_BINDLESS) {
+                    instance.indices.x = k % MAX_MATERIALS;
+                }
+
+                // View-space depth of node origin (camera looks down -Z)
+                float viewDepth = -modelViewMats.e[14][k];
+                glm::mat4 modelViewMat = modelViewMats.get(k);
+
+                // Emit draw packets (sorted and merged into instanced draws later)
+                for (unsigned int m = 0; m < graph.meshCnt[i]; m++) {
+                    unsigned int index = graph.meshIndices[graph.meshStart[i] + m];
+                    unsigned int lod = selectLOD(sceneData, index, modelViewMat, pixelsPerUnitAtOne);
+                    renderQueue.add(shadeID, getNodeMaterialID(sceneData, k), meshIDs.at(index).at(lod),
+                                    viewDepth, instance);
+                    lodStats.instanceCnt[lod]++;
+                    lodStats.triangleCnt[lod] += meshLODs.at(index)->at(lod).indexCnt / 3;
+
+                    // Shadow casters (full detail: the static cache doesn't follow the camera)
+                    bool isDynamic = (int(i) >= dynamicBegin && int(i) < dynamicEnd);
+                    if (sceneData->shadows && isDynamic) {
+                        dynamicShadowQueue.add(dynamicShadowPipelineID, 0, meshIDs.at(index).at(0), 0.0f, instance);
+                    }
+                    else if (cacheShadows && !isDynamic) {
+                        staticShadowQueue.add(staticShadowPipelineID, 0, meshIDs.at(index).at(0), 0.0f, instance);
+                    }
+                }
             }
         }
 
         virtual void recordCommandBuffer(void *userData, vk::CommandBuffer &commandBuffer, 
             unsigned int frameIndex) override {
             SceneData *sceneData = static_cast<SceneData*>(userData);
+            auto recordStart = getTime();
+
+            // Rebuild the static shadow cache only if the light or static geometry changed
+            glm::vec3 lightPos = glm::vec3(sceneData->light.pos);
+            if (lightPos != lastShadowLightPos || sceneData->rotAngle != lastShadowRotAngle) {
+                shadowCube.cacheDirty = true;
+                lastShadowLightPos = lightPos;
+                lastShadowRotAngle = sceneData->rotAngle;
+            }
+
+            // Pass times of the last frame in this slot (fence already waited on)
+            bool gpuTimesRead = readVulkanGPUProfiler(vkInitData.device, gpuProfiler, this->currentImage);
+            beginVulkanFrameCapture(frameCapture, this->currentImage);
+
+            // Pick this frame's resolution (before anything depends on it)
+            updateRenderExtent(sceneData, gpuTimesRead);
 
             // Begin commands
             commandBuffer.begin(vk::CommandBufferBeginInfo());
+            recordGPUProfilerFrameBegin(commandBuffer, gpuProfiler, this->currentImage);
+            recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "frame");
 
-            // Get the extents of the buffers (since we'll use it a few times)
-            vk::Extent2D extent = vkInitData.swapchain.extent;
+            // Update uniform buffers before calling renderScene
+            {
+                CPU_PROFILE_SCOPE("ubo update");
+                updateUniformBuffers(sceneData, commandBuffer);
+            }
+
+            // Gather draw packets from the flattened scene graph
+            {
+                CPU_PROFILE_SCOPE("scene traversal");
+                renderQueue.begin();
+                staticShadowQueue.begin();
+                dynamicShadowQueue.begin();
+                renderScene(sceneData);
+            }
+
+            // Sort and upload instance data
+            renderQueue.upload(vkInitData.device, vkInitData.physicalDevice, 
+                               deviceInstances, this->currentImage);
+
+            // Shadow passes (before the main render pass)
+            if (sceneData->shadows) {
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "shadows", true);
+                recordShadowPasses(commandBuffer, lightPos);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+            }
+
+            if (multiviewActive) {
+                // Both eyes from one draw stream (culling is per view, so it is skipped)
+                hiz.valid = false;
+
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "main", true);
+                beginMainPass(commandBuffer, multiviewRenderPass, multiviewTarget.framebuffer,
+                              multiviewPipelineData.graphicsPipeline);
+                recordMainDraws(commandBuffer, sceneData, false, 0);
+                commandBuffer.endRenderPass();
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+                // Eyes side by side on the swapchain image
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "upscale");
+                recordUpscaleToSwapchain(commandBuffer, dynamicRes, multiviewTarget.color.image, STEREO_VIEWS,
+                                         renderExtent, vkInitData.swapchain.images.at(frameIndex),
+                                         vkInitData.swapchain.extent);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+                recordOverlay(commandBuffer, frameIndex);
+                recordVulkanFrameCapture(vkInitData, frameCapture, commandBuffer, this->currentImage,
+                                         vkInitData.swapchain.images.at(frameIndex), vkInitData.swapchain.extent);
+                commandBuffer.end();
+                lastRecordTime = getElapsedSeconds(recordStart, getTime());
+                return;
+            }
+
+            // Fill culling inputs (falls back to drawing everything if not possible)
+            bool culling = (sceneData->cullMode != CULL_OFF) && prepareCulling(sceneData);
+
+            // Only two-phase writes visibility, so start it over as all-visible
+            int cullMode = culling ? sceneData->cullMode : CULL_OFF;
+            if (culling && cullMode != lastCullMode) {
+                recordResetVisibility(commandBuffer);
+            }
+            lastCullMode = cullMode;
+
+            if (!culling) {
+                // Stale pyramid must not be used when culling gets turned back on
+                hiz.valid = false;
+
+                // Optionally skip meshlets that are off-screen or facing away
+                bool clusters = (sceneData->clusterCullMode != CLUSTER_CULL_OFF) 
+                                && prepareClusterDraws(sceneData);
 
-            // Begin render pass
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "main", true);
+                beginMainPass(commandBuffer, this->renderPass, this->framebuffers[0]);
+                if (clusters) {
+                    recordClusterDraws(commandBuffer, sceneData);
+                }
+                else {
+                    recordMainDraws(commandBuffer, sceneData, false, 0);
+                }
+                commandBuffer.endRenderPass();
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+            }
+            else if (sceneData->cullMode == CULL_SINGLE) {
+                // Cull against last frame's Hi-Z, draw, then build this frame's Hi-Z
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "cull");
+                recordCull(commandBuffer, 0, hiz.valid);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "main", true);
+                beginMainPass(commandBuffer, this->renderPass, this->framebuffers[0]);
+                recordMainDraws(commandBuffer, sceneData, true, 0);
+                commandBuffer.endRenderPass();
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "hiz");
+                recordBuildHiZ(commandBuffer, hiz, depthImage);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+                lastHiZViewProj = currentViewProj;
+                lastHiZExtent = renderExtent;
+            }
+            else {
+                // Early: what was visible last frame
+                // (scopes used twice per frame report their total)
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "cull");
+                recordCull(commandBuffer, 1, false);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "main", true);
+                beginMainPass(commandBuffer, earlyRenderPass, this->framebuffers[0]);
+                recordMainDraws(commandBuffer, sceneData, true, 0);
+                commandBuffer.endRenderPass();
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+                // Occluders from the early pass -> Hi-Z
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "hiz");
+                recordBuildHiZ(commandBuffer, hiz, depthImage);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+                lastHiZViewProj = currentViewProj;
+                lastHiZExtent = renderExtent;
+
+                // Late: everything else that is visible now
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "cull");
+                recordCull(commandBuffer, 2, true);
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+                recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "main", true);
+                beginMainPass(commandBuffer, lateRenderPass, this->framebuffers[0]);
+                recordMainDraws(commandBuffer, sceneData, true,
+                                renderQueue.getRunCount() * sizeof(vk::DrawIndexedIndirectCommand));
+                commandBuffer.endRenderPass();
+                recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+            }
+
+            // Scale the rendered region up to the swapchain image
+            recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "upscale");
+            recordDynamicResolutionUpscale(commandBuffer, dynamicRes, renderExtent,
+                                           vkInitData.swapchain.images.at(frameIndex),
+                                           vkInitData.swapchain.extent);
+            recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+            recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+            // Stats on top (after the "frame" scope, which drives the
+            // resolution scale, so showing them does not change it;
+            // captures include them)
+            recordOverlay(commandBuffer, frameIndex);
+
+            // Copy out the finished image if a capture was requested
+            recordVulkanFrameCapture(vkInitData, frameCapture, commandBuffer, this->currentImage,
+                                     vkInitData.swapchain.images.at(frameIndex), vkInitData.swapchain.extent);
+
+            // End command buffer
+            commandBuffer.end();
+            lastRecordTime = getElapsedSeconds(recordStart, getTime());
+        }
+
+        // GPU time of the last frame in this slot (the profiler's "frame"
+        // scope, just read) drives the scale; CPU frame time if the profiler
+        // has no timestamps or is switched off
+        void updateRenderExtent(SceneData *sceneData, bool gpuTimesRead) {
+            auto now = getTime();
+            float cpuFrameTime = getElapsedSeconds(lastFrameStart, now);
+            lastFrameStart = now;
+
+            multiviewActive = (sceneData->viewCnt > 1);
+            dynamicRes.enabled = sceneData->dynamicResolution;
+            dynamicRes.settings.targetFrameTime = sceneData->targetFrameTime;
+            if (gpuTimesRead) {
+                lastGPUFrameTime = 0.001f * getGPUScopeLastMs(gpuProfiler, "frame");
+                updateDynamicResolution(dynamicRes, lastGPUFrameTime);
+            }
+            else if (!gpuProfiler.supported || !gpuProfiler.enabled) {
+                updateDynamicResolution(dynamicRes, cpuFrameTime);
+            }
+            renderExtent = getDynamicResolutionExtent(dynamicRes);
+
+            // Each eye covers a (half-width) layer of the stereo target
+            if (multiviewActive) {
+                renderExtent.width = min(max(renderExtent.width / STEREO_VIEWS, 1u), multiviewTarget.width);
+                renderExtent.height = min(renderExtent.height, multiviewTarget.height);
+            }
+        }
+
+        vk::Extent2D getRenderExtent() {
+            return renderExtent;
+        }
+
+        float getResolutionScale() {
+            return dynamicRes.enabled ? dynamicRes.scale : dynamicRes.settings.maxScale;
+        }
+
+        float getGPUFrameTime() {
+            return lastGPUFrameTime;
+        }
+
+        VulkanGPUProfiler& getGPUProfiler() {
+            return gpuProfiler;
+        }
+
+        VulkanFrameCapture& getFrameCapture() {
+            return frameCapture;
+        }
+
+        VulkanOverlay& getOverlay() {
+            return overlay;
+        }
+
+        // One pass, one draw; its own GPU scope shows what it costs
+        void recordOverlay(vk::CommandBuffer &commandBuffer, unsigned int frameIndex) {
+            if (!overlay.visible) {
+                return;
+            }
+            recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "overlay");
+            float margin = 4.0f * getOverlayScale(overlay);
+            addOverlayPerformancePanel(overlay, margin, margin);
+            recordVulkanOverlay(commandBuffer, overlay, this->currentImage, frameIndex);
+            recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+        }
+
+        void beginMainPass( vk::CommandBuffer &commandBuffer, vk::RenderPass &pass, vk::Framebuffer framebuffer,
+                            vk::Pipeline pipeline = nullptr) {
+            // Only the dynamic resolution region is rendered
+            vk::Extent2D extent = renderExtent;
+
+            // Begin render pass (clear values are ignored by passes that load)
             array<vk::ClearValue, 2> clearValues {};
             clearValues[0].color = vk::ClearColorValue(1.0f, 1.0f, 0.7f, 1.0f);
             clearValues[1].depthStencil = vk::ClearDepthStencilValue(1.0f, 0.0f);
 
             commandBuffer.beginRenderPass(vk::RenderPassBeginInfo(
-                this->renderPass, 
-                this->framebuffers[frameIndex], 
+                pass, 
+                framebuffer, 
                 { {0,0}, extent },
                 clearValues),
                 vk::SubpassContents::eInline);
@@ -419,7 +1631,18 @@ class Assign05RenderEngine : public VulkanRenderEngine {
             // Bind pipeline
             commandBuffer.bindPipeline(
                 vk::PipelineBindPoint::eGraphics, 
-                this->pipelineData.graphicsPipeline);
+                pipeline ? pipeline : this->pipelineData.graphicsPipeline);
+
+            // Sets 0 (per frame) and 2 (bindless) stay bound; materials only
+            // change set 1 (so sets are bound with the layout that pushes it)
+            vk::PipelineLayout layout = pushMaterialsActive ? pushPipelineData.pipelineLayout 
+                                                            : this->pipelineData.pipelineLayout;
+            commandBuffer.bindDescriptorSets(
+                vk::PipelineBindPoint::eGraphics, layout, 0, descriptorSets[this->currentImage], {});
+            if (bindlessSupported) {
+                commandBuffer.bindDescriptorSets(
+                    vk::PipelineBindPoint::eGraphics, layout, 2, bindless.set, {});
+            }
 
             // Set up viewport and scissors
             vk::Viewport viewports[] = {{0, 0, (float)extent.width, (float)extent.height, 0.0f, 1.0f}};
@@ -427,55 +1650,363 @@ class Assign05RenderEngine : public VulkanRenderEngine {
 
             vk::Rect2D scissors[] = {{{0,0}, extent}};
             commandBuffer.setScissor(0, scissors);
+        }
 
-            // Update uniform buffers before calling renderScene
-            updateUniformBuffers(sceneData, commandBuffer);
-
-            // Call render scene
-            renderScene(commandBuffer, sceneData, sceneData->scene->mRootNode, glm::mat4(1.0f), 0);
-
-            // Stop render pass
-            commandBuffer.endRenderPass();
+        void recordMainDraws(   vk::CommandBuffer &commandBuffer, SceneData *sceneData, 
+                                bool indirect, vk::DeviceSize indirectOffset) {
+            // Multiview pass and pushed materials need their own pipelines
+            int depthID = multiviewActive ? multiviewDepthPipelineID : depthPipelineID;
+            int shadeEqualID = multiviewActive ? multiviewShadeEqualPipelineID 
+                             : (pushMaterialsActive ? pushShadeEqualPipelineID : shadeEqualPipelineID);
+            int shadeID = multiviewActive ? int(multiviewShadePipelineID) : -1;
+
+            if (!indirect) {
+                if (sceneData->depthPrepass) {
+                    // Lay down depth only, then shade ONLY the visible fragments
+                    renderQueue.record(commandBuffer, deviceInstances, this->currentImage, 
+                                       INSTANCE_BINDING, depthID);
+                    renderQueue.record(commandBuffer, deviceInstances, this->currentImage, 
+                                       INSTANCE_BINDING, shadeEqualID);
+                }
+                else {
+                    renderQueue.record(commandBuffer, deviceInstances, this->currentImage, 
+                                       INSTANCE_BINDING, shadeID);
+                }
+                return;
+            }
 
-            // End command buffer
-            commandBuffer.end();
+            // Same runs, but instance counts and data come from the culling shader
+            vk::Buffer instanceBuffer = culledInstances.bufferData[this->currentImage].buffer;
+            vk::Buffer indirectBuffer = deviceIndirect.bufferData[this->currentImage].buffer;
+            if (sceneData->depthPrepass) {
+                renderQueue.recordIndirect(commandBuffer, instanceBuffer, this->currentImage, INSTANCE_BINDING,
+                                           indirectBuffer, indirectOffset, depthID);
+                renderQueue.recordIndirect(commandBuffer, instanceBuffer, this->currentImage, INSTANCE_BINDING,
+                                           indirectBuffer, indirectOffset, shadeEqualID);
+            }
+            else {
+                renderQueue.recordIndirect(commandBuffer, instanceBuffer, this->currentImage, INSTANCE_BINDING,
+                                           indirectBuffer, indirectOffset);
+            }
         }
 
-        void extractMeshData(aiMesh *mesh, Mesh<Vertex> &m) {
-            m.vertices.clear();
-            m.indices.clear();
+        // CPU meshlet culling; returns false if the commands don't fit
+        bool prepareClusterDraws(SceneData *sceneData) {
+            glm::vec4 planes[6];
+            extractFrustumPlanes(currentViewProj, planes);
+            renderQueue.buildClusterDraws(planes, sceneData->eye, 
+                                          sceneData->clusterCullMode == CLUSTER_CULL_FRUSTUM_CONE);
+            clusterStats = renderQueue.getClusterStats();
+
+            const vector<vk::DrawIndexedIndirectCommand> &commands = renderQueue.getClusterCommands();
+            if (commands.size() > MAX_CLUSTER_DRAWS) {
+                return false;
+            }
+            memcpy(deviceClusterCommands.mapped[this->currentImage], commands.data(), 
+                   sizeof(vk::DrawIndexedIndirectCommand) * commands.size());
+            return true;
+        }
 
-            for(int i = 0; i < mesh->mNumVertices; ++i){
-                Vertex vertex;
+        void recordClusterDraws(vk::CommandBuffer &commandBuffer, SceneData *sceneData) {
+            vk::Buffer indirectBuffer = deviceClusterCommands.bufferData[this->currentImage].buffer;
+            if (sceneData->depthPrepass) {
+                renderQueue.recordClusters(commandBuffer, deviceInstances, this->currentImage, INSTANCE_BINDING,
+                                           indirectBuffer, maxDrawIndirectCnt, depthPipelineID);
+                renderQueue.recordClusters(commandBuffer, deviceInstances, this->currentImage, INSTANCE_BINDING,
+                                           indirectBuffer, maxDrawIndirectCnt,
+                                           pushMaterialsActive ? pushShadeEqualPipelineID : shadeEqualPipelineID);
+            }
+            else {
+                renderQueue.recordClusters(commandBuffer, deviceInstances, this->currentImage, INSTANCE_BINDING,
+                                           indirectBuffer, maxDrawIndirectCnt);
+            }
+        }
 
-                // Position
-                aiVector3D aiPos = mesh->mVertices[i];
-                vertex.pos = glm::vec3(aiPos.x, aiPos.y, aiPos.z);
+        MeshletCullStats getClusterStats() {
+            return clusterStats;
+        }
 
-                // Set color to yellow
-                vertex.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
-                
-                // Set normal
-                if (mesh->HasNormals()) {
-                    aiVector3D aiNormal = mesh->mNormals[i];
-                    vertex.normal = glm::vec3(aiNormal.x, aiNormal.y, aiNormal.z);
-                } else {
-                    vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);  // default up vector
+        // Writes per-frame culling inputs (after renderQueue.upload());
+        // returns false if culling can't be used this frame
+        bool prepareCulling(SceneData *sceneData) {
+            unsigned int frame = this->currentImage;
+            unsigned int instanceCnt = renderQueue.getPacketCount();
+            unsigned int runCnt = renderQueue.getRunCount();
+
+            // Stats from the last time these buffers were used (fence already waited on)
+            vk::DrawIndexedIndirectCommand *commands = 
+                static_cast<vk::DrawIndexedIndirectCommand*>(deviceIndirect.mapped[frame]);
+            if (lastCullRunCnt[frame] > 0) {
+                cullVisibleCnt = 0;
+                for (unsigned int r = 0; r < 2 * lastCullRunCnt[frame]; r++) {
+                    cullVisibleCnt += commands[r].instanceCount;
                 }
+                cullTotalCnt = lastCullInstanceCnt[frame];
+            }
+            lastCullRunCnt[frame] = 0;
 
-                m.vertices.push_back(vertex);
+            if (instanceCnt == 0 || instanceCnt > MAX_CULL_OBJECTS) {
+                return false;
             }
 
-            for(int i = 0; i < mesh->mNumFaces; ++i){
-                aiFace face = mesh->mFaces[i];
+            // Per-instance (run, object), per-run bounds, zeroed indirect commands
+            renderQueue.writeCullingData(static_cast<CullInstanceInfo*>(deviceCullInfo.mapped[frame]),
+                                         static_cast<glm::vec4*>(deviceRunBounds.mapped[frame]));
+            renderQueue.writeIndirectCommands(commands, 0);
+            renderQueue.writeIndirectCommands(commands + runCnt, instanceCnt);
+            ensureVulkanInstanceBufferCapacity(vkInitData.device, vkInitData.physicalDevice,
+                                               culledInstances, frame, 2 * instanceCnt);
+
+            lastCullRunCnt[frame] = runCnt;
+            lastCullInstanceCnt[frame] = instanceCnt;
+
+            // Two-phase tests against this frame's Hi-Z; single against the last one
+            UBOCull hostUBOCull;
+            hostUBOCull.hizViewProj = (sceneData->cullMode == CULL_TWO_PHASE) ? currentViewProj : lastHiZViewProj;
+            extractFrustumPlanes(currentViewProj, hostUBOCull.planes);
+            // Hi-Z texels only cover the region that was rendered into the depth buffer
+            vk::Extent2D hizExtent = (sceneData->cullMode == CULL_TWO_PHASE) ? renderExtent : lastHiZExtent;
+            hostUBOCull.hizSize = glm::vec4(hizExtent.width, hizExtent.height, hiz.mipCnt, 0.0f);
+            memcpy(deviceUBOCull.mapped[frame], &hostUBOCull, sizeof(UBOCull));
+
+            // Instance buffers may have been reallocated, so rewrite every binding
+            vk::DescriptorSet &set = cullDescriptorSets[frame];
+            vk::DescriptorBufferInfo uboInfo(deviceUBOCull.bufferData[frame].buffer, 0, sizeof(UBOCull));
+            vk::DescriptorBufferInfo srcInfo(deviceInstances.bufferData[frame].buffer, 0, VK_WHOLE_SIZE);
+            vk::DescriptorBufferInfo cullInfo(deviceCullInfo.bufferData[frame].buffer, 0, VK_WHOLE_SIZE);
+            vk::DescriptorBufferInfo boundsInfo(deviceRunBounds.bufferData[frame].buffer, 0, VK_WHOLE_SIZE);
+            vk::DescriptorBufferInfo indirectInfo(deviceIndirect.bufferData[frame].buffer, 0, VK_WHOLE_SIZE);
+            vk::DescriptorBufferInfo dstInfo(culledInstances.bufferData[frame].buffer, 0, VK_WHOLE_SIZE);
+            vk::DescriptorBufferInfo visibilityInfo(deviceVisibility.bufferData[0].buffer, 0, VK_WHOLE_SIZE);
+            vk::DescriptorImageInfo hizInfo(hiz.sampler, hiz.view, vk::ImageLayout::eGeneral);
+
+            vector<vk::WriteDescriptorSet> writes = {
+                vk::WriteDescriptorSet(set, 0, 0, vk::DescriptorType::eUniformBuffer, {}, uboInfo),
+                vk::WriteDescriptorSet(set, 1, 0, vk::DescriptorType::eStorageBuffer, {}, srcInfo),
+                vk::WriteDescriptorSet(set, 2, 0, vk::DescriptorType::eStorageBuffer, {}, cullInfo),
+                vk::WriteDescriptorSet(set, 3, 0, vk::DescriptorType::eStorageBuffer, {}, boundsInfo),
+                vk::WriteDescriptorSet(set, 4, 0, vk::DescriptorType::eStorageBuffer, {}, indirectInfo),
+                vk::WriteDescriptorSet(set, 5, 0, vk::DescriptorType::eStorageBuffer, {}, dstInfo),
+                vk::WriteDescriptorSet(set, 6, 0, vk::DescriptorType::eStorageBuffer, {}, visibilityInfo),
+                vk::WriteDescriptorSet(set, 7, 0, vk::DescriptorType::eCombinedImageSampler, hizInfo)
+            };
+            vkInitData.device.updateDescriptorSets(writes, {});
+
+            return true;
+        }
+
+        // Culling dispatch + barrier so draws (and later phases/host stats) see the results
+        void recordCull(vk::CommandBuffer &commandBuffer, unsigned int phase, bool useHiZ) {
+            CullPushConstants pc;
+            pc.instanceCnt = renderQueue.getPacketCount();
+            pc.runCnt = renderQueue.getRunCount();
+            pc.phase = phase;
+            pc.useHiZ = useHiZ ? 1 : 0;
+
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, cullPipelineData.pipeline);
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, cullPipelineData.pipelineLayout,
+                                             0, cullDescriptorSets[this->currentImage], {});
+            commandBuffer.pushConstants(cullPipelineData.pipelineLayout, vk::ShaderStageFlagBits::eCompute,
+                                        0, sizeof(CullPushConstants), &pc);
+            commandBuffer.dispatch(getComputeGroupCount(pc.instanceCnt, CULL_GROUP_SIZE), 1, 1);
+
+            vk::MemoryBarrier barrier(
+                vk::AccessFlagBits::eShaderWrite,
+                vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead
+                | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+                | vk::AccessFlagBits::eHostRead);
+            commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput
+                | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eHost,
+                {}, barrier, {}, {});
+        }
+
+        void recordResetVisibility(vk::CommandBuffer &commandBuffer) {
+            // On the GPU timeline: the other frame in flight may still be reading it
+            commandBuffer.fillBuffer(deviceVisibility.bufferData[0].buffer, 0, VK_WHOLE_SIZE, 1);
+
+            vk::MemoryBarrier barrier(
+                vk::AccessFlagBits::eTransferWrite,
+                vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+            commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eComputeShader,
+                {}, barrier, {}, {});
+        }
+
+        unsigned int getCullVisibleCount() {
+            return cullVisibleCnt;
+        }
+
+        unsigned int getCullTotalCount() {
+            return cullTotalCnt;
+        }
 
-                for(int j = 0; j < face.mNumIndices; ++j) {
-                    m.indices.push_back(face.mIndices[j]);
+        void recordShadowPasses(vk::CommandBuffer &commandBuffer, glm::vec3 lightPos) {
+            ShadowPushConstants pc;
+            pc.lightPosFar = glm::vec4(lightPos, shadowCube.farPlane);
+            vk::ShaderStageFlags pcStages = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+
+            // STATIC casters: only when something invalidated the cache
+            if (shadowCube.cacheDirty) {
+                staticShadowQueue.upload(vkInitData.device, vkInitData.physicalDevice,
+                                         staticShadowInstances, this->currentImage);
+
+                for (unsigned int face = 0; face < SHADOW_CUBE_FACES; face++) {
+                    pc.faceViewProj = getShadowCubeFaceViewProj(shadowCube, lightPos, face);
+                    beginShadowCubeFace(commandBuffer, shadowCube, face, true);
+                    commandBuffer.pushConstants(shadowPipelineData.pipelineLayout, pcStages, 
+                                                0, sizeof(ShadowPushConstants), &pc);
+                    staticShadowQueue.record(commandBuffer, staticShadowInstances, 
+                                             this->currentImage, INSTANCE_BINDING);
+                    commandBuffer.endRenderPass();
                 }
+
+                shadowCube.cacheDirty = false;
+                shadowCube.cacheRenderCnt++;
+            }
+
+            // Start from the cached static depth...
+            recordShadowCubeCacheCopy(commandBuffer, shadowCube);
+
+            // ...and only re-rasterize DYNAMIC casters on top
+            dynamicShadowQueue.upload(vkInitData.device, vkInitData.physicalDevice,
+                                      dynamicShadowInstances, this->currentImage);
+
+            for (unsigned int face = 0; face < SHADOW_CUBE_FACES; face++) {
+                pc.faceViewProj = getShadowCubeFaceViewProj(shadowCube, lightPos, face);
+                beginShadowCubeFace(commandBuffer, shadowCube, face, false);
+                commandBuffer.pushConstants(shadowPipelineData.pipelineLayout, pcStages, 
+                                            0, sizeof(ShadowPushConstants), &pc);
+                dynamicShadowQueue.record(commandBuffer, dynamicShadowInstances, 
+                                          this->currentImage, INSTANCE_BINDING);
+                commandBuffer.endRenderPass();
             }
         }
+
+        unsigned int getShadowCacheRenderCount() {
+            return shadowCube.cacheRenderCnt;
+        }
 };
 
+void generateExtraLights(unsigned int cnt) {
+    mt19937 rng(450);
+    float extent = 0.5f * sceneData.gridSpacing * sceneData.gridCnt + 1.0f;
+    uniform_real_distribution<float> xDist(-extent, extent);
+    uniform_real_distribution<float> yDist(-1.0f, 1.0f);
+    uniform_real_distribution<float> zDist(-2.0f * extent + 1.0f, 1.0f);
+    uniform_real_distribution<float> colorDist(0.0f, 1.0f);
+
+    sceneData.extraLights.clear();
+    for (unsigned int i = 0; i < cnt; i++) {
+        PointLight light;
+        light.pos = glm::vec4(xDist(rng), yDist(rng), zDist(rng), 1.0f);
+        light.vpos = glm::vec4(0.0f);
+        light.color = glm::vec4(colorDist(rng), colorDist(rng), colorDist(rng), 1.0f);
+        sceneData.extraLights.push_back(light);
+    }
+    cout << "Light count: " << (cnt + 1) << endl;
+}
+
+string getLODModeName(int lodMode) {
+    return (lodMode == LOD_AUTO) ? string("AUTO") : ("LOD " + to_string(lodMode));
+}
+
+// Per-feature state and counters shown under the overlay's frame times
+// (built only when its text refreshes); lastObjects is the Vulkan object
+// snapshot of the previous refresh
+void addFeatureOverlayLines(Assign05RenderEngine *engine, const LODStats &lodStats,
+                            VulkanObjectSnapshot &lastObjects, vector<string> &lines) {
+    ostringstream out;
+    out << fixed << setprecision(2);
+
+    vk::Extent2D renderExtent = engine->getRenderExtent();
+    out << "Res " << int(100.0f * engine->getResolutionScale() + 0.5f) << "% "
+        << renderExtent.width << "x" << renderExtent.height
+        << (sceneData.dynamicResolution ? " (dynamic)" : "")
+        << "  pre-pass " << (sceneData.depthPrepass ? "ON" : "OFF")
+        << "  lights " << (sceneData.extraLights.size() + 1);
+    lines.push_back(out.str());
+
+    out.str("");
+    out << "Shadow cache rebuilds " << engine->getShadowCacheRenderCount();
+    if (sceneData.viewCnt > 1) {
+        out << "  stereo " << sceneData.viewCnt << " views (no culling)";
+    }
+    else if (sceneData.cullMode != CULL_OFF) {
+        out << "  cull " << CULL_MODE_NAMES[sceneData.cullMode]
+            << " " << engine->getCullVisibleCount() << "/" << engine->getCullTotalCount();
+    }
+    else if (sceneData.clusterCullMode != CLUSTER_CULL_OFF) {
+        MeshletCullStats clusterStats = engine->getClusterStats();
+        out << "  meshlets " << CLUSTER_CULL_MODE_NAMES[sceneData.clusterCullMode]
+            << " " << clusterStats.drawnCnt << "/" << clusterStats.testedCnt
+            << " (frustum " << clusterStats.frustumCulledCnt
+            << ", back " << clusterStats.backfaceCulledCnt << ")";
+    }
+    lines.push_back(out.str());
+
+    out.str("");
+    out << "Materials " << MATERIAL_MODE_NAMES[sceneData.materialMode];
+    if (sceneData.materialMode == MATERIAL_PUSH && !engine->isPushDescriptorSupported()) {
+        out << " [pooled]";
+    }
+    out << "  binds " << engine->getMaterialBindCount()
+        << "  record " << (1000.0f * engine->getRecordTime()) << " ms";
+    lines.push_back(out.str());
+
+    out.str("");
+    out << "LOD " << getLODModeName(sceneData.lodMode);
+    if (sceneData.lodMode == LOD_AUTO) {
+        out << " (" << sceneData.lodPixelError << " px)";
+    }
+    for (unsigned int l = 0; l < MESH_MAX_LODS; l++) {
+        out << " L" << l << " " << lodStats.instanceCnt[l] << "/" << lodStats.triangleCnt[l];
+    }
+    lines.push_back(out.str());
+
+    // Pipeline statistics (Q), relative to the rendered pixels
+    unsigned long long pixelCnt = (unsigned long long)renderExtent.width * renderExtent.height * sceneData.viewCnt;
+    for (auto &stats : getGPUScopeStats(engine->getGPUProfiler())) {
+        if (stats.pipelineStatsFrameCnt == 0) {
+            continue;
+        }
+        out.str("");
+        out << stats.name << " overdraw " << getGPUOverdraw(stats.pipelineStats, pixelCnt)
+            << "x  ACMR " << getGPUVertexACMR(stats.pipelineStats);
+        lines.push_back(out.str());
+    }
+
+    FrameCaptureStats captureStats = getVulkanFrameCaptureStats(engine->getFrameCapture());
+    if (captureStats.requestedCnt > 0) {
+        out.str("");
+        out << "Capture written " << captureStats.writtenCnt << "  pending " << captureStats.pendingCnt
+            << "  dropped " << captureStats.droppedCnt << "  failed " << captureStats.failedCnt;
+        lines.push_back(out.str());
+    }
+
+    // Live objects should stop changing once everything is loaded
+    VulkanObjectSnapshot objects = getVulkanObjectSnapshot();
+    VulkanObjectSnapshot objectDiff = diffVulkanObjectSnapshots(lastObjects, objects);
+    long long countDiff = 0;
+    long long bytesDiff = 0;
+    for (int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        countDiff += objectDiff.count[type];
+        bytesDiff += objectDiff.bytes[type];
+    }
+    out.str("");
+    if (isVulkanObjectSnapshotEmpty(objectDiff)) {
+        out << "Vulkan objects steady";
+    }
+    else {
+        out << showpos << "Vulkan objects changed: " << countDiff << " objects, "
+            << (bytesDiff / (1024.0 * 1024.0)) << " MB" << noshowpos;
+    }
+    lines.push_back(out.str());
+    lastObjects = objects;
+}
+
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         switch (key) {
@@ -557,6 +2088,120 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
                 sceneData.roughness += 0.1f;
                 if (sceneData.roughness > 0.7f) sceneData.roughness = 0.7f;
                 break;
+            case GLFW_KEY_RIGHT_BRACKET: {
+                // Double lights (1 -> 2 -> 4 ... -> MAX_LIGHTS)
+                unsigned int total = min(MAX_LIGHTS, 2 * (unsigned int)(sceneData.extraLights.size() + 1));
+                generateExtraLights(total - 1);
+                break;
+            }
+            case GLFW_KEY_LEFT_BRACKET: {
+                // Halve lights
+                unsigned int total = max(1u, (unsigned int)(sceneData.extraLights.size() + 1) / 2);
+                generateExtraLights(total - 1);
+                break;
+            }
+            case GLFW_KEY_H:
+                if (action == GLFW_PRESS) {
+                    sceneData.shadows = !sceneData.shadows;
+                    cout << "Shadows: " << (sceneData.shadows ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_O:
+                if (action == GLFW_PRESS) {
+                    sceneData.animateDynamic = !sceneData.animateDynamic;
+                }
+                break;
+            case GLFW_KEY_C:
+                if (action == GLFW_PRESS) {
+                    sceneData.cullMode = (sceneData.cullMode + 1) % CULL_MODE_CNT;
+                    cout << "Occlusion culling: " << CULL_MODE_NAMES[sceneData.cullMode] << endl;
+                }
+                break;
+            case GLFW_KEY_G:
+                if (action == GLFW_PRESS) {
+                    sceneData.clusterCullMode = (sceneData.clusterCullMode + 1) % CLUSTER_CULL_MODE_CNT;
+                    cout << "Meshlet culling: " << CLUSTER_CULL_MODE_NAMES[sceneData.clusterCullMode] << endl;
+                }
+                break;
+            case GLFW_KEY_L:
+                if (action == GLFW_PRESS) {
+                    sceneData.lodMode++;
+                    if (sceneData.lodMode >= int(MESH_MAX_LODS)) {
+                        sceneData.lodMode = LOD_AUTO;
+                    }
+                    cout << "LOD: " << getLODModeName(sceneData.lodMode) << endl;
+                }
+                break;
+            case GLFW_KEY_COMMA:
+            case GLFW_KEY_PERIOD:
+                if (action == GLFW_PRESS || action == GLFW_REPEAT) {
+                    sceneData.lodPixelError *= (key == GLFW_KEY_PERIOD) ? 2.0f : 0.5f;
+                    sceneData.lodPixelError = glm::clamp(sceneData.lodPixelError, 0.125f, 64.0f);
+                    cout << "LOD pixel error: " << sceneData.lodPixelError << endl;
+                }
+                break;
+            case GLFW_KEY_R:
+                if (action == GLFW_PRESS) {
+                    sceneData.dynamicResolution = !sceneData.dynamicResolution;
+                    cout << "Dynamic resolution: " << (sceneData.dynamicResolution ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_MINUS:
+            case GLFW_KEY_EQUAL:
+                sceneData.targetFrameTime += (key == GLFW_KEY_EQUAL) ? 0.001f : -0.001f;
+                sceneData.targetFrameTime = glm::clamp(sceneData.targetFrameTime, 0.002f, 0.1f);
+                cout << "Target GPU frame time: " << (1000.0f * sceneData.targetFrameTime) << " ms" << endl;
+                break;
+            case GLFW_KEY_P:
+                if (action == GLFW_PRESS) {
+                    sceneData.depthPrepass = !sceneData.depthPrepass;
+                    cout << "Depth pre-pass: " << (sceneData.depthPrepass ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_T:
+                if (action == GLFW_PRESS) {
+                    sceneData.materialMode = (sceneData.materialMode + 1) % MATERIAL_MODE_CNT;
+                    if (sceneData.materialMode == MATERIAL_BINDLESS && !sceneData.bindlessSupported) {
+                        sceneData.materialMode = (sceneData.materialMode + 1) % MATERIAL_MODE_CNT;
+                    }
+                    cout << "Materials: " << MATERIAL_MODE_NAMES[sceneData.materialMode] << endl;
+                }
+                break;
+            case GLFW_KEY_Q:
+                if (action == GLFW_PRESS) {
+                    sceneData.pipelineStats = !sceneData.pipelineStats;
+                    cout << "Pipeline statistics: " << (sceneData.pipelineStats ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_F:
+                if (action == GLFW_PRESS) {
+                    sceneData.tracing = !sceneData.tracing;
+                    cout << "Trace capture: " << (sceneData.tracing ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_F12:
+                if (action == GLFW_PRESS) {
+                    sceneData.screenshotRequested = true;
+                }
+                break;
+            case GLFW_KEY_F9:
+                if (action == GLFW_PRESS) {
+                    sceneData.recordingFrames = !sceneData.recordingFrames;
+                    cout << "Frame recording: " << (sceneData.recordingFrames ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_F1:
+                if (action == GLFW_PRESS) {
+                    sceneData.overlay = !sceneData.overlay;
+                    cout << "Overlay: " << (sceneData.overlay ? "ON" : "OFF") << endl;
+                }
+                break;
+            case GLFW_KEY_X:
+                if (action == GLFW_PRESS) {
+                    sceneData.viewCnt = (sceneData.viewCnt > 1) ? 1 : 2;
+                    cout << "Stereo (multiview): " << (sceneData.viewCnt > 1 ? "ON" : "OFF") << endl;
+                }
+                break;
         }
     }
 }
@@ -571,26 +2216,39 @@ int main(int argc, char **argv) {
     int windowWidth = 800;
     int windowHeight = 600;
 
-    // Create GLFW window
-    GLFWwindow* window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+    // Optional headless run (--headless N): render N frames offscreen, then
+    // exit (no display needed; works on software ICDs such as lavapipe)
+    int headlessFrames = getHeadlessFrameCount(argc, argv);
+    bool headless = (headlessFrames > 0);
 
-    // Key callback
-    glfwSetKeyCallback(window, keyCallback);
+    GLFWwindow* window = nullptr;
+    VulkanInitData vkInitData;
 
-    // Get initial mouse position
-    double mx, my;
-    glfwGetCursorPos(window, &mx, &my);
-    sceneData.mousePos = glm::vec2(mx, my);
-    
-    // Set mouse callback
-    glfwSetCursorPosCallback(window, mouse_position_callback);
-    
-    // Hide cursor
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (headless) {
+        // Setup up Vulkan via vk-bootstrap (offscreen swapchain)
+        initVulkanBootstrapHeadless(appName, windowWidth, windowHeight, vkInitData);
+    }
+    else {
+        // Create GLFW window
+        window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
 
-    // Setup up Vulkan via vk-bootstrap
-    VulkanInitData vkInitData;
-    initVulkanBootstrap(appName, window, vkInitData);
+        // Key callback
+        glfwSetKeyCallback(window, keyCallback);
+
+        // Get initial mouse position
+        double mx, my;
+        glfwGetCursorPos(window, &mx, &my);
+        sceneData.mousePos = glm::vec2(mx, my);
+        
+        // Set mouse callback
+        glfwSetCursorPosCallback(window, mouse_position_callback);
+        
+        // Hide cursor
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        // Setup up Vulkan via vk-bootstrap
+        initVulkanBootstrap(appName, window, vkInitData);
+    }
 
     // Load model
     string modelPath = "sampleModels/sphere.obj";
@@ -598,6 +2256,10 @@ int main(int argc, char **argv) {
     if (argc >= 2) 
         modelPath = string(argv[1]);
 
+    // Optional stress test grid size
+    if (argc >= 3)
+        sceneData.gridCnt = max(1, atoi(argv[2]));
+
     Assimp::Importer importer;
     sceneData.scene = importer.ReadFile(modelPath,
         aiProcess_Triangulate |
@@ -617,39 +2279,163 @@ int main(int argc, char **argv) {
         cout << "Scene root node is null " << endl;
     }
 
+    // Flatten scene hierarchy ONCE (one subtree per stress test copy)
+    int gridRoot = addSceneGraphNode(sceneData.graph, -1, glm::mat4(1.0f));
+    float gridOffset = 0.5f * sceneData.gridSpacing * (sceneData.gridCnt - 1);
+    for (int x = 0; x < sceneData.gridCnt; x++) {
+        for (int z = 0; z < sceneData.gridCnt; z++) {
+            glm::mat4 copyMat = glm::translate(glm::vec3(
+                x * sceneData.gridSpacing - gridOffset,
+                0.0f,
+                -z * sceneData.gridSpacing));
+            int copyNode = addSceneGraphNode(sceneData.graph, gridRoot, copyMat);
+            addAssimpSceneGraph(sceneData.graph, sceneData.scene->mRootNode, copyNode);
+
+            // First copy is the dynamic shadow caster
+            if (sceneData.dynamicRoot < 0) {
+                sceneData.dynamicRoot = copyNode;
+                sceneData.dynamicRootMat = copyMat;
+            }
+        }
+    }
+    finalizeSceneGraph(sceneData.graph);
+
     // Setup basic forward rendering process
     string vertSPVFilename = "build/compiledshaders/" + appName + "/shader.vert.spv";                                                    
     string fragSPVFilename = "build/compiledshaders/" + appName + "/shader.frag.spv";
+    string depthVertSPVFilename = "build/compiledshaders/" + appName + "/depth.vert.spv";
+    string shadowVertSPVFilename = "build/compiledshaders/" + appName + "/shadow.vert.spv";
+    string shadowFragSPVFilename = "build/compiledshaders/" + appName + "/shadow.frag.spv";
+    string hizCompSPVFilename = "build/compiledshaders/" + appName + "/hiz.comp.spv";
+    string cullCompSPVFilename = "build/compiledshaders/" + appName + "/cull.comp.spv";
+    string overlayVertSPVFilename = "build/compiledshaders/" + appName + "/overlay.vert.spv";
+    string overlayFragSPVFilename = "build/compiledshaders/" + appName + "/overlay.frag.spv";
+    string noBindlessFragSPVFilename = "build/compiledshaders/" + appName + "/shader_nobindless.frag.spv";
     
     // Create render engine
-    VulkanInitRenderParams params = {
-        vertSPVFilename, fragSPVFilename
-    };    
+    Assign05RenderParams params;
+    params.vertSPVFilename = vertSPVFilename;
+    params.fragSPVFilename = fragSPVFilename;
+    params.depthVertSPVFilename = depthVertSPVFilename;
+    params.shadowVertSPVFilename = shadowVertSPVFilename;
+    params.shadowFragSPVFilename = shadowFragSPVFilename;
+    params.hizCompSPVFilename = hizCompSPVFilename;
+    params.cullCompSPVFilename = cullCompSPVFilename;
+    params.overlayVertSPVFilename = overlayVertSPVFilename;
+    params.overlayFragSPVFilename = overlayFragSPVFilename;
+    params.noBindlessFragSPVFilename = noBindlessFragSPVFilename;
+
     VulkanRenderEngine *renderEngine = new Assign05RenderEngine(vkInitData);
     renderEngine->initialize(&params);
+    sceneData.bindlessSupported = static_cast<Assign05RenderEngine*>(renderEngine)->isBindlessSupported();
+    if (!sceneData.bindlessSupported) {
+        cout << "Descriptor indexing not supported: BINDLESS materials disabled" << endl;
+    }
 
     // Load all meshes from the scene
     for (int i = 0; i < sceneData.scene->mNumMeshes; ++i) {
         Mesh<Vertex> mesh;
-        static_cast<Assign05RenderEngine*>(renderEngine)->
-            extractMeshData(sceneData.scene->mMeshes[i], mesh);
+        extractMeshData(sceneData.scene->mMeshes[i], mesh);
+
+        // Split into meshlets (reorders indices) before uploading
+        sceneData.meshMeshlets.push_back(buildMeshlets(mesh));
+
+        // Simplified LODs are appended to the (already reordered) indices
+        sceneData.meshLODs.push_back(buildMeshLODs(mesh));
+
         VulkanMesh vulkanMesh = 
             createVulkanMesh(vkInitData, renderEngine->getCommandPool(), mesh);
         sceneData.allMeshes.push_back(vulkanMesh);
+        sceneData.meshBounds.push_back(computeMeshBoundingSphere(mesh));
+    }
+    static_cast<Assign05RenderEngine*>(renderEngine)->registerMeshes(
+        sceneData.allMeshes, sceneData.meshBounds, sceneData.meshMeshlets, sceneData.meshLODs);
+
+    for (unsigned int i = 0; i < sceneData.meshLODs.size(); i++) {
+        cout << "Mesh " << i << " LODs (triangles/error):";
+        for (auto &lod : sceneData.meshLODs[i]) {
+            cout << " " << (lod.indexCnt / 3) << "/" << lod.error;
+        }
+        cout << endl;
+    }
+
+    // Frame time per LOD mode (AUTO + each forced level), reported at exit;
+    // a forced mode draws only that level, so its GPU time is the level's
+    vector<double> lodModeTime(MESH_MAX_LODS + 1, 0.0);
+    vector<unsigned long long> lodModeFrames(MESH_MAX_LODS + 1, 0);
+    vector<double> lodModeGPUTime(MESH_MAX_LODS + 1, 0.0);
+    vector<unsigned long long> lodModeGPUFrames(MESH_MAX_LODS + 1, 0);
+    vector<unsigned long long> lodModeTriangles(MESH_MAX_LODS + 1, 0);
+
+    // Frame time, command recording time, and material binds per material mode
+    vector<double> materialModeTime(MATERIAL_MODE_CNT, 0.0);
+    vector<double> materialModeRecordTime(MATERIAL_MODE_CNT, 0.0);
+    vector<unsigned long long> materialModeFrames(MATERIAL_MODE_CNT, 0);
+    vector<unsigned long long> materialModeBinds(MATERIAL_MODE_CNT, 0);
+    vector<unsigned long long> materialModeDraws(MATERIAL_MODE_CNT, 0);
+
+    // Trace ring (the last ~260k CPU/GPU scopes)
+    ChromeTrace trace = createChromeTrace();
+    const char *traceEnv = getenv("FORGE_TRACE");
+    if (traceEnv && traceEnv[0] != '\0') {
+        sceneData.tracing = true;
+        sceneData.tracePath = traceEnv;
     }
 
     float timeElapsed = 1.0f;
     int framesRendered = 0;
     auto startCountTime = getTime();
+
+    // Live Vulkan objects at the last overlay refresh (should stop changing)
+    VulkanObjectSnapshot lastObjects = getVulkanObjectSnapshot();
     float fpsCalcWindow = 5.0f;
+
+    // Numbers screenshots and sequences of this run
+    unsigned int screenshotCnt = 0;
+    unsigned int sequenceCnt = 0;
                                        
     // Main render loop
-    while (!glfwWindowShouldClose(window)) {
+    int framesLeft = headlessFrames;
+    while (headless ? (framesLeft-- > 0) : !glfwWindowShouldClose(window)) {
         // Get start time        
         auto startTime = getTime();
 
+        // Start/stop trace capture
+        Assign05RenderEngine *assignEngine = static_cast<Assign05RenderEngine*>(renderEngine);
+        if (sceneData.tracing != trace.enabled) {
+            if (sceneData.tracing) {
+                clearChromeTrace(trace);
+            }
+            else {
+                collectGPUProfileTrace(assignEngine->getGPUProfiler(), trace);
+                writeChromeTrace(trace, sceneData.tracePath);
+            }
+            trace.enabled = sceneData.tracing;
+            assignEngine->getGPUProfiler().tracing = sceneData.tracing;
+        }
+        assignEngine->getGPUProfiler().pipelineStatsEnabled = sceneData.pipelineStats;
+        assignEngine->getOverlay().visible = sceneData.overlay;
+
+        VulkanFrameCapture &frameCapture = assignEngine->getFrameCapture();
+        if (sceneData.screenshotRequested) {
+            string filename = sceneData.capturePrefix + "_screenshot" + to_string(screenshotCnt++) + ".png";
+            captureNextVulkanFrame(frameCapture, filename);
+            cout << "Screenshot: " << filename << endl;
+            sceneData.screenshotRequested = false;
+        }
+        if (sceneData.recordingFrames != frameCapture.recording) {
+            if (sceneData.recordingFrames) {
+                startVulkanFrameRecording(frameCapture, sceneData.capturePrefix + "_seq" + to_string(sequenceCnt++));
+            }
+            else {
+                stopVulkanFrameRecording(frameCapture);
+            }
+        }
+
         // Poll events for window
-        glfwPollEvents();  
+        if (!headless) {
+            glfwPollEvents();  
+        }
 
         // Update view matrix
         sceneData.viewMat = glm::lookAt(
@@ -659,10 +2445,13 @@ int main(int argc, char **argv) {
         );
 
         // Calculate aspect ratio and update projection matrix
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
+        int width = windowWidth, height = windowHeight;
+        if (!headless) {
+            glfwGetFramebufferSize(window, &width, &height);
+        }
         float aspect = (width > 0 && height > 0) ? 
             static_cast<float>(width) / static_cast<float>(height) : 1.0f;
+        aspect /= sceneData.viewCnt;    // Views share the width
         
         sceneData.projMat = glm::perspective(
             glm::radians(90.0f),
@@ -673,6 +2462,14 @@ int main(int argc, char **argv) {
         
         // Update light view position based on current view matrix
         sceneData.light.vpos = sceneData.viewMat * sceneData.light.pos;
+
+        // Spin the dynamic shadow caster (only its subtree gets dirty)
+        if (sceneData.animateDynamic && sceneData.dynamicRoot >= 0) {
+            sceneData.spinAngle += 1.0f;
+            setSceneGraphLocalMat(sceneData.graph, sceneData.dynamicRoot,
+                sceneData.dynamicRootMat * glm::rotate(glm::radians(sceneData.spinAngle), 
+                                                       glm::vec3(0.0f, 1.0f, 0.0f)));
+        }
         
         // Draw frame
         renderEngine->drawFrame(&sceneData);
@@ -683,6 +2480,41 @@ int main(int argc, char **argv) {
         // Get end and elapsed
         auto endTime = getTime();
         float frameTime = getElapsedSeconds(startTime, endTime);
+
+        // Keep the per-thread profiler rings drained (once per frame)
+        addCPUFrameTime(frameTime);
+        collectCPUProfileTrace(trace);
+        collectGPUProfileTrace(assignEngine->getGPUProfiler(), trace);
+
+        LODStats lodStats = assignEngine->getLODStats();
+        unsigned int lodSlot = sceneData.lodMode + 1;
+        lodModeTime[lodSlot] += frameTime;
+        lodModeFrames[lodSlot]++;
+        if (assignEngine->getGPUFrameTime() > 0.0f) {
+            lodModeGPUTime[lodSlot] += assignEngine->getGPUFrameTime();
+            lodModeGPUFrames[lodSlot]++;
+        }
+        for (unsigned int l = 0; l < MESH_MAX_LODS; l++) {
+            lodModeTriangles[lodSlot] += lodStats.triangleCnt[l];
+        }
+        materialModeTime[sceneData.materialMode] += frameTime;
+        materialModeRecordTime[sceneData.materialMode] += assignEngine->getRecordTime();
+        materialModeFrames[sceneData.materialMode]++;
+        materialModeBinds[sceneData.materialMode] += assignEngine->getMaterialBindCount();
+        materialModeDraws[sceneData.materialMode] += assignEngine->getDrawCount();
+
+        // Overlay history every frame; its text only while shown
+        OverlayFrameInfo overlayInfo;
+        overlayInfo.cpuFrameTime = frameTime;
+        overlayInfo.gpuFrameTime = assignEngine->getGPUFrameTime();
+        overlayInfo.drawCnt = assignEngine->getDrawCount();
+        for (unsigned int l = 0; l < MESH_MAX_LODS; l++) {
+            overlayInfo.triangleCnt += lodStats.triangleCnt[l];
+        }
+        if (isVulkanOverlayRefreshDue(assignEngine->getOverlay(), frameTime)) {
+            addFeatureOverlayLines(assignEngine, lodStats, lastObjects, overlayInfo.extraLines);
+        }
+        updateVulkanOverlayStats(assignEngine->getOverlay(), overlayInfo, &assignEngine->getGPUProfiler());
         
         float timeSoFar = getElapsedSeconds(startCountTime, getTime());
 
@@ -695,8 +2527,56 @@ int main(int argc, char **argv) {
         }        
     }
         
+    // Frame time per LOD mode
+    cout << "LOD mode: frames, avg frame ms, avg GPU frame ms, avg triangles" << endl;
+    for (unsigned int slot = 0; slot <= MESH_MAX_LODS; slot++) {
+        if (lodModeFrames[slot] > 0) {
+            double gpuMs = (lodModeGPUFrames[slot] > 0) ? 
+                           (1000.0 * lodModeGPUTime[slot] / lodModeGPUFrames[slot]) : 0.0;
+            cout << "  " << getLODModeName(int(slot) - 1) << ": " << lodModeFrames[slot]
+                 << ", " << (1000.0 * lodModeTime[slot] / lodModeFrames[slot])
+                 << ", " << gpuMs
+                 << ", " << (lodModeTriangles[slot] / lodModeFrames[slot]) << endl;
+        }
+    }
+
+    // Frame time per material mode
+    cout << "Material mode: frames, avg frame ms, avg record ms, avg material binds, avg draws" << endl;
+    for (unsigned int mode = 0; mode < MATERIAL_MODE_CNT; mode++) {
+        if (materialModeFrames[mode] > 0) {
+            cout << "  " << MATERIAL_MODE_NAMES[mode] << ": " << materialModeFrames[mode]
+                 << ", " << (1000.0 * materialModeTime[mode] / materialModeFrames[mode])
+                 << ", " << (1000.0 * materialModeRecordTime[mode] / materialModeFrames[mode])
+                 << ", " << (materialModeBinds[mode] / materialModeFrames[mode])
+                 << ", " << (materialModeDraws[mode] / materialModeFrames[mode]) << endl;
+        }
+    }
+
+    // CPU frame time percentiles and GPU time per pass (last frames)
+    printCPUProfileStats();
+    printGPUScopeStats(static_cast<Assign05RenderEngine*>(renderEngine)->getGPUProfiler());
+    vk::Extent2D lastExtent = static_cast<Assign05RenderEngine*>(renderEngine)->getRenderExtent();
+    printGPUPipelineStats(static_cast<Assign05RenderEngine*>(renderEngine)->getGPUProfiler(),
+        (unsigned long long)lastExtent.width * lastExtent.height * sceneData.viewCnt);
+
     // Make sure all queues on GPU are done
     vkInitData.device.waitIdle();
+
+    // Captures still in flight or encoding
+    VulkanFrameCapture &frameCapture = static_cast<Assign05RenderEngine*>(renderEngine)->getFrameCapture();
+    flushVulkanFrameCapture(frameCapture);
+    FrameCaptureStats captureStats = getVulkanFrameCaptureStats(frameCapture);
+    if (captureStats.requestedCnt > 0) {
+        cout << "Frame capture: written " << captureStats.writtenCnt << " of " << captureStats.requestedCnt
+             << " (dropped " << captureStats.droppedCnt << ", failed " << captureStats.failedCnt << ")" << endl;
+    }
+
+    // Trace still capturing: write what the ring holds
+    if (trace.enabled) {
+        collectCPUProfileTrace(trace);
+        collectGPUProfileTrace(static_cast<Assign05RenderEngine*>(renderEngine)->getGPUProfiler(), trace);
+        writeChromeTrace(trace, sceneData.tracePath);
+    }
     
     // Cleanup meshes
     for (auto &mesh : sceneData.allMeshes) {
@@ -706,7 +2586,16 @@ int main(int argc, char **argv) {
 
     delete renderEngine;
     cleanupVulkanBootstrap(vkInitData);
-    cleanupGLFWWindow(window);
+    if (!headless) {
+        cleanupGLFWWindow(window);
+    }
+
+    // Anything still tracked was never cleaned up
+    VulkanObjectSnapshot leaked = getVulkanObjectSnapshot();
+    if (!isVulkanObjectSnapshotEmpty(leaked)) {
+        cout << "LEAKED: ";
+        printVulkanObjectSnapshot(leaked, cout, 20);
+    }
     
     cout << "FORGING DONE!!!" << endl;
     return 0;
@@ -11,12 +11,26 @@ int main(int argc, char **argv) {
     int windowWidth = 800;
     int windowHeight = 600;
 
-    // Create GLFW window
-    GLFWwindow* window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+    // Optional headless run (--headless N): render N frames offscreen, then exit
+    int headlessFrames = getHeadlessFrameCount(argc, argv);
+    bool headless = (headlessFrames > 0);
 
-    // Setup up Vulkan via vk-bootstrap
+    GLFWwindow* window = nullptr;
     VulkanInitData vkInitData;
-    if(!initVulkanBootstrap(appName, window, vkInitData)) {
+    bool initOK = false;
+
+    if(headless) {
+        // Setup up Vulkan via vk-bootstrap (offscreen swapchain)
+        initOK = initVulkanBootstrapHeadless(appName, windowWidth, windowHeight, vkInitData);
+    }
+    else {
+        // Create GLFW window
+        window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+
+        // Setup up Vulkan via vk-bootstrap
+        initOK = initVulkanBootstrap(appName, window, vkInitData);
+    }
+    if(!initOK) {
         cerr << "Vulkan Init Failed.  Cannot proceed." << endl;
         return 1;
     }
@@ -55,12 +69,15 @@ int main(int argc, char **argv) {
     float fpsCalcWindow = 5.0f;
                                        
     // Main render loop
-    while (!glfwWindowShouldClose(window)) {
+    int framesLeft = headlessFrames;
+    while (headless ? (framesLeft-- > 0) : !glfwWindowShouldClose(window)) {
         // Get start time        
         auto startTime = getTime();
 
         // Poll events for window
-        glfwPollEvents();  
+        if(!headless) {
+            glfwPollEvents();  
+        }
 
         // Draw frame
         renderEngine->drawFrame(&allMeshes);  
@@ -90,7 +107,9 @@ int main(int argc, char **argv) {
     cleanupVulkanMesh(vkInitData, mesh);
     delete renderEngine;
     cleanupVulkanBootstrap(vkInitData);
-    cleanupGLFWWindow(window);
+    if(!headless) {
+        cleanupGLFWWindow(window);
+    }
     
     cout << "FORGING DONE!!!" << endl;
     return 0;
@@ -0,0 +1,314 @@
+#include "VKSetup.hpp"
+#include "VKRender.hpp"
+#include "VKDeferred.hpp"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include "MeshData.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#define GLM_ENABLE_EXPERIMENTAL
+#include "glm/gtx/transform.hpp"
+#include "VKUtility.hpp"
+#include "SceneGraph.hpp"
+#include "BatchTransform.hpp"
+#include <random>
+
+///////////////////////////////////////////////////////////////////////////////
+// Deferred shading demo: same scene as Assign05, lit once per pixel
+///////////////////////////////////////////////////////////////////////////////
+
+struct SceneData {
+    vector<VulkanMesh> allMeshes;
+    vector<unsigned int> meshIDs;
+    FlatSceneGraph graph;
+    float rotAngle = 0.0f;
+
+    glm::vec3 eye = glm::vec3(0.0f, 0.0f, 1.0f);
+    glm::vec3 lookAt = glm::vec3(0.0f, 0.0f, 0.0f);
+
+    glm::vec4 lightPos = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+    glm::vec4 lightColor = glm::vec4(1.0f);
+    vector<glm::vec4> extraLightPos;
+    vector<glm::vec4> extraLightColor;
+    float extraLightRadius = 0.5f;
+
+    int gridCnt = 1;
+    float gridSpacing = 2.0f;
+
+    DeferredSceneData frame;
+};
+
+SceneData sceneData;
+
+void extractMeshData(aiMesh *mesh, Mesh<DeferredVertex> &m) {
+    m.vertices.clear();
+    m.indices.clear();
+
+    for(int i = 0; i < mesh->mNumVertices; ++i) {
+        DeferredVertex vertex;
+        aiVector3D aiPos = mesh->mVertices[i];
+        vertex.pos = glm::vec3(aiPos.x, aiPos.y, aiPos.z);
+        vertex.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+
+        if(mesh->HasNormals()) {
+            aiVector3D aiNormal = mesh->mNormals[i];
+            vertex.normal = glm::vec3(aiNormal.x, aiNormal.y, aiNormal.z);
+        }
+        else {
+            vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+
+        m.vertices.push_back(vertex);
+    }
+
+    for(int i = 0; i < mesh->mNumFaces; ++i) {
+        aiFace face = mesh->mFaces[i];
+        for(int j = 0; j < face.mNumIndices; ++j) {
+            m.indices.push_back(face.mIndices[j]);
+        }
+    }
+}
+
+void generateExtraLights(unsigned int cnt) {
+    mt19937 rng(450);
+    float extent = 0.5f * sceneData.gridSpacing * sceneData.gridCnt + 1.0f;
+    uniform_real_distribution<float> xDist(-extent, extent);
+    uniform_real_distribution<float> yDist(-1.0f, 1.0f);
+    uniform_real_distribution<float> zDist(-2.0f * extent + 1.0f, 1.0f);
+    uniform_real_distribution<float> colorDist(0.0f, 1.0f);
+
+    sceneData.extraLightPos.clear();
+    sceneData.extraLightColor.clear();
+    for(unsigned int i = 0; i < cnt; i++) {
+        sceneData.extraLightPos.push_back(glm::vec4(xDist(rng), yDist(rng), zDist(rng), 1.0f));
+        sceneData.extraLightColor.push_back(glm::vec4(colorDist(rng), colorDist(rng), colorDist(rng), 1.0f));
+    }
+    cout << "Light count: " << (cnt + 1) << endl;
+}
+
+// Queue G-buffer draws for every node with meshes
+void queueSceneDraws(DeferredRenderEngine *engine) {
+    static Mat4SoA modelMats, modelViewMats, normalMats;
+    static vector<unsigned int> meshNodes;
+
+    FlatSceneGraph &graph = sceneData.graph;
+    updateSceneGraphWorldMats(graph);
+
+    meshNodes.clear();
+    for(unsigned int i = 0; i < graph.worldMat.size(); i++) {
+        if(graph.meshCnt[i] > 0) {
+            meshNodes.push_back(i);
+        }
+    }
+
+    glm::mat4 R = glm::rotate(glm::radians(sceneData.rotAngle), glm::vec3(0.0f, 0.0f, 1.0f));
+    modelMats.resize(meshNodes.size());
+    for(unsigned int k = 0; k < meshNodes.size(); k++) {
+        modelMats.set(k, graph.worldMat[meshNodes[k]] * R);
+    }
+    computeBatchTransforms(sceneData.frame.viewMat, modelMats, modelViewMats, normalMats);
+
+    VulkanRenderQueue &queue = engine->getRenderQueue();
+    queue.begin();
+    for(unsigned int k = 0; k < meshNodes.size(); k++) {
+        unsigned int i = meshNodes[k];
+
+        InstanceData instance;
+        instance.modelMat = modelMats.get(k);
+        instance.normMat = normalMats.get(k);
+        float viewDepth = -modelViewMats.e[14][k];
+
+        for(unsigned int m = 0; m < graph.meshCnt[i]; m++) {
+            unsigned int index = graph.meshIndices[graph.meshStart[i] + m];
+            queue.add(  engine->getGBufferPipelineID(), engine->getMaterialID(),
+                        sceneData.meshIDs.at(index), viewDepth, instance);
+        }
+    }
+}
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if(action == GLFW_PRESS || action == GLFW_REPEAT) {
+        glm::vec3 cameraDir = glm::normalize(sceneData.lookAt - sceneData.eye);
+        glm::vec3 localX = glm::normalize(glm::cross(cameraDir, glm::vec3(0.0f, 1.0f, 0.0f)));
+        float speed = 0.1f;
+
+        switch(key) {
+            case GLFW_KEY_ESCAPE:
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+                break;
+            case GLFW_KEY_J:
+                sceneData.rotAngle += 1.0f;
+                break;
+            case GLFW_KEY_K:
+                sceneData.rotAngle -= 1.0f;
+                break;
+            case GLFW_KEY_W:
+                sceneData.eye += cameraDir * speed;
+                sceneData.lookAt += cameraDir * speed;
+                break;
+            case GLFW_KEY_S:
+                sceneData.eye -= cameraDir * speed;
+                sceneData.lookAt -= cameraDir * speed;
+                break;
+            case GLFW_KEY_D:
+                sceneData.eye += localX * speed;
+                sceneData.lookAt += localX * speed;
+                break;
+            case GLFW_KEY_A:
+                sceneData.eye -= localX * speed;
+                sceneData.lookAt -= localX * speed;
+                break;
+            case GLFW_KEY_RIGHT_BRACKET: {
+                unsigned int total = min(4096u, 2 * (unsigned int)(sceneData.extraLightPos.size() + 1));
+                generateExtraLights(total - 1);
+                break;
+            }
+            case GLFW_KEY_LEFT_BRACKET: {
+                unsigned int total = max(1u, (unsigned int)(sceneData.extraLightPos.size() + 1) / 2);
+                generateExtraLights(total - 1);
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    cout << "BEGIN FORGING!!!" << endl;
+
+    // Set name
+    string appName = "DeferredVulkan";
+    string windowTitle = "DeferredVulkan";
+    int windowWidth = 800;
+    int windowHeight = 600;
+
+    // Optional headless run (--headless N): render N frames offscreen, then exit
+    int headlessFrames = getHeadlessFrameCount(argc, argv);
+    bool headless = (headlessFrames > 0);
+
+    GLFWwindow* window = nullptr;
+    VulkanInitData vkInitData;
+    if(headless) {
+        // Setup up Vulkan via vk-bootstrap (offscreen swapchain)
+        initVulkanBootstrapHeadless(appName, windowWidth, windowHeight, vkInitData);
+    }
+    else {
+        // Create GLFW window
+        window = createGLFWWindow(windowTitle, windowWidth, windowHeight);
+        glfwSetKeyCallback(window, keyCallback);
+
+        // Setup up Vulkan via vk-bootstrap
+        initVulkanBootstrap(appName, window, vkInitData);
+    }
+
+    // Load model
+    string modelPath = "sampleModels/sphere.obj";
+    if(argc >= 2) {
+        modelPath = string(argv[1]);
+    }
+    if(argc >= 3) {
+        sceneData.gridCnt = max(1, atoi(argv[2]));
+    }
+
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(modelPath,
+        aiProcess_Triangulate |
+        aiProcess_FlipUVs     |
+        aiProcess_GenNormals  |
+        aiProcess_JoinIdenticalVertices);
+
+    if(!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
+        cout << "ERROR: Could not load model: " << modelPath << endl;
+        return -1;
+    }
+
+    // Flatten scene hierarchy (one subtree per grid copy)
+    int gridRoot = addSceneGraphNode(sceneData.graph, -1, glm::mat4(1.0f));
+    float gridOffset = 0.5f * sceneData.gridSpacing * (sceneData.gridCnt - 1);
+    for(int x = 0; x < sceneData.gridCnt; x++) {
+        for(int z = 0; z < sceneData.gridCnt; z++) {
+            glm::mat4 copyMat = glm::translate(glm::vec3(
+                x * sceneData.gridSpacing - gridOffset, 0.0f, -z * sceneData.gridSpacing));
+            int copyNode = addSceneGraphNode(sceneData.graph, gridRoot, copyMat);
+            addAssimpSceneGraph(sceneData.graph, scene->mRootNode, copyNode);
+        }
+    }
+    finalizeSceneGraph(sceneData.graph);
+
+    // Create render engine
+    string shaderDir = "build/compiledshaders/" + appName + "/";
+    DeferredRenderParams params;
+    params.vertSPVFilename = shaderDir + "gbuffer.vert.spv";
+    params.fragSPVFilename = shaderDir + "gbuffer.frag.spv";
+    params.lightVertSPVFilename = shaderDir + "lighting.vert.spv";
+    params.lightFragSPVFilename = shaderDir + "lighting.frag.spv";
+
+    DeferredRenderEngine *renderEngine = new DeferredRenderEngine(vkInitData);
+    renderEngine->initialize(&params);
+
+    // Load all meshes from the scene
+    for(int i = 0; i < scene->mNumMeshes; ++i) {
+        Mesh<DeferredVertex> mesh;
+        extractMeshData(scene->mMeshes[i], mesh);
+        sceneData.allMeshes.push_back(createVulkanMesh(vkInitData, renderEngine->getCommandPool(), mesh));
+    }
+    for(auto &mesh : sceneData.allMeshes) {
+        sceneData.meshIDs.push_back(renderEngine->getRenderQueue().addMesh(&mesh));
+    }
+
+    int framesRendered = 0;
+    auto startCountTime = getTime();
+    float fpsCalcWindow = 5.0f;
+
+    int framesLeft = headlessFrames;
+    while(headless ? (framesLeft-- > 0) : !glfwWindowShouldClose(window)) {
+        int width = windowWidth, height = windowHeight;
+        if(!headless) {
+            glfwPollEvents();
+            glfwGetFramebufferSize(window, &width, &height);
+        }
+        float aspect = (width > 0 && height > 0) ? float(width) / float(height) : 1.0f;
+
+        DeferredSceneData &frame = sceneData.frame;
+        frame.viewMat = glm::lookAt(sceneData.eye, sceneData.lookAt, glm::vec3(0.0f, 1.0f, 0.0f));
+        frame.projMat = glm::perspective(glm::radians(90.0f), aspect, 0.01f, 50.0f);
+
+        // Lights in view space (main light reaches everything)
+        frame.lights.clear();
+        frame.lights.push_back({ glm::vec4(glm::vec3(frame.viewMat * sceneData.lightPos), 1000.0f),
+                                 sceneData.lightColor });
+        for(unsigned int i = 0; i < sceneData.extraLightPos.size(); i++) {
+            frame.lights.push_back({ glm::vec4(glm::vec3(frame.viewMat * sceneData.extraLightPos[i]),
+                                               sceneData.extraLightRadius),
+                                     sceneData.extraLightColor[i] });
+        }
+
+        queueSceneDraws(renderEngine);
+        renderEngine->drawFrame(&frame);
+        framesRendered++;
+
+        float timeSoFar = getElapsedSeconds(startCountTime, getTime());
+        if(timeSoFar >= fpsCalcWindow) {
+            cout << "FPS: " << (framesRendered / timeSoFar)
+                 << " (lights: " << frame.lights.size() << ")" << endl;
+            startCountTime = getTime();
+            framesRendered = 0;
+        }
+    }
+
+    // Make sure all queues on GPU are done
+    vkInitData.device.waitIdle();
+
+    for(auto &mesh : sceneData.allMeshes) {
+        cleanupVulkanMesh(vkInitData, mesh);
+    }
+    sceneData.allMeshes.clear();
+
+    delete renderEngine;
+    cleanupVulkanBootstrap(vkInitData);
+    if(!headless) {
+        cleanupGLFWWindow(window);
+    }
+
+    cout << "FORGING DONE!!!" << endl;
+    return 0;
+}
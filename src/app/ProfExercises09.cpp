@@ -9,6 +9,7 @@
 #include "VKBuffer.hpp"
 #include "VKUniform.hpp"
 #include "VKImage.hpp"
+#include "MeshUtility.hpp"
 #include "glm/glm.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/string_cast.hpp"
@@ -188,95 +189,6 @@ static void key_callback(GLFWwindow *window,
     }
 }
 
-void calculateTriangleNormal(
-    vector<PointVertex> &vertices,
-    int i0, int i1, int i2
-) {
-    glm::vec3 A = vertices.at(i0).pos;
-    glm::vec3 B = vertices.at(i1).pos;
-    glm::vec3 C = vertices.at(i2).pos;
-
-    glm::vec3 v1 = B - A;
-    glm::vec3 v2 = C - A;
-
-    glm::vec3 N = glm::cross(v1, v2);
-    N = glm::normalize(N);
-
-    vertices.at(i0).normal += N;
-    vertices.at(i1).normal += N;
-    vertices.at(i2).normal += N;
-}
-
-void calculateAllNormals(
-    vector<PointVertex> &vertices,
-    vector<unsigned int> &indices
-) {
-    for(int i = 0; i < vertices.size(); i++) {
-        vertices.at(i).normal = glm::vec3(0,0,0);
-    }
-
-    for(int i = 0; i < indices.size(); i+=3) {
-        calculateTriangleNormal(vertices,
-            indices.at(i),
-            indices.at(i+1),
-            indices.at(i+2));
-    }
-
-    for(int i = 0; i < vertices.size(); i++) {
-        vertices.at(i).normal
-        = glm::normalize(vertices.at(i).normal);
-    }
-}
-
-void makeCylinder(
-    vector<PointVertex> &vertices,
-    vector<unsigned int> &indices,
-    float length, float radius,
-    int faceCnt) {
-
-    vertices.clear();
-    indices.clear();
-
-    float angleInc
-     = (2.0f*glm::pi<float>())/((float)faceCnt);
-
-    for(int i = 0; i < faceCnt; i++) {
-        PointVertex left, right;
-        float x = length/2.0f;
-        float angle = angleInc*i;
-        float y = radius*glm::sin(angle);
-        float z = radius*glm::cos(angle);
-
-        left.pos = glm::vec3(-x, y, z);
-        right.pos = glm::vec3(x, y, z);
-
-        left.color = glm::vec4(1,0,0,1);
-        right.color = glm::vec4(1,0,1,1);
-
-        vertices.push_back(left);
-        vertices.push_back(right);
-    }
-
-    int max_vert_cnt = faceCnt*2;
-
-    for(int i = 0; i < faceCnt; i++) {
-        int low_left = 2*i;
-        int up_left = (2*(i+1))%max_vert_cnt;
-        int low_right = low_left + 1;
-        int up_right = up_left + 1;
-
-        indices.push_back(low_left);
-        indices.push_back(low_right);
-        indices.push_back(up_left);
-
-        indices.push_back(low_right);
-        indices.push_back(up_right);
-        indices.push_back(up_left);
-    }
-
-    calculateAllNormals(vertices, indices);
-}
-
 int main(int argc, char **argv) {
 
     if(argc >= 2) {
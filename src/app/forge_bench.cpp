@@ -0,0 +1,856 @@
+#include "VKSetup.hpp"
+#include "VKRender.hpp"
+#include "VKImage.hpp"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include "MeshData.hpp"
+#include "MeshUtility.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#define GLM_ENABLE_EXPERIMENTAL
+#include "glm/gtx/transform.hpp"
+#include "glm/gtc/type_ptr.hpp"
+#include "VKUtility.hpp"
+#include "VKUniform.hpp"
+#include "VKGPUProfiler.hpp"
+#include "CPUProfiler.hpp"
+#include "ChromeTrace.hpp"
+#include "VKObjectTracker.hpp"
+#include "VKFrameCapture.hpp"
+#include "ProcessMemory.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+///////////////////////////////////////////////////////////////////////////////
+// Deterministic benchmark
+// - Every model is drawn as a grid of copies from a fixed camera spline at a
+//   fixed resolution; the camera depends only on the frame number, so runs
+//   are repeatable (no input, no wall-clock animation)
+// - Windowed or headless (offscreen swapchain, no display needed)
+// - Writes a JSON report: CPU/GPU frame-time percentiles, CPU scopes, load
+//   time, resident and Vulkan memory before/while/after, and main-pass pipeline statistics (overdraw, vertex
+//   reuse) per model
+// - Measures a baseline forward renderer of its own (one draw per node,
+//   model matrix in push constants), NOT the Assign05 engine: render
+//   queue, culling, LOD and bindless are not exercised (report "renderer")
+///////////////////////////////////////////////////////////////////////////////
+
+// Color is only there for the shared extractMeshData() (not an attribute)
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec4 color;
+    glm::vec3 normal;
+};
+
+struct UPushVertex {
+    alignas(16) glm::mat4 modelMat;
+};
+
+struct UBOVertex {
+    alignas(16) glm::mat4 viewMat;
+    alignas(16) glm::mat4 projMat;
+    alignas(16) glm::vec4 lightDir;     // View space
+};
+
+struct BenchSettings {
+    bool headless = false;
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    unsigned int frames = 600;          // Measured, per model
+    unsigned int warmupFrames = 60;     // Per model (not measured)
+    int gridCnt = 3;                    // gridCnt x gridCnt copies
+    string reportPath = "forge_bench_report.json";
+    string tracePath;                   // Chrome trace of the measured frames
+    string capturePrefix;               // JPG sequence of the measured frames
+    vector<string> modelPaths;
+};
+
+// One mesh of the scene with its node's world transform
+struct BenchDraw {
+    unsigned int mesh = 0;
+    glm::mat4 modelMat = glm::mat4(1.0f);
+};
+
+struct SceneData {
+    vector<VulkanMesh> allMeshes;
+    vector<BenchDraw> draws;            // One copy
+    vector<glm::mat4> copyMats;         // Grid offsets
+    glm::vec4 bounds = glm::vec4(0.0f); // Whole grid (center, radius)
+
+    glm::mat4 viewMat = glm::mat4(1.0f);
+    glm::mat4 projMat = glm::mat4(1.0f);
+};
+
+struct ModelResult {
+    string path;
+    bool completed = false;
+    string error;
+
+    unsigned long long vertexCnt = 0;   // One copy
+    unsigned long long triangleCnt = 0;
+    unsigned long long meshBytes = 0;   // Vertex + index buffers
+    unsigned int drawCnt = 0;           // Per frame
+    float importSeconds = 0.0f;
+    float uploadSeconds = 0.0f;
+
+    CPUTimeStats cpuFrame;
+    vector<CPUTimeStats> cpuScopes;
+    vector<GPUScopeStats> gpuScopes;
+
+    // Current (not peak) memory before the load, with the model loaded
+    // (after the measured frames) and after it was unloaded
+    unsigned long long residentBeforeBytes = 0;
+    unsigned long long residentLoadedBytes = 0;
+    unsigned long long residentAfterBytes = 0;
+    long long vulkanBeforeBytes = 0;    // Tracked Vulkan objects
+    long long vulkanLoadedBytes = 0;
+    long long vulkanAfterBytes = 0;
+
+    FrameCaptureStats capture;          // Measured frames (if capturing)
+
+    VulkanObjectSnapshot objectGrowth;  // Over the measured frames (should be empty)
+    VulkanObjectSnapshot objectLeaks;   // Left after the model is unloaded
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+///////////////////////////////////////////////////////////////////////////////
+
+// Total over all tracked object types
+long long getVulkanObjectBytes(const VulkanObjectSnapshot &snapshot) {
+    long long bytes = 0;
+    for (int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        bytes += snapshot.bytes[type];
+    }
+    return bytes;
+}
+
+glm::vec3 evalCatmullRom(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (-p0 + p2) * t
+                 + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+                 + (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+}
+
+// Closed camera path around the bounds (u in [0,1)): varying distance and
+// height, always looking at the center
+glm::mat4 getBenchCameraView(float u, glm::vec4 bounds) {
+    const int POINT_CNT = 6;
+    glm::vec3 center = glm::vec3(bounds);
+    float radius = max(bounds.w, 0.001f);
+
+    glm::vec3 points[POINT_CNT];
+    for(int i = 0; i < POINT_CNT; i++) {
+        float angle = glm::radians(360.0f * i / POINT_CNT);
+        float dist = radius * ((i % 2 == 0) ? 1.6f : 2.4f);
+        float height = radius * 0.5f * sin(1.7f * i);
+        points[i] = center + glm::vec3(dist * sin(angle), height, dist * cos(angle));
+    }
+
+    float s = (u - floor(u)) * POINT_CNT;
+    int seg = min(int(s), POINT_CNT - 1);
+    float t = s - seg;
+    glm::vec3 eye = evalCatmullRom(points[(seg + POINT_CNT - 1) % POINT_CNT], points[seg],
+                                   points[(seg + 1) % POINT_CNT], points[(seg + 2) % POINT_CNT], t);
+
+    return glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+string escapeJSON(const string &s) {
+    ostringstream out;
+    for(char c : s) {
+        switch(c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default: out << c; break;
+        }
+    }
+    return out.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Render engine
+///////////////////////////////////////////////////////////////////////////////
+
+class BenchRenderEngine : public VulkanRenderEngine {
+    protected:
+    UBOVertex hostUBOVert;
+    UBOData deviceUBOVert;
+    vk::DescriptorPool descriptorPool;
+    vector<vk::DescriptorSet> descriptorSets;
+
+    VulkanGPUProfiler gpuProfiler;
+    VulkanFrameCapture frameCapture;    // Only created with --capture
+
+    public:
+        BenchRenderEngine(VulkanInitData & vkInitData) :
+        VulkanRenderEngine(vkInitData) {};
+
+        virtual bool initialize(VulkanInitRenderParams *params) override {
+            if(!VulkanRenderEngine::initialize(params)) { return false; }
+
+            deviceUBOVert = createVulkanUniformBufferData(
+                vkInitData.device,
+                vkInitData.physicalDevice,
+                sizeof(UBOVertex),
+                MAX_FRAMES_IN_FLIGHT
+            );
+
+            // One UBO set per frame in flight
+            vector<vk::DescriptorPoolSize> poolSizes = {
+                vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, MAX_FRAMES_IN_FLIGHT)
+            };
+            descriptorPool = createVulkanDescriptorPool(
+                vkInitData.device, vk::DescriptorPoolCreateInfo({}, MAX_FRAMES_IN_FLIGHT, poolSizes));
+
+            vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, pipelineData.descriptorSetLayouts[0]);
+            descriptorSets = vkInitData.device.allocateDescriptorSets(
+                vk::DescriptorSetAllocateInfo(descriptorPool, layouts));
+
+            for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                vk::DescriptorBufferInfo bufferInfo(deviceUBOVert.bufferData[i].buffer, 0, sizeof(UBOVertex));
+                vkInitData.device.updateDescriptorSets(vk::WriteDescriptorSet(
+                    descriptorSets[i], 0, 0, vk::DescriptorType::eUniformBuffer, {}, bufferInfo), {});
+            }
+
+            gpuProfiler = createVulkanGPUProfiler(vkInitData, MAX_FRAMES_IN_FLIGHT);
+            gpuProfiler.pipelineStatsEnabled = true;
+            return true;
+        };
+
+        virtual ~BenchRenderEngine() {
+            cleanupVulkanGPUProfiler(vkInitData, gpuProfiler);
+            cleanupVulkanFrameCapture(vkInitData, frameCapture);
+            cleanupVulkanDescriptorPool(vkInitData.device, descriptorPool);
+            cleanupVulkanUniformBufferData(vkInitData.device, deviceUBOVert);
+        };
+
+        virtual AttributeDescData getAttributeDescData() override {
+            AttributeDescData attribDescData;
+            attribDescData.bindDesc = vk::VertexInputBindingDescription(
+                0, sizeof(Vertex), vk::VertexInputRate::eVertex);
+
+            // Position
+            attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+                0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, pos)));
+
+            // Normal
+            attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+                1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, normal)));
+
+            return attribDescData;
+        }
+
+        virtual vector<vk::PushConstantRange> getPushConstantRanges() override {
+            return { vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(UPushVertex)) };
+        }
+
+        virtual vector<vk::DescriptorSetLayout> getDescriptorSetLayouts() override {
+            vk::DescriptorSetLayoutBinding uboBinding(
+                0, vk::DescriptorType::eUniformBuffer, 1,
+                vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, nullptr);
+
+            vk::DescriptorSetLayout layout = vkInitData.device.createDescriptorSetLayout(
+                vk::DescriptorSetLayoutCreateInfo({}, uboBinding));
+            return vector<vk::DescriptorSetLayout>{layout};
+        }
+
+        void updateUniformBuffers(SceneData *sceneData, vk::CommandBuffer &commandBuffer) {
+            hostUBOVert.viewMat = sceneData->viewMat;
+            hostUBOVert.projMat = sceneData->projMat;
+            hostUBOVert.projMat[1][1] *= -1;
+
+            // Light over the camera's right shoulder
+            hostUBOVert.lightDir = glm::vec4(glm::normalize(glm::vec3(0.5f, 1.0f, 0.6f)), 0.0f);
+
+            memcpy(deviceUBOVert.mapped[this->currentImage], &hostUBOVert, sizeof(hostUBOVert));
+
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineData.pipelineLayout,
+                                             0, descriptorSets[this->currentImage], {});
+        }
+
+        virtual void recordCommandBuffer(void *userData, vk::CommandBuffer &commandBuffer,
+            unsigned int frameIndex) override {
+            SceneData *sceneData = static_cast<SceneData*>(userData);
+
+            // Results of the last frame in this slot (fence already waited on)
+            readVulkanGPUProfiler(vkInitData.device, gpuProfiler, this->currentImage);
+            beginVulkanFrameCapture(frameCapture, this->currentImage);
+
+            // Begin commands
+            commandBuffer.begin(vk::CommandBufferBeginInfo());
+            recordGPUProfilerFrameBegin(commandBuffer, gpuProfiler, this->currentImage);
+            recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "frame");
+
+            vk::Extent2D extent = vkInitData.swapchain.extent;
+
+            array<vk::ClearValue, 2> clearValues {};
+            clearValues[0].color = vk::ClearColorValue(0.1f, 0.1f, 0.15f, 1.0f);
+            clearValues[1].depthStencil = vk::ClearDepthStencilValue(1.0f, 0.0f);
+
+            recordGPUScopeBegin(commandBuffer, gpuProfiler, this->currentImage, "main", true);
+            commandBuffer.beginRenderPass(vk::RenderPassBeginInfo(
+                this->renderPass,
+                this->framebuffers[frameIndex],
+                { {0,0}, extent },
+                clearValues),
+                vk::SubpassContents::eInline);
+
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, this->pipelineData.graphicsPipeline);
+
+            vk::Viewport viewports[] = {{0, 0, (float)extent.width, (float)extent.height, 0.0f, 1.0f}};
+            commandBuffer.setViewport(0, viewports);
+            vk::Rect2D scissors[] = {{{0,0}, extent}};
+            commandBuffer.setScissor(0, scissors);
+
+            {
+                CPU_PROFILE_SCOPE("ubo update");
+                updateUniformBuffers(sceneData, commandBuffer);
+            }
+
+            {
+                CPU_PROFILE_SCOPE("draw recording");
+                UPushVertex pushVertex;
+                for (auto &copyMat : sceneData->copyMats) {
+                    for (auto &draw : sceneData->draws) {
+                        pushVertex.modelMat = copyMat * draw.modelMat;
+                        commandBuffer.pushConstants(this->pipelineData.pipelineLayout,
+                                                    vk::ShaderStageFlagBits::eVertex,
+                                                    0, sizeof(UPushVertex), &pushVertex);
+                        recordDrawVulkanMesh(commandBuffer, sceneData->allMeshes.at(draw.mesh));
+                    }
+                }
+            }
+
+            commandBuffer.endRenderPass();
+            recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+            recordGPUScopeEnd(commandBuffer, gpuProfiler, this->currentImage);
+
+            recordVulkanFrameCapture(vkInitData, frameCapture, commandBuffer, this->currentImage,
+                                     vkInitData.swapchain.images.at(frameIndex), extent);
+            commandBuffer.end();
+        }
+
+        // Fresh history sized for one run (call while the GPU is idle)
+        void resetGPUProfiler(unsigned int historySize) {
+            cleanupVulkanGPUProfiler(vkInitData, gpuProfiler);
+            gpuProfiler = createVulkanGPUProfiler(vkInitData, MAX_FRAMES_IN_FLIGHT, 32, historySize);
+            gpuProfiler.pipelineStatsEnabled = true;
+        }
+
+        // Picks up the frames still pending (call after waitIdle())
+        void flushGPUProfiler() {
+            for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                readVulkanGPUProfiler(vkInitData.device, gpuProfiler, i);
+            }
+        }
+
+        VulkanGPUProfiler& getGPUProfiler() {
+            return gpuProfiler;
+        }
+
+        // Readback buffers and encoder threads cost memory, so only on request
+        VulkanFrameCapture& getFrameCapture() {
+            if (!frameCapture.queue) {
+                frameCapture = createVulkanFrameCapture(vkInitData);
+            }
+            return frameCapture;
+        }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Scene setup
+///////////////////////////////////////////////////////////////////////////////
+
+void addNodeDraws(aiNode *node, glm::mat4 parentMat, vector<BenchDraw> &draws) {
+    glm::mat4 nodeT;
+    aiMatToGLM4(node->mTransformation, nodeT);
+    glm::mat4 modelMat = parentMat * nodeT;
+
+    for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+        BenchDraw draw;
+        draw.mesh = node->mMeshes[i];
+        draw.modelMat = modelMat;
+        draws.push_back(draw);
+    }
+
+    for (unsigned int i = 0; i < node->mNumChildren; i++) {
+        addNodeDraws(node->mChildren[i], modelMat, draws);
+    }
+}
+
+// Bounds of one copy from its (transformed) mesh spheres
+glm::vec4 computeDrawBounds(vector<BenchDraw> &draws, vector<glm::vec4> &meshSpheres) {
+    glm::vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
+    for (auto &draw : draws) {
+        glm::vec4 sphere = meshSpheres.at(draw.mesh);
+        glm::vec3 center = glm::vec3(draw.modelMat * glm::vec4(glm::vec3(sphere), 1.0f));
+        float scale = max(glm::length(glm::vec3(draw.modelMat[0])),
+                      max(glm::length(glm::vec3(draw.modelMat[1])), glm::length(glm::vec3(draw.modelMat[2]))));
+        minPos = glm::min(minPos, center - glm::vec3(sphere.w * scale));
+        maxPos = glm::max(maxPos, center + glm::vec3(sphere.w * scale));
+    }
+    if (draws.empty()) {
+        return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    return glm::vec4(0.5f * (minPos + maxPos), max(0.5f * glm::length(maxPos - minPos), 0.001f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark run
+///////////////////////////////////////////////////////////////////////////////
+
+// Returns false if the window was closed (stop everything)
+bool runModel(  BenchSettings &settings, VulkanInitData &vkInitData, GLFWwindow *window,
+                BenchRenderEngine *renderEngine, ChromeTrace &trace, ModelResult &result) {
+    SceneData sceneData;
+    VulkanObjectSnapshot objectsBeforeLoad = getVulkanObjectSnapshot();
+    result.residentBeforeBytes = getProcessMemoryBytes();
+    result.vulkanBeforeBytes = getVulkanObjectBytes(objectsBeforeLoad);
+
+    // Load (import + upload)
+    auto importStart = getTime();
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(result.path,
+        aiProcess_Triangulate |
+        aiProcess_FlipUVs     |
+        aiProcess_GenNormals  |
+        aiProcess_JoinIdenticalVertices);
+    result.importSeconds = getElapsedSeconds(importStart, getTime());
+
+    if (scene == NULL || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || scene->mRootNode == NULL) {
+        result.error = "failed to load model";
+        cout << "Skipping " << result.path << ": " << result.error << endl;
+        return true;
+    }
+
+    auto uploadStart = getTime();
+    vector<glm::vec4> meshSpheres;
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        Mesh<Vertex> mesh;
+        extractMeshData(scene->mMeshes[i], mesh);
+        sceneData.allMeshes.push_back(createVulkanMesh(vkInitData, renderEngine->getCommandPool(), mesh));
+        meshSpheres.push_back(computeMeshBoundingSphere(mesh));
+        result.meshBytes += sizeof(Vertex) * mesh.vertices.size() + sizeof(unsigned int) * mesh.indices.size();
+    }
+    result.uploadSeconds = getElapsedSeconds(uploadStart, getTime());
+
+    addNodeDraws(scene->mRootNode, glm::mat4(1.0f), sceneData.draws);
+    for (auto &draw : sceneData.draws) {
+        result.vertexCnt += scene->mMeshes[draw.mesh]->mNumVertices;
+        result.triangleCnt += scene->mMeshes[draw.mesh]->mNumFaces;
+    }
+
+    // Grid of copies (spaced by the size of one copy)
+    glm::vec4 copyBounds = computeDrawBounds(sceneData.draws, meshSpheres);
+    float spacing = 2.5f * copyBounds.w;
+    float gridOffset = 0.5f * spacing * (settings.gridCnt - 1);
+    for (int x = 0; x < settings.gridCnt; x++) {
+        for (int z = 0; z < settings.gridCnt; z++) {
+            sceneData.copyMats.push_back(glm::translate(glm::vec3(
+                x * spacing - gridOffset, 0.0f, z * spacing - gridOffset)));
+        }
+    }
+    sceneData.bounds = glm::vec4(glm::vec3(copyBounds),
+                                 copyBounds.w + 0.5f * sqrt(2.0f) * spacing * (settings.gridCnt - 1));
+    result.drawCnt = sceneData.draws.size() * sceneData.copyMats.size();
+
+    vk::Extent2D extent = vkInitData.swapchain.extent;
+    float aspect = float(extent.width) / float(max(extent.height, 1u));
+    sceneData.projMat = glm::perspective(glm::radians(60.0f), aspect,
+                                         0.01f * sceneData.bounds.w, 10.0f * sceneData.bounds.w);
+
+    // Warmup at the start of the path, then measure the whole path
+    bool windowOpen = true;
+    vector<float> frameTimes;
+    VulkanObjectSnapshot objectsBeforeMeasure;
+    FrameCaptureStats captureBefore;
+    unsigned int totalFrames = settings.warmupFrames + settings.frames;
+    for (unsigned int frame = 0; frame < totalFrames && windowOpen; frame++) {
+        if (frame == settings.warmupFrames) {
+            vkInitData.device.waitIdle();
+            renderEngine->resetGPUProfiler(max(settings.frames, 1u));
+            renderEngine->getGPUProfiler().tracing = !settings.tracePath.empty();
+            resetCPUProfile();
+            trace.enabled = !settings.tracePath.empty();
+            objectsBeforeMeasure = getVulkanObjectSnapshot();
+
+            // Every measured frame goes to prefix_<model>_NNNNNN.jpg
+            if (!settings.capturePrefix.empty()) {
+                VulkanFrameCapture &frameCapture = renderEngine->getFrameCapture();
+                captureBefore = getVulkanFrameCaptureStats(frameCapture);
+                startVulkanFrameRecording(frameCapture, settings.capturePrefix + "_"
+                                          + filesystem::path(result.path).stem().string());
+            }
+        }
+
+        auto startTime = getTime();
+
+        if (window) {
+            glfwPollEvents();
+            windowOpen = !glfwWindowShouldClose(window);
+        }
+
+        unsigned int measured = (frame >= settings.warmupFrames) ? frame - settings.warmupFrames : 0;
+        sceneData.viewMat = getBenchCameraView(float(measured) / float(max(settings.frames, 1u)),
+                                               sceneData.bounds);
+        renderEngine->drawFrame(&sceneData);
+
+        float frameTime = getElapsedSeconds(startTime, getTime());
+        if (frame >= settings.warmupFrames) {
+            frameTimes.push_back(1000.0f * frameTime);
+            addCPUFrameTime(frameTime);
+        }
+        collectCPUProfileTrace(trace);
+        collectGPUProfileTrace(renderEngine->getGPUProfiler(), trace);
+    }
+
+    vkInitData.device.waitIdle();
+    renderEngine->flushGPUProfiler();
+
+    if (!settings.capturePrefix.empty()) {
+        VulkanFrameCapture &frameCapture = renderEngine->getFrameCapture();
+        stopVulkanFrameRecording(frameCapture);
+        flushVulkanFrameCapture(frameCapture);
+        FrameCaptureStats captureAfter = getVulkanFrameCaptureStats(frameCapture);
+        result.capture.requestedCnt = captureAfter.requestedCnt - captureBefore.requestedCnt;
+        result.capture.droppedCnt = captureAfter.droppedCnt - captureBefore.droppedCnt;
+        result.capture.writtenCnt = captureAfter.writtenCnt - captureBefore.writtenCnt;
+        result.capture.failedCnt = captureAfter.failedCnt - captureBefore.failedCnt;
+    }
+    collectGPUProfileTrace(renderEngine->getGPUProfiler(), trace);
+    trace.enabled = false;
+    VulkanObjectSnapshot objectsLoaded = getVulkanObjectSnapshot();
+    result.objectGrowth = diffVulkanObjectSnapshots(objectsBeforeMeasure, objectsLoaded);
+    result.residentLoadedBytes = getProcessMemoryBytes();
+    result.vulkanLoadedBytes = getVulkanObjectBytes(objectsLoaded);
+
+    result.completed = windowOpen;
+    result.cpuFrame = computeCPUTimeStats("frame", frameTimes);
+    result.cpuScopes = getCPUScopeStats();
+    result.gpuScopes = getGPUScopeStats(renderEngine->getGPUProfiler());
+
+    for (auto &mesh : sceneData.allMeshes) {
+        cleanupVulkanMesh(vkInitData, mesh);
+    }
+    sceneData.allMeshes.clear();
+    VulkanObjectSnapshot objectsAfter = getVulkanObjectSnapshot();
+    result.objectLeaks = diffVulkanObjectSnapshots(objectsBeforeLoad, objectsAfter);
+    result.residentAfterBytes = getProcessMemoryBytes();
+    result.vulkanAfterBytes = getVulkanObjectBytes(objectsAfter);
+
+    return windowOpen;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Report
+///////////////////////////////////////////////////////////////////////////////
+
+void writeTimeStatsJSON(ostream &out, float avgMs, float p50Ms, float p95Ms, float p99Ms, float maxMs) {
+    out << "{\"avg\": " << avgMs << ", \"p50\": " << p50Ms << ", \"p95\": " << p95Ms
+        << ", \"p99\": " << p99Ms << ", \"max\": " << maxMs << "}";
+}
+
+// Counts per type plus total bytes
+void writeVulkanObjectsJSON(ostream &out, const VulkanObjectSnapshot &snapshot) {
+    out << "{";
+    for (int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        out << "\"" << VULKAN_OBJECT_TYPE_NAMES[type] << "\": " << snapshot.count[type] << ", ";
+    }
+    out << "\"bytes\": " << getVulkanObjectBytes(snapshot) << "}";
+}
+
+bool writeReport(BenchSettings &settings, VulkanInitData &vkInitData, vector<ModelResult> &results) {
+    ofstream out(settings.reportPath);
+    if (!out) {
+        cerr << "Could not write report: " << settings.reportPath << endl;
+        return false;
+    }
+
+    vk::PhysicalDeviceProperties props = vkInitData.physicalDevice.getProperties();
+    string deviceName = props.deviceName.data();
+
+    out << "{" << endl;
+    out << "  \"device\": \"" << escapeJSON(deviceName) << "\"," << endl;
+    out << "  \"driverVersion\": " << props.driverVersion << "," << endl;
+    out << "  \"mode\": \"" << (settings.headless ? "headless" : "windowed") << "\"," << endl;
+    out << "  \"renderer\": \"baseline-forward (push constants, one draw per node)\"," << endl;
+    out << "  \"width\": " << vkInitData.swapchain.extent.width << "," << endl;
+    out << "  \"height\": " << vkInitData.swapchain.extent.height << "," << endl;
+    out << "  \"frames\": " << settings.frames << "," << endl;
+    out << "  \"warmupFrames\": " << settings.warmupFrames << "," << endl;
+    out << "  \"grid\": " << settings.gridCnt << "," << endl;
+    out << "  \"models\": [" << endl;
+
+    for (unsigned int i = 0; i < results.size(); i++) {
+        ModelResult &r = results[i];
+        out << "    {" << endl;
+        out << "      \"path\": \"" << escapeJSON(r.path) << "\"," << endl;
+        out << "      \"completed\": " << (r.completed ? "true" : "false") << "," << endl;
+        if (!r.error.empty()) {
+            out << "      \"error\": \"" << escapeJSON(r.error) << "\"," << endl;
+        }
+        out << "      \"vertices\": " << r.vertexCnt << "," << endl;
+        out << "      \"triangles\": " << r.triangleCnt << "," << endl;
+        out << "      \"drawsPerFrame\": " << r.drawCnt << "," << endl;
+        out << "      \"meshBytes\": " << r.meshBytes << "," << endl;
+        out << "      \"importSeconds\": " << r.importSeconds << "," << endl;
+        out << "      \"uploadSeconds\": " << r.uploadSeconds << "," << endl;
+        out << "      \"memoryBytes\": {\"residentBefore\": " << r.residentBeforeBytes
+            << ", \"residentLoaded\": " << r.residentLoadedBytes
+            << ", \"residentAfter\": " << r.residentAfterBytes
+            << ", \"vulkanBefore\": " << r.vulkanBeforeBytes
+            << ", \"vulkanLoaded\": " << r.vulkanLoadedBytes
+            << ", \"vulkanAfter\": " << r.vulkanAfterBytes << "}," << endl;
+
+        out << "      \"cpuFrameMs\": ";
+        writeTimeStatsJSON(out, r.cpuFrame.avgMs, r.cpuFrame.p50Ms, r.cpuFrame.p95Ms, r.cpuFrame.p99Ms, r.cpuFrame.maxMs);
+        out << "," << endl;
+
+        out << "      \"cpuScopesMs\": {";
+        for (unsigned int s = 0; s < r.cpuScopes.size(); s++) {
+            CPUTimeStats &stats = r.cpuScopes[s];
+            out << (s ? ", " : "") << "\"" << escapeJSON(stats.name) << "\": ";
+            writeTimeStatsJSON(out, stats.avgMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+        }
+        out << "}," << endl;
+
+        out << "      \"gpuScopesMs\": {";
+        for (unsigned int s = 0; s < r.gpuScopes.size(); s++) {
+            GPUScopeStats &stats = r.gpuScopes[s];
+            out << (s ? ", " : "") << "\"" << escapeJSON(stats.name) << "\": ";
+            writeTimeStatsJSON(out, stats.avgMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+        }
+        out << "}," << endl;
+
+        // Average per frame; overdraw is relative to the full resolution
+        unsigned long long pixelCnt = (unsigned long long)vkInitData.swapchain.extent.width
+                                      * vkInitData.swapchain.extent.height;
+        out << "      \"gpuPipelineStats\": {";
+        bool firstStats = true;
+        for (auto &stats : r.gpuScopes) {
+            if (stats.pipelineStatsFrameCnt == 0) {
+                continue;
+            }
+            const GPUPipelineStats &p = stats.pipelineStats;
+            out << (firstStats ? "" : ", ") << "\"" << escapeJSON(stats.name) << "\": {"
+                << "\"vertices\": " << p.iaVertices << ", \"primitives\": " << p.iaPrimitives
+                << ", \"vsInvocations\": " << p.vsInvocations
+                << ", \"clipInvocations\": " << p.clipInvocations << ", \"clipPrimitives\": " << p.clipPrimitives
+                << ", \"fsInvocations\": " << p.fsInvocations
+                << ", \"overdraw\": " << getGPUOverdraw(p, pixelCnt)
+                << ", \"vertexReuse\": " << getGPUVertexReuse(p)
+                << ", \"acmr\": " << getGPUVertexACMR(p) << "}";
+            firstStats = false;
+        }
+        out << "}," << endl;
+
+        out << "      \"vulkanObjectGrowth\": ";
+        writeVulkanObjectsJSON(out, r.objectGrowth);
+        out << "," << endl;
+        out << "      \"vulkanObjectLeaks\": ";
+        writeVulkanObjectsJSON(out, r.objectLeaks);
+        if (r.capture.requestedCnt > 0) {
+            out << "," << endl << "      \"capture\": {\"requested\": " << r.capture.requestedCnt
+                << ", \"written\": " << r.capture.writtenCnt << ", \"dropped\": " << r.capture.droppedCnt
+                << ", \"failed\": " << r.capture.failedCnt << "}";
+        }
+        out << endl;
+
+        out << "    }" << ((i + 1 < results.size()) ? "," : "") << endl;
+    }
+
+    out << "  ]" << endl;
+    out << "}" << endl;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+void printUsage() {
+    cout << "Usage: forge_bench [--headless] [--frames N] [--warmup N] [--size W H] [--grid N]"
+         << " [--out report.json] [--trace trace.json] [--capture prefix] [model ...]" << endl;
+    cout << "  (no models = every file in sampleModels/)" << endl;
+}
+
+bool parseArgs(int argc, char **argv, BenchSettings &settings) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--headless") {
+            settings.headless = true;
+        }
+        else if (arg == "--frames" && hasValue) {
+            settings.frames = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--warmup" && hasValue) {
+            settings.warmupFrames = max(0, atoi(argv[++i]));
+        }
+        else if (arg == "--size" && i + 2 < argc) {
+            settings.width = max(1, atoi(argv[++i]));
+            settings.height = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--grid" && hasValue) {
+            settings.gridCnt = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--out" && hasValue) {
+            settings.reportPath = argv[++i];
+        }
+        else if (arg == "--trace" && hasValue) {
+            settings.tracePath = argv[++i];
+        }
+        else if (arg == "--capture" && hasValue) {
+            settings.capturePrefix = argv[++i];
+        }
+        else if (arg.rfind("--", 0) == 0) {
+            printUsage();
+            return false;
+        }
+        else {
+            settings.modelPaths.push_back(arg);
+        }
+    }
+
+    // Default: all sample models, in a fixed order
+    if (settings.modelPaths.empty()) {
+        error_code err;
+        for (auto &entry : filesystem::directory_iterator("sampleModels", err)) {
+            if (entry.is_regular_file()) {
+                settings.modelPaths.push_back(entry.path().generic_string());
+            }
+        }
+        sort(settings.modelPaths.begin(), settings.modelPaths.end());
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    cout << "BEGIN FORGING!!!" << endl;
+
+    BenchSettings settings;
+    if (!parseArgs(argc, argv, settings)) {
+        return -1;
+    }
+    if (settings.modelPaths.empty()) {
+        cout << "No models to benchmark." << endl;
+        printUsage();
+        return -1;
+    }
+
+    string appName = "forge_bench";
+
+    // Fixed resolution: the window cannot be resized
+    GLFWwindow* window = nullptr;
+    VulkanInitData vkInitData;
+    bool initOK = false;
+    if (settings.headless) {
+        initOK = initVulkanBootstrapHeadless(appName, settings.width, settings.height, vkInitData);
+    }
+    else {
+        window = createGLFWWindow(appName, settings.width, settings.height, false);
+        initOK = initVulkanBootstrap(appName, window, vkInitData);
+    }
+    if (!initOK) {
+        cout << "Could not initialize Vulkan." << endl;
+        return -1;
+    }
+
+    string vertSPVFilename = "build/compiledshaders/" + appName + "/shader.vert.spv";
+    string fragSPVFilename = "build/compiledshaders/" + appName + "/shader.frag.spv";
+    VulkanInitRenderParams params = {
+        vertSPVFilename, fragSPVFilename
+    };
+    BenchRenderEngine *renderEngine = new BenchRenderEngine(vkInitData);
+    if (!renderEngine->initialize(&params)) {
+        cout << "Could not initialize render engine." << endl;
+        delete renderEngine;
+        cleanupVulkanBootstrap(vkInitData);
+        if (window) {
+            cleanupGLFWWindow(window);
+        }
+        return -1;
+    }
+    if (!settings.capturePrefix.empty()) {
+        renderEngine->getFrameCapture();    // Before any object snapshot
+    }
+
+    // Measured frames of every model on one timeline (last ~260k scopes)
+    ChromeTrace trace = createChromeTrace();
+
+    vector<ModelResult> results;
+    for (auto &path : settings.modelPaths) {
+        ModelResult result;
+        result.path = path;
+        cout << "Benchmarking " << path << "..." << endl;
+
+        bool keepGoing = runModel(settings, vkInitData, window, renderEngine, trace, result);
+        results.push_back(result);
+
+        if (result.cpuFrame.sampleCnt > 0) {
+            cout << "  CPU frame ms: avg " << result.cpuFrame.avgMs << ", p50 " << result.cpuFrame.p50Ms
+                 << ", p95 " << result.cpuFrame.p95Ms << ", p99 " << result.cpuFrame.p99Ms
+                 << ", max " << result.cpuFrame.maxMs << endl;
+            for (auto &stats : result.gpuScopes) {
+                cout << "  GPU " << stats.name << " ms: avg " << stats.avgMs << ", p50 " << stats.p50Ms
+                     << ", p95 " << stats.p95Ms << ", p99 " << stats.p99Ms << ", max " << stats.maxMs << endl;
+                if (stats.pipelineStatsFrameCnt > 0) {
+                    unsigned long long pixelCnt = (unsigned long long)vkInitData.swapchain.extent.width
+                                                  * vkInitData.swapchain.extent.height;
+                    cout << "  GPU " << stats.name << " overdraw " << getGPUOverdraw(stats.pipelineStats, pixelCnt)
+                         << "x, vertex reuse " << getGPUVertexReuse(stats.pipelineStats)
+                         << ", ACMR " << getGPUVertexACMR(stats.pipelineStats) << endl;
+                }
+            }
+            if (result.capture.requestedCnt > 0) {
+                cout << "  Capture: written " << result.capture.writtenCnt << " of " << result.capture.requestedCnt
+                     << " (dropped " << result.capture.droppedCnt << ")" << endl;
+            }
+            cout << "  Load: import " << result.importSeconds << " s, upload " << result.uploadSeconds << " s" << endl;
+            cout << "  Memory MB (before/loaded/after): resident " << (result.residentBeforeBytes / (1024.0 * 1024.0))
+                 << " / " << (result.residentLoadedBytes / (1024.0 * 1024.0))
+                 << " / " << (result.residentAfterBytes / (1024.0 * 1024.0))
+                 << ", Vulkan " << (result.vulkanBeforeBytes / (1024.0 * 1024.0))
+                 << " / " << (result.vulkanLoadedBytes / (1024.0 * 1024.0))
+                 << " / " << (result.vulkanAfterBytes / (1024.0 * 1024.0)) << endl;
+        }
+        if (!isVulkanObjectSnapshotEmpty(result.objectGrowth)) {
+            cout << "  Grew while measuring: ";
+            printVulkanObjectSnapshot(result.objectGrowth);
+        }
+        if (!isVulkanObjectSnapshotEmpty(result.objectLeaks)) {
+            cout << "  Leaked by the model: ";
+            printVulkanObjectSnapshot(result.objectLeaks);
+        }
+
+        if (!keepGoing) {
+            cout << "Window closed; stopping early." << endl;
+            break;
+        }
+    }
+
+    if (writeReport(settings, vkInitData, results)) {
+        cout << "Report written to " << settings.reportPath << endl;
+    }
+    if (!settings.tracePath.empty()) {
+        writeChromeTrace(trace, settings.tracePath);
+    }
+
+    delete renderEngine;
+    cleanupVulkanBootstrap(vkInitData);
+    if (window) {
+        cleanupGLFWWindow(window);
+    }
+
+    cout << "FORGING DONE!!!" << endl;
+    return 0;
+}
@@ -0,0 +1,443 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <assimp/scene.h>
+#include "VKUtility.hpp"
+#include "MeshData.hpp"
+#include "MeshUtility.hpp"
+#include "BatchTransform.hpp"
+#include "VKRenderQueue.hpp"
+#include "LightClusters.hpp"
+#include "SceneGraph.hpp"
+#include "CPUProfiler.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// CPU-only microbenchmarks (no window or GPU needed)
+// - Every case runs warmup repetitions first, then repeats until it has both
+//   a minimum count and a minimum total time; each repetition is one sample
+// - Reports avg/p50/p95/max per repetition plus p50 per item, so scaling
+//   over input sizes (1k to 10M vertices) can be compared at a glance
+// - Usage: forge_microbench [--quick] [--max-verts N] [--warmup N]
+//          [--reps N] [--csv results.csv]
+///////////////////////////////////////////////////////////////////////////////
+
+struct BenchSettings {
+    unsigned int maxVerts = 10000000;
+    unsigned int warmupReps = 2;
+    unsigned int minReps = 10;
+    unsigned int maxReps = 1000;
+    float minSeconds = 0.25f;           // Per case, measured reps only
+    string csvPath;
+};
+
+BenchSettings settings;
+ofstream csvFile;
+
+// Times func() once per repetition; returns stats in ms per repetition
+CPUTimeStats runBenchmark(const string &name, function<void()> func) {
+    for(unsigned int i = 0; i < settings.warmupReps; i++) {
+        func();
+    }
+
+    vector<float> repMs;
+    float totalSeconds = 0.0f;
+    while(repMs.size() < settings.maxReps
+          && (repMs.size() < settings.minReps || totalSeconds < settings.minSeconds)) {
+        auto start = getTime();
+        func();
+        float seconds = getElapsedSeconds(start, getTime());
+        repMs.push_back(seconds * 1000.0f);
+        totalSeconds += seconds;
+    }
+
+    return computeCPUTimeStats(name, repMs);
+}
+
+// One result line (and CSV row); itemCnt is what one repetition processes
+void printBenchResult(const CPUTimeStats &stats, unsigned int itemCnt, const string &extra = "") {
+    float nsPerItem = stats.p50Ms * 1e6f / max(itemCnt, 1u);
+    cout << stats.name << " N=" << itemCnt
+         << " reps=" << stats.sampleCnt
+         << " avg=" << stats.avgMs << "ms"
+         << " p50=" << stats.p50Ms << "ms"
+         << " p95=" << stats.p95Ms << "ms"
+         << " max=" << stats.maxMs << "ms"
+         << " perItem=" << nsPerItem << "ns"
+         << extra << endl;
+
+    if(csvFile.is_open()) {
+        csvFile << stats.name << "," << itemCnt << "," << stats.sampleCnt << ","
+                << stats.avgMs << "," << stats.p50Ms << "," << stats.p95Ms << ","
+                << stats.p99Ms << "," << stats.maxMs << "," << nsPerItem << endl;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Vertex type of the lit apps (Assign05, ProfExercises09)
+///////////////////////////////////////////////////////////////////////////////
+
+struct ModelVertex {
+    glm::vec3 pos;
+    glm::vec4 color;
+    glm::vec3 normal;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Input generation
+///////////////////////////////////////////////////////////////////////////////
+
+// Random model matrices; every 4th one has non-uniform scale
+vector<glm::mat4> makeRandomModelMats(unsigned int cnt) {
+    mt19937 rng(450);
+    uniform_real_distribution<float> angleDist(0.0f, 360.0f);
+    uniform_real_distribution<float> posDist(-10.0f, 10.0f);
+
+    vector<glm::mat4> mats(cnt);
+    for(unsigned int i = 0; i < cnt; i++) {
+        glm::vec3 axis = glm::normalize(glm::vec3(posDist(rng), posDist(rng), posDist(rng)) + glm::vec3(0.01f));
+        glm::mat4 T = glm::translate(glm::vec3(posDist(rng), posDist(rng), posDist(rng)));
+        glm::mat4 R = glm::rotate(glm::radians(angleDist(rng)), axis);
+        glm::vec3 scale = (i % 4 == 3) ? glm::vec3(1.0f, 2.0f, 0.5f) : glm::vec3(1.5f);
+        mats[i] = T * R * glm::scale(scale);
+    }
+    return mats;
+}
+
+// Wavy grid with about vertCnt vertices (2 triangles per quad, like a
+// typical imported mesh)
+aiMesh* makeGridAiMesh(unsigned int vertCnt) {
+    unsigned int width = max(2u, (unsigned int)sqrt(double(vertCnt)));
+    unsigned int height = max(2u, vertCnt / width);
+
+    aiMesh *mesh = new aiMesh();
+    mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+    mesh->mNumVertices = width * height;
+    mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+    mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+    for(unsigned int y = 0; y < height; y++) {
+        for(unsigned int x = 0; x < width; x++) {
+            unsigned int i = y * width + x;
+            mesh->mVertices[i] = aiVector3D(float(x), 0.1f * sin(0.3f * x + 0.2f * y), float(y));
+            mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    mesh->mNumFaces = 2 * (width - 1) * (height - 1);
+    mesh->mFaces = new aiFace[mesh->mNumFaces];
+    unsigned int f = 0;
+    for(unsigned int y = 0; y + 1 < height; y++) {
+        for(unsigned int x = 0; x + 1 < width; x++) {
+            unsigned int i = y * width + x;
+            unsigned int quad[2][3] = { {i, i + width, i + 1}, {i + 1, i + width, i + width + 1} };
+            for(int t = 0; t < 2; t++) {
+                aiFace &face = mesh->mFaces[f++];
+                face.mNumIndices = 3;
+                face.mIndices = new unsigned int[3] { quad[t][0], quad[t][1], quad[t][2] };
+            }
+        }
+    }
+    return mesh;
+}
+
+// Node tree (4 children per node, breadth-first) with random transforms;
+// every node has one mesh
+aiNode* makeAiNodeTree(unsigned int nodeCnt) {
+    vector<glm::mat4> mats = makeRandomModelMats(nodeCnt);
+    vector<aiNode*> nodes(nodeCnt);
+    for(unsigned int i = 0; i < nodeCnt; i++) {
+        nodes[i] = new aiNode();
+        for(int r = 0; r < 4; r++) {
+            for(int c = 0; c < 4; c++) {
+                nodes[i]->mTransformation[r][c] = mats[i][c][r];
+            }
+        }
+        nodes[i]->mNumMeshes = 1;
+        nodes[i]->mMeshes = new unsigned int[1] { 0 };
+    }
+
+    const unsigned int BRANCHING = 4;
+    for(unsigned int i = 0; i < nodeCnt; i++) {
+        unsigned int first = BRANCHING * i + 1;
+        unsigned int childCnt = (first < nodeCnt) ? min(BRANCHING, nodeCnt - first) : 0;
+        if(childCnt > 0) {
+            nodes[i]->mNumChildren = childCnt;
+            nodes[i]->mChildren = new aiNode*[childCnt];
+            for(unsigned int c = 0; c < childCnt; c++) {
+                nodes[i]->mChildren[c] = nodes[first + c];
+                nodes[first + c]->mParent = nodes[i];
+            }
+        }
+    }
+    return nodes[0];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+///////////////////////////////////////////////////////////////////////////////
+
+void benchTransforms(unsigned int cnt) {
+    vector<glm::mat4> models = makeRandomModelMats(cnt);
+    glm::mat4 viewMat = glm::lookAt(glm::vec3(0, 0, 20), glm::vec3(0), glm::vec3(0, 1, 0));
+
+    // Current per-node GLM path
+    vector<glm::mat4> glmModelView(cnt), glmNormal(cnt);
+    CPUTimeStats glmStats = runBenchmark("transforms/glm", [&]() {
+        for(unsigned int i = 0; i < cnt; i++) {
+            glmModelView[i] = viewMat * models[i];
+            glmNormal[i] = glm::transpose(glm::inverse(glm::mat4(viewMat * models[i])));
+        }
+    });
+
+    // Batched paths
+    Mat4SoA modelSoA, modelViewSoA, normalSoA;
+    modelSoA.resize(cnt);
+    for(unsigned int i = 0; i < cnt; i++) {
+        modelSoA.set(i, models[i]);
+    }
+
+    CPUTimeStats scalarStats = runBenchmark("transforms/batchScalar", [&]() {
+        computeBatchTransformsScalar(viewMat, modelSoA, modelViewSoA, normalSoA);
+    });
+
+    unsigned int cofactorCnt = 0;
+    CPUTimeStats simdStats = runBenchmark(string("transforms/batch") + getBatchTransformISA(), [&]() {
+        cofactorCnt = computeBatchTransforms(viewMat, modelSoA, modelViewSoA, normalSoA);
+    });
+
+    // Check against GLM (upper 3x3 only)
+    float maxErr = 0.0f;
+    for(unsigned int i = 0; i < cnt; i++) {
+        glm::mat3 diff = glm::mat3(normalSoA.get(i)) - glm::mat3(glmNormal[i]);
+        for(int c = 0; c < 3; c++) {
+            maxErr = max(maxErr, glm::length(diff[c]) / max(1.0f, glm::length(glmNormal[i][c])));
+        }
+    }
+
+    printBenchResult(glmStats, cnt);
+    printBenchResult(scalarStats, cnt);
+    printBenchResult(simdStats, cnt,
+        " speedup=" + to_string(glmStats.p50Ms / simdStats.p50Ms) + "x"
+        + " cofactor=" + to_string(cofactorCnt)
+        + " maxRelErr=" + to_string(maxErr));
+}
+
+void benchDrawSort(unsigned int cnt) {
+    mt19937 rng(450);
+    uniform_int_distribution<unsigned int> stateDist(0, 15);
+    uniform_real_distribution<float> depthDist(0.0f, 1.0f);
+
+    vector<DrawPacket> original(cnt);
+    for(unsigned int i = 0; i < cnt; i++) {
+        original[i].key = makeDrawSortKey(stateDist(rng) % 4, stateDist(rng), stateDist(rng)*64, depthDist(rng));
+        original[i].instance = i;
+    }
+
+    // Copying the input is part of both timings
+    vector<DrawPacket> packets, scratch;
+    printBenchResult(runBenchmark("drawSort/radix", [&]() {
+        packets = original;
+        radixSortDrawPackets(packets, scratch);
+    }), cnt);
+
+    printBenchResult(runBenchmark("drawSort/std::sort", [&]() {
+        packets = original;
+        sort(packets.begin(), packets.end(),
+            [](const DrawPacket &a, const DrawPacket &b) { return a.key < b.key; });
+    }), cnt);
+}
+
+void benchLightBinning(unsigned int lightCnt) {
+    mt19937 rng(450);
+    uniform_real_distribution<float> xyDist(-10.0f, 10.0f);
+    uniform_real_distribution<float> zDist(-40.0f, -0.5f);
+
+    vector<ClusterLight> lights(lightCnt);
+    for(auto &light : lights) {
+        light.vposRadius = glm::vec4(xyDist(rng), xyDist(rng), zDist(rng), 0.5f);
+        light.color = glm::vec4(1.0f);
+    }
+
+    glm::mat4 projMat = glm::perspective(glm::radians(90.0f), 16.0f/9.0f, 0.01f, 50.0f);
+    projMat[1][1] *= -1;
+
+    LightClusterGrid grid;
+    CPUTimeStats stats = runBenchmark("lightBinning", [&]() {
+        buildLightClusters(grid, lights, projMat, 256*1024);
+    });
+
+    // Average lights per non-empty cluster (what each fragment loops over)
+    unsigned int nonEmpty = 0;
+    for(auto &range : grid.ranges) {
+        nonEmpty += (range.y > 0) ? 1 : 0;
+    }
+    float avgPerCluster = nonEmpty ? float(grid.indices.size()) / nonEmpty : 0.0f;
+
+    printBenchResult(stats, lightCnt,
+        " avgLightsPerCluster=" + to_string(avgPerCluster)
+        + " overflow=" + to_string(grid.overflowCnt));
+}
+
+void benchExtractMeshData(unsigned int vertCnt) {
+    aiMesh *mesh = makeGridAiMesh(vertCnt);
+
+    Mesh<ModelVertex> m;
+    CPUTimeStats stats = runBenchmark("extractMeshData", [&]() {
+        extractMeshData(mesh, m);
+    });
+    printBenchResult(stats, mesh->mNumVertices, " triangles=" + to_string(mesh->mNumFaces));
+
+    delete mesh;
+}
+
+void benchCylinder(unsigned int vertCnt) {
+    int faceCnt = max(3u, vertCnt / 2);
+
+    vector<ModelVertex> vertices;
+    vector<unsigned int> indices;
+    printBenchResult(runBenchmark("makeCylinder", [&]() {
+        makeCylinder(vertices, indices, 1.0f, 0.5f, faceCnt);
+    }), faceCnt * 2);
+
+    // Normals alone (makeCylinder above includes them)
+    printBenchResult(runBenchmark("calculateAllNormals", [&]() {
+        calculateAllNormals(vertices, indices);
+    }), vertices.size(), " triangles=" + to_string(indices.size() / 3));
+}
+
+void benchSceneTraversal(unsigned int nodeCnt) {
+    aiNode *root = makeAiNodeTree(nodeCnt);
+    glm::mat4 viewMat = glm::lookAt(glm::vec3(0, 0, 20), glm::vec3(0), glm::vec3(0, 1, 0));
+
+    // Per-node recursion over aiNodes (aiMatToGLM4 + glm::inverse per node)
+    vector<glm::mat4> normalMats;
+    CPUTimeStats recursiveStats = runBenchmark("sceneTraversal/recursive", [&]() {
+        normalMats.clear();
+        computeAssimpNormalMatsRecursive(root, glm::mat4(1.0f), viewMat, normalMats);
+    });
+
+    // Flat graph, all world matrices dirty, then one batched normal pass
+    FlatSceneGraph graph;
+    addAssimpSceneGraph(graph, root, -1);
+    finalizeSceneGraph(graph);
+
+    Mat4SoA modelSoA, modelViewSoA, normalSoA;
+    CPUTimeStats flatStats = runBenchmark("sceneTraversal/flatBatch", [&]() {
+        setSceneGraphLocalMat(graph, 0, graph.localMat[0]);
+        updateSceneGraphWorldMats(graph);
+        modelSoA.resize(graph.worldMat.size());
+        for(unsigned int i = 0; i < graph.worldMat.size(); i++) {
+            modelSoA.set(i, graph.worldMat[i]);
+        }
+        computeBatchTransforms(viewMat, modelSoA, modelViewSoA, normalSoA);
+    });
+
+    printBenchResult(recursiveStats, nodeCnt);
+    printBenchResult(flatStats, nodeCnt, " speedup=" + to_string(recursiveStats.p50Ms / flatStats.p50Ms) + "x");
+
+    delete root;
+}
+
+void benchReadBinaryFile(unsigned int vertCnt) {
+    // One position per vertex; the file stays in the OS cache after warmup,
+    // so this measures the copy/allocation path rather than the disk
+    size_t byteCnt = size_t(vertCnt) * sizeof(glm::vec3);
+    string filename = (filesystem::temp_directory_path() / "forge_microbench.bin").string();
+    {
+        ofstream file(filename, ios::binary);
+        vector<char> data(byteCnt, 'F');
+        file.write(data.data(), data.size());
+    }
+
+    size_t readCnt = 0;
+    CPUTimeStats stats = runBenchmark("readBinaryFile", [&]() {
+        readCnt = readBinaryFile(filename).size();
+    });
+    float mbPerSec = (stats.p50Ms > 0.0f) ? float(readCnt) / (stats.p50Ms * 1000.0f) : 0.0f;
+    printBenchResult(stats, vertCnt, " bytes=" + to_string(readCnt) + " MBps=" + to_string(mbPerSec));
+
+    filesystem::remove(filename);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+bool parseArgs(int argc, char **argv) {
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if(arg == "--quick") {
+            settings.maxVerts = 100000;
+            settings.minReps = 3;
+            settings.minSeconds = 0.05f;
+        }
+        else if(arg == "--max-verts" && hasValue) {
+            settings.maxVerts = max(1000, atoi(argv[++i]));
+        }
+        else if(arg == "--warmup" && hasValue) {
+            settings.warmupReps = max(0, atoi(argv[++i]));
+        }
+        else if(arg == "--reps" && hasValue) {
+            settings.minReps = max(1, atoi(argv[++i]));
+        }
+        else if(arg == "--csv" && hasValue) {
+            settings.csvPath = argv[++i];
+        }
+        else {
+            cout << "Usage: forge_microbench [--quick] [--max-verts N] [--warmup N] [--reps N] [--csv results.csv]" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    cout << "BEGIN FORGING!!!" << endl;
+
+    if(!parseArgs(argc, argv)) {
+        return -1;
+    }
+
+    if(!settings.csvPath.empty()) {
+        csvFile.open(settings.csvPath);
+        if(!csvFile) {
+            cerr << "Could not write " << settings.csvPath << endl;
+            return -1;
+        }
+        csvFile << "name,n,reps,avgMs,p50Ms,p95Ms,p99Ms,maxMs,p50NsPerItem" << endl;
+    }
+
+    // Object counts (per frame)
+    vector<unsigned int> sizes = {1000, 10000, 100000};
+    for(unsigned int cnt : sizes) {
+        benchTransforms(cnt);
+        benchDrawSort(cnt);
+    }
+
+    for(unsigned int lightCnt = 1; lightCnt <= 4096; lightCnt *= 4) {
+        benchLightBinning(lightCnt);
+    }
+
+    // Vertex counts (per load)
+    for(unsigned int vertCnt = 1000; vertCnt <= settings.maxVerts; vertCnt *= 10) {
+        benchExtractMeshData(vertCnt);
+        benchCylinder(vertCnt);
+        benchReadBinaryFile(vertCnt);
+    }
+
+    // Node counts; an aiNode is over 1KB (name buffer), so the tree stops
+    // at 100k nodes
+    for(unsigned int nodeCnt = 1000; nodeCnt <= min(settings.maxVerts, 100000u); nodeCnt *= 10) {
+        benchSceneTraversal(nodeCnt);
+    }
+
+    cout << "FORGING DONE!!!" << endl;
+    return 0;
+}
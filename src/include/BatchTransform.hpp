@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// SoA batch of 4x4 matrices
+// - e[col*4 + row][i] is element (col, row) of matrix i
+// - Storage is padded to a multiple of BATCH_TRANSFORM_PAD so SIMD loops
+//   never need a scalar tail
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int BATCH_TRANSFORM_PAD = 8;
+
+struct Mat4SoA {
+    vector<float> e[16];
+    unsigned int count = 0;
+
+    void resize(unsigned int n);
+    void set(unsigned int i, const glm::mat4 &m);
+    glm::mat4 get(unsigned int i) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Batched model-view and normal matrices
+// - normalMats = transpose(inverse(mat3(viewMat * modelMats)))
+// - Rigid/uniformly scaled blocks use M / scale^2; only blocks with
+//   non-uniform scale or shear pay for the full 3x3 cofactor
+// - Uses AVX or SSE when available, scalar otherwise
+// - Returns number of matrices that needed the cofactor path
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int computeBatchTransforms(const glm::mat4 &viewMat,
+                                    const Mat4SoA &modelMats,
+                                    Mat4SoA &modelViewMats,
+                                    Mat4SoA &normalMats);
+
+// Only matrices [first, last) (widened to whole SIMD blocks); the others
+// keep their previous results, so use the same viewMat as the last full call
+unsigned int computeBatchTransformsRange(   const glm::mat4 &viewMat,
+                                            const Mat4SoA &modelMats,
+                                            Mat4SoA &modelViewMats,
+                                            Mat4SoA &normalMats,
+                                            unsigned int first, unsigned int last);
+
+unsigned int computeBatchTransformsScalar(  const glm::mat4 &viewMat,
+                                            const Mat4SoA &modelMats,
+                                            Mat4SoA &modelViewMats,
+                                            Mat4SoA &normalMats);
+
+const char* getBatchTransformISA();
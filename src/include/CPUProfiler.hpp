@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <cstdint>
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// CPU profiler
+// - CPU_PROFILE_SCOPE("name") times the rest of the enclosing block (RAII)
+// - Every thread writes its events into its OWN ring buffer (single
+//   producer/single consumer, no locks on the recording path); a full ring
+//   drops events instead of blocking
+// - collectCPUProfile() (one thread, e.g. once per frame) drains all rings
+//   into per-scope histories; frame times are added with addCPUFrameTime()
+// - Reports p50/p95/p99/max, which show the stutters an average hides
+// - Compiled out entirely with FORGE_NO_CPU_PROFILER
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int CPU_PROFILER_RING_SIZE = 4096;      // Events per thread (power of 2)
+const unsigned int CPU_PROFILER_HISTORY = 1024;        // Samples per scope / frame times
+
+// One finished scope (times in ns since the profiler's epoch)
+struct CPUProfileEvent {
+    uint32_t scopeID = 0;
+    uint32_t threadIndex = 0;
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+};
+
+// Stats over the history window (milliseconds)
+struct CPUTimeStats {
+    string name;
+    unsigned long long sampleCnt = 0;  // In the window
+    float avgMs = 0.0f;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+};
+
+// Registers (or finds) a scope name; thread-safe, meant to be called once
+// per call site (the macro caches the ID in a static)
+unsigned int registerCPUProfileScope(const string &name);
+
+// Runtime switch (scopes still cost one atomic load when off)
+void setCPUProfilerEnabled(bool enabled);
+bool isCPUProfilerEnabled();
+
+// Nanoseconds since the profiler's epoch (steady clock)
+uint64_t getCPUProfilerTimeNs();
+
+// The epoch as a raw steady_clock value (ns), for mapping other clocks that
+// share steady_clock's source (e.g., calibrated GPU timestamps)
+uint64_t getCPUProfilerEpochNs();
+
+// Appends to the calling thread's ring
+void recordCPUProfileEvent(unsigned int scopeID, uint64_t startNs, uint64_t endNs);
+
+class CPUProfileScope {
+    private:
+        unsigned int scopeID;
+        uint64_t startNs = 0;
+        bool active;
+
+    public:
+        CPUProfileScope(unsigned int scopeID) : scopeID(scopeID), active(isCPUProfilerEnabled()) {
+            if(active) {
+                startNs = getCPUProfilerTimeNs();
+            }
+        }
+
+        ~CPUProfileScope() {
+            if(active) {
+                recordCPUProfileEvent(scopeID, startNs, getCPUProfilerTimeNs());
+            }
+        }
+
+        CPUProfileScope(const CPUProfileScope&) = delete;
+        CPUProfileScope& operator=(const CPUProfileScope&) = delete;
+};
+
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+
+#ifndef FORGE_NO_CPU_PROFILER
+#define CPU_PROFILE_SCOPE(name) \
+    static const unsigned int CPU_PROFILE_CONCAT(cpuProfileID, __LINE__) = registerCPUProfileScope(name); \
+    CPUProfileScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(CPU_PROFILE_CONCAT(cpuProfileID, __LINE__))
+#else
+#define CPU_PROFILE_SCOPE(name)
+#endif
+
+// Whole-frame times (seconds), kept in their own history
+void addCPUFrameTime(float frameTime);
+
+// Drains every thread's ring into the scope histories; if events is not
+// null, the drained events are also appended to it (e.g., for tracing).
+// Returns the number of events drained.
+unsigned int collectCPUProfile(vector<CPUProfileEvent> *events = nullptr);
+
+// Drains the rings and forgets all history and the dropped-event count
+// (e.g., after a warmup)
+void resetCPUProfile();
+
+// Events lost to full rings since the start
+unsigned long long getCPUProfileDroppedCount();
+
+// Call collectCPUProfile() first
+CPUTimeStats getCPUFrameTimeStats();
+vector<CPUTimeStats> getCPUScopeStats();     // Per call; scopes never hit are skipped
+string getCPUProfileScopeName(unsigned int scopeID);
+
+// Same stats for any series of durations (ms), e.g., a whole benchmark run
+CPUTimeStats computeCPUTimeStats(const string &name, vector<float> ms);
+
+void printCPUProfileStats(ostream &out = cout);
@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "CPUProfiler.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Chrome/Perfetto trace-event export
+// - Keeps the LAST capacity events in a ring (fixed memory, no allocation
+//   while recording once names are known), so tracing can stay on for a
+//   long session and be written right after a spike
+// - All times are in the CPU profiler's time base (ns since its epoch);
+//   GPU events are converted by the GPU profiler before they get here
+// - One track per CPU thread (profiler thread index) plus GPU tracks
+//   (CHROME_TRACE_GPU_TRACK + queue); open the file in ui.perfetto.dev or
+//   chrome://tracing
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t CHROME_TRACE_GPU_TRACK = 0x10000;
+
+struct ChromeTraceEvent {
+    uint32_t nameID = 0;
+    uint32_t track = 0;
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+};
+
+struct ChromeTrace {
+    bool enabled = false;
+    unsigned int capacity = 0;
+    vector<ChromeTraceEvent> events;        // Ring
+    unsigned long long totalCnt = 0;        // Added since the last clear
+
+    vector<string> names;
+    unordered_map<string, uint32_t> nameIndices;
+    vector<int> cpuScopeNameIDs;            // CPU profiler scope -> name (-1 = unknown yet)
+
+    vector<CPUProfileEvent> scratch;        // Reused by collectCPUProfileTrace()
+};
+
+// capacity events of 24 bytes each (default ~6 MB)
+ChromeTrace createChromeTrace(unsigned int capacity = 262144);
+void clearChromeTrace(ChromeTrace &trace);
+
+uint32_t getChromeTraceNameID(ChromeTrace &trace, const string &name);
+void addChromeTraceEvent(   ChromeTrace &trace, uint32_t nameID, uint32_t track,
+                            uint64_t startNs, uint64_t durationNs);
+
+// Replaces collectCPUProfile() while tracing: drains the profiler rings
+// into the scope histories AND the trace (returns events drained)
+unsigned int collectCPUProfileTrace(ChromeTrace &trace);
+
+// Oldest kept event first; returns false if the file cannot be written
+bool writeChromeTrace(ChromeTrace &trace, const string &filename);
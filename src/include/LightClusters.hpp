@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Clustered forward lighting (CPU binning)
+// - View frustum split into dimX x dimY screen tiles and dimZ exponential
+//   depth slices
+// - Each cluster stores a range (offset, count) into one compact list of
+//   light indices, so fragments only loop over lights that can reach them
+///////////////////////////////////////////////////////////////////////////////
+
+// Matches std430 layout in shaders
+struct ClusterLight {
+    alignas(16) glm::vec4 vposRadius;   // View position (xyz) and radius (w)
+    alignas(16) glm::vec4 color;
+};
+
+struct LightClusterGrid {
+    unsigned int dimX = 16;
+    unsigned int dimY = 9;
+    unsigned int dimZ = 24;
+    float nearZ = 0.01f;
+    float farZ = 50.0f;
+
+    vector<glm::uvec2> ranges;          // Per cluster: (offset, count)
+    vector<unsigned int> indices;       // Light indices for all clusters
+    unsigned int overflowCnt = 0;       // Entries dropped (hit maxIndices)
+};
+
+unsigned int getClusterCount(const LightClusterGrid &grid);
+
+// Depth slice for positive view depth (i.e., -viewPos.z)
+unsigned int getClusterSlice(const LightClusterGrid &grid, float viewDepth);
+
+// Scale and bias such that slice = log(viewDepth)*scale + bias
+glm::vec2 getClusterSliceScaleBias(const LightClusterGrid &grid);
+
+// projMat must be the SAME projection used for rendering
+void buildLightClusters(LightClusterGrid &grid,
+                        const vector<ClusterLight> &lights,
+                        const glm::mat4 &projMat,
+                        unsigned int maxIndices);
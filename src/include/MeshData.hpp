@@ -1,6 +1,7 @@
 #pragma once
 #include <iostream>
 #include <vector>
+#include <cmath>
 #include "glm/glm.hpp"
 using namespace std;
 
@@ -16,3 +17,28 @@ struct Mesh {
 	vector<T> vertices {};
 	vector<unsigned int> indices {};
 };
+
+// Bounding sphere (center xyz, radius w) around AABB center
+// (requires T::pos; empty meshes get radius 0)
+template<typename T>
+glm::vec4 computeMeshBoundingSphere(Mesh<T> &mesh) {
+	if(mesh.vertices.empty()) {
+		return glm::vec4(0.0f);
+	}
+
+	glm::vec3 minPos = mesh.vertices[0].pos;
+	glm::vec3 maxPos = mesh.vertices[0].pos;
+	for(auto &v : mesh.vertices) {
+		minPos = glm::min(minPos, v.pos);
+		maxPos = glm::max(maxPos, v.pos);
+	}
+
+	glm::vec3 center = 0.5f * (minPos + maxPos);
+	float radius2 = 0.0f;
+	for(auto &v : mesh.vertices) {
+		glm::vec3 d = v.pos - center;
+		radius2 = max(radius2, glm::dot(d, d));
+	}
+
+	return glm::vec4(center, sqrt(radius2));
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+#include "MeshData.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Mesh simplification (quadric error metric) and LOD chains
+// - Edge collapses move one vertex ONTO another existing vertex, so every
+//   LOD only needs new indices; all LODs share the original vertex buffer
+// - Vertices on open borders or UV/normal seams (same position, several
+//   vertices) never move, so LODs don't crack
+// - Error = sqrt of the accumulated quadric cost, an upper bound on the
+//   object-space distance to the original surface
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int MESH_MAX_LODS = 4;
+
+// Index range of one LOD inside the mesh's index buffer
+struct MeshLOD {
+    unsigned int firstIndex = 0;
+    unsigned int indexCnt = 0;
+    float error = 0.0f;                 // Object-space error bound (0 for LOD 0)
+};
+
+// Returns a simplified triangle list (same vertex indices) with at most
+// targetIndexCnt indices, unless no collapse below maxError is left
+vector<unsigned int> simplifyMesh(  const vector<glm::vec3> &positions,
+                                    const vector<unsigned int> &indices,
+                                    unsigned int targetIndexCnt,
+                                    float maxError,
+                                    float &resultError);
+
+// Appends LODs 1..maxLODs-1 (each ~reduction times the previous triangle
+// count) after the original indices; LOD 0 is the original range.
+// Stops early once simplification no longer makes progress.
+vector<MeshLOD> buildMeshLODs(  const vector<glm::vec3> &positions,
+                                vector<unsigned int> &indices,
+                                unsigned int maxLODs = MESH_MAX_LODS,
+                                float reduction = 0.5f,
+                                float maxError = 1e30f);
+
+// Convenience wrapper for meshes whose vertices have a pos member
+template<typename T>
+vector<MeshLOD> buildMeshLODs(Mesh<T> &mesh, unsigned int maxLODs = MESH_MAX_LODS, float reduction = 0.5f) {
+    vector<glm::vec3> positions;
+    positions.reserve(mesh.vertices.size());
+    for(auto &v : mesh.vertices) {
+        positions.push_back(v.pos);
+    }
+    return buildMeshLODs(positions, mesh.indices, maxLODs, reduction);
+}
+
+// Coarsest LOD whose error, projected at the given distance, stays within
+// maxPixelError. pixelsPerUnitAtOne = screenHeight * projMat[1][1] / 2
+// (pixels covered by one unit at distance one); scale = model scale.
+unsigned int selectMeshLOD( const vector<MeshLOD> &lods, float distance, float scale,
+                            float pixelsPerUnitAtOne, float maxPixelError);
@@ -0,0 +1,145 @@
+#pragma once
+#include <vector>
+#include <assimp/scene.h>
+#include "glm/glm.hpp"
+#include "glm/gtc/constants.hpp"
+#include "MeshData.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Host-side mesh building shared by the apps and the microbenchmarks
+// - Templated on the vertex type, which needs pos (vec3), color (vec4) and
+//   normal (vec3) members
+///////////////////////////////////////////////////////////////////////////////
+
+// Copies positions, normals (up if missing) and face indices; color is
+// yellow
+template<typename T>
+void extractMeshData(aiMesh *mesh, Mesh<T> &m) {
+    m.vertices.clear();
+    m.indices.clear();
+
+    for(int i = 0; i < mesh->mNumVertices; ++i){
+        T vertex;
+
+        // Position
+        aiVector3D aiPos = mesh->mVertices[i];
+        vertex.pos = glm::vec3(aiPos.x, aiPos.y, aiPos.z);
+
+        // Set color to yellow
+        vertex.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+
+        // Set normal
+        if (mesh->HasNormals()) {
+            aiVector3D aiNormal = mesh->mNormals[i];
+            vertex.normal = glm::vec3(aiNormal.x, aiNormal.y, aiNormal.z);
+        } else {
+            vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);  // default up vector
+        }
+
+        m.vertices.push_back(vertex);
+    }
+
+    for(int i = 0; i < mesh->mNumFaces; ++i){
+        aiFace face = mesh->mFaces[i];
+
+        for(int j = 0; j < face.mNumIndices; ++j) {
+            m.indices.push_back(face.mIndices[j]);
+        }
+    }
+}
+
+// Adds the face normal of one triangle to its three vertices
+template<typename T>
+void calculateTriangleNormal(
+    vector<T> &vertices,
+    unsigned int i0, unsigned int i1, unsigned int i2) {
+
+    glm::vec3 A = vertices.at(i0).pos;
+    glm::vec3 B = vertices.at(i1).pos;
+    glm::vec3 C = vertices.at(i2).pos;
+
+    glm::vec3 v1 = B - A;
+    glm::vec3 v2 = C - A;
+
+    glm::vec3 N = glm::cross(v1, v2);
+    N = glm::normalize(N);
+
+    vertices.at(i0).normal += N;
+    vertices.at(i1).normal += N;
+    vertices.at(i2).normal += N;
+}
+
+// Smooth normals: average of the adjacent face normals
+template<typename T>
+void calculateAllNormals(
+    vector<T> &vertices,
+    vector<unsigned int> &indices
+) {
+    for(int i = 0; i < vertices.size(); i++) {
+        vertices.at(i).normal = glm::vec3(0,0,0);
+    }
+
+    for(int i = 0; i < indices.size(); i+=3) {
+        calculateTriangleNormal(vertices,
+            indices.at(i),
+            indices.at(i+1),
+            indices.at(i+2));
+    }
+
+    for(int i = 0; i < vertices.size(); i++) {
+        vertices.at(i).normal
+        = glm::normalize(vertices.at(i).normal);
+    }
+}
+
+// Open cylinder along x (no caps), faceCnt quads around
+template<typename T>
+void makeCylinder(
+    vector<T> &vertices,
+    vector<unsigned int> &indices,
+    float length, float radius,
+    int faceCnt) {
+
+    vertices.clear();
+    indices.clear();
+
+    float angleInc
+     = (2.0f*glm::pi<float>())/((float)faceCnt);
+
+    for(int i = 0; i < faceCnt; i++) {
+        T left, right;
+        float x = length/2.0f;
+        float angle = angleInc*i;
+        float y = radius*glm::sin(angle);
+        float z = radius*glm::cos(angle);
+
+        left.pos = glm::vec3(-x, y, z);
+        right.pos = glm::vec3(x, y, z);
+
+        left.color = glm::vec4(1,0,0,1);
+        right.color = glm::vec4(1,0,1,1);
+
+        vertices.push_back(left);
+        vertices.push_back(right);
+    }
+
+    int max_vert_cnt = faceCnt*2;
+
+    for(int i = 0; i < faceCnt; i++) {
+        int low_left = 2*i;
+        int up_left = (2*(i+1))%max_vert_cnt;
+        int low_right = low_left + 1;
+        int up_right = up_left + 1;
+
+        indices.push_back(low_left);
+        indices.push_back(low_right);
+        indices.push_back(up_left);
+
+        indices.push_back(low_right);
+        indices.push_back(up_right);
+        indices.push_back(up_left);
+    }
+
+    calculateAllNormals(vertices, indices);
+}
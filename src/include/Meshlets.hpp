@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+#include "MeshData.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Meshlets (clusters of up to 64 vertices / 124 triangles)
+// - Built once at import time: triangles are REORDERED so every meshlet is
+//   one contiguous index range (same vertex and index buffers as before)
+// - Each meshlet has a bounding sphere and a normal cone, so whole clusters
+//   can be rejected when outside the frustum or facing away from the camera
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int MESHLET_MAX_VERTICES = 64;
+const unsigned int MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet {
+    unsigned int firstIndex = 0;
+    unsigned int indexCnt = 0;
+    unsigned int vertexCnt = 0;         // Unique vertices referenced
+    glm::vec4 boundingSphere;           // Object-space center (xyz), radius (w)
+    glm::vec4 cone;                     // Axis (xyz), cutoff (w); cutoff >= 1 = never backface culled
+};
+
+// Contiguous index range that survived culling
+// (adjacent surviving meshlets are merged into one range)
+struct MeshletDrawRange {
+    unsigned int firstIndex;
+    unsigned int indexCnt;
+};
+
+struct MeshletCullStats {
+    unsigned int testedCnt = 0;
+    unsigned int frustumCulledCnt = 0;
+    unsigned int backfaceCulledCnt = 0;
+    unsigned int drawnCnt = 0;
+};
+
+// Reorders indices (triangle lists only) and returns the meshlets in order
+vector<Meshlet> buildMeshlets(  const vector<glm::vec3> &positions,
+                                vector<unsigned int> &indices,
+                                unsigned int maxVertices = MESHLET_MAX_VERTICES,
+                                unsigned int maxTriangles = MESHLET_MAX_TRIANGLES);
+
+// Convenience wrapper for meshes whose vertices have a pos member
+template<typename T>
+vector<Meshlet> buildMeshlets(Mesh<T> &mesh) {
+    vector<glm::vec3> positions;
+    positions.reserve(mesh.vertices.size());
+    for(auto &v : mesh.vertices) {
+        positions.push_back(v.pos);
+    }
+    return buildMeshlets(positions, mesh.indices);
+}
+
+// Culls the meshlets of ONE instance and appends surviving ranges.
+// worldPlanes are world-space frustum planes; cameraPos is in world space.
+// (Tests run in object space; cone tests assume no non-uniform scale.)
+// coneCulling drops back-facing clusters, which is only invisible for
+// closed meshes when the pipeline itself does not cull back faces.
+void cullMeshlets(  const vector<Meshlet> &meshlets,
+                    const glm::mat4 &modelMat,
+                    const glm::vec4 worldPlanes[6],
+                    glm::vec3 cameraPos,
+                    bool coneCulling,
+                    vector<MeshletDrawRange> &ranges,
+                    MeshletCullStats &stats);
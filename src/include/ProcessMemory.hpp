@@ -0,0 +1,13 @@
+#pragma once
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Process memory
+// - Resident memory RIGHT NOW (working set on Windows, resident pages on
+//   Linux), so it can go down again and be compared before/after a piece
+//   of work; a peak (high-water mark) cannot show anything after the
+//   largest allocation
+// - 0 where unknown (other platforms, or the query failed)
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long getProcessMemoryBytes();
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <assimp/scene.h>
+#include "glm/glm.hpp"
+#include "VKUtility.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Flattened scene graph (SoA)
+// - Nodes are stored in pre-order, so a parent always comes before its
+//   children and every subtree is the contiguous range [i, subtreeEnd[i])
+// - World transforms are only recomputed for dirty subtrees
+///////////////////////////////////////////////////////////////////////////////
+
+struct FlatSceneGraph {
+    vector<int> parent;                 // -1 for root nodes
+    vector<glm::mat4> localMat;
+    vector<glm::mat4> worldMat;
+    vector<unsigned int> subtreeEnd;    // One past last descendant
+    vector<unsigned int> meshStart;     // Range into meshIndices
+    vector<unsigned int> meshCnt;
+    vector<unsigned char> dirty;
+
+    vector<unsigned int> meshIndices;   // Indices into aiScene::mMeshes
+    bool anyDirty = false;
+};
+
+// Nodes MUST be added in pre-order (parent = -1 or a node on the current
+// right-most path); call finalizeSceneGraph() once all nodes are added
+void clearSceneGraph(FlatSceneGraph &graph);
+int addSceneGraphNode(  FlatSceneGraph &graph, int parent,
+                        const glm::mat4 &localMat,
+                        const vector<unsigned int> &meshes = {});
+int addAssimpSceneGraph(FlatSceneGraph &graph, aiNode *node, int parent);
+void finalizeSceneGraph(FlatSceneGraph &graph);
+
+void setSceneGraphLocalMat(FlatSceneGraph &graph, int node, const glm::mat4 &localMat);
+
+// Returns number of world transforms recomputed; updatedRanges (if given)
+// gets one [begin, end) node range per recomputed subtree, in order
+unsigned int updateSceneGraphWorldMats( FlatSceneGraph &graph,
+                                        vector<glm::uvec2> *updatedRanges = nullptr);
+
+// Reference per-node path (no flattening): recursive walk over the aiNodes
+// converting every transform and inverting every model-view on the way;
+// appends one normal matrix per node with meshes, in pre-order
+void computeAssimpNormalMatsRecursive(  aiNode *node, glm::mat4 parentMat, const glm::mat4 &viewMat,
+                                        vector<glm::mat4> &normalMats);
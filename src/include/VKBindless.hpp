@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include "VKSetup.hpp"
+#include "VKImage.hpp"
+#include "VKUniform.hpp"
+#include "glm/glm.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Bindless textures and materials (descriptor indexing)
+// - ONE descriptor set for everything, bound once per frame:
+//   binding 0 = sampler2D textures[textureCapacity] (update-after-bind,
+//               partially bound: only written slots may be sampled)
+//   binding 1 = material SSBO (BindlessMaterial[materialCapacity])
+// - Shaders pick a material per draw/instance and sample
+//   textures[material.textureIndex] (nonuniformEXT)
+// - Textures/materials can be added while the set is bound, but a slot must
+//   not be overwritten while a frame in flight may still read it
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int BINDLESS_NO_TEXTURE = 0xFFFFFFFF;
+
+// Matches BindlessMaterial in shaders (std430)
+struct BindlessMaterial {
+    alignas(16) glm::vec4 baseColor = glm::vec4(1.0f);
+    alignas(4) unsigned int textureIndex = BINDLESS_NO_TEXTURE;
+    alignas(4) float textureScale = 1.0f;       // Repeats per unit
+    alignas(4) float metallic = -1.0f;          // < 0 = scene default
+    alignas(4) float roughness = -1.0f;         // < 0 = scene default
+};
+
+struct VulkanBindlessTable {
+    unsigned int textureCapacity = 0;
+    unsigned int materialCapacity = 0;
+
+    vk::DescriptorSetLayout layout;
+    vk::DescriptorPool pool;
+    vk::DescriptorSet set;
+    vk::Sampler sampler;                // Shared by all textures (linear, repeat)
+
+    vector<VulkanImage> textures;       // Index = texture slot
+    UBOData materials;                  // One host-visible SSBO (mapped)
+    unsigned int materialCnt = 0;
+};
+
+// Extension enabled AND the needed features present (see initVulkanBootstrap())
+bool isVulkanBindlessSupported(VulkanInitData &vkInitData);
+
+// Layout of the bindless set (pipelines get their own copy; same definition
+// = compatible with table.layout)
+vk::DescriptorSetLayout createVulkanBindlessSetLayout(  vk::Device &device, unsigned int textureCapacity,
+                                                        vk::ShaderStageFlags stages);
+
+// Texture capacity is clamped to the device's update-after-bind limits
+VulkanBindlessTable createVulkanBindlessTable(  VulkanInitData &vkInitData,
+                                                unsigned int textureCapacity, unsigned int materialCapacity,
+                                                vk::ShaderStageFlags stages = vk::ShaderStageFlagBits::eFragment);
+void cleanupVulkanBindlessTable(VulkanInitData &vkInitData, VulkanBindlessTable &table);
+
+// Takes ownership of the texture (eShaderReadOnlyOptimal); returns its slot
+unsigned int addBindlessTexture(VulkanInitData &vkInitData, VulkanBindlessTable &table, VulkanImage texture);
+
+// Returns the material index
+unsigned int addBindlessMaterial(VulkanBindlessTable &table, const BindlessMaterial &material);
+void updateBindlessMaterial(VulkanBindlessTable &table, unsigned int index, const BindlessMaterial &material);
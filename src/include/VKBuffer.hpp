@@ -3,6 +3,7 @@
 #include <fstream>
 #include <vulkan/vulkan.hpp>
 #include "VKUtility.hpp"
+#include "VKObjectTracker.hpp"
 
 using namespace std;
 
@@ -19,7 +20,8 @@ VulkanBuffer createVulkanBuffer(vk::PhysicalDevice &physicalDevice,
                                 vk::Device &device,
                                 vk::DeviceSize size,
                                 vk::BufferUsageFlags usage,
-                                vk::MemoryPropertyFlags properties);
+                                vk::MemoryPropertyFlags properties,
+                                VulkanCallSite site = VULKAN_CALL_SITE);
 void copyDataToVulkanBuffer(vk::Device &device, vk::DeviceMemory memory, 
                             size_t bufferSize, void *hostData);
 void copyDataToVulkanBufferViaStaging(  vk::PhysicalDevice &physicalDevice,
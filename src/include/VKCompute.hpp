@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "VKSetup.hpp"
+#include "VKUtility.hpp"
+#include "VKObjectTracker.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Compute pipelines
+// - Descriptor set layouts are owned by the caller (often shared with
+//   descriptor set allocation)
+///////////////////////////////////////////////////////////////////////////////
+
+struct VulkanComputePipelineData {
+    vk::PipelineLayout pipelineLayout;
+    vk::Pipeline pipeline;
+};
+
+VulkanComputePipelineData createVulkanComputePipelineData(
+                                vk::Device &device,
+                                string compSPVFilename,
+                                const vector<vk::DescriptorSetLayout> &descriptorSetLayouts,
+                                const vector<vk::PushConstantRange> &pushConstantRanges = {},
+                                VulkanCallSite site = VULKAN_CALL_SITE);
+void cleanupVulkanComputePipelineData(vk::Device &device, VulkanComputePipelineData &data);
+
+// Number of workgroups needed to cover cnt items
+unsigned int getComputeGroupCount(unsigned int cnt, unsigned int groupSize);
@@ -0,0 +1,121 @@
+#pragma once
+#include "VKSetup.hpp"
+#include "VKRender.hpp"
+#include "VKImage.hpp"
+#include "VKMesh.hpp"
+#include "VKUniform.hpp"
+#include "VKInstance.hpp"
+#include "VKRenderQueue.hpp"
+#include "LightClusters.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Deferred shading
+// - ONE render pass with two subpasses:
+//   0: geometry -> G-buffer (normal, albedo, metallic/roughness) + depth
+//   1: full-screen lighting, reading the G-buffer as INPUT attachments
+// - G-buffer images are transient and never stored, so tile-based GPUs
+//   can keep them on-chip for the whole pass
+// - View position is reconstructed from depth (no position attachment)
+///////////////////////////////////////////////////////////////////////////////
+
+// Same layout as the usual position/color/normal vertex
+struct DeferredVertex {
+    glm::vec3 pos;
+    glm::vec4 color;
+    glm::vec3 normal;
+};
+
+struct DeferredRenderParams : public VulkanInitRenderParams {
+    // vertSPVFilename/fragSPVFilename are the G-buffer (geometry) shaders
+    string lightVertSPVFilename;
+    string lightFragSPVFilename;
+};
+
+// What the app hands to drawFrame() (draws go through getRenderQueue())
+struct DeferredSceneData {
+    glm::mat4 viewMat = glm::mat4(1.0f);
+    glm::mat4 projMat = glm::mat4(1.0f);   // OpenGL convention (Y flipped internally)
+    vector<ClusterLight> lights;            // View space
+    float metallic = 0.0f;
+    float roughness = 0.1f;
+    glm::vec4 clearColor = glm::vec4(1.0f, 1.0f, 0.7f, 1.0f);
+};
+
+struct DeferredUBOGeometry {
+    alignas(16) glm::mat4 viewMat;
+    alignas(16) glm::mat4 projMat;
+    alignas(16) glm::vec4 material;         // Metallic, roughness
+};
+
+struct DeferredUBOLighting {
+    alignas(16) glm::mat4 invProjMat;
+    alignas(16) glm::uvec4 clusterDims;     // Tiles in x/y, slices in z, light count in w
+    alignas(16) glm::vec4 clusterParams;    // Slice scale, slice bias, tile width, tile height (pixels)
+    alignas(16) glm::vec4 screenParams;     // Width, height, 1/width, 1/height
+    alignas(16) glm::vec4 clearColor;
+};
+
+enum DeferredGBufferAttachment {
+    GBUFFER_NORMAL = 0,     // View-space normal (RGB10A2)
+    GBUFFER_ALBEDO,         // Base color (RGBA8)
+    GBUFFER_MATERIAL,       // Metallic, roughness (RG8)
+    GBUFFER_CNT
+};
+
+class DeferredRenderEngine : public VulkanRenderEngine {
+    protected:
+        const unsigned int MAX_LIGHTS = 4096;
+        const unsigned int MAX_CLUSTER_LIGHT_INDICES = 256*1024;
+        const unsigned int INSTANCE_BINDING = 1;
+
+        vector<VulkanImage> gBufferImages;
+        VulkanPipelineData lightingPipelineData;
+
+        DeferredUBOGeometry hostUBOGeometry;
+        DeferredUBOLighting hostUBOLighting;
+        UBOData deviceUBOGeometry;
+        UBOData deviceUBOLighting;
+
+        LightClusterGrid lightGrid;
+        UBOData deviceLights;
+        UBOData deviceClusterRanges;
+        UBOData deviceLightIndices;
+
+        vk::DescriptorPool descriptorPool;
+        vector<vk::DescriptorSet> descriptorSets;
+
+        VulkanInstanceBuffer deviceInstances;
+        VulkanRenderQueue renderQueue;
+        unsigned int gBufferPipelineID = 0;
+        unsigned int materialID = 0;
+
+    public:
+        DeferredRenderEngine(VulkanInitData &vkInitData);
+        virtual ~DeferredRenderEngine();
+
+        // params MUST be a DeferredRenderParams
+        virtual bool initialize(VulkanInitRenderParams *params) override;
+
+        // Per-frame usage: getRenderQueue().begin() -> add() ... -> drawFrame(DeferredSceneData*)
+        VulkanRenderQueue& getRenderQueue();
+        unsigned int getGBufferPipelineID();
+        unsigned int getMaterialID();
+
+    protected:
+        virtual vk::RenderPass createVulkanRenderPass(VulkanImage &depthImage) override;
+
+        virtual AttributeDescData getAttributeDescData() override;
+        virtual vector<vk::DescriptorSetLayout> getDescriptorSetLayouts() override;
+
+        // Also (re)creates the G-buffer images, since they follow the swapchain size
+        virtual vector<vk::Framebuffer> createVulkanFramebuffers(   vk::RenderPass &renderPass,
+                                                                    VulkanImage &depthImage) override;
+        virtual void cleanupVulkanFramebuffers(vector<vk::Framebuffer> &framebuffers) override;
+
+        void updateInputAttachmentDescriptors();
+        virtual void updateUniformBuffers(DeferredSceneData *sceneData);
+
+        virtual void recordCommandBuffer(   void *userData,
+                                            vk::CommandBuffer &commandBuffer,
+                                            unsigned int imageIndex) override;
+};
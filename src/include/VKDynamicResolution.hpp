@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include "VKSetup.hpp"
+#include "VKImage.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic resolution
+// - The scene renders into an offscreen color target (swapchain format and
+//   size); only the top-left scale * extent region is rasterized
+// - That region is upscaled to the swapchain image with a blit: linear if
+//   the format can be filtered, else nearest; formats that cannot be
+//   blitted at all are copied, which pins the scale at full resolution
+// - The caller feeds frame times (the GPU profiler's "frame" scope, or CPU
+//   times without it) and the scale moves toward a target frame time
+//   (cost ~ pixel count, so the scale moves by sqrt(ratio))
+///////////////////////////////////////////////////////////////////////////////
+
+struct DynamicResolutionSettings {
+    float minScale = 0.5f;              // Per axis
+    float maxScale = 1.0f;              // Per axis (<= 1; target is swapchain sized)
+    float targetFrameTime = 0.016f;     // Seconds of GPU time
+    float headroom = 0.85f;             // Only scale up below target * headroom
+    float maxStep = 0.1f;               // Largest scale change per adjustment
+    unsigned int adjustInterval = 8;    // Frames between adjustments
+    float smoothing = 0.1f;             // Frame time EMA weight
+};
+
+struct VulkanDynamicResolution {
+    DynamicResolutionSettings settings;
+    bool enabled = true;                // false = fixed at maxScale
+
+    VulkanImage color;                  // Offscreen target (full swapchain size)
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    float scale = 1.0f;
+    float smoothedFrameTime = 0.0f;
+    unsigned int framesSinceAdjust = 0;
+    unsigned int adjustCnt = 0;
+
+    // From the format features (eBlitSrc/eBlitDst, eSampledImageFilterLinear)
+    bool blitSupported = false;         // false = copy, full resolution only
+    vk::Filter blitFilter = vk::Filter::eNearest;
+};
+
+// Color target gets eColorAttachment | eTransferSrc usage
+VulkanDynamicResolution createVulkanDynamicResolution(  VulkanInitData &vkInitData,
+                                                        unsigned int width, unsigned int height,
+                                                        DynamicResolutionSettings settings
+                                                            = DynamicResolutionSettings());
+void cleanupVulkanDynamicResolution(VulkanInitData &vkInitData, VulkanDynamicResolution &dr);
+
+// Region to render this frame (at least 1x1)
+vk::Extent2D getDynamicResolutionExtent(VulkanDynamicResolution &dr);
+
+// Feeds one frame time (seconds) to the controller; may change dr.scale
+void updateDynamicResolution(VulkanDynamicResolution &dr, float frameTime);
+
+// After the last scene pass: color target must be in eColorAttachmentOptimal.
+// Upscales renderExtent to the whole swapchain image (left in ePresentSrcKHR)
+// and returns the target to eColorAttachmentOptimal.
+void recordDynamicResolutionUpscale(vk::CommandBuffer &commandBuffer, VulkanDynamicResolution &dr,
+                                    vk::Extent2D renderExtent,
+                                    vk::Image swapchainImage, vk::Extent2D swapchainExtent);
+
+// Same upscale (dr's blit filter, or copy) for any color image of the
+// swapchain format: layer i of srcImage (its renderExtent region) fills the
+// i-th of layerCnt side-by-side columns of the swapchain. Layouts as for
+// recordDynamicResolutionUpscale().
+void recordUpscaleToSwapchain(  vk::CommandBuffer &commandBuffer, VulkanDynamicResolution &dr,
+                                vk::Image srcImage, unsigned int layerCnt, vk::Extent2D renderExtent,
+                                vk::Image swapchainImage, vk::Extent2D swapchainExtent);
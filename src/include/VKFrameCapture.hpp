@@ -0,0 +1,129 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "VKSetup.hpp"
+#include "VKBuffer.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Asynchronous frame capture (screenshots and image sequences)
+// - The final image is copied into one of a ring of persistently mapped,
+//   host-visible buffers in the frame's own command buffer (no extra submit)
+// - The copy is picked up when that frame slot's fence has signaled, i.e.,
+//   the next time the slot is recorded (a couple of frames later), so the
+//   render thread never waits on the GPU
+// - Encoder threads read straight from the mapped buffer, swizzle to RGB
+//   and write PNG/JPG with stb_image_write; the buffer goes back to the ring
+//   as soon as it is converted, before the (slow) compression
+// - If every buffer is still busy the frame is NOT captured (counted as
+//   dropped) rather than stalling rendering; add buffers or encoders (or
+//   use JPG, which encodes several times faster) if a sequence drops frames
+// - Images must be 8-bit RGBA/BGRA with eTransferSrc usage (the swapchain
+//   has it when the surface allows; headless images always do)
+///////////////////////////////////////////////////////////////////////////////
+
+enum FrameCaptureFormat {
+    FRAME_CAPTURE_PNG = 0,
+    FRAME_CAPTURE_JPG
+};
+
+enum FrameCaptureSlotState {
+    FRAME_CAPTURE_SLOT_FREE = 0,
+    FRAME_CAPTURE_SLOT_IN_FLIGHT,       // Copy recorded, fence not seen yet
+    FRAME_CAPTURE_SLOT_ENCODING         // Owned by the encoders
+};
+
+struct FrameCaptureSlot {
+    VulkanBuffer buffer;
+    void *mapped = nullptr;
+    vk::DeviceSize capacity = 0;
+    FrameCaptureSlotState state = FRAME_CAPTURE_SLOT_FREE;
+
+    unsigned int frameSlot = 0;         // Frame in flight whose fence covers the copy
+    unsigned int width = 0;
+    unsigned int height = 0;
+    bool bgra = false;
+    FrameCaptureFormat format = FRAME_CAPTURE_PNG;
+    string filename;
+};
+
+// Shared with the encoder threads (heap-allocated so the capture can move)
+struct FrameCaptureQueue {
+    mutex lock;
+    condition_variable wake;            // Work queued or stopping
+    condition_variable idle;            // A slot was released
+
+    vector<FrameCaptureSlot> slots;     // State changes under lock
+    deque<unsigned int> jobs;           // Slots to encode, oldest first
+    unsigned int activeCnt = 0;         // Slots being encoded right now
+    bool stopping = false;
+
+    unsigned long long writtenCnt = 0;
+    unsigned long long failedCnt = 0;
+    int jpgQuality = 90;
+
+    vector<thread> encoders;
+};
+
+struct VulkanFrameCapture {
+    bool supported = false;
+    vk::Format format = vk::Format::eUndefined;
+
+    // One-shot request (empty = none)
+    string nextFilename;
+
+    // Image sequence: prefix_000000.jpg, prefix_000001.jpg, ...
+    bool recording = false;
+    string recordPrefix;
+    FrameCaptureFormat recordFormat = FRAME_CAPTURE_JPG;
+    unsigned long long recordFrameCnt = 0;
+
+    unsigned long long requestedCnt = 0;
+    unsigned long long droppedCnt = 0;  // No free buffer at the time
+
+    unique_ptr<FrameCaptureQueue> queue;
+};
+
+struct FrameCaptureStats {
+    unsigned long long requestedCnt = 0;
+    unsigned long long droppedCnt = 0;
+    unsigned long long writtenCnt = 0;
+    unsigned long long failedCnt = 0;
+    unsigned int pendingCnt = 0;        // In flight or being encoded
+};
+
+// slotCnt readback buffers of the current swapchain size (resized when
+// free if the swapchain grows); encoderCnt 0 = half the hardware threads
+// (1 to 4)
+VulkanFrameCapture createVulkanFrameCapture(VulkanInitData &vkInitData,
+                                            unsigned int slotCnt = 6,
+                                            unsigned int encoderCnt = 0);
+// Device must be idle: writes what is pending, then stops the encoders
+void cleanupVulkanFrameCapture(VulkanInitData &vkInitData, VulkanFrameCapture &capture);
+
+// Capture the next recorded frame (format from the extension: .jpg/.jpeg or PNG)
+void captureNextVulkanFrame(VulkanFrameCapture &capture, const string &filename);
+void startVulkanFrameRecording( VulkanFrameCapture &capture, const string &prefix,
+                                FrameCaptureFormat format = FRAME_CAPTURE_JPG);
+void stopVulkanFrameRecording(VulkanFrameCapture &capture);
+
+// At the start of recording frameSlot (after its fence wait): copies made
+// the last time this slot was used are complete, so hand them to the encoders
+void beginVulkanFrameCapture(VulkanFrameCapture &capture, unsigned int frameSlot);
+
+// After the last pass, before commandBuffer.end(): copies image (in layout,
+// and left in it) if a capture was requested; returns true if it did
+bool recordVulkanFrameCapture(  VulkanInitData &vkInitData, VulkanFrameCapture &capture,
+                                vk::CommandBuffer &commandBuffer, unsigned int frameSlot,
+                                vk::Image image, vk::Extent2D extent,
+                                vk::ImageLayout layout = vk::ImageLayout::ePresentSrcKHR);
+
+// Device must be idle: encodes everything recorded so far and waits for it
+void flushVulkanFrameCapture(VulkanFrameCapture &capture);
+
+FrameCaptureStats getVulkanFrameCaptureStats(VulkanFrameCapture &capture);
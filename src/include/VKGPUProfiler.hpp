@@ -0,0 +1,163 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "VKSetup.hpp"
+#include "ChromeTrace.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// GPU profiler (timestamp queries)
+// - One range of 2 * maxScopes timestamp queries per frame in flight
+// - Named scopes are opened/closed while recording (they may nest); each
+//   one writes a top-of-pipe timestamp at begin and bottom-of-pipe at end
+// - A slot's results are read once its fence has signaled (i.e., at the
+//   start of the next recordCommandBuffer() for that slot), so reading
+//   never waits on the GPU
+// - Per-scope history (ms) gives rolling average, min/max and percentiles
+// - Do NOT open/close scopes inside a multiview render pass (timestamps
+//   there use one query per view); put them around the pass instead
+// - With tracing on, every scope instance is also kept as an event in the
+//   CPU profiler's time base (see collectGPUProfileTrace()). The GPU clock
+//   is mapped with VK_EXT_calibrated_timestamps when the device has it;
+//   otherwise each frame's first timestamp is bounded by the CPU time its
+//   recording started (the GPU cannot start earlier), which is a few
+//   hundred microseconds pessimistic at worst
+// - Optional pipeline statistics (vertex/clipping/fragment counts) for
+//   scopes opened with pipelineStats = true, e.g., the passes inside the
+//   "frame" scope. Statistics queries cannot nest, so such a scope opened
+//   inside another one that has them gets timestamps only
+///////////////////////////////////////////////////////////////////////////////
+
+// Pipeline statistics counts (one frame, or the average per frame)
+struct GPUPipelineStats {
+    uint64_t iaVertices = 0;            // Vertices fetched (index count)
+    uint64_t iaPrimitives = 0;
+    uint64_t vsInvocations = 0;         // Vertices actually shaded
+    uint64_t clipInvocations = 0;       // Primitives reaching clipping
+    uint64_t clipPrimitives = 0;        // Primitives leaving clipping
+    uint64_t fsInvocations = 0;         // May count before or after early depth
+};
+const unsigned int GPU_PIPELINE_STATS_CNT = 6;
+
+// Stats of one scope over its history window (milliseconds)
+struct GPUScopeStats {
+    string name;
+    unsigned int sampleCnt = 0;
+    float lastMs = 0.0f;
+    float avgMs = 0.0f;
+    float minMs = 0.0f;
+    float maxMs = 0.0f;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+
+    unsigned long long pipelineStatsFrameCnt = 0;   // 0 = no pipeline statistics
+    GPUPipelineStats pipelineStats;                 // Average per frame
+};
+
+struct GPUProfilerScope {
+    string name;
+    vector<float> history;              // Ring of durations (ms)
+    unsigned int next = 0;
+    unsigned int sampleCnt = 0;         // Valid entries in history
+    float lastMs = 0.0f;
+
+    GPUPipelineStats pipelineStatsTotal;    // Since creation
+    unsigned long long pipelineStatsFrameCnt = 0;
+};
+
+// Scopes recorded into one frame slot (query pairs in recording order)
+struct GPUProfilerFrame {
+    vector<unsigned int> scopeIDs;      // Scope of query pair i
+    vector<unsigned int> openPairs;     // Stack of pairs still open
+    bool written = false;               // Results pending for this slot
+    uint64_t cpuBeginNs = 0;            // CPU profiler time at frame begin
+
+    vector<unsigned char> statsPairs;   // Pair i has a statistics query
+    int statsOpenPair = -1;             // Pair whose statistics query is active
+};
+
+// One scope instance on the CPU profiler's timeline (tracing)
+struct GPUProfileEvent {
+    unsigned int scopeID = 0;
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+};
+
+struct VulkanGPUProfiler {
+    bool supported = false;
+    bool enabled = true;                // false = record nothing (no overhead)
+    float timestampPeriod = 1.0f;       // Nanoseconds per tick
+    uint64_t timestampMask = ~0ull;     // Valid bits of a timestamp
+
+    unsigned int maxScopes = 0;         // Per frame
+    unsigned int historySize = 0;       // Per scope
+    vk::QueryPool queryPool;
+    vector<GPUProfilerFrame> frames;    // Per frame in flight
+
+    // Pipeline statistics (device feature pipelineStatisticsQuery; off by
+    // default, one query per scope slot)
+    bool pipelineStatsSupported = false;
+    bool pipelineStatsEnabled = false;
+    vk::QueryPool statsQueryPool;
+
+    vector<GPUProfilerScope> scopes;    // In order of first use
+    unordered_map<string, unsigned int> scopeIndices;
+
+    // Tracing (off by default; pending events are capped)
+    bool tracing = false;
+    vector<GPUProfileEvent> pendingEvents;
+    unsigned int maxPendingEvents = 0;
+    unsigned long long droppedEventCnt = 0;
+
+    // GPU -> CPU clock mapping: GPU tick calibTicks happened at calibCPUNs
+    bool calibrated = false;            // VK_EXT_calibrated_timestamps in use
+    bool calibHostDomainValid = false;  // Host domain matches steady_clock
+    VkTimeDomainEXT calibHostDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    PFN_vkGetCalibratedTimestampsEXT getCalibratedTimestamps = nullptr;
+    bool calibValid = false;
+    uint64_t calibTicks = 0;
+    uint64_t calibCPUNs = 0;
+    unsigned int readsSinceCalib = 0;
+};
+
+VulkanGPUProfiler createVulkanGPUProfiler(  VulkanInitData &vkInitData, unsigned int framesInFlight,
+                                            unsigned int maxScopes = 32, unsigned int historySize = 256);
+void cleanupVulkanGPUProfiler(VulkanInitData &vkInitData, VulkanGPUProfiler &profiler);
+
+// Adds the results of the last frame that used this slot to the history
+// (call after its fence was waited on); returns false if there were none
+bool readVulkanGPUProfiler(vk::Device &device, VulkanGPUProfiler &profiler, unsigned int frame);
+
+// First profiler command of the frame (outside any render pass): resets the
+// slot's queries
+void recordGPUProfilerFrameBegin(vk::CommandBuffer &commandBuffer, VulkanGPUProfiler &profiler, unsigned int frame);
+
+// Scopes past maxScopes in one frame are silently skipped; pipelineStats
+// also counts the scope's work (if enabled and none is active already)
+void recordGPUScopeBegin(   vk::CommandBuffer &commandBuffer, VulkanGPUProfiler &profiler, unsigned int frame,
+                            const string &name, bool pipelineStats = false);
+void recordGPUScopeEnd(vk::CommandBuffer &commandBuffer, VulkanGPUProfiler &profiler, unsigned int frame);
+
+// Moves the pending scope events into the trace (GPU queue track);
+// returns the number moved
+unsigned int collectGPUProfileTrace(VulkanGPUProfiler &profiler, ChromeTrace &trace);
+
+// Latest sample (ms) of one scope, e.g. "frame" right after a successful
+// readVulkanGPUProfiler(); 0 if the scope has none yet
+float getGPUScopeLastMs(VulkanGPUProfiler &profiler, const string &name);
+
+// One entry per scope seen so far
+vector<GPUScopeStats> getGPUScopeStats(VulkanGPUProfiler &profiler);
+void printGPUScopeStats(VulkanGPUProfiler &profiler, ostream &out = cout);
+
+// Fragments shaded per pixel of a pixelCnt target (1 = no overdraw)
+float getGPUOverdraw(const GPUPipelineStats &stats, unsigned long long pixelCnt);
+// Vertices fetched per vertex shaded (higher = better post-transform reuse)
+float getGPUVertexReuse(const GPUPipelineStats &stats);
+// Vertices shaded per triangle (ACMR; 0.5 is ideal for grids, 3 = no reuse)
+float getGPUVertexACMR(const GPUPipelineStats &stats);
+
+// Scopes with pipeline statistics; overdraw is relative to pixelCnt
+void printGPUPipelineStats(VulkanGPUProfiler &profiler, unsigned long long pixelCnt, ostream &out = cout);
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "VKSetup.hpp"
+#include "VKImage.hpp"
+#include "VKCompute.hpp"
+#include "glm/glm.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Hierarchical-Z (Hi-Z) depth pyramid
+// - Mip 0 = depth buffer; every other mip stores the FARTHEST depth of the
+//   texels it covers, so one fetch tells whether anything behind a
+//   screen rect could still be visible
+// - Built by compute (one dispatch per mip); stays in eGeneral layout
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int HIZ_GROUP_SIZE = 8;
+
+// Matches push constants in the Hi-Z build shader
+struct HiZPushConstants {
+    glm::ivec2 srcSize;
+    glm::ivec2 dstSize;
+};
+
+struct VulkanHiZ {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int mipCnt = 0;
+
+    vk::Image image;
+    vk::DeviceMemory memory;
+    vk::ImageView view;                     // All mips (for culling)
+    vector<vk::ImageView> mipViews;         // One per mip (build reads/writes)
+    vk::Sampler sampler;                    // Nearest, clamp (texelFetch only)
+
+    vk::DescriptorSetLayout setLayout;
+    vk::DescriptorPool descriptorPool;
+    vector<vk::DescriptorSet> mipSets;      // Set k: mip k-1 (or depth) -> mip k
+    VulkanComputePipelineData buildPipeline;
+
+    bool valid = false;                     // Has been built at least once
+};
+
+// depthImage must have been created with eSampled usage
+VulkanHiZ createVulkanHiZ(  VulkanInitData &vkInitData, VulkanImage &depthImage,
+                            unsigned int width, unsigned int height,
+                            string buildCompSPVFilename);
+void cleanupVulkanHiZ(VulkanInitData &vkInitData, VulkanHiZ &hiz);
+
+// Call OUTSIDE a render pass; depth must be in eDepthStencilAttachmentOptimal
+// (it is returned to that layout afterwards)
+void recordBuildHiZ(vk::CommandBuffer &commandBuffer, VulkanHiZ &hiz, VulkanImage &depthImage);
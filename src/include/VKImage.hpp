@@ -12,22 +12,28 @@ struct VulkanImage {
 
 VulkanImage createVulkanImage( VulkanInitData &vkInitData, int width, int height, 
                                 vk::Format format, vk::ImageUsageFlags usage,
-                                vk::ImageAspectFlags aspectFlags);
+                                vk::ImageAspectFlags aspectFlags,
+                                VulkanCallSite site = VULKAN_CALL_SITE);
 VulkanImage createVulkanImage(  
     vk::Device &device, 
     vk::PhysicalDevice &phyDevice,
     int width, int height, 
     vk::Format format, vk::ImageUsageFlags usage,
-    vk::ImageAspectFlags aspectFlags);
+    vk::ImageAspectFlags aspectFlags,
+    VulkanCallSite site = VULKAN_CALL_SITE);
 
 VulkanImage createVulkanDepthImage(
     VulkanInitData &vkInitData, 
-    int width, int height);
+    int width, int height,
+    vk::ImageUsageFlags extraUsage = {},
+    VulkanCallSite site = VULKAN_CALL_SITE);
 
 VulkanImage createVulkanDepthImage(
     vk::Device &device, 
     vk::PhysicalDevice &phyDevice,
-    int width, int height);
+    int width, int height,
+    vk::ImageUsageFlags extraUsage = {},
+    VulkanCallSite site = VULKAN_CALL_SITE);
 
 void transitionVulkanImageLayout(   VulkanInitData &vkInitData, 
                                     vk::CommandPool &commandPool,
@@ -35,6 +41,26 @@ void transitionVulkanImageLayout(   VulkanInitData &vkInitData,
                                     vk::ImageLayout oldLayout,
                                     vk::ImageLayout newLayout);
 
+// Copies tightly packed texels into (mip 0, layer 0 of) an image in eTransferDstOptimal
+void copyBufferToVulkanImage(   VulkanInitData &vkInitData, 
+                                vk::CommandPool &commandPool,
+                                VulkanBuffer &buffer, 
+                                VulkanImage &vkImage,
+                                unsigned int width, unsigned int height);
+
+// Sampled RGBA8 (sRGB) texture, left in eShaderReadOnlyOptimal
+VulkanImage createVulkanTexture(VulkanInitData &vkInitData, 
+                                vk::CommandPool &commandPool,
+                                unsigned int width, unsigned int height,
+                                const unsigned char *rgbaData,
+                                VulkanCallSite site = VULKAN_CALL_SITE);
+
+// Same, from an image file (anything stb_image reads); throws if it can't be loaded
+VulkanImage createVulkanTextureFromFile(VulkanInitData &vkInitData, 
+                                        vk::CommandPool &commandPool,
+                                        string filename,
+                                        VulkanCallSite site = VULKAN_CALL_SITE);
+
 void cleanupVulkanImage(VulkanInitData &vkInitData, VulkanImage &vkImage);
 void cleanupVulkanImage(vk::Device &device, VulkanImage &vkImage);
 
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "VKSetup.hpp"
+#include "VKBuffer.hpp"
+#include "VKMesh.hpp"
+#include "glm/glm.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Per-instance data
+// - Bound as a vertex buffer (eInstance input rate) OR as an SSBO
+//   (indexed by gl_InstanceIndex in the shader)
+///////////////////////////////////////////////////////////////////////////////
+
+struct InstanceData {
+    alignas(16) glm::mat4 modelMat;
+    alignas(16) glm::mat4 normMat;
+    alignas(16) glm::vec4 color = glm::vec4(1.0f);
+    alignas(16) glm::uvec4 indices = glm::uvec4(0);    // x = material (bindless table), rest unused
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Host-visible instance buffers (one per frame in flight)
+///////////////////////////////////////////////////////////////////////////////
+
+struct VulkanInstanceBuffer {
+    vector<VulkanBuffer> bufferData;
+    vector<void*> mapped;
+    vector<unsigned int> capacity;  // Max instance count per buffer
+};
+
+VulkanInstanceBuffer createVulkanInstanceBuffer(vk::Device &device,
+                                                vk::PhysicalDevice &physicalDevice,
+                                                unsigned int capacity,
+                                                int maxFramesInFlight=2);
+void ensureVulkanInstanceBufferCapacity(vk::Device &device,
+                                        vk::PhysicalDevice &physicalDevice,
+                                        VulkanInstanceBuffer &data,
+                                        unsigned int frameIndex,
+                                        unsigned int instanceCnt);
+void cleanupVulkanInstanceBuffer(vk::Device &device, VulkanInstanceBuffer &data);
+
+// Adds the eInstance binding and attributes for InstanceData
+// (mat4 takes 4 locations, so this uses firstLocation to firstLocation + 9)
+void addInstanceAttributeDesc(  AttributeDescData &attribDescData,
+                                unsigned int binding,
+                                unsigned int firstLocation);
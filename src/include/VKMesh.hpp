@@ -13,6 +13,7 @@
 struct AttributeDescData {
     vk::VertexInputBindingDescription bindDesc;
     vector<vk::VertexInputAttributeDescription> attribDesc;
+    vector<vk::VertexInputBindingDescription> instanceBindDesc; // Optional per-instance bindings
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,12 +24,14 @@ struct VulkanMesh {
     VulkanBuffer vertices;
     VulkanBuffer indices;
     int indexCnt = 0;
+    unsigned int firstIndex = 0;        // Drawn range starts here (e.g., one LOD)
 };
 
 template<typename T>
 VulkanMesh createVulkanMesh(VulkanInitData &vkInitData, 
                             vk::CommandPool &commandPool, 
-                            Mesh<T> &hostMesh) {
+                            Mesh<T> &hostMesh,
+                            VulkanCallSite site = VULKAN_CALL_SITE) {
     // Set up Vulkan mesh                            
     VulkanMesh mesh;
 
@@ -37,7 +40,7 @@ VulkanMesh createVulkanMesh(VulkanInitData &vkInitData,
     mesh.vertices = createVulkanBuffer(
         vkInitData.physicalDevice, vkInitData.device, vertBufferSize,
         vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst, 
-        vk::MemoryPropertyFlagBits::eDeviceLocal);
+        vk::MemoryPropertyFlagBits::eDeviceLocal, site);
 
     // Copy to buffer via staging buffer
     copyDataToVulkanBufferViaStaging(vkInitData.physicalDevice, vkInitData.device,
@@ -49,7 +52,7 @@ VulkanMesh createVulkanMesh(VulkanInitData &vkInitData,
     mesh.indices = createVulkanBuffer(
         vkInitData.physicalDevice, vkInitData.device, indexBufferSize,
         vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, 
-        vk::MemoryPropertyFlagBits::eDeviceLocal);
+        vk::MemoryPropertyFlagBits::eDeviceLocal, site);
 
     // Copy to buffer via staging buffer    
     copyDataToVulkanBufferViaStaging(vkInitData.physicalDevice, vkInitData.device,
@@ -63,6 +66,21 @@ VulkanMesh createVulkanMesh(VulkanInitData &vkInitData,
     return mesh;
 }
 
+// Binds vertex (binding 0) and index buffers only
+void recordBindVulkanMesh(vk::CommandBuffer &commandBuffer, VulkanMesh &mesh);
 void recordDrawVulkanMesh(vk::CommandBuffer &commandBuffer, VulkanMesh &mesh);
+void recordDrawVulkanMeshInstanced( vk::CommandBuffer &commandBuffer, VulkanMesh &mesh,
+                                    unsigned int firstInstance, unsigned int instanceCnt);
+void recordDrawVulkanMeshInstanced( vk::CommandBuffer &commandBuffer, VulkanMesh &mesh,
+                                    vk::Buffer instanceBuffer, unsigned int instanceBinding,
+                                    unsigned int firstInstance, unsigned int instanceCnt);
+// Draw parameters (instance count, first instance) come from a GPU buffer
+// holding one vk::DrawIndexedIndirectCommand at offset
+void recordDrawVulkanMeshIndirect(  vk::CommandBuffer &commandBuffer, VulkanMesh &mesh,
+                                    vk::Buffer indirectBuffer, vk::DeviceSize offset);
+// Same buffers, different index range (e.g., one LOD of a mesh whose index
+// buffer holds several); the view does NOT own the buffers, so only clean up
+// the original mesh
+VulkanMesh getVulkanMeshRange(VulkanMesh &mesh, unsigned int firstIndex, unsigned int indexCnt);
 void cleanupVulkanMesh(VulkanInitData &vkInitData, VulkanMesh &mesh);
 
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "VKSetup.hpp"
+#include "VKUtility.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Multiview render targets
+// - Color and depth are 2D ARRAY images with one layer per view; a
+//   multiview render pass (VulkanRenderPassOptions::viewCnt) draws every
+//   command once per view, into layer gl_ViewIndex
+// - Framebuffer has ONE layer (multiview framebuffers always do)
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int MAX_VIEWS = 4;
+
+struct VulkanLayeredImage {
+    vk::Image image;
+    vk::DeviceMemory memory;
+    vk::ImageView view;         // 2D array, all layers
+    vk::Format format;
+};
+
+struct VulkanMultiviewTarget {
+    unsigned int viewCnt = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    VulkanLayeredImage color;   // eColorAttachment | eTransferSrc
+    VulkanLayeredImage depth;   // eDepthStencilAttachment
+    vk::Framebuffer framebuffer;
+};
+
+VulkanLayeredImage createVulkanLayeredImage(VulkanInitData &vkInitData,
+                                            unsigned int width, unsigned int height, unsigned int layerCnt,
+                                            vk::Format format, vk::ImageUsageFlags usage,
+                                            vk::ImageAspectFlags aspectFlags);
+void cleanupVulkanLayeredImage(VulkanInitData &vkInitData, VulkanLayeredImage &image);
+
+// renderPass must be a multiview pass with viewCnt views (color + depth)
+VulkanMultiviewTarget createVulkanMultiviewTarget(  VulkanInitData &vkInitData, vk::RenderPass &renderPass,
+                                                    unsigned int width, unsigned int height,
+                                                    unsigned int viewCnt,
+                                                    vk::Format colorFormat, vk::Format depthFormat);
+void cleanupVulkanMultiviewTarget(VulkanInitData &vkInitData, VulkanMultiviewTarget &target);
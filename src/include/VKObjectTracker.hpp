@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#define VULKAN_HPP_NO_NODISCARD_WARNINGS
+#include <vulkan/vulkan.hpp>
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Live Vulkan object tracker
+// - The lib's create/cleanup functions report buffers, images, image views,
+//   pipelines and descriptor pools here, with the device memory they own
+//   and the call site that asked for them
+// - The call site is file:line of the CALLER of the lib function (default
+//   argument VULKAN_CALL_SITE), so e.g. a staging buffer that is never
+//   cleaned up points at the code that made it
+// - Take a snapshot at a known point and diff it with a later one: in a
+//   steady state the diff is empty; what is left after final cleanup leaked
+// - Thread-safe (one mutex; creation is rare compared to frames)
+///////////////////////////////////////////////////////////////////////////////
+
+enum VulkanObjectType {
+    VULKAN_OBJECT_BUFFER = 0,
+    VULKAN_OBJECT_IMAGE,
+    VULKAN_OBJECT_IMAGE_VIEW,
+    VULKAN_OBJECT_PIPELINE,
+    VULKAN_OBJECT_DESCRIPTOR_POOL,
+    VULKAN_OBJECT_TYPE_CNT
+};
+
+const char * const VULKAN_OBJECT_TYPE_NAMES[VULKAN_OBJECT_TYPE_CNT] = {
+    "buffers", "images", "image views", "pipelines", "descriptor pools"
+};
+
+struct VulkanCallSite {
+    const char *file = "?";
+    int line = 0;
+};
+
+// As a default argument, expands at (and so records) the caller
+#define VULKAN_CALL_SITE VulkanCallSite{__builtin_FILE(), __builtin_LINE()}
+
+// Live objects of one type from one call site
+struct VulkanSiteUsage {
+    string site;                        // file:line
+    VulkanObjectType type = VULKAN_OBJECT_BUFFER;
+    long long count = 0;
+    long long bytes = 0;
+};
+
+// Signed so diffs can go down
+struct VulkanObjectSnapshot {
+    long long count[VULKAN_OBJECT_TYPE_CNT] = {};
+    long long bytes[VULKAN_OBJECT_TYPE_CNT] = {};
+    vector<VulkanSiteUsage> sites;      // Sorted by bytes, then count
+};
+
+// Raw handle value (non-dispatchable handles are pointers or uint64_t)
+template<typename T>
+uint64_t getVulkanHandleID(T handle) {
+    return (uint64_t)(static_cast<typename T::CType>(handle));
+}
+
+void trackVulkanObject(VulkanObjectType type, uint64_t handle, uint64_t bytes, VulkanCallSite site);
+void untrackVulkanObject(VulkanObjectType type, uint64_t handle);
+
+template<typename T>
+void trackVulkanObject(VulkanObjectType type, T handle, uint64_t bytes, VulkanCallSite site) {
+    trackVulkanObject(type, getVulkanHandleID(handle), bytes, site);
+}
+
+template<typename T>
+void untrackVulkanObject(VulkanObjectType type, T handle) {
+    untrackVulkanObject(type, getVulkanHandleID(handle));
+}
+
+VulkanObjectSnapshot getVulkanObjectSnapshot();
+
+// after - before (sites without changes are dropped)
+VulkanObjectSnapshot diffVulkanObjectSnapshots(const VulkanObjectSnapshot &before,
+                                               const VulkanObjectSnapshot &after);
+bool isVulkanObjectSnapshotEmpty(const VulkanObjectSnapshot &snapshot);
+
+// Per type, then per call site (at most maxSites lines)
+void printVulkanObjectSnapshot( const VulkanObjectSnapshot &snapshot, ostream &out = cout,
+                                unsigned int maxSites = 10);
+
+// Tracked descriptor pools (for code that creates its own)
+vk::DescriptorPool createVulkanDescriptorPool(  vk::Device &device, const vk::DescriptorPoolCreateInfo &createInfo,
+                                                VulkanCallSite site = VULKAN_CALL_SITE);
+void cleanupVulkanDescriptorPool(vk::Device &device, vk::DescriptorPool &pool);
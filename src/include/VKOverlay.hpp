@@ -0,0 +1,146 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "VKSetup.hpp"
+#include "VKBuffer.hpp"
+#include "VKImage.hpp"
+#include "VKGPUProfiler.hpp"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// On-screen overlay (text, rectangles, graphs)
+// - Drawn in its own pass on top of the finished swapchain image (loads
+//   it, no depth), after everything else in the frame
+// - Everything is alpha-blended quads in pixel coordinates (origin top
+//   left): glyphs come from a built-in 5x8 bitmap font (ASCII 32-126) and
+//   rectangles from a solid texel of the same texture, so ONE pipeline,
+//   ONE descriptor set and ONE draw call cover the whole overlay
+// - Quads are built on the CPU into a plain vector and copied with one
+//   memcpy into this frame slot's region of a persistently mapped,
+//   host-visible vertex buffer (the slot's fence has been waited on, so
+//   the GPU is done with it); quads past maxQuads are dropped
+// - The performance panel keeps its own frame time history (cheap, every
+//   frame) and only rebuilds its text (profiler percentiles, memory) a few
+//   times per second, so it barely shows up in what it measures
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int OVERLAY_GLYPH_WIDTH = 5;         // Font texels
+const unsigned int OVERLAY_GLYPH_HEIGHT = 8;        // Including one descender row
+const unsigned int OVERLAY_CHAR_ADVANCE = 6;        // Font texels per character
+const unsigned int OVERLAY_LINE_ADVANCE = 10;       // Font texels per line
+const unsigned int OVERLAY_GRAPH_SAMPLES = 240;     // Frames shown in each graph
+
+// 16 bytes
+struct OverlayVertex {
+    glm::vec2 pos;          // Pixels
+    glm::u16vec2 uv;        // Normalized (unorm16)
+    glm::u8vec4 color;      // RGBA (unorm8)
+};
+
+// Matches push constants in the overlay shaders
+struct OverlayPushConstants {
+    glm::vec2 scale;        // 2 / framebuffer size (pixels -> NDC)
+};
+
+// What the app knows about the last frame; the rest comes from the profilers
+struct OverlayFrameInfo {
+    float cpuFrameTime = 0.0f;              // Seconds
+    float gpuFrameTime = 0.0f;              // Seconds (0 = unknown)
+    unsigned long long drawCnt = 0;
+    unsigned long long triangleCnt = 0;
+    vector<string> extraLines;              // App-specific (modes, resolution, ...)
+};
+
+struct VulkanOverlay {
+    bool visible = false;
+    float pixelScale = 0.0f;                // Screen pixels per font texel (0 = by height)
+
+    // Font atlas (white, glyph coverage in alpha) + nearest sampler
+    VulkanImage font;
+    unsigned int fontWidth = 0;
+    unsigned int fontHeight = 0;
+    vk::Sampler sampler;
+
+    vk::DescriptorSetLayout setLayout;
+    vk::DescriptorPool descriptorPool;
+    vk::DescriptorSet descriptorSet;
+    vk::PipelineLayout pipelineLayout;
+    vk::Pipeline pipeline;
+
+    // Color only, loads and keeps the presentable image
+    vk::RenderPass renderPass;
+    vector<vk::Framebuffer> framebuffers;   // Per swapchain image
+    vk::Extent2D extent;
+
+    // One region of maxQuads * 6 vertices per frame in flight
+    unsigned int maxQuads = 0;
+    unsigned int framesInFlight = 0;
+    VulkanBuffer vertexBuffer;
+    OverlayVertex *mapped = nullptr;
+    vector<OverlayVertex> vertices;         // This frame's quads (CPU side)
+    unsigned long long droppedQuadCnt = 0;
+
+    // Performance panel: frame time history (ms, ring)
+    vector<float> cpuHistory;
+    vector<float> gpuHistory;
+    unsigned int historyNext = 0;
+    unsigned int historyCnt = 0;
+
+    // Performance panel: text, rebuilt every refreshInterval seconds
+    vector<string> lines;
+    float refreshInterval = 0.25f;
+    float sinceRefresh = 0.0f;
+    bool refreshNeeded = true;
+};
+
+// Shader filenames are the compiled overlay.vert/overlay.frag
+VulkanOverlay createVulkanOverlay(  VulkanInitData &vkInitData, vk::CommandPool &commandPool,
+                                    unsigned int framesInFlight,
+                                    string vertSPVFilename, string fragSPVFilename,
+                                    unsigned int maxQuads = 4096);
+void cleanupVulkanOverlay(VulkanInitData &vkInitData, VulkanOverlay &overlay);
+
+// After the swapchain was recreated (device idle)
+void recreateVulkanOverlayFramebuffers(VulkanInitData &vkInitData, VulkanOverlay &overlay);
+
+// Colors
+inline glm::u8vec4 makeOverlayColor(unsigned int r, unsigned int g, unsigned int b, unsigned int a = 255) {
+    return glm::u8vec4(r, g, b, a);
+}
+
+// Building (pixel coordinates); cleared by recordVulkanOverlay()
+void addOverlayRect(VulkanOverlay &overlay, float x, float y, float w, float h, glm::u8vec4 color);
+// Returns the width in pixels; '\n' starts a new line, non-ASCII shows as '?'
+float addOverlayText(VulkanOverlay &overlay, float x, float y, const string &text, glm::u8vec4 color);
+// values is a ring (oldest at first); bars scaled so maxValue fills h, and
+// colored by the good/bad thresholds
+void addOverlayGraph(   VulkanOverlay &overlay, float x, float y, float w, float h,
+                        const vector<float> &values, unsigned int first, unsigned int cnt,
+                        float maxValue, float goodValue, float badValue);
+
+// Screen pixels per font texel, and per line of text
+float getOverlayScale(VulkanOverlay &overlay);
+float getOverlayLineHeight(VulkanOverlay &overlay);
+
+// Once per frame: records the frame in the history and, every
+// refreshInterval seconds while visible, rebuilds the panel text from the
+// CPU profiler (collectCPUProfile() first), the GPU profiler (may be null),
+// the object tracker and the process memory
+void updateVulkanOverlayStats(  VulkanOverlay &overlay, const OverlayFrameInfo &info,
+                                VulkanGPUProfiler *gpuProfiler = nullptr);
+
+// True if the next updateVulkanOverlayStats() (with this frame time)
+// rebuilds the text, i.e. when OverlayFrameInfo::extraLines are worth
+// building
+bool isVulkanOverlayRefreshDue(VulkanOverlay &overlay, float cpuFrameTime);
+
+// Panel with graphs and the current text at (x, y)
+void addOverlayPerformancePanel(VulkanOverlay &overlay, float x, float y);
+
+// Outside a render pass, after the last pass: draws what was added this
+// frame onto swapchain image imageIndex (in ePresentSrcKHR, and left in
+// it), then clears the quads. Does nothing if hidden or empty
+void recordVulkanOverlay(   vk::CommandBuffer &commandBuffer, VulkanOverlay &overlay,
+                            unsigned int frameSlot, unsigned int imageIndex);
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include "VKSetup.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Push descriptors (VK_KHR_push_descriptor)
+// - Descriptors for ONE set are written straight into the command buffer:
+//   no pool, no allocation, no vkUpdateDescriptorSets, nothing to track
+// - The set's layout must be created with ePushDescriptorKHR (see
+//   getPushDescriptorLayoutFlags()); pipelines using it are NOT compatible
+//   with pipelines built against a pooled layout for that set
+// - Optional device extension: check supported before using
+///////////////////////////////////////////////////////////////////////////////
+
+struct VulkanPushDescriptors {
+    bool supported = false;
+    unsigned int maxPushDescriptors = 0;    // Per pushed set
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
+};
+
+// One binding of a pushed set (buffer OR image, depending on type)
+struct VulkanPushDescriptorWrite {
+    unsigned int binding = 0;
+    vk::DescriptorType type = vk::DescriptorType::eUniformBuffer;
+    vk::DescriptorBufferInfo bufferInfo;
+    vk::DescriptorImageInfo imageInfo;
+};
+
+VulkanPushDescriptors createVulkanPushDescriptors(VulkanInitData &vkInitData);
+
+// ePushDescriptorKHR if supported (otherwise a regular, pooled layout)
+vk::DescriptorSetLayoutCreateFlags getPushDescriptorLayoutFlags(VulkanPushDescriptors &push);
+
+VulkanPushDescriptorWrite makePushBufferWrite(  unsigned int binding, vk::DescriptorType type,
+                                                vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range);
+VulkanPushDescriptorWrite makePushImageWrite(   unsigned int binding, vk::DescriptorType type,
+                                                vk::Sampler sampler, vk::ImageView view, vk::ImageLayout layout);
+
+// Replaces the contents of set "set" (of a push layout) for later draws
+void recordPushDescriptorSet(   vk::CommandBuffer &commandBuffer, VulkanPushDescriptors &push,
+                                vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout,
+                                unsigned int set, const vector<VulkanPushDescriptorWrite> &writes);
@@ -12,6 +12,26 @@ struct VulkanInitRenderParams {
     string fragSPVFilename;
 };
 
+struct VulkanPipelineOptions {
+    bool depthTest = true;
+    vk::CompareOp depthCompare = vk::CompareOp::eLess;
+    bool depthWrite = true;
+    bool colorWrite = true;     // false for depth-only passes
+    bool vertexInput = true;    // false for full-screen passes (vertices generated in shader)
+    unsigned int subpass = 0;
+    unsigned int colorAttachmentCnt = 1;
+};
+
+// Render passes that only differ in these are compatible (same framebuffers/pipelines),
+// EXCEPT viewCnt: multiview and single-view passes are never compatible
+struct VulkanRenderPassOptions {
+    bool loadContents = false;  // Load color/depth instead of clearing (continue earlier pass)
+    bool storeDepth = false;    // Keep depth after the pass (e.g., to sample it later)
+    bool present = true;        // false leaves color in eColorAttachmentOptimal
+    unsigned int viewCnt = 1;   // > 1 = multiview: every draw goes to layers 0..viewCnt-1
+                                // (gl_ViewIndex); attachments must be layered
+};
+
 struct VulkanPipelineData {
     vk::PipelineCache cache;
     vk::PipelineLayout pipelineLayout; // Necessary for passing in uniform variables
@@ -41,8 +61,10 @@ class VulkanRenderEngine {
 
         vk::RenderPass renderPass;
         VulkanPipelineData pipelineData;
+        VulkanPipelineOptions pipelineOptions;     // Used for the main pipeline
 
         VulkanImage depthImage;
+        vk::ImageUsageFlags depthImageUsage = {};  // Extra usage flags (e.g., eInputAttachment)
         vector<vk::Framebuffer> framebuffers;
         atomic<bool> frameBufferResized = false;
 
@@ -85,6 +107,7 @@ class VulkanRenderEngine {
         ///////////////////////////////////////////////////////////////////////////////
 
         virtual vk::RenderPass createVulkanRenderPass(VulkanImage &depthImage);
+        vk::RenderPass createVulkanRenderPass(VulkanImage &depthImage, VulkanRenderPassOptions options);
         virtual void cleanupVulkanRenderPass(vk::RenderPass &pass);
 
         ///////////////////////////////////////////////////////////////////////////////
@@ -99,9 +122,11 @@ class VulkanRenderEngine {
         // Vulkan pipeline
         ///////////////////////////////////////////////////////////////////////////////
 
+        // An empty fragSPVFilename creates a vertex-only (depth-only) pipeline
         virtual VulkanPipelineData createVulkanPipelineData(vk::RenderPass &renderPass, 
                                                         string vertSPVFilename, 
-                                                        string fragSPVFilename);
+                                                        string fragSPVFilename,
+                                                        VulkanPipelineOptions options = VulkanPipelineOptions());
         virtual void cleanupVulkanPipelineData(VulkanPipelineData &pipelineData); 
 
         ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "VKSetup.hpp"
+#include "VKMesh.hpp"
+#include "VKInstance.hpp"
+#include "Meshlets.hpp"
+#include "VKPushDescriptor.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Draw packets and sort keys
+// - Key layout (most to least significant):
+//   [63-56] pipeline | [55-40] material | [39-24] mesh | [23-0] depth
+// - Sorting by key minimizes state changes and orders each group
+//   front-to-back (better early-Z rejection)
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int SORT_KEY_DEPTH_BITS = 24;
+
+// IDs past these do not fit their key fields (the add* functions throw)
+const unsigned int SORT_KEY_MAX_PIPELINES = 1u << 8;
+const unsigned int SORT_KEY_MAX_MATERIALS = 1u << 16;
+const unsigned int SORT_KEY_MAX_MESHES = 1u << 16;
+
+struct DrawPacket {
+    uint64_t key;
+    unsigned int instance;  // Index into queued instance data
+};
+
+uint64_t makeDrawSortKey(   unsigned int pipelineID, unsigned int materialID,
+                            unsigned int meshID, float normDepth);
+unsigned int getSortKeyPipeline(uint64_t key);
+unsigned int getSortKeyMaterial(uint64_t key);
+unsigned int getSortKeyMesh(uint64_t key);
+
+// LSD radix sort on the 64-bit key (8 bits per pass; passes where every
+// key has the same byte are skipped)
+void radixSortDrawPackets(vector<DrawPacket> &packets, vector<DrawPacket> &scratch);
+
+///////////////////////////////////////////////////////////////////////////////
+// Render queue
+///////////////////////////////////////////////////////////////////////////////
+
+struct VulkanQueueMaterial {
+    vk::PipelineLayout pipelineLayout;
+    unsigned int firstSet = 0;
+    vector<vk::DescriptorSet> descriptorSets;   // One per frame in flight (empty = no bind)
+
+    // Push descriptor path (instead of descriptorSets): set firstSet of
+    // pipelineLayout (a push layout) gets these writes on every material change
+    VulkanPushDescriptors *pushDescriptors = nullptr;
+    vector<vector<VulkanPushDescriptorWrite>> pushWrites;   // One list per frame in flight
+};
+
+// Per-instance culling input (see writeCullingData())
+struct CullInstanceInfo {
+    unsigned int run;       // Draw run (= indirect command) the instance belongs to
+    unsigned int object;    // Index in add() order (stable visibility slot)
+};
+
+class VulkanRenderQueue {
+    protected:
+        struct DrawRun {
+            uint64_t stateKey;
+            unsigned int firstInstance;
+            unsigned int instanceCnt;
+        };
+
+        vector<vk::Pipeline> pipelines;
+        vector<VulkanQueueMaterial> materials;
+        vector<VulkanMesh*> meshes;
+        vector<glm::vec4> meshBounds;
+        vector<const vector<Meshlet>*> meshMeshlets;    // nullptr = no clusters
+
+        vector<DrawPacket> packets;
+        vector<DrawPacket> scratch;
+        vector<InstanceData> instances;
+        vector<DrawRun> runs;
+
+        float nearDepth = 0.01f;
+        float farDepth = 100.0f;
+
+        unsigned int drawCnt = 0;
+        unsigned int pipelineBindCnt = 0;
+        unsigned int materialBindCnt = 0;
+
+        // Cluster draws (see buildClusterDraws())
+        vector<vk::DrawIndexedIndirectCommand> clusterCommands;
+        vector<glm::uvec2> clusterRunCommands;          // Per run: first command, command count
+        vector<MeshletDrawRange> clusterRanges;
+        MeshletCullStats clusterStats;
+
+        // Binds pipeline/material for a run if they changed; returns mesh ID
+        unsigned int bindRunState(  vk::CommandBuffer &commandBuffer, const DrawRun &run,
+                                    unsigned int frameIndex, int pipelineOverrideID,
+                                    unsigned int &currentPipeline, unsigned int &currentMaterial);
+
+    public:
+        unsigned int addPipeline(vk::Pipeline pipeline);
+        unsigned int addMaterial(const VulkanQueueMaterial &material);
+        // boundingSphere = object-space center (xyz) + radius (w); negative radius = never culled
+        unsigned int addMesh(VulkanMesh *mesh, glm::vec4 boundingSphere = glm::vec4(0,0,0,-1));
+        void setDepthRange(float nearDepth, float farDepth);
+
+        // Meshlets must index the mesh's (reordered) index buffer; caller keeps them alive
+        void setMeshMeshlets(unsigned int meshID, const vector<Meshlet> *meshlets);
+
+        // Per-frame usage: begin() -> add() ... -> upload() -> record()
+        void begin();
+        void add(   unsigned int pipelineID, unsigned int materialID, unsigned int meshID,
+                    float viewDepth, const InstanceData &instance);
+
+        // Sorts packets, then writes instances in sorted order
+        void upload(vk::Device &device, vk::PhysicalDevice &physicalDevice,
+                    VulkanInstanceBuffer &buffer, unsigned int frameIndex);
+
+        // Records one instanced draw per run of identical state
+        // (pipelineOverrideID >= 0 draws every run with that pipeline instead,
+        //  e.g., to replay the same sorted draws for a depth pre-pass)
+        void record(vk::CommandBuffer &commandBuffer,
+                    VulkanInstanceBuffer &buffer, unsigned int frameIndex,
+                    unsigned int instanceBinding,
+                    int pipelineOverrideID = -1);
+
+        ///////////////////////////////////////////////////////////////////////
+        // GPU-driven path (after upload()):
+        // - writeCullingData(): per sorted instance (run, object) + per run
+        //   mesh bounding sphere
+        // - writeIndirectCommands(): one command per run with instanceCount = 0
+        //   (culling shader appends survivors) and firstInstance = run start
+        //   + instanceOffset
+        // - recordIndirect(): same state changes as record(), but each run
+        //   draws from indirectBuffer
+        ///////////////////////////////////////////////////////////////////////
+        unsigned int getRunCount();
+        void writeCullingData(CullInstanceInfo *info, glm::vec4 *runBounds);
+        void writeIndirectCommands(vk::DrawIndexedIndirectCommand *commands, unsigned int instanceOffset);
+        void recordIndirect(vk::CommandBuffer &commandBuffer,
+                            vk::Buffer instanceBuffer, unsigned int frameIndex,
+                            unsigned int instanceBinding,
+                            vk::Buffer indirectBuffer, vk::DeviceSize indirectOffset,
+                            int pipelineOverrideID = -1);
+
+        ///////////////////////////////////////////////////////////////////////
+        // Cluster (meshlet) path (after upload()):
+        // - buildClusterDraws(): CPU-culls the meshlets of every instance of
+        //   a clustered mesh; each surviving index range becomes one indirect
+        //   command (instanceCount 1). Other meshes, and runs where nothing
+        //   was culled, keep one instanced command per run.
+        // - Caller copies getClusterCommands() into an indirect buffer
+        // - recordClusters(): same state changes as record(); one
+        //   multi-draw call per run, or direct draws if maxDrawIndirectCnt
+        //   is 1 (no multiDrawIndirect, see getVulkanMaxDrawIndirectCount())
+        ///////////////////////////////////////////////////////////////////////
+        void buildClusterDraws(const glm::vec4 worldPlanes[6], glm::vec3 cameraPos, bool coneCulling);
+        const vector<vk::DrawIndexedIndirectCommand> &getClusterCommands();
+        MeshletCullStats getClusterStats();
+        void recordClusters(vk::CommandBuffer &commandBuffer,
+                            VulkanInstanceBuffer &buffer, unsigned int frameIndex,
+                            unsigned int instanceBinding,
+                            vk::Buffer indirectBuffer,
+                            unsigned int maxDrawIndirectCnt,
+                            int pipelineOverrideID = -1);
+
+        unsigned int getPacketCount();
+        unsigned int getDrawCount();
+        unsigned int getPipelineBindCount();
+        unsigned int getMaterialBindCount();
+};
@@ -9,10 +9,16 @@ using namespace std;
 
 struct VulkanSwapChain {
     vk::SwapchainKHR chain;
-    //vector<vk::Image> images;
+    vector<vk::Image> images;       // Owned by the swapchain (blit targets)
     vector<vk::ImageView> views;
     vk::Extent2D extent;
     vk::Format format;
+    vk::ImageUsageFlags usage;      // eTransferSrc if images can be read back
+
+    // Headless only: offscreen images stand in for the chain (null) and
+    // are owned here, one allocation each
+    vector<vk::DeviceMemory> memory;
+    unsigned int headlessImageCnt = 0;
 };
 
 struct VulkanQueue {
@@ -23,10 +29,11 @@ struct VulkanQueue {
 struct VulkanInitData {
     vkb::Instance bootInstance; // Cleaned up explicitly
     vkb::Device bootDevice;     // Do NOT clean up explicitly
-    GLFWwindow *window;         // Do NOT clean up explicitly
+    GLFWwindow *window;         // Do NOT clean up explicitly (null if headless)
+    bool headless = false;      // No window/surface: see initVulkanBootstrapHeadless()
 
     vk::Instance instance;      // Do NOT clean up explicitly 
-    vk::SurfaceKHR surface;
+    vk::SurfaceKHR surface;     // Null if headless
     vk::PhysicalDevice physicalDevice;
     vk::Device device;    
     VulkanQueue graphicsQueue;
@@ -36,7 +43,21 @@ struct VulkanInitData {
 
 GLFWwindow* createGLFWWindow(string windowName, int windowWidth, int windowHeight, bool isWindowResizable = true);
 void cleanupGLFWWindow(GLFWwindow *window);
+// Takes "--headless N" out of argv (positional arguments keep their index)
+// and returns N: frames to render offscreen before exiting (0 = windowed)
+int getHeadlessFrameCount(int &argc, char **argv);
 bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkInitData);
+
+// No display needed (software ICDs such as lavapipe work): no surface, and
+// the swapchain is imageCnt offscreen images (width x height, same format,
+// also transfer src/sampled for readback). VulkanRenderEngine renders into
+// them by frame-in-flight slot and skips acquire/present, so engines run
+// unchanged.
+bool initVulkanBootstrapHeadless(   string appName, unsigned int width, unsigned int height,
+                                    VulkanInitData &vkInitData, unsigned int imageCnt = 2);
 bool createVulkanSwapchain(VulkanInitData &vkInitData);
 void cleanupVulkanSwapchain(VulkanInitData &vkInitData);
 void cleanupVulkanBootstrap(VulkanInitData &vkInitData);
+bool isVulkanDeviceExtensionEnabled(VulkanInitData &vkInitData, string extensionName);
+// Draws per vkCmdDrawIndexedIndirect call (1 without multiDrawIndirect)
+unsigned int getVulkanMaxDrawIndirectCount(VulkanInitData &vkInitData);
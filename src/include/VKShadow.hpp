@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "VKSetup.hpp"
+#include "VKImage.hpp"
+#include "glm/glm.hpp"
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// Point light shadow cube maps with static-caster caching
+// - cacheImage: static casters ONLY; re-rendered only when the light or
+//   static geometry changes (cacheDirty)
+// - image: sampled by shading; every frame = copy of cache + dynamic casters
+//   drawn on top (load, not clear)
+// - Stored depth is LINEAR distance to light / farPlane (written by the
+//   shadow fragment shader), so comparisons are the same for every face
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned int SHADOW_CUBE_FACES = 6;
+
+// Matches push constants in shadow shaders
+struct ShadowPushConstants {
+    alignas(16) glm::mat4 faceViewProj;
+    alignas(16) glm::vec4 lightPosFar;     // World position (xyz), far plane (w)
+};
+
+struct VulkanShadowCube {
+    unsigned int size = 512;
+    float nearPlane = 0.01f;
+    float farPlane = 50.0f;
+
+    VulkanImage cacheImage;                 // view = unused cube view
+    VulkanImage image;                      // view = cube view for sampling
+    vector<vk::ImageView> cacheFaceViews;
+    vector<vk::ImageView> faceViews;
+
+    vk::RenderPass cachePass;               // Clear -> static casters -> transfer source
+    vk::RenderPass dynamicPass;             // Load copied cache -> dynamic casters -> shader read
+    vector<vk::Framebuffer> cacheFramebuffers;
+    vector<vk::Framebuffer> framebuffers;
+
+    vk::Sampler sampler;                    // Comparison sampler (samplerCubeShadow)
+
+    bool cacheDirty = true;
+    unsigned int cacheRenderCnt = 0;        // How often the cache was rebuilt (stats)
+};
+
+VulkanShadowCube createVulkanShadowCube(VulkanInitData &vkInitData, unsigned int size,
+                                        float nearPlane, float farPlane);
+void cleanupVulkanShadowCube(VulkanInitData &vkInitData, VulkanShadowCube &cube);
+
+// View-projection for one face (+X, -X, +Y, -Y, +Z, -Z)
+glm::mat4 getShadowCubeFaceViewProj(const VulkanShadowCube &cube, glm::vec3 lightPos, unsigned int face);
+
+// Face pass: begins render pass and sets viewport/scissor; caller draws, then ends render pass.
+// cachePass = true renders into the static cache.
+void beginShadowCubeFace(vk::CommandBuffer &commandBuffer, VulkanShadowCube &cube,
+                         unsigned int face, bool cachePass);
+
+// Copies the static cache into the sampled image (call before dynamic face passes)
+void recordShadowCubeCacheCopy(vk::CommandBuffer &commandBuffer, VulkanShadowCube &cube);
@@ -21,5 +21,20 @@ struct UBOData {
 UBOData createVulkanUniformBufferData(vk::Device &device,
                                 vk::PhysicalDevice &physicalDevice,
                                 size_t bufferSize, 
-                                int maxFramesInFlights=2);
+                                int maxFramesInFlights=2,
+                                VulkanCallSite site = VULKAN_CALL_SITE);
+// Same as above, but host-visible SSBOs (e.g., light lists); can also be
+// cleared on the GPU with fillBuffer
+UBOData createVulkanStorageBufferData(vk::Device &device,
+                                vk::PhysicalDevice &physicalDevice,
+                                size_t bufferSize, 
+                                int maxFramesInFlights=2,
+                                VulkanCallSite site = VULKAN_CALL_SITE);
+// Host-visible SSBOs that are also valid indirect draw sources
+// (e.g., vk::DrawIndexedIndirectCommand arrays written by compute)
+UBOData createVulkanIndirectBufferData(vk::Device &device,
+                                vk::PhysicalDevice &physicalDevice,
+                                size_t bufferSize, 
+                                int maxFramesInFlights=2,
+                                VulkanCallSite site = VULKAN_CALL_SITE);
 void cleanupVulkanUniformBufferData(vk::Device &device, UBOData &uboData);
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "BatchTransform.hpp"
+#include <cmath>
+
+#if defined(__AVX__)
+#define BATCH_TRANSFORM_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCH_TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Mat4SoA
+///////////////////////////////////////////////////////////////////////////////
+
+void Mat4SoA::resize(unsigned int n) {
+    unsigned int padded = ((n + BATCH_TRANSFORM_PAD - 1) / BATCH_TRANSFORM_PAD) * BATCH_TRANSFORM_PAD;
+
+    // Padding (and new) entries are identity so they never produce NaNs
+    for(unsigned int k = 0; k < 16; k++) {
+        float value = (k % 5 == 0) ? 1.0f : 0.0f;
+        e[k].resize(padded, value);
+    }
+    count = n;
+}
+
+void Mat4SoA::set(unsigned int i, const glm::mat4 &m) {
+    for(unsigned int c = 0; c < 4; c++) {
+        for(unsigned int r = 0; r < 4; r++) {
+            e[c*4 + r][i] = m[c][r];
+        }
+    }
+}
+
+glm::mat4 Mat4SoA::get(unsigned int i) const {
+    glm::mat4 m;
+    for(unsigned int c = 0; c < 4; c++) {
+        for(unsigned int r = 0; r < 4; r++) {
+            m[c][r] = e[c*4 + r][i];
+        }
+    }
+    return m;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Lane operations (one struct per instruction set)
+///////////////////////////////////////////////////////////////////////////////
+
+struct ScalarOps {
+    typedef float V;
+    static constexpr unsigned int W = 1;
+    static V load(const float *p) { return *p; }
+    static void store(float *p, V a) { *p = a; }
+    static V set1(float a) { return a; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V abs(V a) { return fabsf(a); }
+    static bool allLE(V a, V b) { return a <= b; }
+};
+
+#if defined(BATCH_TRANSFORM_AVX)
+struct SIMDOps {
+    typedef __m256 V;
+    static constexpr unsigned int W = 8;
+    static V load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, V a) { _mm256_storeu_ps(p, a); }
+    static V set1(float a) { return _mm256_set1_ps(a); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static bool allLE(V a, V b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ)) == 0xFF; }
+};
+#elif defined(BATCH_TRANSFORM_SSE)
+struct SIMDOps {
+    typedef __m128 V;
+    static constexpr unsigned int W = 4;
+    static V load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, V a) { _mm_storeu_ps(p, a); }
+    static V set1(float a) { return _mm_set1_ps(a); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static bool allLE(V a, V b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)) == 0xF; }
+};
+#else
+typedef ScalarOps SIMDOps;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Kernel
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename Ops>
+static unsigned int batchTransformKernel(   const glm::mat4 &viewMat,
+                                            const Mat4SoA &modelMats,
+                                            Mat4SoA &modelViewMats,
+                                            Mat4SoA &normalMats,
+                                            unsigned int first, unsigned int last) {
+    typedef typename Ops::V V;
+
+    modelViewMats.resize(modelMats.count);
+    normalMats.resize(modelMats.count);
+
+    // View matrix is the same for every object, so broadcast it once
+    V view[16];
+    for(unsigned int c = 0; c < 4; c++) {
+        for(unsigned int r = 0; r < 4; r++) {
+            view[c*4 + r] = Ops::set1(viewMat[c][r]);
+        }
+    }
+
+    const V eps = Ops::set1(1e-4f);
+    const V zero = Ops::set1(0.0f);
+    const V one = Ops::set1(1.0f);
+
+    unsigned int cofactorCnt = 0;
+
+    // Start on a block boundary (storage is padded, so blocks never overrun)
+    first -= first % Ops::W;
+    last = min(last, modelMats.count);
+
+    for(unsigned int i = first; i < last; i += Ops::W) {
+        // Load model matrices
+        V m[16];
+        for(unsigned int k = 0; k < 16; k++) {
+            m[k] = Ops::load(&modelMats.e[k][i]);
+        }
+
+        // Model-view = view * model
+        V mv[16];
+        for(unsigned int c = 0; c < 4; c++) {
+            for(unsigned int r = 0; r < 4; r++) {
+                V sum = Ops::mul(view[0*4 + r], m[c*4 + 0]);
+                sum = Ops::add(sum, Ops::mul(view[1*4 + r], m[c*4 + 1]));
+                sum = Ops::add(sum, Ops::mul(view[2*4 + r], m[c*4 + 2]));
+                sum = Ops::add(sum, Ops::mul(view[3*4 + r], m[c*4 + 3]));
+                mv[c*4 + r] = sum;
+                Ops::store(&modelViewMats.e[c*4 + r][i], sum);
+            }
+        }
+
+        // Upper 3x3 columns
+        V a0[3] = { mv[0], mv[1], mv[2] };
+        V a1[3] = { mv[4], mv[5], mv[6] };
+        V a2[3] = { mv[8], mv[9], mv[10] };
+
+        // Column lengths and pairwise dot products
+        V l0 = Ops::add(Ops::add(Ops::mul(a0[0], a0[0]), Ops::mul(a0[1], a0[1])), Ops::mul(a0[2], a0[2]));
+        V l1 = Ops::add(Ops::add(Ops::mul(a1[0], a1[0]), Ops::mul(a1[1], a1[1])), Ops::mul(a1[2], a1[2]));
+        V l2 = Ops::add(Ops::add(Ops::mul(a2[0], a2[0]), Ops::mul(a2[1], a2[1])), Ops::mul(a2[2], a2[2]));
+        V d01 = Ops::add(Ops::add(Ops::mul(a0[0], a1[0]), Ops::mul(a0[1], a1[1])), Ops::mul(a0[2], a1[2]));
+        V d02 = Ops::add(Ops::add(Ops::mul(a0[0], a2[0]), Ops::mul(a0[1], a2[1])), Ops::mul(a0[2], a2[2]));
+        V d12 = Ops::add(Ops::add(Ops::mul(a1[0], a2[0]), Ops::mul(a1[1], a2[1])), Ops::mul(a1[2], a2[2]));
+
+        V tol = Ops::mul(eps, l0);
+        bool uniform = Ops::allLE(Ops::abs(Ops::sub(l0, l1)), tol)
+                        && Ops::allLE(Ops::abs(Ops::sub(l0, l2)), tol)
+                        && Ops::allLE(Ops::abs(d01), tol)
+                        && Ops::allLE(Ops::abs(d02), tol)
+                        && Ops::allLE(Ops::abs(d12), tol);
+
+        V n[9];
+        if(uniform) {
+            // Rigid or uniform scale: inverse-transpose = M / scale^2
+            V invScale2 = Ops::div(one, l0);
+            for(unsigned int k = 0; k < 3; k++) {
+                n[0 + k] = Ops::mul(a0[k], invScale2);
+                n[3 + k] = Ops::mul(a1[k], invScale2);
+                n[6 + k] = Ops::mul(a2[k], invScale2);
+            }
+        }
+        else {
+            // General case: inverse-transpose = cofactor / determinant
+            V c0[3] = { Ops::sub(Ops::mul(a1[1], a2[2]), Ops::mul(a1[2], a2[1])),
+                        Ops::sub(Ops::mul(a1[2], a2[0]), Ops::mul(a1[0], a2[2])),
+                        Ops::sub(Ops::mul(a1[0], a2[1]), Ops::mul(a1[1], a2[0])) };
+            V c1[3] = { Ops::sub(Ops::mul(a2[1], a0[2]), Ops::mul(a2[2], a0[1])),
+                        Ops::sub(Ops::mul(a2[2], a0[0]), Ops::mul(a2[0], a0[2])),
+                        Ops::sub(Ops::mul(a2[0], a0[1]), Ops::mul(a2[1], a0[0])) };
+            V c2[3] = { Ops::sub(Ops::mul(a0[1], a1[2]), Ops::mul(a0[2], a1[1])),
+                        Ops::sub(Ops::mul(a0[2], a1[0]), Ops::mul(a0[0], a1[2])),
+                        Ops::sub(Ops::mul(a0[0], a1[1]), Ops::mul(a0[1], a1[0])) };
+
+            V det = Ops::add(Ops::add(Ops::mul(a0[0], c0[0]), Ops::mul(a0[1], c0[1])), Ops::mul(a0[2], c0[2]));
+            V invDet = Ops::div(one, det);
+
+            for(unsigned int k = 0; k < 3; k++) {
+                n[0 + k] = Ops::mul(c0[k], invDet);
+                n[3 + k] = Ops::mul(c1[k], invDet);
+                n[6 + k] = Ops::mul(c2[k], invDet);
+            }
+
+            cofactorCnt += min(Ops::W, last - i);
+        }
+
+        // Store normal matrix (only upper 3x3 is used by shaders)
+        for(unsigned int c = 0; c < 3; c++) {
+            for(unsigned int r = 0; r < 3; r++) {
+                Ops::store(&normalMats.e[c*4 + r][i], n[c*3 + r]);
+            }
+            Ops::store(&normalMats.e[c*4 + 3][i], zero);
+            Ops::store(&normalMats.e[3*4 + c][i], zero);
+        }
+        Ops::store(&normalMats.e[15][i], one);
+    }
+
+    return cofactorCnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Public interface
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int computeBatchTransforms(const glm::mat4 &viewMat,
+                                    const Mat4SoA &modelMats,
+                                    Mat4SoA &modelViewMats,
+                                    Mat4SoA &normalMats) {
+    return batchTransformKernel<SIMDOps>(viewMat, modelMats, modelViewMats, normalMats, 0, modelMats.count);
+}
+
+unsigned int computeBatchTransformsRange(   const glm::mat4 &viewMat,
+                                            const Mat4SoA &modelMats,
+                                            Mat4SoA &modelViewMats,
+                                            Mat4SoA &normalMats,
+                                            unsigned int first, unsigned int last) {
+    return batchTransformKernel<SIMDOps>(viewMat, modelMats, modelViewMats, normalMats, first, last);
+}
+
+unsigned int computeBatchTransformsScalar(  const glm::mat4 &viewMat,
+                                            const Mat4SoA &modelMats,
+                                            Mat4SoA &modelViewMats,
+                                            Mat4SoA &normalMats) {
+    return batchTransformKernel<ScalarOps>(viewMat, modelMats, modelViewMats, normalMats, 0, modelMats.count);
+}
+
+const char* getBatchTransformISA() {
+#if defined(BATCH_TRANSFORM_AVX)
+    return "AVX";
+#elif defined(BATCH_TRANSFORM_SSE)
+    return "SSE";
+#else
+    return "Scalar";
+#endif
+}
@@ -0,0 +1,264 @@
+#include "CPUProfiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////
+// State
+///////////////////////////////////////////////////////////////////////////////
+
+// Written only by its thread (head) and the collector (tail)
+struct CPUProfileRing {
+    CPUProfileEvent events[CPU_PROFILER_RING_SIZE];
+    atomic<uint64_t> head = 0;
+    atomic<uint64_t> tail = 0;
+};
+
+// Ring of durations (ms)
+struct CPUTimeHistory {
+    vector<float> ms;
+    unsigned int next = 0;
+    unsigned long long sampleCnt = 0;   // All time
+};
+
+struct CPUProfilerState {
+    chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+    atomic<bool> enabled = true;
+    atomic<unsigned long long> droppedCnt = 0;
+
+    // Guarded by registryMutex (touched once per thread / call site)
+    mutex registryMutex;
+    vector<shared_ptr<CPUProfileRing>> rings;
+    vector<string> scopeNames;
+    unordered_map<string, unsigned int> scopeIndices;
+
+    // Collector thread only
+    vector<CPUTimeHistory> scopeHistories;
+    CPUTimeHistory frameHistory;
+};
+
+static CPUProfilerState& getCPUProfilerState() {
+    static CPUProfilerState state;
+    return state;
+}
+
+static thread_local CPUProfileRing *threadRing = nullptr;
+static thread_local uint32_t threadIndex = 0;
+
+static CPUProfileRing* getThreadRing() {
+    if(!threadRing) {
+        CPUProfilerState &state = getCPUProfilerState();
+        lock_guard<mutex> lock(state.registryMutex);
+        state.rings.push_back(make_shared<CPUProfileRing>());
+        threadRing = state.rings.back().get();
+        threadIndex = state.rings.size() - 1;
+    }
+    return threadRing;
+}
+
+static void addTimeSample(CPUTimeHistory &history, float ms) {
+    if(history.ms.empty()) {
+        history.ms.resize(CPU_PROFILER_HISTORY, 0.0f);
+    }
+    history.ms[history.next] = ms;
+    history.next = (history.next + 1) % CPU_PROFILER_HISTORY;
+    history.sampleCnt++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int registerCPUProfileScope(const string &name) {
+    CPUProfilerState &state = getCPUProfilerState();
+    lock_guard<mutex> lock(state.registryMutex);
+
+    auto it = state.scopeIndices.find(name);
+    if(it != state.scopeIndices.end()) {
+        return it->second;
+    }
+
+    unsigned int scopeID = state.scopeNames.size();
+    state.scopeNames.push_back(name);
+    state.scopeIndices[name] = scopeID;
+    return scopeID;
+}
+
+void setCPUProfilerEnabled(bool enabled) {
+    getCPUProfilerState().enabled.store(enabled, memory_order_relaxed);
+}
+
+bool isCPUProfilerEnabled() {
+    return getCPUProfilerState().enabled.load(memory_order_relaxed);
+}
+
+uint64_t getCPUProfilerTimeNs() {
+    auto elapsed = chrono::steady_clock::now() - getCPUProfilerState().epoch;
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+}
+
+uint64_t getCPUProfilerEpochNs() {
+    auto sinceEpoch = getCPUProfilerState().epoch.time_since_epoch();
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(sinceEpoch).count());
+}
+
+void recordCPUProfileEvent(unsigned int scopeID, uint64_t startNs, uint64_t endNs) {
+    CPUProfileRing *ring = getThreadRing();
+
+    uint64_t head = ring->head.load(memory_order_relaxed);
+    if(head - ring->tail.load(memory_order_acquire) >= CPU_PROFILER_RING_SIZE) {
+        getCPUProfilerState().droppedCnt.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    CPUProfileEvent &event = ring->events[head & (CPU_PROFILER_RING_SIZE - 1)];
+    event.scopeID = scopeID;
+    event.threadIndex = threadIndex;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+
+    // Publish the event to the collector
+    ring->head.store(head + 1, memory_order_release);
+}
+
+void addCPUFrameTime(float frameTime) {
+    addTimeSample(getCPUProfilerState().frameHistory, frameTime * 1000.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Collection
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int collectCPUProfile(vector<CPUProfileEvent> *events) {
+    CPUProfilerState &state = getCPUProfilerState();
+
+    vector<shared_ptr<CPUProfileRing>> rings;
+    {
+        lock_guard<mutex> lock(state.registryMutex);
+        rings = state.rings;
+        state.scopeHistories.resize(state.scopeNames.size());
+    }
+
+    unsigned int drainedCnt = 0;
+    for(auto &ring : rings) {
+        uint64_t tail = ring->tail.load(memory_order_relaxed);
+        uint64_t head = ring->head.load(memory_order_acquire);
+
+        for(; tail < head; tail++) {
+            const CPUProfileEvent &event = ring->events[tail & (CPU_PROFILER_RING_SIZE - 1)];
+            if(event.scopeID < state.scopeHistories.size()) {
+                addTimeSample(state.scopeHistories[event.scopeID], float(event.durationNs * 1e-6));
+            }
+            if(events) {
+                events->push_back(event);
+            }
+            drainedCnt++;
+        }
+
+        // Hand the slots back to the producer
+        ring->tail.store(tail, memory_order_release);
+    }
+
+    return drainedCnt;
+}
+
+void resetCPUProfile() {
+    collectCPUProfile();
+
+    CPUProfilerState &state = getCPUProfilerState();
+    for(auto &history : state.scopeHistories) {
+        history = CPUTimeHistory();
+    }
+    state.frameHistory = CPUTimeHistory();
+    state.droppedCnt.store(0, memory_order_relaxed);
+}
+
+unsigned long long getCPUProfileDroppedCount() {
+    return getCPUProfilerState().droppedCnt.load(memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Stats
+///////////////////////////////////////////////////////////////////////////////
+
+// Nearest-rank percentile of sorted values
+static float getSortedPercentile(const vector<float> &sorted, float percent) {
+    unsigned int rank = (unsigned int)ceil(percent / 100.0f * sorted.size());
+    rank = min(max(rank, 1u), (unsigned int)sorted.size());
+    return sorted[rank - 1];
+}
+
+CPUTimeStats computeCPUTimeStats(const string &name, vector<float> ms) {
+    CPUTimeStats stats;
+    stats.name = name;
+    stats.sampleCnt = ms.size();
+    if(ms.empty()) {
+        return stats;
+    }
+
+    vector<float> &sorted = ms;
+    sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for(float sample : sorted) {
+        sum += sample;
+    }
+    stats.avgMs = float(sum / sorted.size());
+    stats.p50Ms = getSortedPercentile(sorted, 50.0f);
+    stats.p95Ms = getSortedPercentile(sorted, 95.0f);
+    stats.p99Ms = getSortedPercentile(sorted, 99.0f);
+    stats.maxMs = sorted.back();
+    return stats;
+}
+
+static CPUTimeStats getTimeStats(const string &name, const CPUTimeHistory &history) {
+    unsigned int windowCnt = (unsigned int)min<unsigned long long>(history.sampleCnt, CPU_PROFILER_HISTORY);
+    return computeCPUTimeStats(name, vector<float>(history.ms.begin(), history.ms.begin() + windowCnt));
+}
+
+CPUTimeStats getCPUFrameTimeStats() {
+    return getTimeStats("frame", getCPUProfilerState().frameHistory);
+}
+
+vector<CPUTimeStats> getCPUScopeStats() {
+    CPUProfilerState &state = getCPUProfilerState();
+    vector<CPUTimeStats> allStats;
+    for(unsigned int i = 0; i < state.scopeHistories.size(); i++) {
+        if(state.scopeHistories[i].sampleCnt > 0) {
+            allStats.push_back(getTimeStats(getCPUProfileScopeName(i), state.scopeHistories[i]));
+        }
+    }
+    return allStats;
+}
+
+string getCPUProfileScopeName(unsigned int scopeID) {
+    CPUProfilerState &state = getCPUProfilerState();
+    lock_guard<mutex> lock(state.registryMutex);
+    return (scopeID < state.scopeNames.size()) ? state.scopeNames[scopeID] : string("?");
+}
+
+void printCPUProfileStats(ostream &out) {
+    streamsize oldPrecision = out.precision();
+    out << fixed << setprecision(3);
+
+    CPUTimeStats frame = getCPUFrameTimeStats();
+    out << "CPU frame time (ms over last " << frame.sampleCnt << " frames): avg " << frame.avgMs
+        << ", p50 " << frame.p50Ms << ", p95 " << frame.p95Ms << ", p99 " << frame.p99Ms
+        << ", max " << frame.maxMs << endl;
+
+    out << "CPU scopes (ms per call): samples, avg, p50, p95, p99, max";
+    unsigned long long droppedCnt = getCPUProfileDroppedCount();
+    if(droppedCnt > 0) {
+        out << " (" << droppedCnt << " events dropped)";
+    }
+    out << endl;
+    for(auto &stats : getCPUScopeStats()) {
+        out << "  " << stats.name << ": " << stats.sampleCnt << ", " << stats.avgMs << ", " << stats.p50Ms
+            << ", " << stats.p95Ms << ", " << stats.p99Ms << ", " << stats.maxMs << endl;
+    }
+
+    out << defaultfloat << setprecision(oldPrecision);
+}
@@ -0,0 +1,154 @@
+#include "ChromeTrace.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <set>
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and clear
+///////////////////////////////////////////////////////////////////////////////
+
+ChromeTrace createChromeTrace(unsigned int capacity) {
+    ChromeTrace trace;
+    trace.capacity = max(capacity, 1u);
+    trace.events.resize(trace.capacity);
+    return trace;
+}
+
+void clearChromeTrace(ChromeTrace &trace) {
+    trace.totalCnt = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t getChromeTraceNameID(ChromeTrace &trace, const string &name) {
+    auto it = trace.nameIndices.find(name);
+    if(it != trace.nameIndices.end()) {
+        return it->second;
+    }
+
+    uint32_t nameID = trace.names.size();
+    trace.names.push_back(name);
+    trace.nameIndices[name] = nameID;
+    return nameID;
+}
+
+void addChromeTraceEvent(   ChromeTrace &trace, uint32_t nameID, uint32_t track,
+                            uint64_t startNs, uint64_t durationNs) {
+    if(!trace.enabled || trace.events.empty()) {
+        return;
+    }
+
+    ChromeTraceEvent &event = trace.events[trace.totalCnt % trace.capacity];
+    event.nameID = nameID;
+    event.track = track;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    trace.totalCnt++;
+}
+
+unsigned int collectCPUProfileTrace(ChromeTrace &trace) {
+    if(!trace.enabled) {
+        return collectCPUProfile();
+    }
+
+    trace.scratch.clear();
+    unsigned int drainedCnt = collectCPUProfile(&trace.scratch);
+
+    for(auto &event : trace.scratch) {
+        if(event.scopeID >= trace.cpuScopeNameIDs.size()) {
+            trace.cpuScopeNameIDs.resize(event.scopeID + 1, -1);
+        }
+        int &nameID = trace.cpuScopeNameIDs[event.scopeID];
+        if(nameID < 0) {
+            nameID = getChromeTraceNameID(trace, getCPUProfileScopeName(event.scopeID));
+        }
+        addChromeTraceEvent(trace, nameID, event.threadIndex, event.startNs, event.durationNs);
+    }
+
+    return drainedCnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Export
+///////////////////////////////////////////////////////////////////////////////
+
+static string escapeTraceJSON(const string &s) {
+    ostringstream out;
+    for(char c : s) {
+        switch(c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default: out << c; break;
+        }
+    }
+    return out.str();
+}
+
+// CPU threads are process 1, GPU queues process 2
+static void getTraceProcessThread(uint32_t track, unsigned int &pid, unsigned int &tid) {
+    if(track >= CHROME_TRACE_GPU_TRACK) {
+        pid = 2;
+        tid = track - CHROME_TRACE_GPU_TRACK;
+    }
+    else {
+        pid = 1;
+        tid = track;
+    }
+}
+
+bool writeChromeTrace(ChromeTrace &trace, const string &filename) {
+    ofstream out(filename);
+    if(!out) {
+        cerr << "Could not write trace: " << filename << endl;
+        return false;
+    }
+
+    unsigned long long keptCnt = min<unsigned long long>(trace.totalCnt, trace.capacity);
+    unsigned long long first = trace.totalCnt - keptCnt;
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << endl;
+
+    // Process/thread names
+    out << "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": 1, \"args\": {\"name\": \"CPU\"}}," << endl;
+    out << "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": 2, \"args\": {\"name\": \"GPU\"}}";
+
+    set<uint32_t> tracks;
+    for(unsigned long long i = first; i < trace.totalCnt; i++) {
+        tracks.insert(trace.events[i % trace.capacity].track);
+    }
+    for(uint32_t track : tracks) {
+        unsigned int pid, tid;
+        getTraceProcessThread(track, pid, tid);
+        string threadName = (pid == 2) ? ("queue " + to_string(tid)) : ("thread " + to_string(tid));
+        out << "," << endl << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " << pid
+            << ", \"tid\": " << tid << ", \"args\": {\"name\": \"" << threadName << "\"}}";
+    }
+
+    // Complete events (microseconds)
+    out.setf(ios::fixed);
+    out.precision(3);
+    for(unsigned long long i = first; i < trace.totalCnt; i++) {
+        ChromeTraceEvent &event = trace.events[i % trace.capacity];
+        unsigned int pid, tid;
+        getTraceProcessThread(event.track, pid, tid);
+        string name = (event.nameID < trace.names.size()) ? trace.names[event.nameID] : string("?");
+
+        out << "," << endl << "{\"ph\": \"X\", \"name\": \"" << escapeTraceJSON(name)
+            << "\", \"pid\": " << pid << ", \"tid\": " << tid
+            << ", \"ts\": " << (event.startNs * 1e-3) << ", \"dur\": " << (event.durationNs * 1e-3) << "}";
+    }
+
+    out << endl << "]}" << endl;
+
+    cout << "Trace written to " << filename << " (" << keptCnt << " events";
+    if(first > 0) {
+        cout << ", " << first << " older dropped";
+    }
+    cout << ")" << endl;
+    return true;
+}
@@ -0,0 +1,154 @@
+#include "LightClusters.hpp"
+#include <cmath>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+// Grid helpers
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int getClusterCount(const LightClusterGrid &grid) {
+    return grid.dimX * grid.dimY * grid.dimZ;
+}
+
+glm::vec2 getClusterSliceScaleBias(const LightClusterGrid &grid) {
+    float logRatio = log(grid.farZ / grid.nearZ);
+    float scale = grid.dimZ / logRatio;
+    float bias = -(grid.dimZ * log(grid.nearZ)) / logRatio;
+    return glm::vec2(scale, bias);
+}
+
+unsigned int getClusterSlice(const LightClusterGrid &grid, float viewDepth) {
+    if(viewDepth <= grid.nearZ) {
+        return 0;
+    }
+
+    glm::vec2 scaleBias = getClusterSliceScaleBias(grid);
+    int slice = int(floor(log(viewDepth) * scaleBias.x + scaleBias.y));
+    return (unsigned int)min(max(slice, 0), int(grid.dimZ) - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Screen-space bounds of a light sphere (in tiles)
+///////////////////////////////////////////////////////////////////////////////
+
+static bool getLightTileBounds(  const LightClusterGrid &grid,
+                                 const glm::vec3 &center, float radius,
+                                 const glm::mat4 &projMat,
+                                 glm::uvec2 &minTile, glm::uvec2 &maxTile) {
+
+    // Full screen if the camera is inside (or too close to) the sphere
+    if(-center.z - radius <= grid.nearZ) {
+        minTile = glm::uvec2(0, 0);
+        maxTile = glm::uvec2(grid.dimX - 1, grid.dimY - 1);
+        return true;
+    }
+
+    // Project the 8 corners of the view-space bounding box
+    glm::vec2 minNDC(1.0f), maxNDC(-1.0f);
+    for(int i = 0; i < 8; i++) {
+        glm::vec3 corner = center + radius * glm::vec3( (i & 1) ? 1.0f : -1.0f,
+                                                        (i & 2) ? 1.0f : -1.0f,
+                                                        (i & 4) ? 1.0f : -1.0f);
+        glm::vec4 clip = projMat * glm::vec4(corner, 1.0f);
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        minNDC = glm::min(minNDC, ndc);
+        maxNDC = glm::max(maxNDC, ndc);
+    }
+
+    // Entirely off screen?
+    if(maxNDC.x < -1.0f || maxNDC.y < -1.0f || minNDC.x > 1.0f || minNDC.y > 1.0f) {
+        return false;
+    }
+
+    // NDC [-1,1] -> tile
+    glm::vec2 dims = glm::vec2(grid.dimX, grid.dimY);
+    glm::vec2 minT = glm::floor((glm::clamp(minNDC, -1.0f, 1.0f) * 0.5f + 0.5f) * dims);
+    glm::vec2 maxT = glm::floor((glm::clamp(maxNDC, -1.0f, 1.0f) * 0.5f + 0.5f) * dims);
+
+    minTile = glm::uvec2(glm::clamp(minT, glm::vec2(0.0f), dims - 1.0f));
+    maxTile = glm::uvec2(glm::clamp(maxT, glm::vec2(0.0f), dims - 1.0f));
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Binning
+///////////////////////////////////////////////////////////////////////////////
+
+void buildLightClusters(LightClusterGrid &grid,
+                        const vector<ClusterLight> &lights,
+                        const glm::mat4 &projMat,
+                        unsigned int maxIndices) {
+
+    unsigned int clusterCnt = getClusterCount(grid);
+    grid.ranges.assign(clusterCnt, glm::uvec2(0, 0));
+    grid.overflowCnt = 0;
+
+    // Cluster bounds of every visible light
+    struct LightBounds {
+        unsigned int light;
+        glm::uvec2 minTile, maxTile;
+        unsigned int minSlice, maxSlice;
+    };
+    vector<LightBounds> allBounds;
+    allBounds.reserve(lights.size());
+
+    for(unsigned int i = 0; i < lights.size(); i++) {
+        glm::vec3 center = glm::vec3(lights[i].vposRadius);
+        float radius = lights[i].vposRadius.w;
+
+        float minDepth = -center.z - radius;
+        float maxDepth = -center.z + radius;
+        if(maxDepth < grid.nearZ || minDepth > grid.farZ) {
+            continue;
+        }
+
+        LightBounds b;
+        b.light = i;
+        if(!getLightTileBounds(grid, center, radius, projMat, b.minTile, b.maxTile)) {
+            continue;
+        }
+        b.minSlice = getClusterSlice(grid, minDepth);
+        b.maxSlice = getClusterSlice(grid, maxDepth);
+        allBounds.push_back(b);
+    }
+
+    // PASS 1: Count lights per cluster
+    for(auto &b : allBounds) {
+        for(unsigned int z = b.minSlice; z <= b.maxSlice; z++) {
+            for(unsigned int y = b.minTile.y; y <= b.maxTile.y; y++) {
+                for(unsigned int x = b.minTile.x; x <= b.maxTile.x; x++) {
+                    grid.ranges[(z*grid.dimY + y)*grid.dimX + x].y++;
+                }
+            }
+        }
+    }
+
+    // Prefix sum -> offsets (clamped to capacity)
+    unsigned int offset = 0;
+    for(auto &range : grid.ranges) {
+        unsigned int cnt = min(range.y, maxIndices - offset);
+        grid.overflowCnt += range.y - cnt;
+        range = glm::uvec2(offset, 0);
+        offset += cnt;
+    }
+    grid.indices.resize(offset);
+
+    // PASS 2: Fill index lists
+    for(auto &b : allBounds) {
+        for(unsigned int z = b.minSlice; z <= b.maxSlice; z++) {
+            for(unsigned int y = b.minTile.y; y <= b.maxTile.y; y++) {
+                for(unsigned int x = b.minTile.x; x <= b.maxTile.x; x++) {
+                    unsigned int c = (z*grid.dimY + y)*grid.dimX + x;
+                    glm::uvec2 &range = grid.ranges[c];
+
+                    // Next cluster's offset marks the end of this one's space
+                    unsigned int end = (c + 1 < clusterCnt) ? grid.ranges[c + 1].x : offset;
+                    if(range.x + range.y < end) {
+                        grid.indices[range.x + range.y] = b.light;
+                        range.y++;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,379 @@
+#include "MeshSimplify.hpp"
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////
+// Quadrics (symmetric 4x4, upper triangle)
+///////////////////////////////////////////////////////////////////////////////
+
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+
+    void addPlane(double a, double b, double c, double d, double w) {
+        a2 += w*a*a; ab += w*a*b; ac += w*a*c; ad += w*a*d;
+        b2 += w*b*b; bc += w*b*c; bd += w*b*d;
+        c2 += w*c*c; cd += w*c*d;
+        d2 += w*d*d;
+    }
+
+    void add(const Quadric &q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+    }
+
+    // v^T Q v with v = (x, y, z, 1)
+    double evaluate(const glm::vec3 &p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double r = a2*x*x + 2*ab*x*y + 2*ac*x*z + 2*ad*x
+                 + b2*y*y + 2*bc*y*z + 2*bd*y
+                 + c2*z*z + 2*cd*z
+                 + d2;
+        return max(r, 0.0);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Simplification
+///////////////////////////////////////////////////////////////////////////////
+
+struct Collapse {
+    unsigned int from;      // Canonical vertex that moves
+    unsigned int to;        // Canonical vertex it moves onto
+    unsigned int tri;       // A triangle containing the edge (picks the target index)
+    double cost;
+};
+
+static glm::vec3 triangleNormal(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2) {
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+vector<unsigned int> simplifyMesh(  const vector<glm::vec3> &positions,
+                                    const vector<unsigned int> &indices,
+                                    unsigned int targetIndexCnt,
+                                    float maxError,
+                                    float &resultError) {
+    resultError = 0.0f;
+    unsigned int triCnt = indices.size() / 3;
+    unsigned int vertexCnt = positions.size();
+    vector<unsigned int> tris(indices.begin(), indices.begin() + triCnt*3);
+
+    // Canonical vertex per position (seams = several vertices at one position)
+    vector<unsigned int> remap(vertexCnt);
+    vector<unsigned int> wedgeCnt(vertexCnt, 0);
+    {
+        struct PosHash {
+            size_t operator()(const glm::vec3 &p) const {
+                hash<float> h;
+                return h(p.x) ^ (h(p.y) * 31) ^ (h(p.z) * 131);
+            }
+        };
+        unordered_map<glm::vec3, unsigned int, PosHash> firstAt;
+        for(unsigned int v = 0; v < vertexCnt; v++) {
+            auto it = firstAt.find(positions[v]);
+            if(it == firstAt.end()) {
+                firstAt[positions[v]] = v;
+                remap[v] = v;
+            }
+            else {
+                remap[v] = it->second;
+            }
+        }
+        vector<bool> referenced(vertexCnt, false);
+        for(unsigned int i : tris) {
+            if(!referenced[i]) {
+                referenced[i] = true;
+                wedgeCnt[remap[i]]++;
+            }
+        }
+    }
+
+    // Border edges (one triangle) on the canonical topology
+    vector<bool> locked(vertexCnt, false);
+    {
+        unordered_map<unsigned long long, int> edgeCnt;
+        for(unsigned int t = 0; t < triCnt; t++) {
+            for(unsigned int k = 0; k < 3; k++) {
+                unsigned int a = remap[tris[t*3 + k]];
+                unsigned int b = remap[tris[t*3 + (k+1)%3]];
+                unsigned long long key = (unsigned long long)min(a, b) << 32 | max(a, b);
+                edgeCnt[key]++;
+            }
+        }
+        for(auto &e : edgeCnt) {
+            if(e.second == 1) {
+                locked[e.first >> 32] = true;
+                locked[e.first & 0xFFFFFFFFull] = true;
+            }
+        }
+        for(unsigned int v = 0; v < vertexCnt; v++) {
+            if(wedgeCnt[v] > 1) {
+                locked[v] = true;
+            }
+        }
+    }
+
+    // Plane quadrics (area weighted) per canonical vertex
+    vector<Quadric> quadrics(vertexCnt);
+    for(unsigned int t = 0; t < triCnt; t++) {
+        glm::vec3 p0 = positions[tris[t*3]];
+        glm::vec3 n = triangleNormal(p0, positions[tris[t*3+1]], positions[tris[t*3+2]]);
+        float len = glm::length(n);
+        if(len <= 0.0f) {
+            continue;
+        }
+        n /= len;
+        double d = -glm::dot(n, p0);
+        double area = 0.5 * len;
+        for(unsigned int k = 0; k < 3; k++) {
+            quadrics[remap[tris[t*3 + k]]].addPlane(n.x, n.y, n.z, d, area);
+        }
+    }
+
+    // Normalize so cost is a squared DISTANCE (not area * distance^2)
+    {
+        vector<double> weight(vertexCnt, 0.0);
+        for(unsigned int t = 0; t < triCnt; t++) {
+            glm::vec3 p0 = positions[tris[t*3]];
+            double area = 0.5 * glm::length(triangleNormal(p0, positions[tris[t*3+1]], positions[tris[t*3+2]]));
+            for(unsigned int k = 0; k < 3; k++) {
+                weight[remap[tris[t*3 + k]]] += area;
+            }
+        }
+        for(unsigned int v = 0; v < vertexCnt; v++) {
+            if(weight[v] > 0.0) {
+                double s = 1.0 / weight[v];
+                Quadric &q = quadrics[v];
+                q.a2 *= s; q.ab *= s; q.ac *= s; q.ad *= s;
+                q.b2 *= s; q.bc *= s; q.bd *= s;
+                q.c2 *= s; q.cd *= s;
+                q.d2 *= s;
+            }
+        }
+    }
+
+    // Canonical vertex -> triangles (grows as vertices merge; dead entries skipped)
+    vector<vector<unsigned int>> vertexTris(vertexCnt);
+    for(unsigned int t = 0; t < triCnt; t++) {
+        for(unsigned int k = 0; k < 3; k++) {
+            vertexTris[remap[tris[t*3 + k]]].push_back(t);
+        }
+    }
+
+    vector<bool> triAlive(triCnt, true);
+    unsigned int aliveCnt = triCnt;
+    unsigned int targetTris = targetIndexCnt / 3;
+    double maxCost = double(maxError) * double(maxError);
+    double worstCost = 0.0;
+
+    auto canon = [&](unsigned int t, unsigned int k) { return remap[tris[t*3 + k]]; };
+
+    // Would moving "from" onto "to" flip or collapse any surviving triangle?
+    auto flips = [&](unsigned int from, unsigned int to) {
+        for(unsigned int t : vertexTris[from]) {
+            if(!triAlive[t]) {
+                continue;
+            }
+            bool hasTo = false;
+            glm::vec3 p[3], q[3];
+            for(unsigned int k = 0; k < 3; k++) {
+                unsigned int c = canon(t, k);
+                hasTo |= (c == to);
+                p[k] = positions[c];
+                q[k] = positions[(c == from) ? to : c];
+            }
+            if(hasTo) {
+                continue;   // Becomes degenerate and is removed
+            }
+            glm::vec3 n0 = triangleNormal(p[0], p[1], p[2]);
+            glm::vec3 n1 = triangleNormal(q[0], q[1], q[2]);
+            if(glm::dot(n0, n1) <= 0.0f || glm::length(n1) <= 1e-12f * glm::length(n0)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    vector<Collapse> collapses;
+    vector<unsigned int> touchedPass(vertexCnt, 0);
+    unsigned int pass = 0;
+
+    while(aliveCnt > targetTris) {
+        pass++;
+
+        // Best direction for every edge of every live triangle
+        collapses.clear();
+        for(unsigned int t = 0; t < triCnt; t++) {
+            if(!triAlive[t]) {
+                continue;
+            }
+            for(unsigned int k = 0; k < 3; k++) {
+                unsigned int a = canon(t, k);
+                unsigned int b = canon(t, (k+1)%3);
+                if(a > b) {
+                    continue;   // Each edge once (interior edges appear twice)
+                }
+
+                Quadric q = quadrics[a];
+                q.add(quadrics[b]);
+                double costAB = locked[a] ? 1e300 : q.evaluate(positions[b]);
+                double costBA = locked[b] ? 1e300 : q.evaluate(positions[a]);
+                if(costAB >= 1e300 && costBA >= 1e300) {
+                    continue;
+                }
+                if(costAB <= costBA) {
+                    collapses.push_back({a, b, t, costAB});
+                }
+                else {
+                    collapses.push_back({b, a, t, costBA});
+                }
+            }
+        }
+        if(collapses.empty()) {
+            break;
+        }
+
+        sort(collapses.begin(), collapses.end(),
+             [](const Collapse &x, const Collapse &y) { return x.cost < y.cost; });
+
+        // Independent collapses, cheapest first
+        unsigned int doneCnt = 0;
+        for(auto &c : collapses) {
+            if(aliveCnt <= targetTris || c.cost > maxCost) {
+                break;
+            }
+            if(touchedPass[c.from] == pass || touchedPass[c.to] == pass || !triAlive[c.tri]) {
+                continue;
+            }
+            if(flips(c.from, c.to)) {
+                continue;
+            }
+
+            // Index of "to" on the same side of any seam as the edge triangle
+            unsigned int toIndex = 0;
+            for(unsigned int k = 0; k < 3; k++) {
+                if(canon(c.tri, k) == c.to) {
+                    toIndex = tris[c.tri*3 + k];
+                }
+            }
+
+            // Rewire (triangles with both ends become degenerate)
+            for(unsigned int t : vertexTris[c.from]) {
+                if(!triAlive[t]) {
+                    continue;
+                }
+                bool hasTo = false;
+                for(unsigned int k = 0; k < 3; k++) {
+                    hasTo |= (canon(t, k) == c.to);
+                }
+                if(hasTo) {
+                    triAlive[t] = false;
+                    aliveCnt--;
+                    continue;
+                }
+                for(unsigned int k = 0; k < 3; k++) {
+                    if(canon(t, k) == c.from) {
+                        tris[t*3 + k] = toIndex;
+                    }
+                }
+                vertexTris[c.to].push_back(t);
+            }
+            vertexTris[c.from].clear();
+            quadrics[c.to].add(quadrics[c.from]);
+
+            // Neighbors of both ends changed; leave them for the next pass
+            for(unsigned int t : vertexTris[c.to]) {
+                if(triAlive[t]) {
+                    for(unsigned int k = 0; k < 3; k++) {
+                        touchedPass[canon(t, k)] = pass;
+                    }
+                }
+            }
+            touchedPass[c.from] = pass;
+
+            worstCost = max(worstCost, c.cost);
+            doneCnt++;
+        }
+
+        if(doneCnt == 0) {
+            break;
+        }
+    }
+
+    vector<unsigned int> result;
+    result.reserve(aliveCnt * 3);
+    for(unsigned int t = 0; t < triCnt; t++) {
+        if(triAlive[t]) {
+            result.insert(result.end(), tris.begin() + t*3, tris.begin() + t*3 + 3);
+        }
+    }
+
+    resultError = float(sqrt(worstCost));
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// LOD chains
+///////////////////////////////////////////////////////////////////////////////
+
+vector<MeshLOD> buildMeshLODs(  const vector<glm::vec3> &positions,
+                                vector<unsigned int> &indices,
+                                unsigned int maxLODs,
+                                float reduction,
+                                float maxError) {
+    vector<MeshLOD> lods;
+
+    MeshLOD lod0;
+    lod0.indexCnt = (indices.size() / 3) * 3;
+    lods.push_back(lod0);
+
+    vector<unsigned int> original(indices.begin(), indices.begin() + lod0.indexCnt);
+    unsigned int prevCnt = lod0.indexCnt;
+
+    for(unsigned int level = 1; level < maxLODs; level++) {
+        unsigned int target = (unsigned int)(prevCnt * reduction) / 3 * 3;
+        if(target < 3) {
+            break;
+        }
+
+        // Always from the original, so errors are measured against it
+        float error = 0.0f;
+        vector<unsigned int> simplified = simplifyMesh(positions, original, target, maxError, error);
+
+        // Not worth another level (<10% fewer triangles)
+        if(simplified.empty() || simplified.size() > prevCnt * 0.9f) {
+            break;
+        }
+
+        MeshLOD lod;
+        lod.firstIndex = indices.size();
+        lod.indexCnt = simplified.size();
+        lod.error = max(error, lods.back().error);
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+        lods.push_back(lod);
+
+        prevCnt = lod.indexCnt;
+    }
+
+    return lods;
+}
+
+unsigned int selectMeshLOD( const vector<MeshLOD> &lods, float distance, float scale,
+                            float pixelsPerUnitAtOne, float maxPixelError) {
+    if(lods.size() < 2 || maxPixelError <= 0.0f) {
+        return 0;
+    }
+
+    // Errors only grow with the level, so stop at the first one that is too big
+    float pixelsPerUnit = pixelsPerUnitAtOne / max(distance, 1e-4f);
+    unsigned int level = 0;
+    while(level + 1 < lods.size() && lods[level + 1].error * scale * pixelsPerUnit <= maxPixelError) {
+        level++;
+    }
+    return level;
+}
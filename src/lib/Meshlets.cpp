@@ -0,0 +1,251 @@
+#include "Meshlets.hpp"
+#include <cmath>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+// Meshlet bounds
+///////////////////////////////////////////////////////////////////////////////
+
+static void computeMeshletBounds(   Meshlet &meshlet,
+                                    const vector<glm::vec3> &positions,
+                                    const vector<unsigned int> &indices) {
+    unsigned int end = meshlet.firstIndex + meshlet.indexCnt;
+
+    // Sphere around AABB center
+    glm::vec3 minPos = positions[indices[meshlet.firstIndex]];
+    glm::vec3 maxPos = minPos;
+    for(unsigned int i = meshlet.firstIndex; i < end; i++) {
+        minPos = glm::min(minPos, positions[indices[i]]);
+        maxPos = glm::max(maxPos, positions[indices[i]]);
+    }
+
+    glm::vec3 center = 0.5f * (minPos + maxPos);
+    float radius2 = 0.0f;
+    for(unsigned int i = meshlet.firstIndex; i < end; i++) {
+        glm::vec3 d = positions[indices[i]] - center;
+        radius2 = max(radius2, glm::dot(d, d));
+    }
+    meshlet.boundingSphere = glm::vec4(center, sqrt(radius2));
+
+    // Normal cone: average face normal, widest deviation from it
+    vector<glm::vec3> normals;
+    glm::vec3 axis(0.0f);
+    for(unsigned int i = meshlet.firstIndex; i < end; i += 3) {
+        glm::vec3 p0 = positions[indices[i]];
+        glm::vec3 p1 = positions[indices[i+1]];
+        glm::vec3 p2 = positions[indices[i+2]];
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float len = glm::length(n);
+        if(len > 1e-12f) {
+            normals.push_back(n / len);
+            axis += normals.back();
+        }
+    }
+
+    // Degenerate or too wide (>~84 degrees) cones are never culled
+    meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    float axisLen = glm::length(axis);
+    if(normals.empty() || axisLen < 1e-6f) {
+        return;
+    }
+    axis /= axisLen;
+
+    float minDot = 1.0f;
+    for(auto &n : normals) {
+        minDot = min(minDot, glm::dot(axis, n));
+    }
+    if(minDot <= 0.1f) {
+        return;
+    }
+
+    // All normals within acos(minDot) of axis: back-facing for every view
+    // direction within 90 - acos(minDot) degrees of it
+    meshlet.cone = glm::vec4(axis, sqrt(1.0f - minDot*minDot));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Building
+// - Greedy: grow the current meshlet with the neighboring triangle that adds
+//   the fewest new vertices; start a new meshlet when either limit is hit
+///////////////////////////////////////////////////////////////////////////////
+
+vector<Meshlet> buildMeshlets(  const vector<glm::vec3> &positions,
+                                vector<unsigned int> &indices,
+                                unsigned int maxVertices,
+                                unsigned int maxTriangles) {
+    vector<Meshlet> meshlets;
+    unsigned int triCnt = indices.size() / 3;
+    if(triCnt == 0 || maxVertices < 3 || maxTriangles < 1) {
+        return meshlets;
+    }
+
+    // Vertex -> triangle adjacency (CSR)
+    unsigned int vertexCnt = positions.size();
+    vector<unsigned int> adjOffsets(vertexCnt + 1, 0);
+    for(unsigned int i = 0; i < triCnt*3; i++) {
+        adjOffsets[indices[i] + 1]++;
+    }
+    for(unsigned int v = 0; v < vertexCnt; v++) {
+        adjOffsets[v + 1] += adjOffsets[v];
+    }
+    vector<unsigned int> adjTris(triCnt*3);
+    vector<unsigned int> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+    for(unsigned int i = 0; i < triCnt*3; i++) {
+        adjTris[fill[indices[i]]++] = i / 3;
+    }
+
+    const unsigned int NONE = 0xFFFFFFFF;
+    vector<bool> triUsed(triCnt, false);
+    vector<unsigned int> vertexMeshlet(vertexCnt, NONE);   // Last meshlet that used vertex
+    vector<unsigned int> candidates;
+    vector<unsigned int> newIndices;
+    newIndices.reserve(indices.size());
+
+    Meshlet current;
+    unsigned int currentID = 0;
+    unsigned int currentTris = 0;
+    unsigned int scanTri = 0;
+
+    auto countNewVertices = [&](unsigned int t) {
+        unsigned int cnt = 0;
+        for(unsigned int k = 0; k < 3; k++) {
+            cnt += (vertexMeshlet[indices[t*3 + k]] != currentID) ? 1 : 0;
+        }
+        return cnt;
+    };
+
+    auto finishMeshlet = [&]() {
+        current.indexCnt = currentTris * 3;
+        computeMeshletBounds(current, positions, newIndices);
+        meshlets.push_back(current);
+
+        current = Meshlet();
+        current.firstIndex = newIndices.size();
+        currentID++;
+        currentTris = 0;
+        candidates.clear();
+    };
+
+    for(unsigned int emitted = 0; emitted < triCnt; emitted++) {
+        // Best neighbor (fewest new vertices); drop used candidates as we go
+        unsigned int best = NONE;
+        unsigned int bestNew = 4;
+        unsigned int keep = 0;
+        for(unsigned int c = 0; c < candidates.size(); c++) {
+            unsigned int t = candidates[c];
+            if(triUsed[t]) {
+                continue;
+            }
+            candidates[keep++] = t;
+            unsigned int n = countNewVertices(t);
+            if(n < bestNew) {
+                best = t;
+                bestNew = n;
+            }
+        }
+        candidates.resize(keep);
+
+        // No neighbors left: next unused triangle in original order
+        if(best == NONE) {
+            while(triUsed[scanTri]) {
+                scanTri++;
+            }
+            best = scanTri;
+            bestNew = countNewVertices(best);
+        }
+
+        // Full? Close it and let the neighbor seed the next one
+        if(currentTris > 0 && (current.vertexCnt + bestNew > maxVertices || currentTris + 1 > maxTriangles)) {
+            finishMeshlet();
+            bestNew = 3;
+        }
+
+        // Add triangle
+        triUsed[best] = true;
+        currentTris++;
+        current.vertexCnt += bestNew;
+        for(unsigned int k = 0; k < 3; k++) {
+            unsigned int v = indices[best*3 + k];
+            newIndices.push_back(v);
+            vertexMeshlet[v] = currentID;
+
+            for(unsigned int a = adjOffsets[v]; a < adjOffsets[v + 1]; a++) {
+                if(!triUsed[adjTris[a]]) {
+                    candidates.push_back(adjTris[a]);
+                }
+            }
+        }
+    }
+
+    if(currentTris > 0) {
+        finishMeshlet();
+    }
+
+    // Leftover indices (not a multiple of 3) are dropped, as they were never drawable
+    indices.swap(newIndices);
+    return meshlets;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Culling
+///////////////////////////////////////////////////////////////////////////////
+
+void cullMeshlets(  const vector<Meshlet> &meshlets,
+                    const glm::mat4 &modelMat,
+                    const glm::vec4 worldPlanes[6],
+                    glm::vec3 cameraPos,
+                    bool coneCulling,
+                    vector<MeshletDrawRange> &ranges,
+                    MeshletCullStats &stats) {
+
+    // Bring planes and camera into object space (once per instance)
+    // (plane' = transpose(M) * plane; not normalized, so scale by length below)
+    glm::mat4 modelT = glm::transpose(modelMat);
+    glm::vec4 planes[6];
+    float planeScale[6];
+    for(int p = 0; p < 6; p++) {
+        planes[p] = modelT * worldPlanes[p];
+        planeScale[p] = glm::length(glm::vec3(planes[p]));
+    }
+    glm::vec3 localCamera = glm::vec3(glm::inverse(modelMat) * glm::vec4(cameraPos, 1.0f));
+
+    bool merging = false;
+    for(auto &m : meshlets) {
+        stats.testedCnt++;
+
+        glm::vec3 center = glm::vec3(m.boundingSphere);
+        float radius = m.boundingSphere.w;
+
+        bool visible = true;
+        for(int p = 0; p < 6 && visible; p++) {
+            if(glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -radius * planeScale[p]) {
+                visible = false;
+                stats.frustumCulledCnt++;
+            }
+        }
+
+        if(visible && coneCulling && m.cone.w < 1.0f) {
+            glm::vec3 toCenter = center - localCamera;
+            if(glm::dot(toCenter, glm::vec3(m.cone)) >= m.cone.w * glm::length(toCenter) + radius) {
+                visible = false;
+                stats.backfaceCulledCnt++;
+            }
+        }
+
+        if(!visible) {
+            merging = false;
+            continue;
+        }
+
+        stats.drawnCnt++;
+
+        // Meshlets are contiguous, so neighbors that both survive become one range
+        if(merging && ranges.back().firstIndex + ranges.back().indexCnt == m.firstIndex) {
+            ranges.back().indexCnt += m.indexCnt;
+        }
+        else {
+            ranges.push_back({ m.firstIndex, m.indexCnt });
+        }
+        merging = true;
+    }
+}
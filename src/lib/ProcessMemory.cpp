@@ -0,0 +1,36 @@
+#include "ProcessMemory.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+unsigned long long getProcessMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    // Second field: resident pages
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if(!statm) {
+        return 0;
+    }
+    unsigned long long totalPages = 0, residentPages = 0;
+    int readCnt = fscanf(statm, "%llu %llu", &totalPages, &residentPages);
+    fclose(statm);
+    if(readCnt != 2) {
+        return 0;
+    }
+    return residentPages * (unsigned long long)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
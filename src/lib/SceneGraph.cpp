@@ -0,0 +1,133 @@
+#include "SceneGraph.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Building
+///////////////////////////////////////////////////////////////////////////////
+
+void clearSceneGraph(FlatSceneGraph &graph) {
+    graph.parent.clear();
+    graph.localMat.clear();
+    graph.worldMat.clear();
+    graph.subtreeEnd.clear();
+    graph.meshStart.clear();
+    graph.meshCnt.clear();
+    graph.dirty.clear();
+    graph.meshIndices.clear();
+    graph.anyDirty = false;
+}
+
+int addSceneGraphNode(  FlatSceneGraph &graph, int parent,
+                        const glm::mat4 &localMat,
+                        const vector<unsigned int> &meshes) {
+
+    int index = graph.parent.size();
+
+    graph.parent.push_back(parent);
+    graph.localMat.push_back(localMat);
+    graph.worldMat.push_back(localMat);
+    graph.subtreeEnd.push_back(index + 1);
+    graph.meshStart.push_back(graph.meshIndices.size());
+    graph.meshCnt.push_back(meshes.size());
+    graph.dirty.push_back(1);
+
+    graph.meshIndices.insert(graph.meshIndices.end(), meshes.begin(), meshes.end());
+    graph.anyDirty = true;
+
+    return index;
+}
+
+int addAssimpSceneGraph(FlatSceneGraph &graph, aiNode *node, int parent) {
+    // Convert transformation ONCE
+    aiMatrix4x4 aiNodeT = node->mTransformation;
+    glm::mat4 nodeT;
+    aiMatToGLM4(aiNodeT, nodeT);
+
+    vector<unsigned int> meshes(node->mMeshes, node->mMeshes + node->mNumMeshes);
+    int index = addSceneGraphNode(graph, parent, nodeT, meshes);
+
+    // Children follow their parent (pre-order)
+    for(unsigned int i = 0; i < node->mNumChildren; i++) {
+        addAssimpSceneGraph(graph, node->mChildren[i], index);
+    }
+
+    return index;
+}
+
+void finalizeSceneGraph(FlatSceneGraph &graph) {
+    // Walking backwards, each child's range is known before its parent's
+    for(int i = (int)graph.parent.size() - 1; i >= 0; i--) {
+        int p = graph.parent[i];
+        if(p >= 0) {
+            graph.subtreeEnd[p] = max(graph.subtreeEnd[p], graph.subtreeEnd[i]);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Updating
+///////////////////////////////////////////////////////////////////////////////
+
+void setSceneGraphLocalMat(FlatSceneGraph &graph, int node, const glm::mat4 &localMat) {
+    graph.localMat[node] = localMat;
+    graph.dirty[node] = 1;
+    graph.anyDirty = true;
+}
+
+unsigned int updateSceneGraphWorldMats( FlatSceneGraph &graph,
+                                        vector<glm::uvec2> *updatedRanges) {
+    if(!graph.anyDirty) {
+        return 0;
+    }
+
+    unsigned int updateCnt = 0;
+    unsigned int nodeCnt = graph.parent.size();
+    unsigned int i = 0;
+
+    while(i < nodeCnt) {
+        if(!graph.dirty[i]) {
+            i++;
+            continue;
+        }
+
+        // Recompute entire subtree in order (parents always done first)
+        unsigned int end = graph.subtreeEnd[i];
+        for(unsigned int j = i; j < end; j++) {
+            int p = graph.parent[j];
+            if(p >= 0) {
+                graph.worldMat[j] = graph.worldMat[p] * graph.localMat[j];
+            }
+            else {
+                graph.worldMat[j] = graph.localMat[j];
+            }
+            graph.dirty[j] = 0;
+        }
+
+        if(updatedRanges) {
+            updatedRanges->push_back(glm::uvec2(i, end));
+        }
+        updateCnt += end - i;
+        i = end;
+    }
+
+    graph.anyDirty = false;
+    return updateCnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recursive reference
+///////////////////////////////////////////////////////////////////////////////
+
+void computeAssimpNormalMatsRecursive(  aiNode *node, glm::mat4 parentMat, const glm::mat4 &viewMat,
+                                        vector<glm::mat4> &normalMats) {
+    glm::mat4 nodeT;
+    aiMatToGLM4(node->mTransformation, nodeT);
+    glm::mat4 modelMat = parentMat * nodeT;
+
+    if(node->mNumMeshes > 0) {
+        normalMats.push_back(glm::transpose(glm::inverse(viewMat * modelMat)));
+    }
+
+    for(unsigned int i = 0; i < node->mNumChildren; i++) {
+        computeAssimpNormalMatsRecursive(node->mChildren[i], modelMat, viewMat, normalMats);
+    }
+}
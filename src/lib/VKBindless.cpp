@@ -0,0 +1,147 @@
+#include "VKBindless.hpp"
+#include <algorithm>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Support and layout
+///////////////////////////////////////////////////////////////////////////////
+
+bool isVulkanBindlessSupported(VulkanInitData &vkInitData) {
+    if(!isVulkanDeviceExtensionEnabled(vkInitData, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+        return false;
+    }
+
+    // Setup enables these only if all of them are present
+    auto features = vkInitData.physicalDevice.getFeatures2<
+        vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>();
+    auto &indexing = features.get<vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>();
+    return indexing.shaderSampledImageArrayNonUniformIndexing
+        && indexing.descriptorBindingSampledImageUpdateAfterBind
+        && indexing.descriptorBindingPartiallyBound
+        && indexing.runtimeDescriptorArray;
+}
+
+vk::DescriptorSetLayout createVulkanBindlessSetLayout(  vk::Device &device, unsigned int textureCapacity,
+                                                        vk::ShaderStageFlags stages) {
+    vector<vk::DescriptorSetLayoutBinding> bindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, textureCapacity, stages, nullptr),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, stages, nullptr)
+    };
+
+    // Texture slots may be written while the set is bound and may be left empty
+    vector<vk::DescriptorBindingFlagsEXT> bindingFlags = {
+        vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind | vk::DescriptorBindingFlagBitsEXT::ePartiallyBound,
+        {}
+    };
+    vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT flagsInfo(bindingFlags);
+
+    vk::DescriptorSetLayoutCreateInfo layoutInfo(
+        vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT, bindings);
+    layoutInfo.setPNext(&flagsInfo);
+
+    return device.createDescriptorSetLayout(layoutInfo);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanBindlessTable createVulkanBindlessTable(  VulkanInitData &vkInitData,
+                                                unsigned int textureCapacity, unsigned int materialCapacity,
+                                                vk::ShaderStageFlags stages) {
+    if(!isVulkanBindlessSupported(vkInitData)) {
+        throw runtime_error("createVulkanBindlessTable: Descriptor indexing not supported!");
+    }
+
+    vk::Device &device = vkInitData.device;
+    VulkanBindlessTable table;
+
+    // Update-after-bind descriptors have their own (per stage) limits
+    auto props = vkInitData.physicalDevice.getProperties2<
+        vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>();
+    auto &indexingProps = props.get<vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>();
+    unsigned int maxTextures = min(indexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                   indexingProps.maxPerStageDescriptorUpdateAfterBindSamplers);
+    table.textureCapacity = max(min(textureCapacity, maxTextures), 1u);
+    table.materialCapacity = max(materialCapacity, 1u);
+
+    table.layout = createVulkanBindlessSetLayout(device, table.textureCapacity, stages);
+
+    vector<vk::DescriptorPoolSize> poolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, table.textureCapacity),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 1)
+    };
+    table.pool = createVulkanDescriptorPool(device, vk::DescriptorPoolCreateInfo(
+        vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT, 1, poolSizes));
+    table.set = device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(table.pool, table.layout)).front();
+
+    // Materials: written in place (host coherent)
+    table.materials = createVulkanStorageBufferData(device, vkInitData.physicalDevice,
+                                                    sizeof(BindlessMaterial) * table.materialCapacity, 1);
+    vk::DescriptorBufferInfo materialInfo(table.materials.bufferData[0].buffer, 0, VK_WHOLE_SIZE);
+    device.updateDescriptorSets(vk::WriteDescriptorSet(
+        table.set, 1, 0, vk::DescriptorType::eStorageBuffer, {}, materialInfo), {});
+
+    vk::SamplerCreateInfo samplerInfo;
+    samplerInfo.magFilter = vk::Filter::eLinear;
+    samplerInfo.minFilter = vk::Filter::eLinear;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
+    samplerInfo.anisotropyEnable = true;
+    samplerInfo.maxAnisotropy = min(8.0f, vkInitData.physicalDevice.getProperties().limits.maxSamplerAnisotropy);
+    table.sampler = device.createSampler(samplerInfo);
+
+    return table;
+}
+
+void cleanupVulkanBindlessTable(VulkanInitData &vkInitData, VulkanBindlessTable &table) {
+    for(auto &texture : table.textures) {
+        cleanupVulkanImage(vkInitData, texture);
+    }
+    table.textures.clear();
+
+    vkInitData.device.destroySampler(table.sampler);
+    cleanupVulkanUniformBufferData(vkInitData.device, table.materials);
+    cleanupVulkanDescriptorPool(vkInitData.device, table.pool);
+    vkInitData.device.destroyDescriptorSetLayout(table.layout);
+    table.materialCnt = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Textures and materials
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int addBindlessTexture(VulkanInitData &vkInitData, VulkanBindlessTable &table, VulkanImage texture) {
+    if(table.textures.size() >= table.textureCapacity) {
+        throw runtime_error("addBindlessTexture: Texture table is full!");
+    }
+
+    unsigned int slot = table.textures.size();
+    table.textures.push_back(texture);
+
+    vk::DescriptorImageInfo imageInfo(table.sampler, texture.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+    vkInitData.device.updateDescriptorSets(vk::WriteDescriptorSet(
+        table.set, 0, slot, vk::DescriptorType::eCombinedImageSampler, imageInfo), {});
+
+    return slot;
+}
+
+unsigned int addBindlessMaterial(VulkanBindlessTable &table, const BindlessMaterial &material) {
+    if(table.materialCnt >= table.materialCapacity) {
+        throw runtime_error("addBindlessMaterial: Material table is full!");
+    }
+
+    unsigned int index = table.materialCnt++;
+    updateBindlessMaterial(table, index, material);
+    return index;
+}
+
+void updateBindlessMaterial(VulkanBindlessTable &table, unsigned int index, const BindlessMaterial &material) {
+    if(index >= table.materialCnt) {
+        throw runtime_error("updateBindlessMaterial: Invalid material index!");
+    }
+
+    BindlessMaterial *materials = static_cast<BindlessMaterial*>(table.materials.mapped[0]);
+    memcpy(&materials[index], &material, sizeof(BindlessMaterial));
+}
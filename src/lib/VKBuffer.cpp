@@ -34,7 +34,8 @@ VulkanBuffer createVulkanBuffer(vk::PhysicalDevice &physicalDevice,
                                 vk::Device &device,
                                 vk::DeviceSize size,
                                 vk::BufferUsageFlags usage,
-                                vk::MemoryPropertyFlags properties) {
+                                vk::MemoryPropertyFlags properties,
+                                VulkanCallSite site) {
 
     // Set up struct
     VulkanBuffer data;
@@ -57,6 +58,9 @@ VulkanBuffer createVulkanBuffer(vk::PhysicalDevice &physicalDevice,
     // Bind the memory
     device.bindBufferMemory(data.buffer, data.memory, 0);
 
+    // Track buffer (with its memory)
+    trackVulkanObject(VULKAN_OBJECT_BUFFER, data.buffer, memRequirements.size, site);
+
     // Return data
     return data;
 }
@@ -106,6 +110,7 @@ void copyDataToVulkanBufferViaStaging(  vk::PhysicalDevice &physicalDevice,
 }
 
 void cleanupVulkanBuffer(vk::Device &device, VulkanBuffer &data) {
+    untrackVulkanObject(VULKAN_OBJECT_BUFFER, data.buffer);
     device.destroyBuffer(data.buffer);
     device.freeMemory(data.memory);
 }
@@ -0,0 +1,48 @@
+#include "VKCompute.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Compute pipelines
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanComputePipelineData createVulkanComputePipelineData(
+                                vk::Device &device,
+                                string compSPVFilename,
+                                const vector<vk::DescriptorSetLayout> &descriptorSetLayouts,
+                                const vector<vk::PushConstantRange> &pushConstantRanges,
+                                VulkanCallSite site) {
+    VulkanComputePipelineData data;
+
+    // Load up BYTECODE shader file
+    auto compShaderCode = readBinaryFile(compSPVFilename);
+    vk::ShaderModule compShaderModule = createVulkanShaderModule(device, compShaderCode);
+
+    data.pipelineLayout = device.createPipelineLayout(
+        vk::PipelineLayoutCreateInfo({}, descriptorSetLayouts, pushConstantRanges));
+
+    vk::ComputePipelineCreateInfo pipelineInfo(
+        {},
+        vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, compShaderModule, "main"),
+        data.pipelineLayout);
+
+    auto ret = device.createComputePipeline(nullptr, pipelineInfo);
+    if(ret.result != vk::Result::eSuccess) {
+        throw runtime_error("Failed to create compute pipeline: " + compSPVFilename);
+    }
+    data.pipeline = ret.value;
+    trackVulkanObject(VULKAN_OBJECT_PIPELINE, data.pipeline, 0, site);
+
+    // Module no longer needed once pipeline exists
+    device.destroyShaderModule(compShaderModule);
+
+    return data;
+}
+
+void cleanupVulkanComputePipelineData(vk::Device &device, VulkanComputePipelineData &data) {
+    untrackVulkanObject(VULKAN_OBJECT_PIPELINE, data.pipeline);
+    device.destroyPipeline(data.pipeline);
+    device.destroyPipelineLayout(data.pipelineLayout);
+}
+
+unsigned int getComputeGroupCount(unsigned int cnt, unsigned int groupSize) {
+    return (cnt + groupSize - 1) / groupSize;
+}
@@ -0,0 +1,453 @@
+#include "VKDeferred.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructors and Destructor
+///////////////////////////////////////////////////////////////////////////////
+
+DeferredRenderEngine::DeferredRenderEngine(VulkanInitData &vkInitData) : VulkanRenderEngine(vkInitData) {
+    // Depth is read back in the lighting subpass
+    this->depthImageUsage = vk::ImageUsageFlagBits::eInputAttachment;
+
+    // Geometry pipeline writes every G-buffer attachment
+    this->pipelineOptions.colorAttachmentCnt = GBUFFER_CNT;
+}
+
+bool DeferredRenderEngine::initialize(VulkanInitRenderParams *params) {
+    if(!VulkanRenderEngine::initialize(params)) { return false; }
+
+    DeferredRenderParams *deferredParams = static_cast<DeferredRenderParams*>(params);
+
+    // Full-screen lighting pipeline (second subpass)
+    VulkanPipelineOptions lightOptions;
+    lightOptions.depthTest = false;
+    lightOptions.depthWrite = false;
+    lightOptions.vertexInput = false;
+    lightOptions.subpass = 1;
+    lightingPipelineData = createVulkanPipelineData(this->renderPass,
+                                                    deferredParams->lightVertSPVFilename,
+                                                    deferredParams->lightFragSPVFilename,
+                                                    lightOptions);
+
+    // Uniform and storage buffers
+    deviceUBOGeometry = createVulkanUniformBufferData(  vkInitData.device, vkInitData.physicalDevice,
+                                                        sizeof(DeferredUBOGeometry), MAX_FRAMES_IN_FLIGHT);
+    deviceUBOLighting = createVulkanUniformBufferData(  vkInitData.device, vkInitData.physicalDevice,
+                                                        sizeof(DeferredUBOLighting), MAX_FRAMES_IN_FLIGHT);
+    deviceLights = createVulkanStorageBufferData(   vkInitData.device, vkInitData.physicalDevice,
+                                                    sizeof(ClusterLight) * MAX_LIGHTS, MAX_FRAMES_IN_FLIGHT);
+    deviceClusterRanges = createVulkanStorageBufferData(vkInitData.device, vkInitData.physicalDevice,
+                                                        sizeof(glm::uvec2) * getClusterCount(lightGrid),
+                                                        MAX_FRAMES_IN_FLIGHT);
+    deviceLightIndices = createVulkanStorageBufferData( vkInitData.device, vkInitData.physicalDevice,
+                                                        sizeof(unsigned int) * MAX_CLUSTER_LIGHT_INDICES,
+                                                        MAX_FRAMES_IN_FLIGHT);
+
+    // Per-instance buffers (grows on demand)
+    deviceInstances = createVulkanInstanceBuffer(vkInitData.device, vkInitData.physicalDevice,
+                                                 64, MAX_FRAMES_IN_FLIGHT);
+
+    // Descriptor pool
+    vector<vk::DescriptorPoolSize> poolSizes;
+    poolSizes.push_back(vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, 2 * MAX_FRAMES_IN_FLIGHT));
+    poolSizes.push_back(vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 3 * MAX_FRAMES_IN_FLIGHT));
+    poolSizes.push_back(vk::DescriptorPoolSize(vk::DescriptorType::eInputAttachment,
+                                               (GBUFFER_CNT + 1) * MAX_FRAMES_IN_FLIGHT));
+
+    vk::DescriptorPoolCreateInfo poolCreateInfo;
+    poolCreateInfo.setPoolSizes(poolSizes);
+    poolCreateInfo.setMaxSets(MAX_FRAMES_IN_FLIGHT);
+    descriptorPool = createVulkanDescriptorPool(vkInitData.device, poolCreateInfo);
+
+    // One set per frame in flight (same layout for both subpasses)
+    vector<vk::DescriptorSetLayout> localLayoutList(MAX_FRAMES_IN_FLIGHT, pipelineData.descriptorSetLayouts[0]);
+
+    vk::DescriptorSetAllocateInfo allocInfo;
+    allocInfo.setDescriptorPool(descriptorPool);
+    allocInfo.setSetLayouts(localLayoutList);
+    descriptorSets = vkInitData.device.allocateDescriptorSets(allocInfo);
+
+    for(int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        vk::DescriptorBufferInfo geometryInfo(deviceUBOGeometry.bufferData[i].buffer, 0, sizeof(DeferredUBOGeometry));
+        vk::DescriptorBufferInfo lightingInfo(deviceUBOLighting.bufferData[i].buffer, 0, sizeof(DeferredUBOLighting));
+        vk::DescriptorBufferInfo lightInfo(deviceLights.bufferData[i].buffer, 0, VK_WHOLE_SIZE);
+        vk::DescriptorBufferInfo rangeInfo(deviceClusterRanges.bufferData[i].buffer, 0, VK_WHOLE_SIZE);
+        vk::DescriptorBufferInfo indexInfo(deviceLightIndices.bufferData[i].buffer, 0, VK_WHOLE_SIZE);
+
+        vector<vk::WriteDescriptorSet> writes;
+        writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 0, 0,
+                            vk::DescriptorType::eUniformBuffer, {}, geometryInfo));
+        writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 1, 0,
+                            vk::DescriptorType::eUniformBuffer, {}, lightingInfo));
+        writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 2, 0,
+                            vk::DescriptorType::eStorageBuffer, {}, lightInfo));
+        writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 3, 0,
+                            vk::DescriptorType::eStorageBuffer, {}, rangeInfo));
+        writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 4, 0,
+                            vk::DescriptorType::eStorageBuffer, {}, indexInfo));
+        vkInitData.device.updateDescriptorSets(writes, {});
+    }
+
+    // G-buffer images already exist (created with the framebuffers)
+    updateInputAttachmentDescriptors();
+
+    // Geometry draws go through the render queue
+    gBufferPipelineID = renderQueue.addPipeline(pipelineData.graphicsPipeline);
+
+    VulkanQueueMaterial material;
+    material.pipelineLayout = pipelineData.pipelineLayout;
+    material.firstSet = 0;
+    material.descriptorSets = descriptorSets;
+    materialID = renderQueue.addMaterial(material);
+
+    renderQueue.setDepthRange(lightGrid.nearZ, lightGrid.farZ);
+    return true;
+}
+
+DeferredRenderEngine::~DeferredRenderEngine() {
+    if(initialized) {
+        cleanupVulkanDescriptorPool(vkInitData.device, descriptorPool);
+        cleanupVulkanUniformBufferData(vkInitData.device, deviceUBOGeometry);
+        cleanupVulkanUniformBufferData(vkInitData.device, deviceUBOLighting);
+        cleanupVulkanUniformBufferData(vkInitData.device, deviceLights);
+        cleanupVulkanUniformBufferData(vkInitData.device, deviceClusterRanges);
+        cleanupVulkanUniformBufferData(vkInitData.device, deviceLightIndices);
+        cleanupVulkanInstanceBuffer(vkInitData.device, deviceInstances);
+        cleanupVulkanPipelineData(lightingPipelineData);
+
+        // Base destructor can't reach our override, so release G-buffer here
+        cleanupVulkanFramebuffers(this->framebuffers);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Getters
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderQueue& DeferredRenderEngine::getRenderQueue() {
+    return renderQueue;
+}
+
+unsigned int DeferredRenderEngine::getGBufferPipelineID() {
+    return gBufferPipelineID;
+}
+
+unsigned int DeferredRenderEngine::getMaterialID() {
+    return materialID;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Render pass (two subpasses)
+///////////////////////////////////////////////////////////////////////////////
+
+static const vk::Format GBUFFER_FORMATS[GBUFFER_CNT] = {
+    vk::Format::eA2B10G10R10UnormPack32,
+    vk::Format::eR8G8B8A8Unorm,
+    vk::Format::eR8G8Unorm
+};
+
+vk::RenderPass DeferredRenderEngine::createVulkanRenderPass(VulkanImage &depthImage) {
+    vector<vk::AttachmentDescription> attachmentDescriptions;
+
+    // 0: Swapchain color (only attachment that is stored)
+    attachmentDescriptions.push_back(vk::AttachmentDescription(
+        {},
+        vkInitData.swapchain.format,
+        vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eDontCare,    // Every pixel written by the lighting pass
+        vk::AttachmentStoreOp::eStore,
+        vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::ePresentSrcKHR
+    ));
+
+    // 1: Depth (written in subpass 0, read as input in subpass 1)
+    attachmentDescriptions.push_back(vk::AttachmentDescription(
+        {},
+        depthImage.format,
+        vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eClear,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eDepthStencilReadOnlyOptimal
+    ));
+
+    // 2+: G-buffer (never leaves the render pass)
+    for(unsigned int i = 0; i < GBUFFER_CNT; i++) {
+        attachmentDescriptions.push_back(vk::AttachmentDescription(
+            {},
+            GBUFFER_FORMATS[i],
+            vk::SampleCountFlagBits::e1,
+            vk::AttachmentLoadOp::eClear,
+            vk::AttachmentStoreOp::eDontCare,
+            vk::AttachmentLoadOp::eDontCare,
+            vk::AttachmentStoreOp::eDontCare,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eShaderReadOnlyOptimal
+        ));
+    }
+
+    // Subpass 0: geometry
+    vector<vk::AttachmentReference> gBufferWriteRefs;
+    for(unsigned int i = 0; i < GBUFFER_CNT; i++) {
+        gBufferWriteRefs.push_back(vk::AttachmentReference(2 + i, vk::ImageLayout::eColorAttachmentOptimal));
+    }
+    vk::AttachmentReference depthWriteRef(1, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+    // Subpass 1: lighting (input_attachment_index follows this order; depth last)
+    vector<vk::AttachmentReference> gBufferReadRefs;
+    for(unsigned int i = 0; i < GBUFFER_CNT; i++) {
+        gBufferReadRefs.push_back(vk::AttachmentReference(2 + i, vk::ImageLayout::eShaderReadOnlyOptimal));
+    }
+    gBufferReadRefs.push_back(vk::AttachmentReference(1, vk::ImageLayout::eDepthStencilReadOnlyOptimal));
+    vk::AttachmentReference colorRef(0, vk::ImageLayout::eColorAttachmentOptimal);
+
+    vector<vk::SubpassDescription> subpasses;
+    subpasses.push_back(vk::SubpassDescription(
+        {}, vk::PipelineBindPoint::eGraphics,
+        {}, gBufferWriteRefs, {}, &depthWriteRef));
+    subpasses.push_back(vk::SubpassDescription(
+        {}, vk::PipelineBindPoint::eGraphics,
+        gBufferReadRefs, colorRef, {}, nullptr));
+
+    vector<vk::SubpassDependency> dependencies;
+
+    // Previous frame's lighting reads must finish before we overwrite the G-buffer
+    // (also orders the swapchain layout transition after image acquisition)
+    dependencies.push_back(vk::SubpassDependency(
+        VK_SUBPASS_EXTERNAL, 0,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests
+            | vk::PipelineStageFlagBits::eFragmentShader,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite));
+
+    // G-buffer writes -> input attachment reads (same pixel only, so stays on tile)
+    dependencies.push_back(vk::SubpassDependency(
+        0, 1,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::AccessFlagBits::eInputAttachmentRead,
+        vk::DependencyFlagBits::eByRegion));
+
+    return vkInitData.device.createRenderPass(vk::RenderPassCreateInfo(
+        {},
+        attachmentDescriptions,
+        subpasses,
+        dependencies
+    ));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Attributes and descriptor layout
+///////////////////////////////////////////////////////////////////////////////
+
+AttributeDescData DeferredRenderEngine::getAttributeDescData() {
+    AttributeDescData attribDescData;
+    attribDescData.bindDesc = vk::VertexInputBindingDescription(0, sizeof(DeferredVertex), vk::VertexInputRate::eVertex);
+
+    attribDescData.attribDesc.clear();
+    attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+        0, 0, vk::Format::eR32G32B32Sfloat, offsetof(DeferredVertex, pos)));
+    attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+        1, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(DeferredVertex, color)));
+    attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+        2, 0, vk::Format::eR32G32B32Sfloat, offsetof(DeferredVertex, normal)));
+
+    // Per-instance model matrix, normal matrix, and color
+    addInstanceAttributeDesc(attribDescData, INSTANCE_BINDING, 3);
+
+    return attribDescData;
+}
+
+vector<vk::DescriptorSetLayout> DeferredRenderEngine::getDescriptorSetLayouts() {
+    // Shared by both subpasses (geometry never touches the input attachments)
+    vector<vk::DescriptorSetLayoutBinding> allBindings;
+
+    // 0: Geometry UBO
+    allBindings.push_back(vk::DescriptorSetLayoutBinding(
+        0, vk::DescriptorType::eUniformBuffer, 1,
+        vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, nullptr));
+
+    // 1: Lighting UBO
+    allBindings.push_back(vk::DescriptorSetLayoutBinding(
+        1, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eFragment, nullptr));
+
+    // 2-4: Clustered lighting SSBOs (lights, cluster ranges, light indices)
+    for(unsigned int b = 2; b <= 4; b++) {
+        allBindings.push_back(vk::DescriptorSetLayoutBinding(
+            b, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eFragment, nullptr));
+    }
+
+    // 5+: G-buffer and depth input attachments
+    for(unsigned int i = 0; i <= GBUFFER_CNT; i++) {
+        allBindings.push_back(vk::DescriptorSetLayoutBinding(
+            5 + i, vk::DescriptorType::eInputAttachment, 1, vk::ShaderStageFlagBits::eFragment, nullptr));
+    }
+
+    vk::DescriptorSetLayout layout = vkInitData.device.createDescriptorSetLayout(
+        vk::DescriptorSetLayoutCreateInfo({}, allBindings));
+
+    return vector<vk::DescriptorSetLayout>{layout};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Framebuffers and G-buffer images
+///////////////////////////////////////////////////////////////////////////////
+
+vector<vk::Framebuffer> DeferredRenderEngine::createVulkanFramebuffers(
+                                                    vk::RenderPass &renderPass,
+                                                    VulkanImage &depthImage) {
+
+    vk::Extent2D extent = vkInitData.swapchain.extent;
+
+    // Transient: contents only live inside the render pass
+    gBufferImages.clear();
+    for(unsigned int i = 0; i < GBUFFER_CNT; i++) {
+        gBufferImages.push_back(createVulkanImage(  vkInitData, extent.width, extent.height,
+                                                    GBUFFER_FORMATS[i],
+                                                    vk::ImageUsageFlagBits::eColorAttachment
+                                                    | vk::ImageUsageFlagBits::eInputAttachment
+                                                    | vk::ImageUsageFlagBits::eTransientAttachment,
+                                                    vk::ImageAspectFlagBits::eColor));
+    }
+
+    vector<vk::Framebuffer> framebuffers;
+    framebuffers.resize(vkInitData.swapchain.views.size());
+
+    for(size_t i = 0; i < vkInitData.swapchain.views.size(); i++) {
+        vector<vk::ImageView> attachments = {   vkInitData.swapchain.views.at(i),
+                                                depthImage.view };
+        for(auto &image : gBufferImages) {
+            attachments.push_back(image.view);
+        }
+
+        framebuffers[i] = vkInitData.device.createFramebuffer(vk::FramebufferCreateInfo({},
+                                                    renderPass, attachments,
+                                                    extent.width, extent.height, 1));
+    }
+
+    // On swapchain recreation, point descriptors at the new images
+    if(!descriptorSets.empty()) {
+        updateInputAttachmentDescriptors();
+    }
+
+    return framebuffers;
+}
+
+void DeferredRenderEngine::cleanupVulkanFramebuffers(vector<vk::Framebuffer> &framebuffers) {
+    VulkanRenderEngine::cleanupVulkanFramebuffers(framebuffers);
+
+    for(auto &image : gBufferImages) {
+        cleanupVulkanImage(vkInitData, image);
+    }
+    gBufferImages.clear();
+}
+
+void DeferredRenderEngine::updateInputAttachmentDescriptors() {
+    for(unsigned int i = 0; i < descriptorSets.size(); i++) {
+        vector<vk::DescriptorImageInfo> imageInfos;
+        for(auto &image : gBufferImages) {
+            imageInfos.push_back(vk::DescriptorImageInfo({}, image.view, vk::ImageLayout::eShaderReadOnlyOptimal));
+        }
+        imageInfos.push_back(vk::DescriptorImageInfo({}, depthImage.view, vk::ImageLayout::eDepthStencilReadOnlyOptimal));
+
+        vector<vk::WriteDescriptorSet> writes;
+        for(unsigned int k = 0; k < imageInfos.size(); k++) {
+            writes.push_back(vk::WriteDescriptorSet(descriptorSets[i], 5 + k, 0,
+                                vk::DescriptorType::eInputAttachment, imageInfos[k]));
+        }
+        vkInitData.device.updateDescriptorSets(writes, {});
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Per-frame data and recording
+///////////////////////////////////////////////////////////////////////////////
+
+void DeferredRenderEngine::updateUniformBuffers(DeferredSceneData *sceneData) {
+    vk::Extent2D extent = vkInitData.swapchain.extent;
+
+    // Geometry UBO (invert Y for Vulkan)
+    hostUBOGeometry.viewMat = sceneData->viewMat;
+    hostUBOGeometry.projMat = sceneData->projMat;
+    hostUBOGeometry.projMat[1][1] *= -1;
+    hostUBOGeometry.material = glm::vec4(sceneData->metallic, sceneData->roughness, 0.0f, 0.0f);
+    memcpy(deviceUBOGeometry.mapped[this->currentImage], &hostUBOGeometry, sizeof(hostUBOGeometry));
+
+    // Bin lights (CPU) exactly like the clustered forward path
+    unsigned int lightCnt = min((unsigned int)sceneData->lights.size(), MAX_LIGHTS);
+    vector<ClusterLight> lights(sceneData->lights.begin(), sceneData->lights.begin() + lightCnt);
+    buildLightClusters(lightGrid, lights, hostUBOGeometry.projMat, MAX_CLUSTER_LIGHT_INDICES);
+
+    memcpy(deviceLights.mapped[this->currentImage], lights.data(), sizeof(ClusterLight) * lights.size());
+    memcpy(deviceClusterRanges.mapped[this->currentImage], lightGrid.ranges.data(),
+           sizeof(glm::uvec2) * lightGrid.ranges.size());
+    memcpy(deviceLightIndices.mapped[this->currentImage], lightGrid.indices.data(),
+           sizeof(unsigned int) * lightGrid.indices.size());
+
+    // Lighting UBO
+    glm::vec2 sliceScaleBias = getClusterSliceScaleBias(lightGrid);
+    hostUBOLighting.invProjMat = glm::inverse(hostUBOGeometry.projMat);
+    hostUBOLighting.clusterDims = glm::uvec4(lightGrid.dimX, lightGrid.dimY, lightGrid.dimZ, lightCnt);
+    hostUBOLighting.clusterParams = glm::vec4(  sliceScaleBias.x, sliceScaleBias.y,
+                                                float(extent.width) / lightGrid.dimX,
+                                                float(extent.height) / lightGrid.dimY);
+    hostUBOLighting.screenParams = glm::vec4(   extent.width, extent.height,
+                                                1.0f / extent.width, 1.0f / extent.height);
+    hostUBOLighting.clearColor = sceneData->clearColor;
+    memcpy(deviceUBOLighting.mapped[this->currentImage], &hostUBOLighting, sizeof(hostUBOLighting));
+}
+
+void DeferredRenderEngine::recordCommandBuffer( void *userData,
+                                                vk::CommandBuffer &commandBuffer,
+                                                unsigned int frameIndex) {
+
+    DeferredSceneData *sceneData = static_cast<DeferredSceneData*>(userData);
+
+    // Safe to touch this frame's buffers (drawFrame waited on its fence)
+    updateUniformBuffers(sceneData);
+    renderQueue.upload(vkInitData.device, vkInitData.physicalDevice, deviceInstances, this->currentImage);
+
+    commandBuffer.begin(vk::CommandBufferBeginInfo());
+
+    vk::Extent2D extent = vkInitData.swapchain.extent;
+
+    // Color, depth, then G-buffer
+    array<vk::ClearValue, 2 + GBUFFER_CNT> clearValues {};
+    clearValues[0].color = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f);
+    clearValues[1].depthStencil = vk::ClearDepthStencilValue(1.0f, 0.0f);
+    for(unsigned int i = 0; i < GBUFFER_CNT; i++) {
+        clearValues[2 + i].color = vk::ClearColorValue(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    commandBuffer.beginRenderPass(vk::RenderPassBeginInfo(
+        this->renderPass,
+        this->framebuffers[frameIndex],
+        { {0,0}, extent },
+        clearValues),
+        vk::SubpassContents::eInline);
+
+    vk::Viewport viewports[] = {{0, 0, (float)extent.width, (float)extent.height, 0.0f, 1.0f}};
+    commandBuffer.setViewport(0, viewports);
+
+    vk::Rect2D scissors[] = {{{0,0}, extent}};
+    commandBuffer.setScissor(0, scissors);
+
+    // SUBPASS 0: Geometry (sorted, instanced draws)
+    renderQueue.record(commandBuffer, deviceInstances, this->currentImage, INSTANCE_BINDING);
+
+    // SUBPASS 1: Lighting, once per pixel
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, lightingPipelineData.graphicsPipeline);
+    commandBuffer.bindDescriptorSets(   vk::PipelineBindPoint::eGraphics,
+                                        lightingPipelineData.pipelineLayout,
+                                        0, descriptorSets[this->currentImage], {});
+    commandBuffer.draw(3, 1, 0, 0);
+
+    commandBuffer.endRenderPass();
+    commandBuffer.end();
+}
@@ -0,0 +1,168 @@
+#include "VKDynamicResolution.hpp"
+#include <cmath>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanDynamicResolution createVulkanDynamicResolution(  VulkanInitData &vkInitData,
+                                                        unsigned int width, unsigned int height,
+                                                        DynamicResolutionSettings settings) {
+    VulkanDynamicResolution dr;
+    dr.settings = settings;
+    dr.settings.maxScale = min(settings.maxScale, 1.0f);
+    dr.settings.minScale = min(max(settings.minScale, 0.1f), dr.settings.maxScale);
+    dr.scale = dr.settings.maxScale;
+    dr.width = max(width, 1u);
+    dr.height = max(height, 1u);
+
+    dr.color = createVulkanImage(vkInitData, dr.width, dr.height, vkInitData.swapchain.format,
+                                 vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                                 vk::ImageAspectFlagBits::eColor);
+
+    // Target and swapchain share the format (both optimal tiling)
+    vk::FormatFeatureFlags features = vkInitData.physicalDevice.getFormatProperties(
+        vkInitData.swapchain.format).optimalTilingFeatures;
+    dr.blitSupported = (features & vk::FormatFeatureFlagBits::eBlitSrc)
+                       && (features & vk::FormatFeatureFlagBits::eBlitDst);
+    dr.blitFilter = (features & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)
+                    ? vk::Filter::eLinear : vk::Filter::eNearest;
+
+    if(!dr.blitSupported) {
+        cout << "WARNING: Swapchain format cannot be blitted; dynamic resolution stays at full resolution." << endl;
+        dr.settings.minScale = dr.settings.maxScale = dr.scale = 1.0f;
+    }
+    else if(dr.blitFilter != vk::Filter::eLinear) {
+        cout << "WARNING: Swapchain format cannot be filtered; dynamic resolution upscales with nearest filtering." << endl;
+    }
+
+    return dr;
+}
+
+void cleanupVulkanDynamicResolution(VulkanInitData &vkInitData, VulkanDynamicResolution &dr) {
+    cleanupVulkanImage(vkInitData, dr.color);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scale controller
+///////////////////////////////////////////////////////////////////////////////
+
+vk::Extent2D getDynamicResolutionExtent(VulkanDynamicResolution &dr) {
+    float scale = dr.enabled ? dr.scale : dr.settings.maxScale;
+    unsigned int w = (unsigned int)(dr.width * scale + 0.5f);
+    unsigned int h = (unsigned int)(dr.height * scale + 0.5f);
+    return vk::Extent2D(min(max(w, 1u), dr.width), min(max(h, 1u), dr.height));
+}
+
+void updateDynamicResolution(VulkanDynamicResolution &dr, float frameTime) {
+    DynamicResolutionSettings &s = dr.settings;
+    if(frameTime <= 0.0f) {
+        return;
+    }
+
+    dr.smoothedFrameTime = (dr.smoothedFrameTime <= 0.0f) ? frameTime
+                         : dr.smoothedFrameTime + s.smoothing * (frameTime - dr.smoothedFrameTime);
+
+    if(!dr.enabled || ++dr.framesSinceAdjust < s.adjustInterval) {
+        return;
+    }
+    dr.framesSinceAdjust = 0;
+
+    // Dead band between target * headroom and target avoids oscillation
+    if(dr.smoothedFrameTime <= s.targetFrameTime && dr.smoothedFrameTime >= s.targetFrameTime * s.headroom) {
+        return;
+    }
+
+    float desired = dr.scale * sqrt(s.targetFrameTime / dr.smoothedFrameTime);
+    desired = min(max(desired, dr.scale - s.maxStep), dr.scale + s.maxStep);
+    desired = min(max(desired, s.minScale), s.maxScale);
+
+    // Ignore tiny changes (each one shifts the image slightly)
+    if(fabs(desired - dr.scale) >= 0.01f) {
+        dr.scale = desired;
+        dr.adjustCnt++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+void recordDynamicResolutionUpscale(vk::CommandBuffer &commandBuffer, VulkanDynamicResolution &dr,
+                                    vk::Extent2D renderExtent,
+                                    vk::Image swapchainImage, vk::Extent2D swapchainExtent) {
+    recordUpscaleToSwapchain(commandBuffer, dr, dr.color.image, 1, renderExtent, swapchainImage, swapchainExtent);
+}
+
+void recordUpscaleToSwapchain(  vk::CommandBuffer &commandBuffer, VulkanDynamicResolution &dr,
+                                vk::Image srcImage, unsigned int layerCnt, vk::Extent2D renderExtent,
+                                vk::Image swapchainImage, vk::Extent2D swapchainExtent) {
+    vk::ImageSubresourceRange srcRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, layerCnt);
+    vk::ImageSubresourceRange dstRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+
+    // Source: rendered -> blit source; swapchain: (acquired) -> blit destination
+    // (swapchain barrier starts at color output, where the acquire semaphore waits)
+    vk::ImageMemoryBarrier toTransfer[2] = {
+        vk::ImageMemoryBarrier(
+            vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead,
+            vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage, srcRange),
+        vk::ImageMemoryBarrier(
+            {}, vk::AccessFlagBits::eTransferWrite,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, swapchainImage, dstRange)
+    };
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer,
+        {}, {}, {}, toTransfer);
+
+    // One column per layer
+    vector<vk::ImageBlit> blits;
+    vector<vk::ImageCopy> copies;
+    for(unsigned int layer = 0; layer < layerCnt; layer++) {
+        int x0 = int(swapchainExtent.width * layer / layerCnt);
+        int x1 = int(swapchainExtent.width * (layer + 1) / layerCnt);
+        vk::ImageSubresourceLayers srcLayer(vk::ImageAspectFlagBits::eColor, 0, layer, 1);
+        vk::ImageSubresourceLayers dstLayer(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+        if(dr.blitSupported) {
+            blits.push_back(vk::ImageBlit(
+                srcLayer, { vk::Offset3D(0, 0, 0), vk::Offset3D(renderExtent.width, renderExtent.height, 1) },
+                dstLayer, { vk::Offset3D(x0, 0, 0), vk::Offset3D(x1, swapchainExtent.height, 1) }));
+        }
+        else {
+            // No scaling possible: copy what fits (the same size at full resolution)
+            copies.push_back(vk::ImageCopy(
+                srcLayer, vk::Offset3D(0, 0, 0), dstLayer, vk::Offset3D(x0, 0, 0),
+                vk::Extent3D(min(renderExtent.width, unsigned(x1 - x0)),
+                             min(renderExtent.height, swapchainExtent.height), 1)));
+        }
+    }
+    if(dr.blitSupported) {
+        commandBuffer.blitImage(srcImage, vk::ImageLayout::eTransferSrcOptimal,
+                                swapchainImage, vk::ImageLayout::eTransferDstOptimal,
+                                blits, dr.blitFilter);
+    }
+    else {
+        commandBuffer.copyImage(srcImage, vk::ImageLayout::eTransferSrcOptimal,
+                                swapchainImage, vk::ImageLayout::eTransferDstOptimal, copies);
+    }
+
+    // Swapchain -> present; source back to attachment (next frame's pass
+    // must not overwrite it before the blit has read it)
+    vk::ImageMemoryBarrier toPresent(
+        vk::AccessFlagBits::eTransferWrite, {},
+        vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, swapchainImage, dstRange);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+        {}, {}, {}, toPresent);
+
+    vk::ImageMemoryBarrier toAttachment(
+        vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eColorAttachmentWrite,
+        vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eColorAttachmentOptimal,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage, srcRange);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        {}, {}, {}, toAttachment);
+}
@@ -0,0 +1,382 @@
+#include "VKFrameCapture.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+///////////////////////////////////////////////////////////////////////////////
+
+static bool isFrameCaptureFormatSupported(vk::Format format, bool &bgra) {
+    switch(format) {
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+            bgra = true;
+            return true;
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+            bgra = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The encoders read every byte back: cached memory if there is any
+static vk::MemoryPropertyFlags getReadbackMemoryProperties(vk::PhysicalDevice &physicalDevice) {
+    vk::MemoryPropertyFlags cached = vk::MemoryPropertyFlagBits::eHostVisible
+                                     | vk::MemoryPropertyFlagBits::eHostCoherent
+                                     | vk::MemoryPropertyFlagBits::eHostCached;
+    vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice.getMemoryProperties();
+    for(unsigned int i = 0; i < memProperties.memoryTypeCount; i++) {
+        if((memProperties.memoryTypes[i].propertyFlags & cached) == cached) {
+            return cached;
+        }
+    }
+    return vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+}
+
+static void createFrameCaptureSlotBuffer(VulkanInitData &vkInitData, FrameCaptureSlot &slot, vk::DeviceSize size) {
+    slot.buffer = createVulkanBuffer(vkInitData.physicalDevice, vkInitData.device, size,
+                                     vk::BufferUsageFlagBits::eTransferDst,
+                                     getReadbackMemoryProperties(vkInitData.physicalDevice));
+    slot.mapped = vkInitData.device.mapMemory(slot.buffer.memory, 0, size);
+    slot.capacity = size;
+}
+
+static void cleanupFrameCaptureSlotBuffer(VulkanInitData &vkInitData, FrameCaptureSlot &slot) {
+    if(slot.capacity == 0) {
+        return;
+    }
+    vkInitData.device.unmapMemory(slot.buffer.memory);
+    cleanupVulkanBuffer(vkInitData.device, slot.buffer);
+    slot.mapped = nullptr;
+    slot.capacity = 0;
+}
+
+static FrameCaptureFormat getFrameCaptureFormat(const string &filename) {
+    string ext = filename.substr(min(filename.size(), filename.find_last_of('.')));
+    transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return (ext == ".jpg" || ext == ".jpeg") ? FRAME_CAPTURE_JPG : FRAME_CAPTURE_PNG;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Encoder threads
+///////////////////////////////////////////////////////////////////////////////
+
+static void runFrameCaptureEncoder(FrameCaptureQueue *queue) {
+    vector<unsigned char> rgb;
+
+    while(true) {
+        FrameCaptureSlot *slot = nullptr;
+        int jpgQuality = 90;
+        {
+            unique_lock<mutex> lock(queue->lock);
+            queue->wake.wait(lock, [queue]() { return queue->stopping || !queue->jobs.empty(); });
+            if(queue->jobs.empty()) {
+                return;
+            }
+            slot = &queue->slots[queue->jobs.front()];
+            queue->jobs.pop_front();
+            queue->activeCnt++;
+            jpgQuality = queue->jpgQuality;
+        }
+
+        // Swizzle to RGB (alpha of a swapchain image is meaningless)
+        unsigned int width = slot->width;
+        unsigned int height = slot->height;
+        FrameCaptureFormat format = slot->format;
+        string filename = slot->filename;
+        unsigned int r = slot->bgra ? 2 : 0;
+        unsigned int b = slot->bgra ? 0 : 2;
+
+        rgb.resize(size_t(width) * height * 3);
+        const unsigned char *src = static_cast<const unsigned char*>(slot->mapped);
+        unsigned char *dst = rgb.data();
+        for(size_t i = 0, cnt = size_t(width) * height; i < cnt; i++, src += 4, dst += 3) {
+            dst[0] = src[r];
+            dst[1] = src[1];
+            dst[2] = src[b];
+        }
+
+        // Buffer can take the next copy while this one is compressed
+        {
+            lock_guard<mutex> lock(queue->lock);
+            slot->state = FRAME_CAPTURE_SLOT_FREE;
+        }
+
+        int ok = 0;
+        if(format == FRAME_CAPTURE_JPG) {
+            ok = stbi_write_jpg(filename.c_str(), width, height, 3, rgb.data(), jpgQuality);
+        }
+        else {
+            ok = stbi_write_png(filename.c_str(), width, height, 3, rgb.data(), width * 3);
+        }
+        if(!ok) {
+            cerr << "Frame capture: could not write " << filename << endl;
+        }
+
+        {
+            lock_guard<mutex> lock(queue->lock);
+            queue->activeCnt--;
+            if(ok) {
+                queue->writtenCnt++;
+            }
+            else {
+                queue->failedCnt++;
+            }
+        }
+        queue->idle.notify_all();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanFrameCapture createVulkanFrameCapture(VulkanInitData &vkInitData,
+                                            unsigned int slotCnt,
+                                            unsigned int encoderCnt) {
+    VulkanFrameCapture capture;
+    capture.format = vkInitData.swapchain.format;
+    capture.queue = make_unique<FrameCaptureQueue>();
+
+    bool bgra = false;
+    if(!isFrameCaptureFormatSupported(capture.format, bgra)) {
+        cout << "Frame capture unavailable: swapchain format is not 8-bit RGBA/BGRA." << endl;
+        return capture;
+    }
+    if(!(vkInitData.swapchain.usage & vk::ImageUsageFlagBits::eTransferSrc)) {
+        cout << "Frame capture unavailable: swapchain images cannot be a transfer source." << endl;
+        return capture;
+    }
+    capture.supported = true;
+
+    // Allocated up front so the first capture does not hitch
+    vk::DeviceSize size = vk::DeviceSize(vkInitData.swapchain.extent.width) * vkInitData.swapchain.extent.height * 4;
+    capture.queue->slots.resize(max(slotCnt, 1u));
+    for(auto &slot : capture.queue->slots) {
+        createFrameCaptureSlotBuffer(vkInitData, slot, size);
+    }
+
+    if(encoderCnt == 0) {
+        encoderCnt = min(max(thread::hardware_concurrency() / 2, 1u), 4u);
+    }
+    for(unsigned int i = 0; i < encoderCnt; i++) {
+        capture.queue->encoders.push_back(thread(runFrameCaptureEncoder, capture.queue.get()));
+    }
+
+    return capture;
+}
+
+void cleanupVulkanFrameCapture(VulkanInitData &vkInitData, VulkanFrameCapture &capture) {
+    if(!capture.queue) {
+        return;
+    }
+
+    flushVulkanFrameCapture(capture);
+    {
+        lock_guard<mutex> lock(capture.queue->lock);
+        capture.queue->stopping = true;
+    }
+    capture.queue->wake.notify_all();
+    for(auto &encoder : capture.queue->encoders) {
+        encoder.join();
+    }
+
+    for(auto &slot : capture.queue->slots) {
+        cleanupFrameCaptureSlotBuffer(vkInitData, slot);
+    }
+    capture.queue.reset();
+    capture.supported = false;
+    capture.recording = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Requests
+///////////////////////////////////////////////////////////////////////////////
+
+void captureNextVulkanFrame(VulkanFrameCapture &capture, const string &filename) {
+    capture.nextFilename = filename;
+}
+
+void startVulkanFrameRecording( VulkanFrameCapture &capture, const string &prefix,
+                                FrameCaptureFormat format) {
+    capture.recording = true;
+    capture.recordPrefix = prefix;
+    capture.recordFormat = format;
+    capture.recordFrameCnt = 0;
+}
+
+void stopVulkanFrameRecording(VulkanFrameCapture &capture) {
+    capture.recording = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Per frame
+///////////////////////////////////////////////////////////////////////////////
+
+void beginVulkanFrameCapture(VulkanFrameCapture &capture, unsigned int frameSlot) {
+    if(!capture.queue) {
+        return;
+    }
+
+    bool queued = false;
+    {
+        lock_guard<mutex> lock(capture.queue->lock);
+        for(unsigned int i = 0; i < capture.queue->slots.size(); i++) {
+            FrameCaptureSlot &slot = capture.queue->slots[i];
+            if(slot.state == FRAME_CAPTURE_SLOT_IN_FLIGHT && slot.frameSlot == frameSlot) {
+                slot.state = FRAME_CAPTURE_SLOT_ENCODING;
+                capture.queue->jobs.push_back(i);
+                queued = true;
+            }
+        }
+    }
+    if(queued) {
+        capture.queue->wake.notify_all();
+    }
+}
+
+bool recordVulkanFrameCapture(  VulkanInitData &vkInitData, VulkanFrameCapture &capture,
+                                vk::CommandBuffer &commandBuffer, unsigned int frameSlot,
+                                vk::Image image, vk::Extent2D extent,
+                                vk::ImageLayout layout) {
+    // Anything requested for this frame?
+    string filename;
+    FrameCaptureFormat format = FRAME_CAPTURE_PNG;
+    if(!capture.nextFilename.empty()) {
+        filename = capture.nextFilename;
+        format = getFrameCaptureFormat(filename);
+        capture.nextFilename.clear();
+    }
+    else if(capture.recording) {
+        ostringstream name;
+        name << capture.recordPrefix << "_" << setw(6) << setfill('0') << capture.recordFrameCnt++
+             << ((capture.recordFormat == FRAME_CAPTURE_JPG) ? ".jpg" : ".png");
+        filename = name.str();
+        format = capture.recordFormat;
+    }
+    else {
+        return false;
+    }
+
+    capture.requestedCnt++;
+    if(!capture.supported || extent.width == 0 || extent.height == 0) {
+        capture.droppedCnt++;
+        return false;
+    }
+
+    // Never wait for a buffer: drop the frame instead
+    FrameCaptureSlot *slot = nullptr;
+    {
+        lock_guard<mutex> lock(capture.queue->lock);
+        for(auto &s : capture.queue->slots) {
+            if(s.state == FRAME_CAPTURE_SLOT_FREE) {
+                slot = &s;
+                slot->state = FRAME_CAPTURE_SLOT_IN_FLIGHT;
+                break;
+            }
+        }
+    }
+    if(!slot) {
+        capture.droppedCnt++;
+        return false;
+    }
+
+    // Swapchain grew since the buffer was made
+    vk::DeviceSize size = vk::DeviceSize(extent.width) * extent.height * 4;
+    if(slot->capacity < size) {
+        cleanupFrameCaptureSlotBuffer(vkInitData, *slot);
+        createFrameCaptureSlotBuffer(vkInitData, *slot, size);
+    }
+
+    isFrameCaptureFormatSupported(capture.format, slot->bgra);
+    slot->frameSlot = frameSlot;
+    slot->width = extent.width;
+    slot->height = extent.height;
+    slot->format = format;
+    slot->filename = filename;
+
+    // Whatever wrote the image last (render pass or blit) -> transfer source
+    vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+    vk::ImageMemoryBarrier toTransfer(
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eTransferRead,
+        layout, vk::ImageLayout::eTransferSrcOptimal,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, range);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eTransfer,
+        {}, {}, {}, toTransfer);
+
+    // Tightly packed rows
+    vk::BufferImageCopy region(
+        0, 0, 0,
+        vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+        vk::Offset3D(0, 0, 0), vk::Extent3D(extent.width, extent.height, 1));
+    commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, slot->buffer.buffer, region);
+
+    // Copy visible to the host (after the fence); image back where it was
+    vk::BufferMemoryBarrier toHost(
+        vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, slot->buffer.buffer, 0, size);
+    vk::ImageMemoryBarrier toLayout(
+        vk::AccessFlagBits::eTransferRead, {},
+        vk::ImageLayout::eTransferSrcOptimal, layout,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, range);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eBottomOfPipe,
+        {}, {}, toHost, toLayout);
+
+    return true;
+}
+
+void flushVulkanFrameCapture(VulkanFrameCapture &capture) {
+    if(!capture.queue) {
+        return;
+    }
+
+    FrameCaptureQueue &queue = *capture.queue;
+    {
+        lock_guard<mutex> lock(queue.lock);
+        for(unsigned int i = 0; i < queue.slots.size(); i++) {
+            if(queue.slots[i].state == FRAME_CAPTURE_SLOT_IN_FLIGHT) {
+                queue.slots[i].state = FRAME_CAPTURE_SLOT_ENCODING;
+                queue.jobs.push_back(i);
+            }
+        }
+    }
+    queue.wake.notify_all();
+
+    unique_lock<mutex> lock(queue.lock);
+    if(queue.encoders.empty()) {
+        return;
+    }
+    queue.idle.wait(lock, [&queue]() { return queue.jobs.empty() && queue.activeCnt == 0; });
+}
+
+FrameCaptureStats getVulkanFrameCaptureStats(VulkanFrameCapture &capture) {
+    FrameCaptureStats stats;
+    stats.requestedCnt = capture.requestedCnt;
+    stats.droppedCnt = capture.droppedCnt;
+    if(!capture.queue) {
+        return stats;
+    }
+
+    // In flight + queued + being encoded (slots are freed before compression)
+    lock_guard<mutex> lock(capture.queue->lock);
+    stats.writtenCnt = capture.queue->writtenCnt;
+    stats.failedCnt = capture.queue->failedCnt;
+    for(auto &slot : capture.queue->slots) {
+        if(slot.state == FRAME_CAPTURE_SLOT_IN_FLIGHT) {
+            stats.pendingCnt++;
+        }
+    }
+    stats.pendingCnt += capture.queue->jobs.size() + capture.queue->activeCnt;
+    return stats;
+}
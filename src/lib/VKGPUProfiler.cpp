@@ -0,0 +1,519 @@
+#include "VKGPUProfiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+const unsigned int GPU_PROFILER_CALIB_INTERVAL = 120;    // Reads between calibrations
+
+// Result order follows the bit order (same order as GPUPipelineStats)
+const vk::QueryPipelineStatisticFlags GPU_PIPELINE_STATS_FLAGS =
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+
+///////////////////////////////////////////////////////////////////////////////
+// Clock calibration
+///////////////////////////////////////////////////////////////////////////////
+
+// Host time domain that shares steady_clock's source
+#ifdef _WIN32
+static const VkTimeDomainEXT STEADY_HOST_DOMAIN = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+static const VkTimeDomainEXT STEADY_HOST_DOMAIN = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+
+// Host domain value -> raw steady_clock ns
+static uint64_t getSteadyHostNs(uint64_t hostValue) {
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    uint64_t f = uint64_t(freq.QuadPart);
+    return (hostValue / f) * 1000000000ull + (hostValue % f) * 1000000000ull / f;
+#else
+    return hostValue;
+#endif
+}
+
+static void setupGPUProfilerCalibration(VulkanInitData &vkInitData, VulkanGPUProfiler &profiler) {
+    if(!isVulkanDeviceExtensionEnabled(vkInitData, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+        return;
+    }
+
+    auto getTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+        vkGetInstanceProcAddr(vkInitData.instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+    profiler.getCalibratedTimestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+        vkGetDeviceProcAddr(vkInitData.device, "vkGetCalibratedTimestampsEXT"));
+    if(!getTimeDomains || !profiler.getCalibratedTimestamps) {
+        return;
+    }
+
+    uint32_t domainCnt = 0;
+    getTimeDomains(vkInitData.physicalDevice, &domainCnt, nullptr);
+    vector<VkTimeDomainEXT> domains(domainCnt);
+    getTimeDomains(vkInitData.physicalDevice, &domainCnt, domains.data());
+
+    bool hasDevice = false;
+    for(auto domain : domains) {
+        hasDevice = hasDevice || (domain == VK_TIME_DOMAIN_DEVICE_EXT);
+        profiler.calibHostDomainValid = profiler.calibHostDomainValid || (domain == STEADY_HOST_DOMAIN);
+    }
+    profiler.calibrated = hasDevice;
+    profiler.calibHostDomain = STEADY_HOST_DOMAIN;
+}
+
+// Anchors GPU ticks to CPU profiler time with one calibrated sample: the
+// host timestamp if its domain maps to steady_clock (and agrees with the
+// bracketing CPU times), the middle of the call otherwise
+static bool calibrateGPUProfiler(vk::Device &device, VulkanGPUProfiler &profiler) {
+    VkCalibratedTimestampInfoEXT infos[2] = {};
+    infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[1].timeDomain = profiler.calibHostDomain;
+    uint32_t infoCnt = profiler.calibHostDomainValid ? 2 : 1;
+
+    uint64_t timestamps[2] = {};
+    uint64_t maxDeviation = 0;
+    uint64_t beforeNs = getCPUProfilerTimeNs();
+    VkResult result = profiler.getCalibratedTimestamps(device, infoCnt, infos, timestamps, &maxDeviation);
+    uint64_t afterNs = getCPUProfilerTimeNs();
+    if(result != VK_SUCCESS) {
+        return false;
+    }
+
+    uint64_t cpuNs = beforeNs + (afterNs - beforeNs) / 2;
+    if(profiler.calibHostDomainValid) {
+        int64_t hostNs = int64_t(getSteadyHostNs(timestamps[1]) - getCPUProfilerEpochNs());
+        if(hostNs >= int64_t(beforeNs) - 1000000 && hostNs <= int64_t(afterNs) + 1000000) {
+            cpuNs = uint64_t(max<int64_t>(hostNs, 0));
+        }
+    }
+
+    profiler.calibTicks = timestamps[0] & profiler.timestampMask;
+    profiler.calibCPUNs = cpuNs;
+    profiler.calibValid = true;
+    return true;
+}
+
+// Signed tick distance from the anchor (timestamps may wrap at validBits)
+static int64_t getTicksSinceCalib(VulkanGPUProfiler &profiler, uint64_t ticks) {
+    uint64_t delta = (ticks - profiler.calibTicks) & profiler.timestampMask;
+    if(delta > (profiler.timestampMask >> 1)) {
+        return -int64_t((profiler.calibTicks - ticks) & profiler.timestampMask);
+    }
+    return int64_t(delta);
+}
+
+static int64_t getGPUTicksAsCPUNs(VulkanGPUProfiler &profiler, uint64_t ticks) {
+    return int64_t(profiler.calibCPUNs) + int64_t(double(getTicksSinceCalib(profiler, ticks)) * profiler.timestampPeriod);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanGPUProfiler createVulkanGPUProfiler(  VulkanInitData &vkInitData, unsigned int framesInFlight,
+                                            unsigned int maxScopes, unsigned int historySize) {
+    VulkanGPUProfiler profiler;
+    profiler.maxScopes = max(maxScopes, 1u);
+    profiler.historySize = max(historySize, 1u);
+    profiler.frames.resize(framesInFlight);
+
+    // Timestamps need support on the graphics queue family
+    vk::PhysicalDeviceProperties props = vkInitData.physicalDevice.getProperties();
+    vector<vk::QueueFamilyProperties> families = vkInitData.physicalDevice.getQueueFamilyProperties();
+    unsigned int validBits = families.at(vkInitData.graphicsQueue.index).timestampValidBits;
+    profiler.supported = (props.limits.timestampPeriod > 0.0f) && (validBits > 0);
+    profiler.timestampPeriod = props.limits.timestampPeriod;
+    profiler.timestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+
+    if(profiler.supported) {
+        profiler.queryPool = vkInitData.device.createQueryPool(vk::QueryPoolCreateInfo(
+            {}, vk::QueryType::eTimestamp, 2 * profiler.maxScopes * framesInFlight));
+        profiler.maxPendingEvents = 4 * profiler.maxScopes * framesInFlight;
+        setupGPUProfilerCalibration(vkInitData, profiler);
+
+        // Enabled by initVulkanBootstrap() when the device has it
+        profiler.pipelineStatsSupported = vkInitData.bootDevice.physical_device.features.pipelineStatisticsQuery;
+        if(profiler.pipelineStatsSupported) {
+            profiler.statsQueryPool = vkInitData.device.createQueryPool(vk::QueryPoolCreateInfo(
+                {}, vk::QueryType::ePipelineStatistics, profiler.maxScopes * framesInFlight,
+                GPU_PIPELINE_STATS_FLAGS));
+        }
+    }
+    else {
+        cout << "WARNING: GPU timestamps not supported; GPU profiler disabled." << endl;
+    }
+
+    return profiler;
+}
+
+void cleanupVulkanGPUProfiler(VulkanInitData &vkInitData, VulkanGPUProfiler &profiler) {
+    if(profiler.supported) {
+        vkInitData.device.destroyQueryPool(profiler.queryPool);
+    }
+    if(profiler.pipelineStatsSupported) {
+        vkInitData.device.destroyQueryPool(profiler.statsQueryPool);
+    }
+    profiler.frames.clear();
+    profiler.scopes.clear();
+    profiler.scopeIndices.clear();
+    profiler.pendingEvents.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Readback
+///////////////////////////////////////////////////////////////////////////////
+
+static void addGPUScopeSample(GPUProfilerScope &scope, float ms, unsigned int historySize) {
+    if(scope.history.size() < historySize) {
+        scope.history.resize(historySize, 0.0f);
+    }
+    scope.history[scope.next] = ms;
+    scope.next = (scope.next + 1) % historySize;
+    scope.sampleCnt = min(scope.sampleCnt + 1, historySize);
+    scope.lastMs = ms;
+}
+
+static void addGPUPipelineStats(GPUPipelineStats &total, const uint64_t *counts) {
+    total.iaVertices += counts[0];
+    total.iaPrimitives += counts[1];
+    total.vsInvocations += counts[2];
+    total.clipInvocations += counts[3];
+    total.clipPrimitives += counts[4];
+    total.fsInvocations += counts[5];
+}
+
+// Adds the slot's statistics queries to their scopes (per-frame totals)
+static void readGPUPipelineStats(vk::Device &device, VulkanGPUProfiler &profiler, GPUProfilerFrame &f,
+                                 unsigned int frame) {
+    if(find(f.statsPairs.begin(), f.statsPairs.end(), 1) == f.statsPairs.end()) {
+        return;
+    }
+
+    // Counters then availability per query; pairs without a query stay unavailable
+    const unsigned int STRIDE = GPU_PIPELINE_STATS_CNT + 1;
+    unsigned int queryCnt = f.scopeIDs.size();
+    vector<uint64_t> results(STRIDE * queryCnt, 0);
+    vk::Result result = device.getQueryPoolResults(
+        profiler.statsQueryPool, profiler.maxScopes * frame, queryCnt,
+        results.size() * sizeof(uint64_t), results.data(), STRIDE * sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+    if(result != vk::Result::eSuccess && result != vk::Result::eNotReady) {
+        return;
+    }
+
+    vector<GPUPipelineStats> frameTotals(profiler.scopes.size());
+    vector<unsigned char> hasStats(profiler.scopes.size(), 0);
+    for(unsigned int pair = 0; pair < queryCnt; pair++) {
+        uint64_t *counts = &results[STRIDE * pair];
+        if(!f.statsPairs[pair] || counts[GPU_PIPELINE_STATS_CNT] == 0) {
+            continue;
+        }
+        unsigned int scopeID = f.scopeIDs[pair];
+        addGPUPipelineStats(frameTotals[scopeID], counts);
+        hasStats[scopeID] = 1;
+    }
+
+    for(unsigned int i = 0; i < hasStats.size(); i++) {
+        if(hasStats[i]) {
+            GPUPipelineStats &t = frameTotals[i];
+            uint64_t counts[GPU_PIPELINE_STATS_CNT] = {
+                t.iaVertices, t.iaPrimitives, t.vsInvocations, t.clipInvocations, t.clipPrimitives, t.fsInvocations
+            };
+            addGPUPipelineStats(profiler.scopes[i].pipelineStatsTotal, counts);
+            profiler.scopes[i].pipelineStatsFrameCnt++;
+        }
+    }
+}
+
+bool readVulkanGPUProfiler(vk::Device &device, VulkanGPUProfiler &profiler, unsigned int frame) {
+    GPUProfilerFrame &f = profiler.frames.at(frame);
+    if(!profiler.supported || !f.written || f.scopeIDs.empty()) {
+        return false;
+    }
+    f.written = false;
+
+    // (value, availability) per query: scopes left open are just skipped
+    unsigned int queryCnt = 2 * f.scopeIDs.size();
+    vector<uint64_t> results(2 * queryCnt, 0);
+    vk::Result result = device.getQueryPoolResults(
+        profiler.queryPool, 2 * profiler.maxScopes * frame, queryCnt,
+        results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+    if(result != vk::Result::eSuccess && result != vk::Result::eNotReady) {
+        return false;
+    }
+
+    // Keep the clock mapping fresh (GPU and CPU clocks drift apart slowly)
+    bool tracing = profiler.tracing;
+    if(tracing && profiler.calibrated
+       && (!profiler.calibValid || ++profiler.readsSinceCalib >= GPU_PROFILER_CALIB_INTERVAL)) {
+        profiler.readsSinceCalib = 0;
+        calibrateGPUProfiler(device, profiler);
+    }
+
+    // Without calibration: the frame cannot start before its recording did
+    if(tracing && !profiler.calibrated && results[1] != 0) {
+        uint64_t firstTicks = results[0] & profiler.timestampMask;
+        if(!profiler.calibValid || getGPUTicksAsCPUNs(profiler, firstTicks) < int64_t(f.cpuBeginNs)) {
+            profiler.calibTicks = firstTicks;
+            profiler.calibCPUNs = f.cpuBeginNs;
+            profiler.calibValid = true;
+        }
+    }
+
+    // Scopes used more than once per frame report their total
+    vector<float> totals(profiler.scopes.size(), -1.0f);
+    for(unsigned int pair = 0; pair < f.scopeIDs.size(); pair++) {
+        uint64_t *begin = &results[4 * pair];
+        uint64_t *end = &results[4 * pair + 2];
+        if(begin[1] == 0 || end[1] == 0) {
+            continue;
+        }
+        uint64_t ticks = (end[0] - begin[0]) & profiler.timestampMask;
+        float ms = float(double(ticks) * profiler.timestampPeriod * 1e-6);
+
+        unsigned int scopeID = f.scopeIDs[pair];
+        totals[scopeID] = max(totals[scopeID], 0.0f) + ms;
+
+        if(tracing && profiler.calibValid) {
+            if(profiler.pendingEvents.size() >= profiler.maxPendingEvents) {
+                profiler.droppedEventCnt++;
+                continue;
+            }
+            GPUProfileEvent event;
+            event.scopeID = scopeID;
+            event.startNs = uint64_t(max<int64_t>(getGPUTicksAsCPUNs(profiler, begin[0] & profiler.timestampMask), 0));
+            event.durationNs = uint64_t(double(ticks) * profiler.timestampPeriod);
+            profiler.pendingEvents.push_back(event);
+        }
+    }
+
+    for(unsigned int i = 0; i < totals.size(); i++) {
+        if(totals[i] >= 0.0f) {
+            addGPUScopeSample(profiler.scopes[i], totals[i], profiler.historySize);
+        }
+    }
+
+    readGPUPipelineStats(device, profiler, f, frame);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+void recordGPUProfilerFrameBegin(vk::CommandBuffer &commandBuffer, VulkanGPUProfiler &profiler, unsigned int frame) {
+    GPUProfilerFrame &f = profiler.frames.at(frame);
+    f.scopeIDs.clear();
+    f.openPairs.clear();
+    f.statsPairs.clear();
+    f.statsOpenPair = -1;
+    f.written = false;
+
+    if(!profiler.supported || !profiler.enabled) {
+        return;
+    }
+    commandBuffer.resetQueryPool(profiler.queryPool, 2 * profiler.maxScopes * frame, 2 * profiler.maxScopes);
+    if(profiler.pipelineStatsSupported && profiler.pipelineStatsEnabled) {
+        commandBuffer.resetQueryPool(profiler.statsQueryPool, profiler.maxScopes * frame, profiler.maxScopes);
+    }
+    f.written = true;
+    f.cpuBeginNs = getCPUProfilerTimeNs();
+}
+
+void recordGPUScopeBegin(   vk::CommandBuffer &commandBuffer, VulkanGPUProfiler &profiler, unsigned int frame,
+                            const string &name, bool pipelineStats) {
+    GPUProfilerFrame &f = profiler.frames.at(frame);
+    if(!f.written) {
+        return;
+    }
+
+    // Still counts as open when full, so begin/end stay balanced
+    if(f.scopeIDs.size() >= profiler.maxScopes) {
+        f.openPairs.push_back(profiler.maxScopes);
+        return;
+    }
+
+    auto it = profiler.scopeIndices.find(name);
+    unsigned int scopeID = 0;
+    if(it == profiler.scopeIndices.end()) {
+        scopeID = profiler.scopes.size();
+        profiler.scopeIndices[name] = scopeID;
+        GPUProfilerScope scope;
+        scope.name = name;
+        profiler.scopes.push_back(scope);
+    }
+    else {
+        scopeID = it->second;
+    }
+
+    unsigned int pair = f.scopeIDs.size();
+    f.scopeIDs.push_back(scopeID);
+    f.openPairs.push_back(pair);
+    f.statsPairs.push_back(0);
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, profiler.queryPool,
+                                 2 * profiler.maxScopes * frame + 2 * pair);
+
+    if(pipelineStats && profiler.pipelineStatsSupported && profiler.pipelineStatsEnabled && f.statsOpenPair < 0) {
+        commandBuffer.beginQuery(profiler.statsQueryPool, profiler.maxScopes * frame + pair, {});
+        f.statsPairs[pair] = 1;
+        f.statsOpenPair = pair;
+    }
+}
+
+void recordGPUScopeEnd(vk::CommandBuffer &commandBuffer, VulkanGPUProfiler &profiler, unsigned int frame) {
+    GPUProfilerFrame &f = profiler.frames.at(frame);
+    if(!f.written || f.openPairs.empty()) {
+        return;
+    }
+
+    unsigned int pair = f.openPairs.back();
+    f.openPairs.pop_back();
+    if(pair >= profiler.maxScopes) {
+        return;
+    }
+
+    if(f.statsOpenPair == int(pair)) {
+        commandBuffer.endQuery(profiler.statsQueryPool, profiler.maxScopes * frame + pair);
+        f.statsOpenPair = -1;
+    }
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, profiler.queryPool,
+                                 2 * profiler.maxScopes * frame + 2 * pair + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Tracing
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int collectGPUProfileTrace(VulkanGPUProfiler &profiler, ChromeTrace &trace) {
+    unsigned int movedCnt = profiler.pendingEvents.size();
+    for(auto &event : profiler.pendingEvents) {
+        uint32_t nameID = getChromeTraceNameID(trace, profiler.scopes.at(event.scopeID).name);
+        addChromeTraceEvent(trace, nameID, CHROME_TRACE_GPU_TRACK, event.startNs, event.durationNs);
+    }
+    profiler.pendingEvents.clear();
+    return movedCnt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Stats
+///////////////////////////////////////////////////////////////////////////////
+
+// Nearest-rank percentile of sorted values
+static float getSortedPercentile(const vector<float> &sorted, float percent) {
+    unsigned int rank = (unsigned int)ceil(percent / 100.0f * sorted.size());
+    rank = min(max(rank, 1u), (unsigned int)sorted.size());
+    return sorted[rank - 1];
+}
+
+float getGPUScopeLastMs(VulkanGPUProfiler &profiler, const string &name) {
+    auto it = profiler.scopeIndices.find(name);
+    if(it == profiler.scopeIndices.end()) {
+        return 0.0f;
+    }
+    GPUProfilerScope &scope = profiler.scopes[it->second];
+    return (scope.sampleCnt > 0) ? scope.lastMs : 0.0f;
+}
+
+vector<GPUScopeStats> getGPUScopeStats(VulkanGPUProfiler &profiler) {
+    vector<GPUScopeStats> allStats;
+    for(auto &scope : profiler.scopes) {
+        GPUScopeStats stats;
+        stats.name = scope.name;
+        stats.sampleCnt = scope.sampleCnt;
+        stats.lastMs = scope.lastMs;
+
+        if(scope.sampleCnt > 0) {
+            vector<float> sorted(scope.history.begin(), scope.history.begin() + scope.sampleCnt);
+            sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for(float ms : sorted) {
+                sum += ms;
+            }
+            stats.avgMs = float(sum / sorted.size());
+            stats.minMs = sorted.front();
+            stats.maxMs = sorted.back();
+            stats.p50Ms = getSortedPercentile(sorted, 50.0f);
+            stats.p95Ms = getSortedPercentile(sorted, 95.0f);
+            stats.p99Ms = getSortedPercentile(sorted, 99.0f);
+        }
+
+        stats.pipelineStatsFrameCnt = scope.pipelineStatsFrameCnt;
+        if(scope.pipelineStatsFrameCnt > 0) {
+            const GPUPipelineStats &t = scope.pipelineStatsTotal;
+            unsigned long long n = scope.pipelineStatsFrameCnt;
+            stats.pipelineStats.iaVertices = t.iaVertices / n;
+            stats.pipelineStats.iaPrimitives = t.iaPrimitives / n;
+            stats.pipelineStats.vsInvocations = t.vsInvocations / n;
+            stats.pipelineStats.clipInvocations = t.clipInvocations / n;
+            stats.pipelineStats.clipPrimitives = t.clipPrimitives / n;
+            stats.pipelineStats.fsInvocations = t.fsInvocations / n;
+        }
+
+        allStats.push_back(stats);
+    }
+    return allStats;
+}
+
+void printGPUScopeStats(VulkanGPUProfiler &profiler, ostream &out) {
+    if(!profiler.supported) {
+        return;
+    }
+
+    out << "GPU scopes (ms over last " << profiler.historySize << " frames): avg, min, max, p50, p95, p99" << endl;
+    streamsize oldPrecision = out.precision();
+    out << fixed << setprecision(3);
+    for(auto &stats : getGPUScopeStats(profiler)) {
+        out << "  " << stats.name << ": " << stats.avgMs << ", " << stats.minMs << ", " << stats.maxMs
+            << ", " << stats.p50Ms << ", " << stats.p95Ms << ", " << stats.p99Ms << endl;
+    }
+    out << defaultfloat << setprecision(oldPrecision);
+}
+
+float getGPUOverdraw(const GPUPipelineStats &stats, unsigned long long pixelCnt) {
+    return (pixelCnt > 0) ? float(double(stats.fsInvocations) / double(pixelCnt)) : 0.0f;
+}
+
+float getGPUVertexReuse(const GPUPipelineStats &stats) {
+    return (stats.vsInvocations > 0) ? float(double(stats.iaVertices) / double(stats.vsInvocations)) : 0.0f;
+}
+
+float getGPUVertexACMR(const GPUPipelineStats &stats) {
+    return (stats.iaPrimitives > 0) ? float(double(stats.vsInvocations) / double(stats.iaPrimitives)) : 0.0f;
+}
+
+void printGPUPipelineStats(VulkanGPUProfiler &profiler, unsigned long long pixelCnt, ostream &out) {
+    if(!profiler.pipelineStatsSupported || !profiler.pipelineStatsEnabled) {
+        return;
+    }
+
+    out << "GPU pipeline stats (avg per frame): VS invocations, primitives in/out of clipping, "
+        << "FS invocations, overdraw, vertex reuse, ACMR" << endl;
+    streamsize oldPrecision = out.precision();
+    out << fixed << setprecision(2);
+    for(auto &stats : getGPUScopeStats(profiler)) {
+        if(stats.pipelineStatsFrameCnt == 0) {
+            continue;
+        }
+        const GPUPipelineStats &p = stats.pipelineStats;
+        out << "  " << stats.name << ": " << p.vsInvocations << ", " << p.clipInvocations << "/" << p.clipPrimitives
+            << ", " << p.fsInvocations << ", " << getGPUOverdraw(p, pixelCnt) << "x, "
+            << getGPUVertexReuse(p) << ", " << getGPUVertexACMR(p) << endl;
+    }
+    out << defaultfloat << setprecision(oldPrecision);
+}
@@ -0,0 +1,198 @@
+#include "VKHiZ.hpp"
+#include "VKBuffer.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+static const vk::Format HIZ_FORMAT = vk::Format::eR32Sfloat;
+
+VulkanHiZ createVulkanHiZ(  VulkanInitData &vkInitData, VulkanImage &depthImage,
+                            unsigned int width, unsigned int height,
+                            string buildCompSPVFilename) {
+    vk::Device &device = vkInitData.device;
+
+    VulkanHiZ hiz;
+    hiz.width = max(width, 1u);
+    hiz.height = max(height, 1u);
+    hiz.mipCnt = 1;
+    while((max(hiz.width, hiz.height) >> hiz.mipCnt) > 0) {
+        hiz.mipCnt++;
+    }
+
+    // Pyramid image (full mip chain)
+    vk::ImageCreateInfo imageInfo(
+        {},
+        vk::ImageType::e2D,
+        HIZ_FORMAT,
+        vk::Extent3D(hiz.width, hiz.height, 1),
+        hiz.mipCnt, 1, vk::SampleCountFlagBits::e1,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        vk::SharingMode::eExclusive
+    );
+    hiz.image = device.createImage(imageInfo);
+
+    vk::MemoryRequirements memRequirements = device.getImageMemoryRequirements(hiz.image);
+    vk::MemoryAllocateInfo allocInfo(memRequirements.size,
+                                     findMemoryType(memRequirements.memoryTypeBits,
+                                                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                    vkInitData.physicalDevice));
+    hiz.memory = device.allocateMemory(allocInfo);
+    device.bindImageMemory(hiz.image, hiz.memory, 0);
+    trackVulkanObject(VULKAN_OBJECT_IMAGE, hiz.image, memRequirements.size, VULKAN_CALL_SITE);
+
+    hiz.view = device.createImageView(vk::ImageViewCreateInfo(
+        {}, hiz.image, vk::ImageViewType::e2D, HIZ_FORMAT, {},
+        { vk::ImageAspectFlagBits::eColor, 0, hiz.mipCnt, 0, 1 }));
+    trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, hiz.view, 0, VULKAN_CALL_SITE);
+
+    for(unsigned int mip = 0; mip < hiz.mipCnt; mip++) {
+        hiz.mipViews.push_back(device.createImageView(vk::ImageViewCreateInfo(
+            {}, hiz.image, vk::ImageViewType::e2D, HIZ_FORMAT, {},
+            { vk::ImageAspectFlagBits::eColor, mip, 1, 0, 1 })));
+        trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, hiz.mipViews.back(), 0, VULKAN_CALL_SITE);
+    }
+
+    vk::SamplerCreateInfo samplerInfo;
+    samplerInfo.magFilter = vk::Filter::eNearest;
+    samplerInfo.minFilter = vk::Filter::eNearest;
+    samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.maxLod = float(hiz.mipCnt);
+    hiz.sampler = device.createSampler(samplerInfo);
+
+    // Build pipeline: binding 0 = source (sampled), binding 1 = destination (storage)
+    vector<vk::DescriptorSetLayoutBinding> bindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1,
+                                       vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1,
+                                       vk::ShaderStageFlagBits::eCompute, nullptr)
+    };
+    hiz.setLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, bindings));
+
+    vector<vk::PushConstantRange> pushRanges = {
+        vk::PushConstantRange(vk::ShaderStageFlagBits::eCompute, 0, sizeof(HiZPushConstants))
+    };
+    hiz.buildPipeline = createVulkanComputePipelineData(device, buildCompSPVFilename,
+                                                        { hiz.setLayout }, pushRanges);
+
+    // One set per mip
+    vector<vk::DescriptorPoolSize> poolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, hiz.mipCnt),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, hiz.mipCnt)
+    };
+    hiz.descriptorPool = createVulkanDescriptorPool(
+        device, vk::DescriptorPoolCreateInfo({}, hiz.mipCnt, poolSizes));
+
+    vector<vk::DescriptorSetLayout> layouts(hiz.mipCnt, hiz.setLayout);
+    hiz.mipSets = device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(hiz.descriptorPool, layouts));
+
+    for(unsigned int mip = 0; mip < hiz.mipCnt; mip++) {
+        vk::DescriptorImageInfo srcInfo = (mip == 0)
+            ? vk::DescriptorImageInfo(hiz.sampler, depthImage.view, vk::ImageLayout::eDepthStencilReadOnlyOptimal)
+            : vk::DescriptorImageInfo(hiz.sampler, hiz.mipViews[mip - 1], vk::ImageLayout::eGeneral);
+        vk::DescriptorImageInfo dstInfo({}, hiz.mipViews[mip], vk::ImageLayout::eGeneral);
+
+        vector<vk::WriteDescriptorSet> writes = {
+            vk::WriteDescriptorSet(hiz.mipSets[mip], 0, 0, vk::DescriptorType::eCombinedImageSampler, srcInfo),
+            vk::WriteDescriptorSet(hiz.mipSets[mip], 1, 0, vk::DescriptorType::eStorageImage, dstInfo)
+        };
+        device.updateDescriptorSets(writes, {});
+    }
+
+    hiz.valid = false;
+    return hiz;
+}
+
+void cleanupVulkanHiZ(VulkanInitData &vkInitData, VulkanHiZ &hiz) {
+    vk::Device &device = vkInitData.device;
+
+    cleanupVulkanDescriptorPool(device, hiz.descriptorPool);
+    cleanupVulkanComputePipelineData(device, hiz.buildPipeline);
+    device.destroyDescriptorSetLayout(hiz.setLayout);
+    device.destroySampler(hiz.sampler);
+
+    for(auto &view : hiz.mipViews) {
+        untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, view);
+        device.destroyImageView(view);
+    }
+    hiz.mipViews.clear();
+    hiz.mipSets.clear();
+
+    untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, hiz.view);
+    untrackVulkanObject(VULKAN_OBJECT_IMAGE, hiz.image);
+    device.destroyImageView(hiz.view);
+    device.destroyImage(hiz.image);
+    device.freeMemory(hiz.memory);
+    hiz.valid = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Building
+///////////////////////////////////////////////////////////////////////////////
+
+void recordBuildHiZ(vk::CommandBuffer &commandBuffer, VulkanHiZ &hiz, VulkanImage &depthImage) {
+    vk::ImageSubresourceRange depthRange(vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1);
+    vk::ImageSubresourceRange allMips(vk::ImageAspectFlagBits::eColor, 0, hiz.mipCnt, 0, 1);
+
+    // Depth: attachment -> sampled; pyramid: old contents no longer needed
+    // (but earlier culling reads must be done)
+    vector<vk::ImageMemoryBarrier> startBarriers = {
+        vk::ImageMemoryBarrier(
+            vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, depthImage.image, depthRange),
+        vk::ImageMemoryBarrier(
+            vk::AccessFlagBits::eShaderRead, vk::AccessFlagBits::eShaderWrite,
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, hiz.image, allMips)
+    };
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {}, {}, {}, startBarriers);
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, hiz.buildPipeline.pipeline);
+
+    glm::ivec2 srcSize(hiz.width, hiz.height);
+    for(unsigned int mip = 0; mip < hiz.mipCnt; mip++) {
+        HiZPushConstants pc;
+        pc.srcSize = srcSize;
+        pc.dstSize = glm::ivec2(max(hiz.width >> mip, 1u), max(hiz.height >> mip, 1u));
+
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, hiz.buildPipeline.pipelineLayout,
+                                         0, hiz.mipSets[mip], {});
+        commandBuffer.pushConstants(hiz.buildPipeline.pipelineLayout, vk::ShaderStageFlagBits::eCompute,
+                                    0, sizeof(HiZPushConstants), &pc);
+        commandBuffer.dispatch( getComputeGroupCount(pc.dstSize.x, HIZ_GROUP_SIZE),
+                                getComputeGroupCount(pc.dstSize.y, HIZ_GROUP_SIZE), 1);
+
+        // Next mip reads what we just wrote (also covers later culling reads)
+        vk::ImageMemoryBarrier mipBarrier(
+            vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral,
+            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, hiz.image,
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, mip, 1, 0, 1));
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+            {}, {}, {}, mipBarrier);
+
+        srcSize = pc.dstSize;
+    }
+
+    // Depth back to attachment (a later pass may load it)
+    vk::ImageMemoryBarrier depthBack(
+        vk::AccessFlagBits::eShaderRead,
+        vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::ImageLayout::eDepthStencilReadOnlyOptimal, vk::ImageLayout::eDepthStencilAttachmentOptimal,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, depthImage.image, depthRange);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+        {}, {}, {}, depthBack);
+
+    hiz.valid = true;
+}
@@ -5,12 +5,13 @@
 VulkanImage createVulkanImage(  
     VulkanInitData &vkInitData, int width, int height, 
     vk::Format format, vk::ImageUsageFlags usage,
-    vk::ImageAspectFlags aspectFlags) {
+    vk::ImageAspectFlags aspectFlags,
+    VulkanCallSite site) {
     
     return createVulkanImage(vkInitData.device,
         vkInitData.physicalDevice,
         width, height, format, usage,
-        aspectFlags);
+        aspectFlags, site);
 }
 
 VulkanImage createVulkanImage(  
@@ -18,7 +19,8 @@ VulkanImage createVulkanImage(
     vk::PhysicalDevice &phyDevice,
     int width, int height, 
     vk::Format format, vk::ImageUsageFlags usage,
-    vk::ImageAspectFlags aspectFlags) {
+    vk::ImageAspectFlags aspectFlags,
+    VulkanCallSite site) {
 
     // Create struct
     VulkanImage vkImage;
@@ -60,6 +62,7 @@ VulkanImage createVulkanImage(
     // Move into struct (rather than copy)
     vkImage.image = std::move(image);
     vkImage.memory = std::move(memory);
+    trackVulkanObject(VULKAN_OBJECT_IMAGE, vkImage.image, memRequirements.size, site);
 
     ///////////////////////////////////////////////////////////////////////////
     // IMAGEVIEW
@@ -75,6 +78,7 @@ VulkanImage createVulkanImage(
     );
 
     vkImage.view = device.createImageView(viewInfo);
+    trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, vkImage.view, 0, site);
 
     // Return struct
     return vkImage;
@@ -82,18 +86,22 @@ VulkanImage createVulkanImage(
 
 VulkanImage createVulkanDepthImage(
     VulkanInitData &vkInitData, 
-    int width, int height) {
+    int width, int height,
+    vk::ImageUsageFlags extraUsage,
+    VulkanCallSite site) {
 
     return createVulkanDepthImage(
         vkInitData.device,
         vkInitData.physicalDevice,
-        width, height);
+        width, height, extraUsage, site);
 }    
 
 VulkanImage createVulkanDepthImage(
     vk::Device &device,
     vk::PhysicalDevice &phyDevice,
-    int width, int height) {
+    int width, int height,
+    vk::ImageUsageFlags extraUsage,
+    VulkanCallSite site) {
 
     // Start with image
     VulkanImage depthImage;
@@ -106,8 +114,9 @@ VulkanImage createVulkanDepthImage(
                                     phyDevice, 
                                     width, height, 
                                     depthFormat, 
-                                    vk::ImageUsageFlagBits::eDepthStencilAttachment,
-                                    vk::ImageAspectFlagBits::eDepth);  
+                                    vk::ImageUsageFlagBits::eDepthStencilAttachment | extraUsage,
+                                    vk::ImageAspectFlagBits::eDepth,
+                                    site);  
 
     // Return image struct
     return depthImage; 
@@ -166,11 +175,78 @@ void transitionVulkanImageLayout(   VulkanInitData &vkInitData,
                                             oneTimeBuffer, vkInitData.graphicsQueue.queue);      
 }
 
+void copyBufferToVulkanImage(   VulkanInitData &vkInitData, 
+                                vk::CommandPool &commandPool,
+                                VulkanBuffer &buffer, 
+                                VulkanImage &vkImage,
+                                unsigned int width, unsigned int height) {
+    vk::CommandBuffer oneTimeBuffer = createAndStartOneTimeVulkanCommandBuffer(vkInitData.device, commandPool);
+
+    // Row length/height of 0 = tightly packed
+    vk::BufferImageCopy region(
+        0, 0, 0,
+        vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+        vk::Offset3D(0, 0, 0),
+        vk::Extent3D(width, height, 1));
+
+    oneTimeBuffer.copyBufferToImage(buffer.buffer, vkImage.image, 
+                                    vk::ImageLayout::eTransferDstOptimal, region);
+
+    stopAndCleanupOneTimeVulkanCommandBuffer(vkInitData.device, commandPool, 
+                                            oneTimeBuffer, vkInitData.graphicsQueue.queue);
+}
+
+VulkanImage createVulkanTexture(VulkanInitData &vkInitData, 
+                                vk::CommandPool &commandPool,
+                                unsigned int width, unsigned int height,
+                                const unsigned char *rgbaData,
+                                VulkanCallSite site) {
+    // Texels go through a host-visible staging buffer
+    vk::DeviceSize size = vk::DeviceSize(width) * height * 4;
+    VulkanBuffer staging = createVulkanBuffer(  vkInitData.physicalDevice, vkInitData.device, size,
+                                                vk::BufferUsageFlagBits::eTransferSrc,
+                                                vk::MemoryPropertyFlagBits::eHostVisible 
+                                                | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                                site);
+    copyDataToVulkanBuffer(vkInitData.device, staging.memory, size, (void*)rgbaData);
+
+    VulkanImage texture = createVulkanImage(vkInitData, width, height, vk::Format::eR8G8B8A8Srgb,
+                                            vk::ImageUsageFlagBits::eTransferDst 
+                                            | vk::ImageUsageFlagBits::eSampled,
+                                            vk::ImageAspectFlagBits::eColor, site);
+
+    transitionVulkanImageLayout(vkInitData, commandPool, texture, 
+                                vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
+    copyBufferToVulkanImage(vkInitData, commandPool, staging, texture, width, height);
+    transitionVulkanImageLayout(vkInitData, commandPool, texture, 
+                                vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    cleanupVulkanBuffer(vkInitData.device, staging);
+    return texture;
+}
+
+VulkanImage createVulkanTextureFromFile(VulkanInitData &vkInitData, 
+                                        vk::CommandPool &commandPool,
+                                        string filename,
+                                        VulkanCallSite site) {
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if(!pixels) {
+        throw runtime_error("createVulkanTextureFromFile: Failed to load " + filename);
+    }
+
+    VulkanImage texture = createVulkanTexture(vkInitData, commandPool, width, height, pixels, site);
+    stbi_image_free(pixels);
+    return texture;
+}
+
 void cleanupVulkanImage(VulkanInitData &vkInitData, VulkanImage &vkImage) {
     cleanupVulkanImage(vkInitData.device, vkImage);
 }
 
 void cleanupVulkanImage(vk::Device &device, VulkanImage &vkImage) {
+    untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, vkImage.view);
+    untrackVulkanObject(VULKAN_OBJECT_IMAGE, vkImage.image);
     device.destroyImageView(vkImage.view);
     device.freeMemory(vkImage.memory);
     device.destroyImage(vkImage.image);
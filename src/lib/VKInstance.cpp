@@ -0,0 +1,100 @@
+#include "VKInstance.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Instance buffers
+///////////////////////////////////////////////////////////////////////////////
+
+static VulkanBuffer createInstanceBuffer(   vk::Device &device,
+                                            vk::PhysicalDevice &physicalDevice,
+                                            unsigned int capacity,
+                                            void **mapped) {
+    vk::DeviceSize bufferSize = sizeof(InstanceData) * max(capacity, 1u);
+
+    // Usable as vertex buffer OR storage buffer
+    VulkanBuffer buffer = createVulkanBuffer(
+                            physicalDevice,
+                            device,
+                            bufferSize,
+                            vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+                            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    // Keep the memory mapped
+    *mapped = device.mapMemory(buffer.memory, 0, bufferSize);
+
+    return buffer;
+}
+
+VulkanInstanceBuffer createVulkanInstanceBuffer(vk::Device &device,
+                                                vk::PhysicalDevice &physicalDevice,
+                                                unsigned int capacity,
+                                                int maxFramesInFlight) {
+    VulkanInstanceBuffer data;
+
+    data.bufferData.resize(maxFramesInFlight);
+    data.mapped.resize(maxFramesInFlight);
+    data.capacity.resize(maxFramesInFlight, capacity);
+
+    for(unsigned int i = 0; i < maxFramesInFlight; i++) {
+        data.bufferData[i] = createInstanceBuffer(device, physicalDevice, capacity, &data.mapped[i]);
+    }
+
+    return data;
+}
+
+void ensureVulkanInstanceBufferCapacity(vk::Device &device,
+                                        vk::PhysicalDevice &physicalDevice,
+                                        VulkanInstanceBuffer &data,
+                                        unsigned int frameIndex,
+                                        unsigned int instanceCnt) {
+    if(instanceCnt <= data.capacity[frameIndex]) {
+        return;
+    }
+
+    // Safe to replace: the fence for this frame has already been waited on
+    unsigned int newCapacity = max(instanceCnt, data.capacity[frameIndex]*2);
+    cleanupVulkanBuffer(device, data.bufferData[frameIndex]);
+    data.bufferData[frameIndex] = createInstanceBuffer(device, physicalDevice, newCapacity,
+                                                        &data.mapped[frameIndex]);
+    data.capacity[frameIndex] = newCapacity;
+}
+
+void cleanupVulkanInstanceBuffer(vk::Device &device, VulkanInstanceBuffer &data) {
+    for(unsigned int i = 0; i < data.bufferData.size(); i++) {
+        cleanupVulkanBuffer(device, data.bufferData[i]);
+    }
+    data.bufferData.clear();
+    data.mapped.clear();
+    data.capacity.clear();
+}
+
+void addInstanceAttributeDesc(  AttributeDescData &attribDescData,
+                                unsigned int binding,
+                                unsigned int firstLocation) {
+
+    // One InstanceData per instance
+    attribDescData.instanceBindDesc.push_back(vk::VertexInputBindingDescription(
+        binding, sizeof(InstanceData), vk::VertexInputRate::eInstance));
+
+    // Matrices are passed as 4 column vectors each
+    for(unsigned int i = 0; i < 4; i++) {
+        attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+            firstLocation + i, binding, vk::Format::eR32G32B32A32Sfloat,
+            offsetof(InstanceData, modelMat) + sizeof(glm::vec4)*i));
+    }
+
+    for(unsigned int i = 0; i < 4; i++) {
+        attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+            firstLocation + 4 + i, binding, vk::Format::eR32G32B32A32Sfloat,
+            offsetof(InstanceData, normMat) + sizeof(glm::vec4)*i));
+    }
+
+    // COLOR
+    attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+        firstLocation + 8, binding, vk::Format::eR32G32B32A32Sfloat,
+        offsetof(InstanceData, color)));
+
+    // INDICES (integer attribute: declare as uvec4 in the shader)
+    attribDescData.attribDesc.push_back(vk::VertexInputAttributeDescription(
+        firstLocation + 9, binding, vk::Format::eR32G32B32A32Uint,
+        offsetof(InstanceData, indices)));
+}
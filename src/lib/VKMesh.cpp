@@ -4,16 +4,55 @@
 // Vulkan mesh
 ///////////////////////////////////////////////////////////////////////////////
 
-void recordDrawVulkanMesh(vk::CommandBuffer &commandBuffer, VulkanMesh &mesh) {
-    
+void recordBindVulkanMesh(vk::CommandBuffer &commandBuffer, VulkanMesh &mesh) {
     vk::Buffer vertexBuffers[] = {mesh.vertices.buffer};
     vk::DeviceSize offsets[] = {0};
     commandBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
     commandBuffer.bindIndexBuffer(mesh.indices.buffer, 0, vk::IndexType::eUint32);
+}
+
+void recordDrawVulkanMesh(vk::CommandBuffer &commandBuffer, VulkanMesh &mesh) {
     
-    commandBuffer.drawIndexed(static_cast<unsigned int>(mesh.indexCnt), 1, 0, 0, 0);
+    recordBindVulkanMesh(commandBuffer, mesh);
+    
+    commandBuffer.drawIndexed(static_cast<unsigned int>(mesh.indexCnt), 1, mesh.firstIndex, 0, 0);
 }    
 
+// Per-instance data is looked up in the shader (e.g., SSBO indexed by gl_InstanceIndex)
+void recordDrawVulkanMeshInstanced( vk::CommandBuffer &commandBuffer, VulkanMesh &mesh,
+                                    unsigned int firstInstance, unsigned int instanceCnt) {
+
+    recordBindVulkanMesh(commandBuffer, mesh);
+
+    commandBuffer.drawIndexed(static_cast<unsigned int>(mesh.indexCnt), instanceCnt, mesh.firstIndex, 0, firstInstance);
+}
+
+// Per-instance data comes from a vertex buffer bound with eInstance input rate
+void recordDrawVulkanMeshInstanced( vk::CommandBuffer &commandBuffer, VulkanMesh &mesh,
+                                    vk::Buffer instanceBuffer, unsigned int instanceBinding,
+                                    unsigned int firstInstance, unsigned int instanceCnt) {
+
+    vk::Buffer instanceBuffers[] = {instanceBuffer};
+    vk::DeviceSize offsets[] = {0};
+    commandBuffer.bindVertexBuffers(instanceBinding, instanceBuffers, offsets);
+
+    recordDrawVulkanMeshInstanced(commandBuffer, mesh, firstInstance, instanceCnt);
+}
+
+void recordDrawVulkanMeshIndirect(  vk::CommandBuffer &commandBuffer, VulkanMesh &mesh,
+                                    vk::Buffer indirectBuffer, vk::DeviceSize offset) {
+
+    recordBindVulkanMesh(commandBuffer, mesh);
+
+    commandBuffer.drawIndexedIndirect(indirectBuffer, offset, 1, sizeof(vk::DrawIndexedIndirectCommand));
+}
+
+VulkanMesh getVulkanMeshRange(VulkanMesh &mesh, unsigned int firstIndex, unsigned int indexCnt) {
+    VulkanMesh view = mesh;
+    view.firstIndex = firstIndex;
+    view.indexCnt = indexCnt;
+    return view;
+}
 
 void cleanupVulkanMesh(VulkanInitData &vkInitData, VulkanMesh &mesh) {
     cleanupVulkanBuffer(vkInitData.device, mesh.vertices);
@@ -0,0 +1,91 @@
+#include "VKMultiview.hpp"
+#include "VKBuffer.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Layered images
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanLayeredImage createVulkanLayeredImage(VulkanInitData &vkInitData,
+                                            unsigned int width, unsigned int height, unsigned int layerCnt,
+                                            vk::Format format, vk::ImageUsageFlags usage,
+                                            vk::ImageAspectFlags aspectFlags) {
+    vk::Device &device = vkInitData.device;
+
+    VulkanLayeredImage layered;
+    layered.format = format;
+
+    vk::ImageCreateInfo imageInfo(
+        {},
+        vk::ImageType::e2D,
+        format,
+        vk::Extent3D(width, height, 1),
+        1, layerCnt, vk::SampleCountFlagBits::e1,   // No mipmaps, one layer per view
+        vk::ImageTiling::eOptimal,
+        usage,
+        vk::SharingMode::eExclusive
+    );
+    layered.image = device.createImage(imageInfo);
+
+    vk::MemoryRequirements memRequirements = device.getImageMemoryRequirements(layered.image);
+    vk::MemoryAllocateInfo allocInfo(memRequirements.size,
+                                     findMemoryType(memRequirements.memoryTypeBits,
+                                                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                    vkInitData.physicalDevice));
+    layered.memory = device.allocateMemory(allocInfo);
+    device.bindImageMemory(layered.image, layered.memory, 0);
+    trackVulkanObject(VULKAN_OBJECT_IMAGE, layered.image, memRequirements.size, VULKAN_CALL_SITE);
+
+    layered.view = device.createImageView(vk::ImageViewCreateInfo(
+        {}, layered.image, vk::ImageViewType::e2DArray, format, {},
+        { aspectFlags, 0, 1, 0, layerCnt }));
+    trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, layered.view, 0, VULKAN_CALL_SITE);
+
+    return layered;
+}
+
+void cleanupVulkanLayeredImage(VulkanInitData &vkInitData, VulkanLayeredImage &image) {
+    untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, image.view);
+    untrackVulkanObject(VULKAN_OBJECT_IMAGE, image.image);
+    vkInitData.device.destroyImageView(image.view);
+    vkInitData.device.destroyImage(image.image);
+    vkInitData.device.freeMemory(image.memory);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Multiview targets
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanMultiviewTarget createVulkanMultiviewTarget(  VulkanInitData &vkInitData, vk::RenderPass &renderPass,
+                                                    unsigned int width, unsigned int height,
+                                                    unsigned int viewCnt,
+                                                    vk::Format colorFormat, vk::Format depthFormat) {
+    if(viewCnt < 1 || viewCnt > MAX_VIEWS) {
+        throw runtime_error("createVulkanMultiviewTarget: Unsupported view count!");
+    }
+
+    VulkanMultiviewTarget target;
+    target.viewCnt = viewCnt;
+    target.width = max(width, 1u);
+    target.height = max(height, 1u);
+
+    target.color = createVulkanLayeredImage(vkInitData, target.width, target.height, viewCnt, colorFormat,
+                                            vk::ImageUsageFlagBits::eColorAttachment
+                                            | vk::ImageUsageFlagBits::eTransferSrc,
+                                            vk::ImageAspectFlagBits::eColor);
+    target.depth = createVulkanLayeredImage(vkInitData, target.width, target.height, viewCnt, depthFormat,
+                                            vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                                            vk::ImageAspectFlagBits::eDepth);
+
+    vector<vk::ImageView> attachments = { target.color.view, target.depth.view };
+    target.framebuffer = vkInitData.device.createFramebuffer(vk::FramebufferCreateInfo(
+        {}, renderPass, attachments, target.width, target.height, 1));
+
+    return target;
+}
+
+void cleanupVulkanMultiviewTarget(VulkanInitData &vkInitData, VulkanMultiviewTarget &target) {
+    vkInitData.device.destroyFramebuffer(target.framebuffer);
+    cleanupVulkanLayeredImage(vkInitData, target.depth);
+    cleanupVulkanLayeredImage(vkInitData, target.color);
+    target.viewCnt = 0;
+}
@@ -0,0 +1,204 @@
+#include "VKObjectTracker.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////
+// State
+///////////////////////////////////////////////////////////////////////////////
+
+struct VulkanTrackedObject {
+    uint64_t bytes = 0;
+    unsigned int siteID = 0;
+};
+
+struct VulkanObjectTrackerState {
+    mutex lock;
+    unordered_map<uint64_t, VulkanTrackedObject> objects[VULKAN_OBJECT_TYPE_CNT];
+
+    vector<string> siteNames;
+    map<pair<const char*, int>, unsigned int> siteIndices;
+    unordered_map<string, unsigned int> siteNameIndices;   // Same header, different TUs
+};
+
+static VulkanObjectTrackerState& getVulkanObjectTrackerState() {
+    static VulkanObjectTrackerState state;
+    return state;
+}
+
+// Call with the lock held
+static unsigned int getVulkanSiteID(VulkanObjectTrackerState &state, VulkanCallSite site) {
+    auto key = make_pair(site.file, site.line);
+    auto it = state.siteIndices.find(key);
+    if(it != state.siteIndices.end()) {
+        return it->second;
+    }
+
+    // Keep just the file name
+    string file = site.file ? site.file : "?";
+    size_t slash = file.find_last_of("/\\");
+    if(slash != string::npos) {
+        file = file.substr(slash + 1);
+    }
+
+    string name = file + ":" + to_string(site.line);
+    auto nameIt = state.siteNameIndices.find(name);
+    unsigned int siteID = 0;
+    if(nameIt != state.siteNameIndices.end()) {
+        siteID = nameIt->second;
+    }
+    else {
+        siteID = state.siteNames.size();
+        state.siteNames.push_back(name);
+        state.siteNameIndices[name] = siteID;
+    }
+    state.siteIndices[key] = siteID;
+    return siteID;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Tracking
+///////////////////////////////////////////////////////////////////////////////
+
+void trackVulkanObject(VulkanObjectType type, uint64_t handle, uint64_t bytes, VulkanCallSite site) {
+    if(handle == 0) {
+        return;
+    }
+
+    VulkanObjectTrackerState &state = getVulkanObjectTrackerState();
+    lock_guard<mutex> lock(state.lock);
+
+    VulkanTrackedObject object;
+    object.bytes = bytes;
+    object.siteID = getVulkanSiteID(state, site);
+    state.objects[type][handle] = object;
+}
+
+void untrackVulkanObject(VulkanObjectType type, uint64_t handle) {
+    if(handle == 0) {
+        return;
+    }
+
+    VulkanObjectTrackerState &state = getVulkanObjectTrackerState();
+    lock_guard<mutex> lock(state.lock);
+    state.objects[type].erase(handle);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Snapshots
+///////////////////////////////////////////////////////////////////////////////
+
+static void sortVulkanSiteUsage(vector<VulkanSiteUsage> &sites) {
+    sort(sites.begin(), sites.end(), [](const VulkanSiteUsage &a, const VulkanSiteUsage &b) {
+        if(llabs(a.bytes) != llabs(b.bytes)) {
+            return llabs(a.bytes) > llabs(b.bytes);
+        }
+        return llabs(a.count) > llabs(b.count);
+    });
+}
+
+VulkanObjectSnapshot getVulkanObjectSnapshot() {
+    VulkanObjectTrackerState &state = getVulkanObjectTrackerState();
+    lock_guard<mutex> lock(state.lock);
+
+    VulkanObjectSnapshot snapshot;
+    map<pair<unsigned int, int>, VulkanSiteUsage> sites;
+    for(int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        for(auto &entry : state.objects[type]) {
+            snapshot.count[type]++;
+            snapshot.bytes[type] += entry.second.bytes;
+
+            VulkanSiteUsage &usage = sites[make_pair(entry.second.siteID, type)];
+            usage.site = state.siteNames[entry.second.siteID];
+            usage.type = VulkanObjectType(type);
+            usage.count++;
+            usage.bytes += entry.second.bytes;
+        }
+    }
+
+    for(auto &entry : sites) {
+        snapshot.sites.push_back(entry.second);
+    }
+    sortVulkanSiteUsage(snapshot.sites);
+    return snapshot;
+}
+
+VulkanObjectSnapshot diffVulkanObjectSnapshots(const VulkanObjectSnapshot &before,
+                                               const VulkanObjectSnapshot &after) {
+    VulkanObjectSnapshot diff;
+    for(int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        diff.count[type] = after.count[type] - before.count[type];
+        diff.bytes[type] = after.bytes[type] - before.bytes[type];
+    }
+
+    map<pair<string, int>, VulkanSiteUsage> sites;
+    for(auto &usage : after.sites) {
+        sites[make_pair(usage.site, int(usage.type))] = usage;
+    }
+    for(auto &usage : before.sites) {
+        VulkanSiteUsage &d = sites[make_pair(usage.site, int(usage.type))];
+        d.site = usage.site;
+        d.type = usage.type;
+        d.count -= usage.count;
+        d.bytes -= usage.bytes;
+    }
+
+    for(auto &entry : sites) {
+        if(entry.second.count != 0 || entry.second.bytes != 0) {
+            diff.sites.push_back(entry.second);
+        }
+    }
+    sortVulkanSiteUsage(diff.sites);
+    return diff;
+}
+
+bool isVulkanObjectSnapshotEmpty(const VulkanObjectSnapshot &snapshot) {
+    for(int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        if(snapshot.count[type] != 0 || snapshot.bytes[type] != 0) {
+            return false;
+        }
+    }
+    return snapshot.sites.empty();
+}
+
+void printVulkanObjectSnapshot(const VulkanObjectSnapshot &snapshot, ostream &out, unsigned int maxSites) {
+    out << "Vulkan objects (count, MB):";
+    for(int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        out << (type ? "," : "") << " " << VULKAN_OBJECT_TYPE_NAMES[type] << " " << snapshot.count[type];
+        if(snapshot.bytes[type] != 0) {
+            out << " (" << (snapshot.bytes[type] / (1024.0 * 1024.0)) << ")";
+        }
+    }
+    out << endl;
+
+    for(unsigned int i = 0; i < snapshot.sites.size() && i < maxSites; i++) {
+        const VulkanSiteUsage &usage = snapshot.sites[i];
+        out << "  " << usage.site << ": " << usage.count << " " << VULKAN_OBJECT_TYPE_NAMES[usage.type];
+        if(usage.bytes != 0) {
+            out << ", " << (usage.bytes / (1024.0 * 1024.0)) << " MB";
+        }
+        out << endl;
+    }
+    if(snapshot.sites.size() > maxSites) {
+        out << "  (" << (snapshot.sites.size() - maxSites) << " more sites)" << endl;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Descriptor pools
+///////////////////////////////////////////////////////////////////////////////
+
+vk::DescriptorPool createVulkanDescriptorPool(  vk::Device &device, const vk::DescriptorPoolCreateInfo &createInfo,
+                                                VulkanCallSite site) {
+    vk::DescriptorPool pool = device.createDescriptorPool(createInfo);
+    trackVulkanObject(VULKAN_OBJECT_DESCRIPTOR_POOL, pool, 0, site);
+    return pool;
+}
+
+void cleanupVulkanDescriptorPool(vk::Device &device, vk::DescriptorPool &pool) {
+    untrackVulkanObject(VULKAN_OBJECT_DESCRIPTOR_POOL, pool);
+    device.destroyDescriptorPool(pool);
+    pool = nullptr;
+}
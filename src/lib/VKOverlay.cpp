@@ -0,0 +1,690 @@
+#include "VKOverlay.hpp"
+#include "VKObjectTracker.hpp"
+#include "CPUProfiler.hpp"
+#include "ProcessMemory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+const unsigned int OVERLAY_FONT_COLS = 16;          // Atlas cells per row
+const unsigned int OVERLAY_FONT_CELL_WIDTH = 6;
+const unsigned int OVERLAY_FONT_CELL_HEIGHT = 9;
+const unsigned int OVERLAY_FONT_FIRST_CHAR = 32;
+const unsigned int OVERLAY_FONT_CHAR_CNT = 95;      // ' ' to '~'
+const unsigned int OVERLAY_FONT_SOLID_CELL = 95;    // Fully set (rectangles)
+const unsigned int OVERLAY_PANEL_MIN_COLS = 40;
+const unsigned int OVERLAY_PANEL_MAX_SCOPES = 12;   // Per profiler
+const float OVERLAY_GRAPH_HEIGHT = 32.0f;           // Font texels
+const float OVERLAY_GRAPH_MAX_MS = 33.3f;           // Top of the graphs (30 FPS)
+const float OVERLAY_GRAPH_GOOD_MS = 16.7f;          // 60 FPS
+
+// Rows top to bottom, bit 4 = leftmost column; row 6 is the baseline and
+// row 7 holds descenders
+static const unsigned char OVERLAY_FONT[OVERLAY_FONT_CHAR_CNT][OVERLAY_GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00 },   // '!'
+    { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '"'
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00 },   // '#'
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04, 0x00 },   // '$'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00 },   // '%'
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D, 0x00 },   // '&'
+    { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '''
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00 },   // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00 },   // ')'
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00, 0x00 },   // '*'
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x00 },   // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },   // ','
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00 },   // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },   // '.'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00 },   // '/'
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E, 0x00 },   // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00 },   // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F, 0x00 },   // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E, 0x00 },   // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02, 0x00 },   // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E, 0x00 },   // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E, 0x00 },   // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00 },   // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00 },   // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C, 0x00 },   // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00, 0x00 },   // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08, 0x00 },   // ';'
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00 },   // '<'
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, 0x00 },   // '='
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00 },   // '>'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00 },   // '?'
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E, 0x00 },   // '@'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00 },   // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E, 0x00 },   // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E, 0x00 },   // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C, 0x00 },   // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F, 0x00 },   // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10, 0x00 },   // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F, 0x00 },   // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00 },   // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00 },   // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C, 0x00 },   // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00 },   // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F, 0x00 },   // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00 },   // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00 },   // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 },   // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10, 0x00 },   // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D, 0x00 },   // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11, 0x00 },   // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E, 0x00 },   // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 },   // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 },   // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00 },   // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00 },   // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00 },   // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x00 },   // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F, 0x00 },   // 'Z'
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E, 0x00 },   // '['
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00 },   // '\'
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E, 0x00 },   // ']'
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00 },   // '_'
+    { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '`'
+    { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 },   // 'a'
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E, 0x00 },   // 'b'
+    { 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x00 },   // 'c'
+    { 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F, 0x00 },   // 'd'
+    { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 },   // 'e'
+    { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08, 0x00 },   // 'f'
+    { 0x00, 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E },   // 'g'
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00 },   // 'h'
+    { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 },   // 'i'
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x12, 0x0C },   // 'j'
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00 },   // 'k'
+    { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00 },   // 'l'
+    { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11, 0x00 },   // 'm'
+    { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00 },   // 'n'
+    { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 },   // 'o'
+    { 0x00, 0x00, 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10 },   // 'p'
+    { 0x00, 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x01 },   // 'q'
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00 },   // 'r'
+    { 0x00, 0x00, 0x0F, 0x10, 0x0E, 0x01, 0x1E, 0x00 },   // 's'
+    { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06, 0x00 },   // 't'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00 },   // 'u'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00 },   // 'v'
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00 },   // 'w'
+    { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00 },   // 'x'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x0E },   // 'y'
+    { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F, 0x00 },   // 'z'
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00 },   // '{'
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 },   // '|'
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00 },   // '}'
+    { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00 },   // '~'
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Setup helpers
+///////////////////////////////////////////////////////////////////////////////
+
+// RGBA atlas: white everywhere, glyph bits in alpha
+static vector<unsigned char> createOverlayFontPixels(unsigned int width, unsigned int height) {
+    vector<unsigned char> pixels(width * height * 4, 255);
+    for(unsigned int i = 3; i < pixels.size(); i += 4) {
+        pixels[i] = 0;
+    }
+
+    for(unsigned int cell = 0; cell <= OVERLAY_FONT_SOLID_CELL; cell++) {
+        unsigned int x0 = (cell % OVERLAY_FONT_COLS) * OVERLAY_FONT_CELL_WIDTH;
+        unsigned int y0 = (cell / OVERLAY_FONT_COLS) * OVERLAY_FONT_CELL_HEIGHT;
+        for(unsigned int y = 0; y < OVERLAY_FONT_CELL_HEIGHT; y++) {
+            for(unsigned int x = 0; x < OVERLAY_FONT_CELL_WIDTH; x++) {
+                bool set = (cell == OVERLAY_FONT_SOLID_CELL);
+                if(!set && x < OVERLAY_GLYPH_WIDTH && y < OVERLAY_GLYPH_HEIGHT) {
+                    set = (OVERLAY_FONT[cell][y] >> (OVERLAY_GLYPH_WIDTH - 1 - x)) & 1;
+                }
+                pixels[((y0 + y) * width + x0 + x) * 4 + 3] = set ? 255 : 0;
+            }
+        }
+    }
+    return pixels;
+}
+
+// The image was finished by earlier passes or blits and goes back to
+// presentation afterwards
+static vk::RenderPass createOverlayRenderPass(VulkanInitData &vkInitData) {
+    vk::AttachmentDescription colorAttachment(
+        {}, vkInitData.swapchain.format, vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eLoad, vk::AttachmentStoreOp::eStore,
+        vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::ePresentSrcKHR, vk::ImageLayout::ePresentSrcKHR);
+
+    vk::AttachmentReference colorAttachmentRef(0, vk::ImageLayout::eColorAttachmentOptimal);
+    vk::SubpassDescription subpass({}, vk::PipelineBindPoint::eGraphics, {}, colorAttachmentRef);
+
+    vk::SubpassDependency dependency(
+        VK_SUBPASS_EXTERNAL, 0,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite);
+
+    return vkInitData.device.createRenderPass(vk::RenderPassCreateInfo(
+        {}, colorAttachment, subpass, dependency));
+}
+
+static void createOverlayFramebuffers(VulkanInitData &vkInitData, VulkanOverlay &overlay) {
+    overlay.extent = vkInitData.swapchain.extent;
+    for(auto &view : vkInitData.swapchain.views) {
+        overlay.framebuffers.push_back(vkInitData.device.createFramebuffer(vk::FramebufferCreateInfo(
+            {}, overlay.renderPass, view, overlay.extent.width, overlay.extent.height, 1)));
+    }
+}
+
+static void cleanupOverlayFramebuffers(VulkanInitData &vkInitData, VulkanOverlay &overlay) {
+    for(auto &fb : overlay.framebuffers) {
+        vkInitData.device.destroyFramebuffer(fb);
+    }
+    overlay.framebuffers.clear();
+}
+
+// Alpha blended, no depth, viewport/scissor set when recording
+static void createOverlayPipeline(  VulkanInitData &vkInitData, VulkanOverlay &overlay,
+                                    string vertSPVFilename, string fragSPVFilename) {
+    vk::Device &device = vkInitData.device;
+
+    auto vertShaderCode = readBinaryFile(vertSPVFilename);
+    auto fragShaderCode = readBinaryFile(fragSPVFilename);
+    vk::ShaderModule vertShaderModule = createVulkanShaderModule(device, vertShaderCode);
+    vk::ShaderModule fragShaderModule = createVulkanShaderModule(device, fragShaderCode);
+
+    vector<vk::PipelineShaderStageCreateInfo> shaderStages = {
+        vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main"),
+        vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main")
+    };
+
+    vk::VertexInputBindingDescription bindDesc(0, sizeof(OverlayVertex), vk::VertexInputRate::eVertex);
+    vector<vk::VertexInputAttributeDescription> attribDesc = {
+        vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(OverlayVertex, pos)),
+        vk::VertexInputAttributeDescription(1, 0, vk::Format::eR16G16Unorm, offsetof(OverlayVertex, uv)),
+        vk::VertexInputAttributeDescription(2, 0, vk::Format::eR8G8B8A8Unorm, offsetof(OverlayVertex, color))
+    };
+    vk::PipelineVertexInputStateCreateInfo vertexInputInfo({}, bindDesc, attribDesc);
+    vk::PipelineInputAssemblyStateCreateInfo inputAssembly({}, vk::PrimitiveTopology::eTriangleList, false);
+
+    vk::Viewport viewport(0, 0, (float)vkInitData.swapchain.extent.width,
+                          (float)vkInitData.swapchain.extent.height, 0.0f, 1.0f);
+    vk::Rect2D scissor({0,0}, vkInitData.swapchain.extent);
+    vk::PipelineViewportStateCreateInfo viewportState({}, viewport, scissor);
+
+    vector<vk::DynamicState> dynamicStates = {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor
+    };
+    vk::PipelineDynamicStateCreateInfo dynamicState({}, dynamicStates);
+
+    vk::PipelineRasterizationStateCreateInfo rasterizer {};
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = vk::CullModeFlagBits::eNone;
+    rasterizer.frontFace = vk::FrontFace::eCounterClockwise;
+
+    vk::PipelineMultisampleStateCreateInfo multisample({}, vk::SampleCountFlagBits::e1);
+    vk::PipelineDepthStencilStateCreateInfo depthStencil({}, false, false, vk::CompareOp::eAlways, false, false);
+
+    // Straight alpha over what is already there
+    vk::PipelineColorBlendAttachmentState colorBlendAttachment(
+        true,
+        vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd,
+        vk::BlendFactor::eOne, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd,
+        vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
+        | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+    vk::PipelineColorBlendStateCreateInfo colorBlending({}, false, vk::LogicOp::eCopy, colorBlendAttachment);
+
+    vector<vk::PushConstantRange> pushRanges = {
+        vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(OverlayPushConstants))
+    };
+    overlay.pipelineLayout = device.createPipelineLayout(
+        vk::PipelineLayoutCreateInfo({}, overlay.setLayout, pushRanges));
+
+    vk::GraphicsPipelineCreateInfo pipelineInfo({},
+                                                shaderStages,
+                                                &vertexInputInfo,
+                                                &inputAssembly,
+                                                0,
+                                                &viewportState,
+                                                &rasterizer,
+                                                &multisample,
+                                                &depthStencil,
+                                                &colorBlending,
+                                                &dynamicState,
+                                                overlay.pipelineLayout,
+                                                overlay.renderPass,
+                                                0);
+
+    auto ret = device.createGraphicsPipeline(nullptr, pipelineInfo);
+    if(ret.result != vk::Result::eSuccess) {
+        throw runtime_error("Failed to create overlay pipeline!");
+    }
+    overlay.pipeline = ret.value;
+    trackVulkanObject(VULKAN_OBJECT_PIPELINE, overlay.pipeline, 0, VULKAN_CALL_SITE);
+
+    device.destroyShaderModule(fragShaderModule);
+    device.destroyShaderModule(vertShaderModule);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanOverlay createVulkanOverlay(  VulkanInitData &vkInitData, vk::CommandPool &commandPool,
+                                    unsigned int framesInFlight,
+                                    string vertSPVFilename, string fragSPVFilename,
+                                    unsigned int maxQuads) {
+    VulkanOverlay overlay;
+    vk::Device &device = vkInitData.device;
+
+    // Font
+    overlay.fontWidth = OVERLAY_FONT_COLS * OVERLAY_FONT_CELL_WIDTH;
+    overlay.fontHeight = ((OVERLAY_FONT_SOLID_CELL / OVERLAY_FONT_COLS) + 1) * OVERLAY_FONT_CELL_HEIGHT;
+    vector<unsigned char> fontPixels = createOverlayFontPixels(overlay.fontWidth, overlay.fontHeight);
+    overlay.font = createVulkanTexture(vkInitData, commandPool, overlay.fontWidth, overlay.fontHeight,
+                                       fontPixels.data());
+
+    // Texels stay crisp at integer scales
+    vk::SamplerCreateInfo samplerInfo;
+    samplerInfo.magFilter = vk::Filter::eNearest;
+    samplerInfo.minFilter = vk::Filter::eNearest;
+    samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+    overlay.sampler = device.createSampler(samplerInfo);
+
+    // One set: binding 0 = font
+    vk::DescriptorSetLayoutBinding fontBinding(0, vk::DescriptorType::eCombinedImageSampler, 1,
+                                               vk::ShaderStageFlagBits::eFragment, nullptr);
+    overlay.setLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, fontBinding));
+
+    vk::DescriptorPoolSize poolSize(vk::DescriptorType::eCombinedImageSampler, 1);
+    overlay.descriptorPool = createVulkanDescriptorPool(
+        device, vk::DescriptorPoolCreateInfo({}, 1, poolSize));
+    overlay.descriptorSet = device.allocateDescriptorSets(
+        vk::DescriptorSetAllocateInfo(overlay.descriptorPool, overlay.setLayout)).front();
+
+    vk::DescriptorImageInfo fontInfo(overlay.sampler, overlay.font.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+    device.updateDescriptorSets(vk::WriteDescriptorSet(
+        overlay.descriptorSet, 0, 0, vk::DescriptorType::eCombinedImageSampler, fontInfo), {});
+
+    overlay.renderPass = createOverlayRenderPass(vkInitData);
+    createOverlayFramebuffers(vkInitData, overlay);
+    createOverlayPipeline(vkInitData, overlay, vertSPVFilename, fragSPVFilename);
+
+    // Vertices: written by the CPU once per frame, read once by the GPU
+    overlay.maxQuads = max(maxQuads, 1u);
+    overlay.framesInFlight = max(framesInFlight, 1u);
+    vk::DeviceSize size = vk::DeviceSize(overlay.maxQuads) * 6 * sizeof(OverlayVertex) * overlay.framesInFlight;
+    overlay.vertexBuffer = createVulkanBuffer(vkInitData.physicalDevice, device, size,
+                                              vk::BufferUsageFlagBits::eVertexBuffer,
+                                              vk::MemoryPropertyFlagBits::eHostVisible
+                                              | vk::MemoryPropertyFlagBits::eHostCoherent);
+    overlay.mapped = static_cast<OverlayVertex*>(device.mapMemory(overlay.vertexBuffer.memory, 0, size));
+    overlay.vertices.reserve(overlay.maxQuads * 6);
+
+    overlay.cpuHistory.assign(OVERLAY_GRAPH_SAMPLES, 0.0f);
+    overlay.gpuHistory.assign(OVERLAY_GRAPH_SAMPLES, 0.0f);
+    return overlay;
+}
+
+void cleanupVulkanOverlay(VulkanInitData &vkInitData, VulkanOverlay &overlay) {
+    vk::Device &device = vkInitData.device;
+
+    device.unmapMemory(overlay.vertexBuffer.memory);
+    overlay.mapped = nullptr;
+    cleanupVulkanBuffer(device, overlay.vertexBuffer);
+
+    untrackVulkanObject(VULKAN_OBJECT_PIPELINE, overlay.pipeline);
+    device.destroyPipeline(overlay.pipeline);
+    device.destroyPipelineLayout(overlay.pipelineLayout);
+
+    cleanupOverlayFramebuffers(vkInitData, overlay);
+    device.destroyRenderPass(overlay.renderPass);
+
+    cleanupVulkanDescriptorPool(device, overlay.descriptorPool);
+    device.destroyDescriptorSetLayout(overlay.setLayout);
+    device.destroySampler(overlay.sampler);
+    cleanupVulkanImage(vkInitData, overlay.font);
+}
+
+void recreateVulkanOverlayFramebuffers(VulkanInitData &vkInitData, VulkanOverlay &overlay) {
+    cleanupOverlayFramebuffers(vkInitData, overlay);
+    createOverlayFramebuffers(vkInitData, overlay);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Building
+///////////////////////////////////////////////////////////////////////////////
+
+float getOverlayScale(VulkanOverlay &overlay) {
+    if(overlay.pixelScale > 0.0f) {
+        return overlay.pixelScale;
+    }
+    // About 60 lines of text fit at any height
+    return max(1.0f, floor(overlay.extent.height / 540.0f));
+}
+
+float getOverlayLineHeight(VulkanOverlay &overlay) {
+    return OVERLAY_LINE_ADVANCE * getOverlayScale(overlay);
+}
+
+static glm::u16vec2 getOverlayUV(VulkanOverlay &overlay, float texelX, float texelY) {
+    return glm::u16vec2((unsigned short)(texelX / overlay.fontWidth * 65535.0f + 0.5f),
+                        (unsigned short)(texelY / overlay.fontHeight * 65535.0f + 0.5f));
+}
+
+// Two triangles; uv0/uv1 are the top left/bottom right texels
+static void addOverlayQuad( VulkanOverlay &overlay, float x0, float y0, float x1, float y1,
+                            glm::u16vec2 uv0, glm::u16vec2 uv1, glm::u8vec4 color) {
+    if(overlay.vertices.size() + 6 > size_t(overlay.maxQuads) * 6) {
+        overlay.droppedQuadCnt++;
+        return;
+    }
+
+    OverlayVertex v00 = { glm::vec2(x0, y0), uv0, color };
+    OverlayVertex v10 = { glm::vec2(x1, y0), glm::u16vec2(uv1.x, uv0.y), color };
+    OverlayVertex v01 = { glm::vec2(x0, y1), glm::u16vec2(uv0.x, uv1.y), color };
+    OverlayVertex v11 = { glm::vec2(x1, y1), uv1, color };
+    overlay.vertices.insert(overlay.vertices.end(), { v00, v10, v11, v00, v11, v01 });
+}
+
+void addOverlayRect(VulkanOverlay &overlay, float x, float y, float w, float h, glm::u8vec4 color) {
+    // Every corner samples the middle of the solid cell
+    float cx = (OVERLAY_FONT_SOLID_CELL % OVERLAY_FONT_COLS + 0.5f) * OVERLAY_FONT_CELL_WIDTH;
+    float cy = (OVERLAY_FONT_SOLID_CELL / OVERLAY_FONT_COLS + 0.5f) * OVERLAY_FONT_CELL_HEIGHT;
+    glm::u16vec2 uv = getOverlayUV(overlay, cx, cy);
+    addOverlayQuad(overlay, x, y, x + w, y + h, uv, uv, color);
+}
+
+float addOverlayText(VulkanOverlay &overlay, float x, float y, const string &text, glm::u8vec4 color) {
+    float scale = getOverlayScale(overlay);
+    float penX = x;
+    float width = 0.0f;
+
+    for(char c : text) {
+        if(c == '\n') {
+            penX = x;
+            y += OVERLAY_LINE_ADVANCE * scale;
+            continue;
+        }
+
+        unsigned int code = (unsigned char)c;
+        if(code < OVERLAY_FONT_FIRST_CHAR || code >= OVERLAY_FONT_FIRST_CHAR + OVERLAY_FONT_CHAR_CNT) {
+            code = '?';
+        }
+
+        // Spaces only move the pen
+        if(code != ' ') {
+            unsigned int cell = code - OVERLAY_FONT_FIRST_CHAR;
+            float tx = float((cell % OVERLAY_FONT_COLS) * OVERLAY_FONT_CELL_WIDTH);
+            float ty = float((cell / OVERLAY_FONT_COLS) * OVERLAY_FONT_CELL_HEIGHT);
+            addOverlayQuad(overlay, penX, y,
+                           penX + OVERLAY_GLYPH_WIDTH * scale, y + OVERLAY_GLYPH_HEIGHT * scale,
+                           getOverlayUV(overlay, tx, ty),
+                           getOverlayUV(overlay, tx + OVERLAY_GLYPH_WIDTH, ty + OVERLAY_GLYPH_HEIGHT),
+                           color);
+        }
+
+        penX += OVERLAY_CHAR_ADVANCE * scale;
+        width = max(width, penX - x);
+    }
+    return width;
+}
+
+void addOverlayGraph(   VulkanOverlay &overlay, float x, float y, float w, float h,
+                        const vector<float> &values, unsigned int first, unsigned int cnt,
+                        float maxValue, float goodValue, float badValue) {
+    addOverlayRect(overlay, x, y, w, h, makeOverlayColor(0, 0, 0, 128));
+    if(values.empty() || cnt == 0 || maxValue <= 0.0f) {
+        return;
+    }
+
+    // Newest sample at the right edge
+    cnt = min(cnt, (unsigned int)values.size());
+    float barWidth = w / values.size();
+    float startX = x + w - cnt * barWidth;
+    for(unsigned int i = 0; i < cnt; i++) {
+        float value = values[(first + i) % values.size()];
+        float barHeight = min(value / maxValue, 1.0f) * h;
+        if(barHeight <= 0.0f) {
+            continue;
+        }
+
+        glm::u8vec4 color = (value <= goodValue) ? makeOverlayColor(80, 220, 80, 220)
+                          : (value <= badValue) ? makeOverlayColor(240, 200, 60, 220)
+                                                : makeOverlayColor(240, 70, 60, 220);
+        addOverlayRect(overlay, startX + i * barWidth, y + h - barHeight, barWidth, barHeight, color);
+    }
+
+    // Where "good" ends
+    float guideY = y + h - min(goodValue / maxValue, 1.0f) * h;
+    addOverlayRect(overlay, x, guideY, w, max(1.0f, getOverlayScale(overlay) * 0.5f),
+                   makeOverlayColor(255, 255, 255, 96));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Performance panel
+///////////////////////////////////////////////////////////////////////////////
+
+static string formatOverlayCount(unsigned long long cnt) {
+    ostringstream out;
+    out << fixed << setprecision(2);
+    if(cnt >= 1000000ull) {
+        out << (cnt / 1e6) << "M";
+    }
+    else if(cnt >= 10000ull) {
+        out << setprecision(1) << (cnt / 1e3) << "K";
+    }
+    else {
+        out << cnt;
+    }
+    return out.str();
+}
+
+static string formatOverlayScope(const string &name, float avgMs, float p95Ms) {
+    string shortName = (name.size() > 16) ? name.substr(0, 15) + "~" : name;
+    ostringstream out;
+    out << fixed << setprecision(3) << "  " << left << setw(17) << shortName
+        << right << setw(7) << avgMs << setw(8) << p95Ms;
+    return out.str();
+}
+
+static void refreshOverlayLines(VulkanOverlay &overlay, const OverlayFrameInfo &info,
+                                VulkanGPUProfiler *gpuProfiler) {
+    overlay.lines.clear();
+    ostringstream out;
+    out << fixed;
+
+    CPUTimeStats frame = getCPUFrameTimeStats();
+    out << setprecision(1) << "FPS " << ((frame.avgMs > 0.0f) ? 1000.0f / frame.avgMs : 0.0f)
+        << setprecision(2) << "  CPU " << frame.avgMs << " ms  p95 " << frame.p95Ms
+        << "  p99 " << frame.p99Ms;
+    overlay.lines.push_back(out.str());
+
+    out.str("");
+    out << "GPU ";
+    if(info.gpuFrameTime > 0.0f) {
+        out << setprecision(2) << (1000.0f * info.gpuFrameTime) << " ms";
+    }
+    else {
+        out << "n/a";
+    }
+    out << "  draws " << info.drawCnt << "  tris " << formatOverlayCount(info.triangleCnt);
+    overlay.lines.push_back(out.str());
+
+    // Device memory the lib allocated (buffers and images own all of it)
+    VulkanObjectSnapshot objects = getVulkanObjectSnapshot();
+    long long deviceBytes = 0;
+    for(int type = 0; type < VULKAN_OBJECT_TYPE_CNT; type++) {
+        deviceBytes += objects.bytes[type];
+    }
+    unsigned long long processBytes = getProcessMemoryBytes();
+    out.str("");
+    out << setprecision(1) << "Mem: process ";
+    if(processBytes > 0) {
+        out << (processBytes / (1024.0 * 1024.0)) << " MB";
+    }
+    else {
+        out << "n/a";
+    }
+    out << ", Vulkan " << (deviceBytes / (1024.0 * 1024.0)) << " MB";
+    overlay.lines.push_back(out.str());
+
+    overlay.lines.insert(overlay.lines.end(), info.extraLines.begin(), info.extraLines.end());
+
+    vector<CPUTimeStats> cpuScopes = getCPUScopeStats();
+    if(!cpuScopes.empty()) {
+        overlay.lines.push_back("CPU scopes (ms)       avg     p95");
+        for(unsigned int i = 0; i < cpuScopes.size() && i < OVERLAY_PANEL_MAX_SCOPES; i++) {
+            overlay.lines.push_back(formatOverlayScope(cpuScopes[i].name, cpuScopes[i].avgMs, cpuScopes[i].p95Ms));
+        }
+    }
+
+    if(gpuProfiler) {
+        vector<GPUScopeStats> gpuScopes = getGPUScopeStats(*gpuProfiler);
+        if(!gpuScopes.empty()) {
+            overlay.lines.push_back("GPU scopes (ms)       avg     p95");
+            for(unsigned int i = 0; i < gpuScopes.size() && i < OVERLAY_PANEL_MAX_SCOPES; i++) {
+                overlay.lines.push_back(formatOverlayScope(gpuScopes[i].name, gpuScopes[i].avgMs, gpuScopes[i].p95Ms));
+            }
+        }
+    }
+
+    if(overlay.droppedQuadCnt > 0) {
+        overlay.lines.push_back("(" + to_string(overlay.droppedQuadCnt) + " quads dropped)");
+    }
+}
+
+void updateVulkanOverlayStats(  VulkanOverlay &overlay, const OverlayFrameInfo &info,
+                                VulkanGPUProfiler *gpuProfiler) {
+    if(!overlay.cpuHistory.empty()) {
+        overlay.cpuHistory[overlay.historyNext] = 1000.0f * info.cpuFrameTime;
+        overlay.gpuHistory[overlay.historyNext] = 1000.0f * info.gpuFrameTime;
+        overlay.historyNext = (overlay.historyNext + 1) % overlay.cpuHistory.size();
+        overlay.historyCnt = min(overlay.historyCnt + 1, (unsigned int)overlay.cpuHistory.size());
+    }
+
+    // Text only while it is shown (percentiles sort every scope's history)
+    overlay.sinceRefresh += info.cpuFrameTime;
+    if(!overlay.visible) {
+        overlay.refreshNeeded = true;
+        return;
+    }
+    if(overlay.refreshNeeded || overlay.sinceRefresh >= overlay.refreshInterval) {
+        refreshOverlayLines(overlay, info, gpuProfiler);
+        overlay.sinceRefresh = 0.0f;
+        overlay.refreshNeeded = false;
+    }
+}
+
+bool isVulkanOverlayRefreshDue(VulkanOverlay &overlay, float cpuFrameTime) {
+    return overlay.visible
+           && (overlay.refreshNeeded || overlay.sinceRefresh + cpuFrameTime >= overlay.refreshInterval);
+}
+
+void addOverlayPerformancePanel(VulkanOverlay &overlay, float x, float y) {
+    float scale = getOverlayScale(overlay);
+    float lineHeight = OVERLAY_LINE_ADVANCE * scale;
+    float pad = 4.0f * scale;
+
+    size_t cols = OVERLAY_PANEL_MIN_COLS;
+    for(auto &line : overlay.lines) {
+        cols = max(cols, line.size());
+    }
+    float graphWidth = OVERLAY_GRAPH_SAMPLES * scale;
+    float graphHeight = OVERLAY_GRAPH_HEIGHT * scale;
+    float width = max(cols * OVERLAY_CHAR_ADVANCE * scale, graphWidth);
+
+    bool gpuKnown = false;
+    for(unsigned int i = 0; i < overlay.historyCnt && !gpuKnown; i++) {
+        gpuKnown = overlay.gpuHistory[(overlay.historyNext + overlay.gpuHistory.size() - 1 - i)
+                                      % overlay.gpuHistory.size()] > 0.0f;
+    }
+    unsigned int graphCnt = gpuKnown ? 2 : 1;
+    float height = graphCnt * (lineHeight + graphHeight + pad) + overlay.lines.size() * lineHeight;
+
+    addOverlayRect(overlay, x, y, width + 2.0f * pad, height + 2.0f * pad, makeOverlayColor(0, 0, 0, 160));
+    x += pad;
+    y += pad;
+
+    // Oldest sample first
+    unsigned int first = (overlay.historyNext + overlay.cpuHistory.size() - overlay.historyCnt)
+                         % overlay.cpuHistory.size();
+    glm::u8vec4 labelColor = makeOverlayColor(160, 200, 255);
+
+    addOverlayText(overlay, x, y, "CPU frame (ms, line = 16.7)", labelColor);
+    y += lineHeight;
+    addOverlayGraph(overlay, x, y, graphWidth, graphHeight, overlay.cpuHistory, first, overlay.historyCnt,
+                    OVERLAY_GRAPH_MAX_MS, OVERLAY_GRAPH_GOOD_MS, OVERLAY_GRAPH_MAX_MS);
+    y += graphHeight + pad;
+
+    if(gpuKnown) {
+        addOverlayText(overlay, x, y, "GPU frame (ms)", labelColor);
+        y += lineHeight;
+        addOverlayGraph(overlay, x, y, graphWidth, graphHeight, overlay.gpuHistory, first, overlay.historyCnt,
+                        OVERLAY_GRAPH_MAX_MS, OVERLAY_GRAPH_GOOD_MS, OVERLAY_GRAPH_MAX_MS);
+        y += graphHeight + pad;
+    }
+
+    for(auto &line : overlay.lines) {
+        bool header = !line.empty() && line[0] != ' ';
+        addOverlayText(overlay, x, y, line, header ? makeOverlayColor(255, 255, 255)
+                                                   : makeOverlayColor(210, 210, 210));
+        y += lineHeight;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+void recordVulkanOverlay(   vk::CommandBuffer &commandBuffer, VulkanOverlay &overlay,
+                            unsigned int frameSlot, unsigned int imageIndex) {
+    CPU_PROFILE_SCOPE("overlay");
+
+    if(!overlay.visible || overlay.vertices.empty() || imageIndex >= overlay.framebuffers.size()) {
+        overlay.vertices.clear();
+        return;
+    }
+
+    // This slot's region (its fence was waited on: the GPU is done with it)
+    size_t regionVertexCnt = size_t(overlay.maxQuads) * 6;
+    size_t regionStart = (frameSlot % overlay.framesInFlight) * regionVertexCnt;
+    unsigned int vertexCnt = (unsigned int)min(overlay.vertices.size(), regionVertexCnt);
+    memcpy(overlay.mapped + regionStart, overlay.vertices.data(), vertexCnt * sizeof(OverlayVertex));
+    overlay.vertices.clear();
+
+    vk::Extent2D extent = overlay.extent;
+    commandBuffer.beginRenderPass(vk::RenderPassBeginInfo(
+        overlay.renderPass, overlay.framebuffers[imageIndex], { {0,0}, extent }),
+        vk::SubpassContents::eInline);
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, overlay.pipeline);
+
+    vk::Viewport viewports[] = {{0, 0, (float)extent.width, (float)extent.height, 0.0f, 1.0f}};
+    commandBuffer.setViewport(0, viewports);
+    vk::Rect2D scissors[] = {{{0,0}, extent}};
+    commandBuffer.setScissor(0, scissors);
+
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, overlay.pipelineLayout,
+                                     0, overlay.descriptorSet, {});
+
+    OverlayPushConstants pc;
+    pc.scale = glm::vec2(2.0f / extent.width, 2.0f / extent.height);
+    commandBuffer.pushConstants(overlay.pipelineLayout, vk::ShaderStageFlagBits::eVertex,
+                                0, sizeof(OverlayPushConstants), &pc);
+
+    vk::Buffer vertexBuffers[] = {overlay.vertexBuffer.buffer};
+    vk::DeviceSize offsets[] = {regionStart * sizeof(OverlayVertex)};
+    commandBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
+
+    // Everything in one draw
+    commandBuffer.draw(vertexCnt, 1, 0, 0);
+
+    commandBuffer.endRenderPass();
+}
@@ -0,0 +1,89 @@
+#include "VKPushDescriptor.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Setup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanPushDescriptors createVulkanPushDescriptors(VulkanInitData &vkInitData) {
+    VulkanPushDescriptors push;
+
+    if(isVulkanDeviceExtensionEnabled(vkInitData, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) {
+        // Extension command: not exported by the loader, so fetch it from the device
+        push.cmdPushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+            vkGetDeviceProcAddr(vkInitData.device, "vkCmdPushDescriptorSetKHR"));
+
+        auto props = vkInitData.physicalDevice.getProperties2<
+            vk::PhysicalDeviceProperties2, vk::PhysicalDevicePushDescriptorPropertiesKHR>();
+        push.maxPushDescriptors = props.get<vk::PhysicalDevicePushDescriptorPropertiesKHR>().maxPushDescriptors;
+        push.supported = (push.cmdPushDescriptorSet != nullptr);
+    }
+
+    if(!push.supported) {
+        cout << "WARNING: " << VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME << " not supported." << endl;
+    }
+
+    return push;
+}
+
+vk::DescriptorSetLayoutCreateFlags getPushDescriptorLayoutFlags(VulkanPushDescriptors &push) {
+    if(push.supported) {
+        return vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR;
+    }
+    return {};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Writes
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanPushDescriptorWrite makePushBufferWrite(  unsigned int binding, vk::DescriptorType type,
+                                                vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+    VulkanPushDescriptorWrite write;
+    write.binding = binding;
+    write.type = type;
+    write.bufferInfo = vk::DescriptorBufferInfo(buffer, offset, range);
+    return write;
+}
+
+VulkanPushDescriptorWrite makePushImageWrite(   unsigned int binding, vk::DescriptorType type,
+                                                vk::Sampler sampler, vk::ImageView view, vk::ImageLayout layout) {
+    VulkanPushDescriptorWrite write;
+    write.binding = binding;
+    write.type = type;
+    write.imageInfo = vk::DescriptorImageInfo(sampler, view, layout);
+    return write;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+void recordPushDescriptorSet(   vk::CommandBuffer &commandBuffer, VulkanPushDescriptors &push,
+                                vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout,
+                                unsigned int set, const vector<VulkanPushDescriptorWrite> &writes) {
+    if(!push.supported) {
+        throw runtime_error("recordPushDescriptorSet: Push descriptors not supported!");
+    }
+
+    // The info structs are copied into the command buffer, so the
+    // descriptor writes only have to live until the call returns
+    vector<vk::WriteDescriptorSet> descWrites;
+    descWrites.reserve(writes.size());
+    for(auto &write : writes) {
+        vk::WriteDescriptorSet descWrite({}, write.binding, 0, 1, write.type);
+        if(write.type == vk::DescriptorType::eUniformBuffer
+            || write.type == vk::DescriptorType::eStorageBuffer) {
+            descWrite.setPBufferInfo(&write.bufferInfo);
+        }
+        else {
+            descWrite.setPImageInfo(&write.imageInfo);
+        }
+        descWrites.push_back(descWrite);
+    }
+
+    push.cmdPushDescriptorSet(  static_cast<VkCommandBuffer>(commandBuffer),
+                                static_cast<VkPipelineBindPoint>(bindPoint),
+                                static_cast<VkPipelineLayout>(layout), set,
+                                static_cast<uint32_t>(descWrites.size()),
+                                reinterpret_cast<const VkWriteDescriptorSet*>(descWrites.data()));
+}
@@ -1,4 +1,5 @@
 #include "VKRender.hpp"
+#include "CPUProfiler.hpp"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Constructors and Destructor
@@ -13,7 +14,8 @@ bool VulkanRenderEngine::initialize(VulkanInitRenderParams *params) {
         // Create depth image    
         this->depthImage = createVulkanDepthImage(  vkInitData, 
                                                     vkInitData.swapchain.extent.width, 
-                                                    vkInitData.swapchain.extent.height);
+                                                    vkInitData.swapchain.extent.height,
+                                                    this->depthImageUsage);
 
         // Create render pass
         this->renderPass = createVulkanRenderPass(this->depthImage);
@@ -21,7 +23,8 @@ bool VulkanRenderEngine::initialize(VulkanInitRenderParams *params) {
         // Create pipeline
         this->pipelineData = createVulkanPipelineData(  this->renderPass,
                                                         params->vertSPVFilename, 
-                                                        params->fragSPVFilename);
+                                                        params->fragSPVFilename,
+                                                        this->pipelineOptions);
 
         // Create frame buffers
         this->framebuffers = createVulkanFramebuffers(this->renderPass, this->depthImage);
@@ -111,7 +114,8 @@ void VulkanRenderEngine::recreateSwapChain() {
     // (Re)create depth image
     this->depthImage = createVulkanDepthImage(  vkInitData, 
                                                 vkInitData.swapchain.extent.width, 
-                                                vkInitData.swapchain.extent.height);
+                                                vkInitData.swapchain.extent.height,
+                                                this->depthImageUsage);
 
     // (Re)create frame buffers
     this->framebuffers = createVulkanFramebuffers(this->renderPass, this->depthImage);
@@ -122,6 +126,11 @@ void VulkanRenderEngine::recreateSwapChain() {
 ///////////////////////////////////////////////////////////////////////////////
 
 vk::RenderPass VulkanRenderEngine::createVulkanRenderPass(VulkanImage &depthImage) {
+    return createVulkanRenderPass(depthImage, VulkanRenderPassOptions());
+}
+
+vk::RenderPass VulkanRenderEngine::createVulkanRenderPass(  VulkanImage &depthImage, 
+                                                            VulkanRenderPassOptions options) {
 
     // Create attachment for color and depth
     vector<vk::AttachmentDescription> attachmentDescriptions;
@@ -131,12 +140,15 @@ vk::RenderPass VulkanRenderEngine::createVulkanRenderPass(VulkanImage &depthImag
         {},
         vkInitData.swapchain.format,
         vk::SampleCountFlagBits::e1,
-        vk::AttachmentLoadOp::eClear,       // Clear buffer to constant value on load
+        options.loadContents ? vk::AttachmentLoadOp::eLoad 
+                             : vk::AttachmentLoadOp::eClear,    // Clear buffer to constant value on load
         vk::AttachmentStoreOp::eStore,      // Store values (so we can see what we render :)
         vk::AttachmentLoadOp::eDontCare,    // Don't care about stencil buffer
         vk::AttachmentStoreOp::eDontCare,
-        vk::ImageLayout::eUndefined,        // Initially undefined before presentation
-        vk::ImageLayout::ePresentSrcKHR     // Present appropriate to surface
+        options.loadContents ? vk::ImageLayout::eColorAttachmentOptimal 
+                             : vk::ImageLayout::eUndefined,     // Initially undefined before presentation
+        options.present ? vk::ImageLayout::ePresentSrcKHR 
+                        : vk::ImageLayout::eColorAttachmentOptimal  // Present appropriate to surface
     ));
     
     // Depth attachment
@@ -144,11 +156,14 @@ vk::RenderPass VulkanRenderEngine::createVulkanRenderPass(VulkanImage &depthImag
         {},
         depthImage.format,
         vk::SampleCountFlagBits::e1,
-        vk::AttachmentLoadOp::eClear,       // Clear buffer to constant value on load
-        vk::AttachmentStoreOp::eDontCare,   // We don't need to see this later
+        options.loadContents ? vk::AttachmentLoadOp::eLoad 
+                             : vk::AttachmentLoadOp::eClear,    // Clear buffer to constant value on load
+        options.storeDepth ? vk::AttachmentStoreOp::eStore 
+                           : vk::AttachmentStoreOp::eDontCare,  // Usually don't need to see this later
         vk::AttachmentLoadOp::eDontCare,    // Don't care about stencil buffer
         vk::AttachmentStoreOp::eDontCare,
-        vk::ImageLayout::eUndefined,        // Initially undefined before presentation
+        options.loadContents ? vk::ImageLayout::eDepthStencilAttachmentOptimal 
+                             : vk::ImageLayout::eUndefined,     // Initially undefined before presentation
         vk::ImageLayout::eDepthStencilAttachmentOptimal     // Present as depth buffer
     ));
 
@@ -167,12 +182,24 @@ vk::RenderPass VulkanRenderEngine::createVulkanRenderPass(VulkanImage &depthImag
         &depthAttachmentRef
     );  
 
-    // Make the ACTUAL render pass
-    return vkInitData.device.createRenderPass(vk::RenderPassCreateInfo(
+    vk::RenderPassCreateInfo renderPassInfo(
         {},
         attachmentDescriptions,
         subpassDescription
-    ));      
+    );
+
+    // Multiview: the one subpass broadcasts to all views (which are spatially 
+    // correlated, so the implementation may share work between them)
+    uint32_t viewMask = (1u << options.viewCnt) - 1u;
+    vk::RenderPassMultiviewCreateInfo multiviewInfo;
+    if(options.viewCnt > 1) {
+        multiviewInfo.setViewMasks(viewMask);
+        multiviewInfo.setCorrelationMasks(viewMask);
+        renderPassInfo.setPNext(&multiviewInfo);
+    }
+
+    // Make the ACTUAL render pass
+    return vkInitData.device.createRenderPass(renderPassInfo);      
 }
 
 void VulkanRenderEngine::cleanupVulkanRenderPass(vk::RenderPass &pass) {    
@@ -228,37 +255,53 @@ vector<vk::PushConstantRange> VulkanRenderEngine::getPushConstantRanges() {
 VulkanPipelineData VulkanRenderEngine::createVulkanPipelineData(      
     vk::RenderPass &renderPass, 
     string vertSPVFilename, 
-    string fragSPVFilename) {
+    string fragSPVFilename,
+    VulkanPipelineOptions options) {
        
     // Set up data
     VulkanPipelineData data;
 
+    // Depth-only pipelines have no fragment shader
+    bool hasFragShader = !fragSPVFilename.empty();
+
     // Load up BYTECODE shader files
     auto vertShaderCode = readBinaryFile(vertSPVFilename);
-    auto fragShaderCode = readBinaryFile(fragSPVFilename);
 
     // Compiling/linking to GPU machine code doesn't happen until graphics pipeline created.
     // Once the pipeline is created, we will be able to destroy these modules safely.
     vk::ShaderModule vertShaderModule = createVulkanShaderModule(vkInitData.device, vertShaderCode);
-    vk::ShaderModule fragShaderModule = createVulkanShaderModule(vkInitData.device, fragShaderCode);
+    vk::ShaderModule fragShaderModule;
 
     // Assign VERTEX SHADER to appropriate stage
-    vk::PipelineShaderStageCreateInfo vertShaderStageInfo(
-        {}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main");  
+    vector<vk::PipelineShaderStageCreateInfo> shaderStages;
+    shaderStages.push_back(vk::PipelineShaderStageCreateInfo(
+        {}, vk::ShaderStageFlagBits::eVertex, vertShaderModule, "main"));  
    
     // Assign FRAGMENT SHADER to appropriate stage
-    vk::PipelineShaderStageCreateInfo fragShaderStageInfo(
-        {}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main");  
-
-    // Combine them
-    vk::PipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+    if(hasFragShader) {
+        auto fragShaderCode = readBinaryFile(fragSPVFilename);
+        fragShaderModule = createVulkanShaderModule(vkInitData.device, fragShaderCode);
+        shaderStages.push_back(vk::PipelineShaderStageCreateInfo(
+            {}, vk::ShaderStageFlagBits::eFragment, fragShaderModule, "main"));
+    }
 
     // Get the attribute description data
     AttributeDescData attribDescData = getAttributeDescData(); 
     
+    // Combine per-vertex binding with any per-instance bindings
+    vector<vk::VertexInputBindingDescription> allBindDesc = { attribDescData.bindDesc };
+    allBindDesc.insert(allBindDesc.end(), 
+                        attribDescData.instanceBindDesc.begin(), 
+                        attribDescData.instanceBindDesc.end());
+
     // Set up how attributes are arranged
     vk::PipelineVertexInputStateCreateInfo vertexInputInfo(
-        {}, attribDescData.bindDesc, attribDescData.attribDesc);
+        {}, allBindDesc, attribDescData.attribDesc);
+
+    // Full-screen passes generate vertices in the shader
+    if(!options.vertexInput) {
+        vertexInputInfo = vk::PipelineVertexInputStateCreateInfo();
+    }
         
     // Render a regular triangle list
     vk::PipelineInputAssemblyStateCreateInfo inputAssembly({}, vk::PrimitiveTopology::eTriangleList, false);
@@ -299,20 +342,26 @@ VulkanPipelineData VulkanRenderEngine::createVulkanPipelineData(
     // Basically no blending here
     // Per frame buffer...
     vk::PipelineColorBlendAttachmentState colorBlendAttachment {};
-    colorBlendAttachment.colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+    if(options.colorWrite) {
+        colorBlendAttachment.colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+    }
+    
+    // Same blending for every color attachment in the subpass
+    vector<vk::PipelineColorBlendAttachmentState> colorBlendAttachments(
+        options.colorAttachmentCnt, colorBlendAttachment);
     
     // Set up depth testing
     vk::PipelineDepthStencilStateCreateInfo depthStencil(
         {},
-        true,                   // Enable depth testing
-        true,                   // Enable depth writing
-        vk::CompareOp::eLess,   // Lower depth = closer = keep
+        options.depthTest,      // Enable depth testing (usually)
+        options.depthWrite,     // Enable depth writing (usually)
+        options.depthCompare,   // Usually eLess: lower depth = closer = keep
         false,                  // Not putting bounds on depth test
         false, {}, {}          // Not using stencil test
     );
 
     // Global blend settings
-    vk::PipelineColorBlendStateCreateInfo colorBlending({}, false, vk::LogicOp::eCopy, colorBlendAttachment);
+    vk::PipelineColorBlendStateCreateInfo colorBlending({}, false, vk::LogicOp::eCopy, colorBlendAttachments);
         
     // Get the pipeline creation info
     data.descriptorSetLayouts = getDescriptorSetLayouts();
@@ -346,7 +395,8 @@ VulkanPipelineData VulkanRenderEngine::createVulkanPipelineData(
                                                 &colorBlending,
                                                 &dynamicState,
                                                 data.pipelineLayout,
-                                                renderPass);    
+                                                renderPass,
+                                                options.subpass);    
     
     auto ret = vkInitData.device.createGraphicsPipeline(data.cache, pipelineInfo);
 
@@ -356,9 +406,12 @@ VulkanPipelineData VulkanRenderEngine::createVulkanPipelineData(
 
     // Set pipeline
     data.graphicsPipeline = ret.value;
+    trackVulkanObject(VULKAN_OBJECT_PIPELINE, data.graphicsPipeline, 0, VULKAN_CALL_SITE);
 
     // Cleanup modules
-    vkInitData.device.destroyShaderModule(fragShaderModule);
+    if(hasFragShader) {
+        vkInitData.device.destroyShaderModule(fragShaderModule);
+    }
     vkInitData.device.destroyShaderModule(vertShaderModule);
     
     // Return data
@@ -372,6 +425,7 @@ void VulkanRenderEngine::cleanupVulkanPipelineData(VulkanPipelineData &pipelineD
 
     vkInitData.device.destroyPipelineCache(pipelineData.cache);
     vkInitData.device.destroyPipelineLayout(pipelineData.pipelineLayout);
+    untrackVulkanObject(VULKAN_OBJECT_PIPELINE, pipelineData.graphicsPipeline);
     vkInitData.device.destroyPipeline(pipelineData.graphicsPipeline);
 }
 
@@ -468,10 +522,12 @@ void VulkanRenderEngine::notifyFrameResize() {
 void VulkanRenderEngine::drawFrame(void *userData) {
 
     // Is the current size 0 x 0 (minimized?)
-    int windowWidth = 0, windowHeight = 0;
-    glfwGetFramebufferSize(vkInitData.window, &windowWidth, &windowHeight);
-    if(windowWidth == 0 || windowHeight == 0) {
-        return;
+    if(!vkInitData.headless) {
+        int windowWidth = 0, windowHeight = 0;
+        glfwGetFramebufferSize(vkInitData.window, &windowWidth, &windowHeight);
+        if(windowWidth == 0 || windowHeight == 0) {
+            return;
+        }
     }
 
     // Have we resized recently?
@@ -482,16 +538,29 @@ void VulkanRenderEngine::drawFrame(void *userData) {
     }
 
     // Wait for this image to finish
-    auto waitRes = vkInitData.device.waitForFences(1, &this->allFrameData[currentImage].inFlightFence, true, UINT64_MAX);
-    if(waitRes != vk::Result::eSuccess) {
-        throw runtime_error("drawFrame: Timeout while waiting for image fence!");
+    {
+        CPU_PROFILE_SCOPE("fence wait");
+        auto waitRes = vkInitData.device.waitForFences(1, &this->allFrameData[currentImage].inFlightFence, true, UINT64_MAX);
+        if(waitRes != vk::Result::eSuccess) {
+            throw runtime_error("drawFrame: Timeout while waiting for image fence!");
+        }
     }
 
-    // Acquire a frame index from the swap chain
-    auto result = vkInitData.device.acquireNextImageKHR(vkInitData.swapchain.chain, 
-                                                        UINT64_MAX, 
-                                                        this->allFrameData[currentImage].imageAvailableSemaphore, 
-                                                        nullptr);   
+    // Get actual image index for framebuffer purposes:
+    // - Headless: image of this frame slot (the fence above says it is free)
+    // - Otherwise: acquire a frame index from the swap chain
+    unsigned int frameIndex = 0;
+    if(vkInitData.headless) {
+        frameIndex = currentImage % vkInitData.swapchain.images.size();
+    }
+    else {
+        CPU_PROFILE_SCOPE("acquire");
+        auto result = vkInitData.device.acquireNextImageKHR(vkInitData.swapchain.chain, 
+                                                            UINT64_MAX, 
+                                                            this->allFrameData[currentImage].imageAvailableSemaphore, 
+                                                            nullptr);   
+        frameIndex = result.value;
+    }
 
     // Reset the fence since we're about to submit work
     auto resetRes = vkInitData.device.resetFences(1, &this->allFrameData[currentImage].inFlightFence);
@@ -499,12 +568,12 @@ void VulkanRenderEngine::drawFrame(void *userData) {
         throw runtime_error("drawFrame: Failed to reset image fence!");
     }
     
-    // Get actual image index for framebuffer purposes
-    unsigned int frameIndex = result.value;
-    
     // Record a command buffer which draws the scene onto that image
-    this->allFrameData[currentImage].commandBuffer.reset();        
-    recordCommandBuffer(userData, this->allFrameData[currentImage].commandBuffer, frameIndex);
+    {
+        CPU_PROFILE_SCOPE("record");
+        this->allFrameData[currentImage].commandBuffer.reset();        
+        recordCommandBuffer(userData, this->allFrameData[currentImage].commandBuffer, frameIndex);
+    }
 
     // Submit the recorded command buffer
     vk::Semaphore waitSemaphores[] = {this->allFrameData[currentImage].imageAvailableSemaphore};
@@ -516,8 +585,21 @@ void VulkanRenderEngine::drawFrame(void *userData) {
         waitStages,
         this->allFrameData[currentImage].commandBuffer,
         signalSemaphores);
+
+    // Headless: nothing was acquired and nothing will be presented
+    if(vkInitData.headless) {
+        submitInfo = vk::SubmitInfo({}, {}, this->allFrameData[currentImage].commandBuffer, {});
+    }
                 
-    vkInitData.graphicsQueue.queue.submit(submitInfo, this->allFrameData[currentImage].inFlightFence);
+    {
+        CPU_PROFILE_SCOPE("submit");
+        vkInitData.graphicsQueue.queue.submit(submitInfo, this->allFrameData[currentImage].inFlightFence);
+    }
+
+    if(vkInitData.headless) {
+        currentImage = (currentImage + 1) % MAX_FRAMES_IN_FLIGHT;
+        return;
+    }
         
     // Present the swap chain image
     vk::SwapchainKHR swapChains[] = {vkInitData.swapchain.chain};
@@ -525,6 +607,7 @@ void VulkanRenderEngine::drawFrame(void *userData) {
     vk::PresentInfoKHR presentInfo(signalSemaphores, swapChains, imageIndices);
     
     try {
+        CPU_PROFILE_SCOPE("present");
         auto presentRes = vkInitData.presentQueue.queue.presentKHR(presentInfo);
     }
     catch(const vk::OutOfDateKHRError& e) {
@@ -0,0 +1,404 @@
+#include "VKRenderQueue.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Sort keys
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t makeDrawSortKey(   unsigned int pipelineID, unsigned int materialID,
+                            unsigned int meshID, float normDepth) {
+
+    // Quantize depth to 24 bits (0 = nearest)
+    const uint64_t maxDepth = (1ull << SORT_KEY_DEPTH_BITS) - 1;
+    normDepth = min(max(normDepth, 0.0f), 1.0f);
+    uint64_t depth = static_cast<uint64_t>(normDepth * maxDepth);
+
+    return (uint64_t(pipelineID & 0xFF) << 56)
+            | (uint64_t(materialID & 0xFFFF) << 40)
+            | (uint64_t(meshID & 0xFFFF) << 24)
+            | depth;
+}
+
+unsigned int getSortKeyPipeline(uint64_t key) {
+    return static_cast<unsigned int>((key >> 56) & 0xFF);
+}
+
+unsigned int getSortKeyMaterial(uint64_t key) {
+    return static_cast<unsigned int>((key >> 40) & 0xFFFF);
+}
+
+unsigned int getSortKeyMesh(uint64_t key) {
+    return static_cast<unsigned int>((key >> 24) & 0xFFFF);
+}
+
+void radixSortDrawPackets(vector<DrawPacket> &packets, vector<DrawPacket> &scratch) {
+    size_t cnt = packets.size();
+    if(cnt < 2) {
+        return;
+    }
+
+    scratch.resize(cnt);
+
+    // Build all 8 histograms in one pass
+    unsigned int histograms[8][256] = {};
+    for(size_t i = 0; i < cnt; i++) {
+        uint64_t key = packets[i].key;
+        for(unsigned int b = 0; b < 8; b++) {
+            histograms[b][(key >> (b*8)) & 0xFF]++;
+        }
+    }
+
+    DrawPacket *src = packets.data();
+    DrawPacket *dst = scratch.data();
+
+    for(unsigned int b = 0; b < 8; b++) {
+        unsigned int *hist = histograms[b];
+
+        // Skip pass if every key has the same byte here
+        if(hist[(src[0].key >> (b*8)) & 0xFF] == cnt) {
+            continue;
+        }
+
+        // Prefix sum -> starting offsets
+        unsigned int offset = 0;
+        for(unsigned int i = 0; i < 256; i++) {
+            unsigned int c = hist[i];
+            hist[i] = offset;
+            offset += c;
+        }
+
+        // Scatter (stable)
+        for(size_t i = 0; i < cnt; i++) {
+            unsigned int bucket = (src[i].key >> (b*8)) & 0xFF;
+            dst[hist[bucket]++] = src[i];
+        }
+
+        swap(src, dst);
+    }
+
+    // Make sure result ends up in packets
+    if(src != packets.data()) {
+        memcpy(packets.data(), src, sizeof(DrawPacket)*cnt);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Render queue: registration
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int VulkanRenderQueue::addPipeline(vk::Pipeline pipeline) {
+    if(pipelines.size() >= SORT_KEY_MAX_PIPELINES) {
+        throw runtime_error("addPipeline: Too many pipelines for the sort key!");
+    }
+    pipelines.push_back(pipeline);
+    return pipelines.size() - 1;
+}
+
+unsigned int VulkanRenderQueue::addMaterial(const VulkanQueueMaterial &material) {
+    if(materials.size() >= SORT_KEY_MAX_MATERIALS) {
+        throw runtime_error("addMaterial: Too many materials for the sort key!");
+    }
+    materials.push_back(material);
+    return materials.size() - 1;
+}
+
+unsigned int VulkanRenderQueue::addMesh(VulkanMesh *mesh, glm::vec4 boundingSphere) {
+    // Every LOD of every mesh takes an ID
+    if(meshes.size() >= SORT_KEY_MAX_MESHES) {
+        throw runtime_error("addMesh: Too many meshes for the sort key!");
+    }
+    meshes.push_back(mesh);
+    meshBounds.push_back(boundingSphere);
+    meshMeshlets.push_back(nullptr);
+    return meshes.size() - 1;
+}
+
+void VulkanRenderQueue::setMeshMeshlets(unsigned int meshID, const vector<Meshlet> *meshlets) {
+    meshMeshlets.at(meshID) = meshlets;
+}
+
+void VulkanRenderQueue::setDepthRange(float nearDepth, float farDepth) {
+    this->nearDepth = nearDepth;
+    this->farDepth = farDepth;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Render queue: per frame
+///////////////////////////////////////////////////////////////////////////////
+
+void VulkanRenderQueue::begin() {
+    packets.clear();
+    instances.clear();
+    runs.clear();
+    drawCnt = 0;
+    pipelineBindCnt = 0;
+    materialBindCnt = 0;
+}
+
+void VulkanRenderQueue::add(unsigned int pipelineID, unsigned int materialID, unsigned int meshID,
+                            float viewDepth, const InstanceData &instance) {
+
+    float normDepth = (viewDepth - nearDepth) / (farDepth - nearDepth);
+
+    DrawPacket packet;
+    packet.key = makeDrawSortKey(pipelineID, materialID, meshID, normDepth);
+    packet.instance = instances.size();
+
+    packets.push_back(packet);
+    instances.push_back(instance);
+}
+
+void VulkanRenderQueue::upload( vk::Device &device, vk::PhysicalDevice &physicalDevice,
+                                VulkanInstanceBuffer &buffer, unsigned int frameIndex) {
+
+    radixSortDrawPackets(packets, scratch);
+
+    ensureVulkanInstanceBufferCapacity(device, physicalDevice, buffer, frameIndex, packets.size());
+    InstanceData *dst = static_cast<InstanceData*>(buffer.mapped[frameIndex]);
+
+    // Gather instances in sorted order and find runs of identical state
+    runs.clear();
+    for(unsigned int i = 0; i < packets.size(); i++) {
+        dst[i] = instances[packets[i].instance];
+
+        uint64_t stateKey = packets[i].key >> SORT_KEY_DEPTH_BITS;
+        if(runs.empty() || runs.back().stateKey != stateKey) {
+            runs.push_back({stateKey, i, 0});
+        }
+        runs.back().instanceCnt++;
+    }
+}
+
+unsigned int VulkanRenderQueue::bindRunState(   vk::CommandBuffer &commandBuffer, const DrawRun &run,
+                                                unsigned int frameIndex, int pipelineOverrideID,
+                                                unsigned int &currentPipeline, unsigned int &currentMaterial) {
+    uint64_t key = run.stateKey << SORT_KEY_DEPTH_BITS;
+    unsigned int pipelineID = (pipelineOverrideID >= 0) ? pipelineOverrideID : getSortKeyPipeline(key);
+    unsigned int materialID = getSortKeyMaterial(key);
+
+    // Only rebind state on change
+    if(pipelineID != currentPipeline) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipelines.at(pipelineID));
+        currentPipeline = pipelineID;
+        pipelineBindCnt++;
+    }
+
+    if(materialID != currentMaterial) {
+        currentMaterial = materialID;
+        if(materialID < materials.size() && !materials[materialID].descriptorSets.empty()) {
+            VulkanQueueMaterial &material = materials[materialID];
+            commandBuffer.bindDescriptorSets(
+                vk::PipelineBindPoint::eGraphics,
+                material.pipelineLayout,
+                material.firstSet,
+                material.descriptorSets[frameIndex % material.descriptorSets.size()],
+                {});
+            materialBindCnt++;
+        }
+        else if(materialID < materials.size() && materials[materialID].pushDescriptors
+                && !materials[materialID].pushWrites.empty()) {
+            VulkanQueueMaterial &material = materials[materialID];
+            recordPushDescriptorSet(commandBuffer, *material.pushDescriptors,
+                                    vk::PipelineBindPoint::eGraphics,
+                                    material.pipelineLayout,
+                                    material.firstSet,
+                                    material.pushWrites[frameIndex % material.pushWrites.size()]);
+            materialBindCnt++;
+        }
+    }
+
+    return getSortKeyMesh(key);
+}
+
+void VulkanRenderQueue::record( vk::CommandBuffer &commandBuffer,
+                                VulkanInstanceBuffer &buffer, unsigned int frameIndex,
+                                unsigned int instanceBinding,
+                                int pipelineOverrideID) {
+
+    const unsigned int NONE = 0xFFFFFFFF;
+    unsigned int currentPipeline = NONE;
+    unsigned int currentMaterial = NONE;
+
+    for(auto &run : runs) {
+        unsigned int meshID = bindRunState( commandBuffer, run, frameIndex, pipelineOverrideID,
+                                            currentPipeline, currentMaterial);
+
+        recordDrawVulkanMeshInstanced(  commandBuffer, *meshes.at(meshID),
+                                        buffer.bufferData[frameIndex].buffer, instanceBinding,
+                                        run.firstInstance, run.instanceCnt);
+        drawCnt++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Render queue: GPU-driven (indirect) path
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int VulkanRenderQueue::getRunCount() {
+    return runs.size();
+}
+
+void VulkanRenderQueue::writeCullingData(CullInstanceInfo *info, glm::vec4 *runBounds) {
+    for(unsigned int r = 0; r < runs.size(); r++) {
+        DrawRun &run = runs[r];
+        unsigned int meshID = getSortKeyMesh(run.stateKey << SORT_KEY_DEPTH_BITS);
+        runBounds[r] = meshBounds.at(meshID);
+
+        for(unsigned int i = run.firstInstance; i < run.firstInstance + run.instanceCnt; i++) {
+            info[i].run = r;
+            info[i].object = packets[i].instance;
+        }
+    }
+}
+
+void VulkanRenderQueue::writeIndirectCommands(  vk::DrawIndexedIndirectCommand *commands,
+                                                unsigned int instanceOffset) {
+    for(unsigned int r = 0; r < runs.size(); r++) {
+        DrawRun &run = runs[r];
+        VulkanMesh *mesh = meshes.at(getSortKeyMesh(run.stateKey << SORT_KEY_DEPTH_BITS));
+        commands[r] = vk::DrawIndexedIndirectCommand(
+                        static_cast<unsigned int>(mesh->indexCnt), 0, mesh->firstIndex, 0,
+                        run.firstInstance + instanceOffset);
+    }
+}
+
+void VulkanRenderQueue::recordIndirect( vk::CommandBuffer &commandBuffer,
+                                        vk::Buffer instanceBuffer, unsigned int frameIndex,
+                                        unsigned int instanceBinding,
+                                        vk::Buffer indirectBuffer, vk::DeviceSize indirectOffset,
+                                        int pipelineOverrideID) {
+
+    const unsigned int NONE = 0xFFFFFFFF;
+    unsigned int currentPipeline = NONE;
+    unsigned int currentMaterial = NONE;
+
+    vk::Buffer instanceBuffers[] = {instanceBuffer};
+    vk::DeviceSize offsets[] = {0};
+    commandBuffer.bindVertexBuffers(instanceBinding, instanceBuffers, offsets);
+
+    for(unsigned int r = 0; r < runs.size(); r++) {
+        unsigned int meshID = bindRunState( commandBuffer, runs[r], frameIndex, pipelineOverrideID,
+                                            currentPipeline, currentMaterial);
+
+        recordDrawVulkanMeshIndirect(   commandBuffer, *meshes.at(meshID), indirectBuffer,
+                                        indirectOffset + r*sizeof(vk::DrawIndexedIndirectCommand));
+        drawCnt++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Render queue: cluster (meshlet) path
+///////////////////////////////////////////////////////////////////////////////
+
+void VulkanRenderQueue::buildClusterDraws(  const glm::vec4 worldPlanes[6], glm::vec3 cameraPos, 
+                                            bool coneCulling) {
+    clusterCommands.clear();
+    clusterRunCommands.clear();
+    clusterStats = MeshletCullStats();
+
+    for(auto &run : runs) {
+        unsigned int meshID = getSortKeyMesh(run.stateKey << SORT_KEY_DEPTH_BITS);
+        VulkanMesh *mesh = meshes.at(meshID);
+        const vector<Meshlet> *meshlets = meshMeshlets.at(meshID);
+        unsigned int firstCommand = clusterCommands.size();
+
+        if(!meshlets) {
+            // Whole mesh, all instances
+            clusterCommands.push_back(vk::DrawIndexedIndirectCommand(
+                static_cast<unsigned int>(mesh->indexCnt), run.instanceCnt, mesh->firstIndex, 0, run.firstInstance));
+        }
+        else {
+            unsigned int culledCnt = clusterStats.frustumCulledCnt + clusterStats.backfaceCulledCnt;
+
+            for(unsigned int i = run.firstInstance; i < run.firstInstance + run.instanceCnt; i++) {
+                clusterRanges.clear();
+                cullMeshlets(*meshlets, instances[packets[i].instance].modelMat, worldPlanes, cameraPos,
+                             coneCulling, clusterRanges, clusterStats);
+
+                for(auto &range : clusterRanges) {
+                    clusterCommands.push_back(vk::DrawIndexedIndirectCommand(
+                        range.indexCnt, 1, range.firstIndex, 0, i));
+                }
+            }
+
+            // Nothing culled: back to one instanced draw for the run
+            if(clusterStats.frustumCulledCnt + clusterStats.backfaceCulledCnt == culledCnt) {
+                clusterCommands.resize(firstCommand);
+                clusterCommands.push_back(vk::DrawIndexedIndirectCommand(
+                    static_cast<unsigned int>(mesh->indexCnt), run.instanceCnt, mesh->firstIndex, 0, 
+                    run.firstInstance));
+            }
+        }
+
+        clusterRunCommands.push_back(glm::uvec2(firstCommand, clusterCommands.size() - firstCommand));
+    }
+}
+
+const vector<vk::DrawIndexedIndirectCommand> &VulkanRenderQueue::getClusterCommands() {
+    return clusterCommands;
+}
+
+MeshletCullStats VulkanRenderQueue::getClusterStats() {
+    return clusterStats;
+}
+
+void VulkanRenderQueue::recordClusters( vk::CommandBuffer &commandBuffer,
+                                        VulkanInstanceBuffer &buffer, unsigned int frameIndex,
+                                        unsigned int instanceBinding,
+                                        vk::Buffer indirectBuffer,
+                                        unsigned int maxDrawIndirectCnt,
+                                        int pipelineOverrideID) {
+
+    const unsigned int NONE = 0xFFFFFFFF;
+    unsigned int currentPipeline = NONE;
+    unsigned int currentMaterial = NONE;
+    const vk::DeviceSize stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+    vk::Buffer instanceBuffers[] = {buffer.bufferData[frameIndex].buffer};
+    vk::DeviceSize offsets[] = {0};
+    commandBuffer.bindVertexBuffers(instanceBinding, instanceBuffers, offsets);
+
+    for(unsigned int r = 0; r < runs.size() && r < clusterRunCommands.size(); r++) {
+        glm::uvec2 commands = clusterRunCommands[r];
+        if(commands.y == 0) {
+            continue;
+        }
+
+        unsigned int meshID = bindRunState( commandBuffer, runs[r], frameIndex, pipelineOverrideID,
+                                            currentPipeline, currentMaterial);
+        recordBindVulkanMesh(commandBuffer, *meshes.at(meshID));
+
+        if(maxDrawIndirectCnt > 1) {
+            // Whole run in one call (split only past the device limit)
+            for(unsigned int c = commands.x; c < commands.x + commands.y; c += maxDrawIndirectCnt) {
+                unsigned int cnt = min(maxDrawIndirectCnt, commands.x + commands.y - c);
+                commandBuffer.drawIndexedIndirect(indirectBuffer, c * stride, cnt, stride);
+                drawCnt++;
+            }
+        }
+        else {
+            // No multiDrawIndirect: direct draws from the host copy
+            for(unsigned int c = commands.x; c < commands.x + commands.y; c++) {
+                const vk::DrawIndexedIndirectCommand &cmd = clusterCommands[c];
+                commandBuffer.drawIndexed(  cmd.indexCount, cmd.instanceCount, cmd.firstIndex, 
+                                            cmd.vertexOffset, cmd.firstInstance);
+                drawCnt++;
+            }
+        }
+    }
+}
+
+unsigned int VulkanRenderQueue::getPacketCount() {
+    return packets.size();
+}
+
+unsigned int VulkanRenderQueue::getDrawCount() {
+    return drawCnt;
+}
+
+unsigned int VulkanRenderQueue::getPipelineBindCount() {
+    return pipelineBindCnt;
+}
+
+unsigned int VulkanRenderQueue::getMaterialBindCount() {
+    return materialBindCnt;
+}
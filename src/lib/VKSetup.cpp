@@ -1,4 +1,7 @@
 #include "VKSetup.hpp"
+#include "VKBuffer.hpp"
+#include <algorithm>
+#include <cstdlib>
 
 ///////////////////////////////////////////////////////////////////////////////
 // GLFW (for Vulkan)
@@ -28,24 +31,40 @@ void cleanupGLFWWindow(GLFWwindow *window) {
     glfwTerminate();
 }
 
+int getHeadlessFrameCount(int &argc, char **argv) {
+    int frameCnt = 0;
+    int keptCnt = 1;
+    for(int i = 1; i < argc; i++) {
+        if(string(argv[i]) == "--headless") {
+            if(i + 1 < argc) {
+                frameCnt = max(0, atoi(argv[++i]));
+            }
+            else {
+                cerr << "getHeadlessFrameCount: --headless needs a frame count!" << endl;
+            }
+        }
+        else {
+            argv[keptCnt++] = argv[i];
+        }
+    }
+    argc = keptCnt;
+    return frameCnt;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Vulkan Boiletplate Setup (using vk-bootstrap and VulkanHPP)
 ///////////////////////////////////////////////////////////////////////////////
 
-bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkInitData) {
-
-    // Store window for reference
-    vkInitData.window = window;
-
-    ///////////////////////////////////////////////////////////////////////////
-    // INSTANCE
-    ///////////////////////////////////////////////////////////////////////////
+// Instance shared by the windowed and headless paths
+static bool initVulkanInstance(string appName, bool headless, VulkanInitData &vkInitData) {
 
     // Create vk-bootstrap instance
     vkb::InstanceBuilder builder;
     // Build the Vulkan instance
     auto instRet = builder.set_app_name(appName.c_str())
                         .set_engine_name("Forge Engine")
+                        .require_api_version(1,1,0) // Vulkan 1.1 core features (e.g., multiview)
+                        .set_headless(headless)     // No surface extensions needed
                         .request_validation_layers()
                         .use_default_debug_messenger()
                         .build();
@@ -58,42 +77,43 @@ bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkI
     }
 
     // Get the VKInstance
-    vkb::Instance vkbInstance = instRet.value();
-    vkInitData.bootInstance = vkbInstance;
+    vkInitData.bootInstance = instRet.value();
 
     // Convert to vk::Instance
-    vkInitData.instance = vk::Instance { vkbInstance.instance };
-    
-    ///////////////////////////////////////////////////////////////////////////
-    // SURFACE
-    ///////////////////////////////////////////////////////////////////////////
-
-    // Create a window surface
-    VkSurfaceKHR surface = nullptr;
-    VkResult surfErr = glfwCreateWindowSurface(vkbInstance.instance, window, NULL, &surface);
-    if(surfErr != VK_SUCCESS) {
-        cerr << "initVulkanBootstrap: Failed to create window surface." << endl;
-        cerr << "Error: " << surfErr << endl;
-        return false;
-    }
+    vkInitData.instance = vk::Instance { vkInitData.bootInstance.instance };
+    return true;
+}
 
-    // Convert to vk::SurfaceKHR
-    vkInitData.surface = vk::SurfaceKHR { surface };
-    
-    ///////////////////////////////////////////////////////////////////////////
-    // DEVICE
-    ///////////////////////////////////////////////////////////////////////////
+// Device and queues; no surface = headless (graphics queue also "presents")
+static bool initVulkanDevice(VulkanInitData &vkInitData) {
+    bool headless = !vkInitData.surface;
 
     // Set up desired features
     vk::PhysicalDeviceFeatures requiredDeviceFeatures {};
     requiredDeviceFeatures.samplerAnisotropy = true;
 
+    // Multiview (core and mandatory in Vulkan 1.1, but must be enabled)
+    VkPhysicalDeviceMultiviewFeatures multiviewFeatures {};
+    multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+    multiviewFeatures.multiview = VK_TRUE;
+
     // Select physical device
-    vkb::PhysicalDeviceSelector selector { vkbInstance };
-    auto physRet = selector.set_surface(surface)
-                        .set_minimum_version(1,1) // require at least a Vulkan 1.1 device
+    vkb::PhysicalDeviceSelector selector { vkInitData.bootInstance };
+    if(headless) {
+        // Nothing to present to, but keep VK_KHR_swapchain so ePresentSrcKHR
+        // stays a legal layout for render passes and blits written for a
+        // window; software ICDs (e.g., lavapipe) report a CPU device type
+        selector.require_present(false)
+                .add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+                .allow_any_gpu_device_type(true);
+    }
+    else {
+        selector.set_surface(static_cast<VkSurfaceKHR>(vkInitData.surface));
+    }
+    auto physRet = selector.set_minimum_version(1,1) // require at least a Vulkan 1.1 device
                         //.require_dedicated_transfer_queue()
                         .set_required_features(requiredDeviceFeatures)
+                        .add_required_extension_features(multiviewFeatures)
                         .select();
 
     // Check for device selection
@@ -103,6 +123,28 @@ bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkI
         return false;
     }
 
+    // Optional extensions (check with isVulkanDeviceExtensionEnabled())
+    physRet.value().enable_extension_if_present(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    physRet.value().enable_extension_if_present(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+
+    // Optional features (check bootDevice.physical_device.features)
+    VkPhysicalDeviceFeatures optionalFeatures {};
+    optionalFeatures.pipelineStatisticsQuery = VK_TRUE;     // GPU profiler pass statistics
+    optionalFeatures.multiDrawIndirect = VK_TRUE;           // Several indirect commands per call
+    physRet.value().enable_features_if_present(optionalFeatures);
+
+    // Descriptor indexing (bindless resources): only the features bindless
+    // texture tables need, and only if ALL of them are there
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    if(physRet.value().enable_extension_if_present(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+        physRet.value().enable_extension_features_if_present(indexingFeatures);
+    }
+
     // Get physical device
     vkInitData.physicalDevice = vk::PhysicalDevice { physRet.value().physical_device };
 
@@ -138,6 +180,11 @@ bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkI
     
     vkInitData.graphicsQueue.queue = vk::Queue { graphicsQueueRet.value() };
     vkInitData.graphicsQueue.index = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
+
+    if(headless) {
+        vkInitData.presentQueue = vkInitData.graphicsQueue;
+        return true;
+    }
     
     // Get present queue
     auto presentQueueRet = vkbDevice.get_queue(vkb::QueueType::present);
@@ -149,6 +196,46 @@ bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkI
 
     vkInitData.presentQueue.queue = vk::Queue { presentQueueRet.value() };
     vkInitData.presentQueue.index = vkbDevice.get_queue_index(vkb::QueueType::present).value();
+    return true;
+}
+
+bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkInitData) {
+
+    // Store window for reference
+    vkInitData.window = window;
+    vkInitData.headless = false;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // INSTANCE
+    ///////////////////////////////////////////////////////////////////////////
+
+    if(!initVulkanInstance(appName, false, vkInitData)) {
+        return false;
+    }
+    
+    ///////////////////////////////////////////////////////////////////////////
+    // SURFACE
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Create a window surface
+    VkSurfaceKHR surface = nullptr;
+    VkResult surfErr = glfwCreateWindowSurface(vkInitData.bootInstance.instance, window, NULL, &surface);
+    if(surfErr != VK_SUCCESS) {
+        cerr << "initVulkanBootstrap: Failed to create window surface." << endl;
+        cerr << "Error: " << surfErr << endl;
+        return false;
+    }
+
+    // Convert to vk::SurfaceKHR
+    vkInitData.surface = vk::SurfaceKHR { surface };
+    
+    ///////////////////////////////////////////////////////////////////////////
+    // DEVICE (and queues)
+    ///////////////////////////////////////////////////////////////////////////
+
+    if(!initVulkanDevice(vkInitData)) {
+        return false;
+    }
     
     ///////////////////////////////////////////////////////////////////////////
     // SWAPCHAIN
@@ -162,7 +249,88 @@ bool initVulkanBootstrap(string appName, GLFWwindow *window, VulkanInitData &vkI
     return true;
 }
 
+bool initVulkanBootstrapHeadless(   string appName, unsigned int width, unsigned int height,
+                                    VulkanInitData &vkInitData, unsigned int imageCnt) {
+
+    // No window, no surface
+    vkInitData.window = nullptr;
+    vkInitData.surface = nullptr;
+    vkInitData.headless = true;
+
+    if(!initVulkanInstance(appName, true, vkInitData)) {
+        return false;
+    }
+
+    if(!initVulkanDevice(vkInitData)) {
+        return false;
+    }
+
+    // Offscreen "swapchain" (same format as the windowed one)
+    vkInitData.swapchain.format = vk::Format::eB8G8R8A8Unorm;
+    vkInitData.swapchain.extent = vk::Extent2D { width, height };
+    // At least one per frame in flight (VulkanRenderEngine uses 2)
+    vkInitData.swapchain.headlessImageCnt = max(imageCnt, 2u);
+
+    if(!createVulkanSwapchain(vkInitData)) {
+        return false;
+    }
+
+    // Success!
+    return true;
+}
+
+// Images the engine renders into instead of swapchain images; they end each
+// frame in ePresentSrcKHR like real ones (transition before reading back)
+static bool createVulkanHeadlessSwapchain(VulkanInitData &vkInitData) {
+    vk::Device &device = vkInitData.device;
+    VulkanSwapChain &swapchain = vkInitData.swapchain;
+    swapchain.usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst
+                      | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled;
+
+    for(unsigned int i = 0; i < swapchain.headlessImageCnt; i++) {
+        vk::ImageCreateInfo imageInfo(
+            {}, vk::ImageType::e2D, swapchain.format,
+            vk::Extent3D(swapchain.extent.width, swapchain.extent.height, 1),
+            1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+            swapchain.usage,
+            vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined);
+
+        vk::Image image;
+        try {
+            image = device.createImage(imageInfo);
+        }
+        catch(const vk::SystemError &e) {
+            cerr << "initVulkanBootstrapHeadless: Failed to create offscreen image." << endl;
+            cerr << "Error: " << e.what() << endl;
+            return false;
+        }
+
+        vk::MemoryRequirements memReqs = device.getImageMemoryRequirements(image);
+        vk::DeviceMemory memory = device.allocateMemory(vk::MemoryAllocateInfo(
+            memReqs.size,
+            findMemoryType(memReqs.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal,
+                           vkInitData.physicalDevice)));
+        device.bindImageMemory(image, memory, 0);
+        trackVulkanObject(VULKAN_OBJECT_IMAGE, image, memReqs.size, VULKAN_CALL_SITE);
+
+        vk::ImageView view = device.createImageView(vk::ImageViewCreateInfo(
+            {}, image, vk::ImageViewType::e2D, swapchain.format, {},
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)));
+        trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, view, 0, VULKAN_CALL_SITE);
+
+        swapchain.images.push_back(image);
+        swapchain.memory.push_back(memory);
+        swapchain.views.push_back(view);
+    }
+
+    return true;
+}
+
 bool createVulkanSwapchain(VulkanInitData &vkInitData) {
+    if(vkInitData.headless) {
+        return createVulkanHeadlessSwapchain(vkInitData);
+    }
+
     // Create swapchain
     vkb::SwapchainBuilder swapchainBuilder { vkInitData.bootDevice };
 
@@ -172,7 +340,17 @@ bool createVulkanSwapchain(VulkanInitData &vkInitData) {
     desiredFormat.format = VK_FORMAT_B8G8R8A8_UNORM;
     desiredFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
 
-    auto swapRet = swapchainBuilder.set_desired_format(desiredFormat).build();
+    // Also a transfer destination, so offscreen images can be blitted in,
+    // and a source (if the surface allows it) so frames can be captured
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    vk::SurfaceCapabilitiesKHR surfaceCaps = vkInitData.physicalDevice.getSurfaceCapabilitiesKHR(vkInitData.surface);
+    if(surfaceCaps.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
+    auto swapRet = swapchainBuilder.set_desired_format(desiredFormat)
+                                   .set_image_usage_flags(usage)
+                                   .build();
 
     if(!swapRet) {
         cerr << "initVulkanBootstrap: Failed to create swapchain." << endl;
@@ -186,33 +364,73 @@ bool createVulkanSwapchain(VulkanInitData &vkInitData) {
     vkInitData.swapchain.chain = vk::SwapchainKHR { vkSwapchain.swapchain };
     vkInitData.swapchain.format = vk::Format(vkSwapchain.image_format);
     vkInitData.swapchain.extent = vk::Extent2D { vkSwapchain.extent };
+    vkInitData.swapchain.usage = vk::ImageUsageFlags(usage);
     
+    vector<VkImage> vkImages = vkSwapchain.get_images().value();
+    for(unsigned int i = 0; i < vkImages.size(); i++) {
+        vkInitData.swapchain.images.push_back(vk::Image { vkImages.at(i) });
+    }
+
     vector<VkImageView> vkViews = vkSwapchain.get_image_views().value();
     for(unsigned int i = 0; i < vkViews.size(); i++) {
         vkInitData.swapchain.views.push_back(vk::ImageView { vkViews.at(i) });
+        trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, vkInitData.swapchain.views.back(), 0, VULKAN_CALL_SITE);
     }
 
     return true;
 }
 
-void cleanupVulkanSwapchain(VulkanInitData &vkInitData) {
+// Views and images (plus their memory when headless) and the chain itself
+static void destroyVulkanSwapchainData(VulkanInitData &vkInitData) {
     for(unsigned int i = 0; i < vkInitData.swapchain.views.size(); i++) {
+        untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, vkInitData.swapchain.views.at(i));
         vkInitData.device.destroyImageView(vkInitData.swapchain.views.at(i));
     }
-    vkInitData.swapchain.views.clear();    
-    vkInitData.device.destroySwapchainKHR(vkInitData.swapchain.chain);
+    vkInitData.swapchain.views.clear();
+
+    // Only headless images are ours to destroy
+    for(unsigned int i = 0; i < vkInitData.swapchain.memory.size(); i++) {
+        untrackVulkanObject(VULKAN_OBJECT_IMAGE, vkInitData.swapchain.images.at(i));
+        vkInitData.device.destroyImage(vkInitData.swapchain.images.at(i));
+        vkInitData.device.freeMemory(vkInitData.swapchain.memory.at(i));
+    }
+    vkInitData.swapchain.memory.clear();
+    vkInitData.swapchain.images.clear();
+
+    if(vkInitData.swapchain.chain) {
+        vkInitData.device.destroySwapchainKHR(vkInitData.swapchain.chain);
+        vkInitData.swapchain.chain = nullptr;
+    }
+}
+
+void cleanupVulkanSwapchain(VulkanInitData &vkInitData) {
+    destroyVulkanSwapchainData(vkInitData);
+}
+
+bool isVulkanDeviceExtensionEnabled(VulkanInitData &vkInitData, string extensionName) {
+    for(auto &name : vkInitData.bootDevice.physical_device.get_extensions()) {
+        if(name == extensionName) {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int getVulkanMaxDrawIndirectCount(VulkanInitData &vkInitData) {
+    if(!vkInitData.bootDevice.physical_device.features.multiDrawIndirect) {
+        return 1;
+    }
+    return vkInitData.physicalDevice.getProperties().limits.maxDrawIndirectCount;
 }
 
 void cleanupVulkanBootstrap(VulkanInitData &vkInitData) {
     
-    for(unsigned int i = 0; i < vkInitData.swapchain.views.size(); i++) {
-        vkInitData.device.destroyImageView(vkInitData.swapchain.views.at(i));
-    }
-    vkInitData.swapchain.views.clear();    
-    vkInitData.device.destroySwapchainKHR(vkInitData.swapchain.chain);
+    destroyVulkanSwapchainData(vkInitData);
 
     vkInitData.device.destroy();
-    vkInitData.instance.destroySurfaceKHR(vkInitData.surface);    
+    if(vkInitData.surface) {
+        vkInitData.instance.destroySurfaceKHR(vkInitData.surface);
+    }
     
     vkb::destroy_instance(vkInitData.bootInstance);    
 }
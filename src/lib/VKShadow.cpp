@@ -0,0 +1,246 @@
+#include "VKShadow.hpp"
+#include "VKBuffer.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+///////////////////////////////////////////////////////////////////////////////
+
+static const vk::Format SHADOW_FORMAT = vk::Format::eD32Sfloat;
+
+static VulkanImage createShadowCubeImage(VulkanInitData &vkInitData, unsigned int size,
+                                         vk::ImageUsageFlags usage) {
+    VulkanImage vkImage;
+    vkImage.format = SHADOW_FORMAT;
+
+    vk::ImageCreateInfo imageInfo(
+        vk::ImageCreateFlagBits::eCubeCompatible,
+        vk::ImageType::e2D,
+        SHADOW_FORMAT,
+        vk::Extent3D(size, size, 1),
+        1, SHADOW_CUBE_FACES, vk::SampleCountFlagBits::e1,    // 6 layers (one per face)
+        vk::ImageTiling::eOptimal,
+        usage,
+        vk::SharingMode::eExclusive
+    );
+    vkImage.image = vkInitData.device.createImage(imageInfo);
+
+    vk::MemoryRequirements memRequirements = vkInitData.device.getImageMemoryRequirements(vkImage.image);
+    vk::MemoryAllocateInfo allocInfo(memRequirements.size,
+                                     findMemoryType(memRequirements.memoryTypeBits,
+                                                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                    vkInitData.physicalDevice));
+    vkImage.memory = vkInitData.device.allocateMemory(allocInfo);
+    vkInitData.device.bindImageMemory(vkImage.image, vkImage.memory, 0);
+    trackVulkanObject(VULKAN_OBJECT_IMAGE, vkImage.image, memRequirements.size, VULKAN_CALL_SITE);
+
+    // Cube view over all faces
+    vkImage.view = vkInitData.device.createImageView(vk::ImageViewCreateInfo(
+        {}, vkImage.image, vk::ImageViewType::eCube, SHADOW_FORMAT, {},
+        { vk::ImageAspectFlagBits::eDepth, 0, 1, 0, SHADOW_CUBE_FACES }));
+    trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, vkImage.view, 0, VULKAN_CALL_SITE);
+
+    return vkImage;
+}
+
+static vector<vk::ImageView> createShadowFaceViews(VulkanInitData &vkInitData, VulkanImage &vkImage) {
+    vector<vk::ImageView> views;
+    for(unsigned int face = 0; face < SHADOW_CUBE_FACES; face++) {
+        views.push_back(vkInitData.device.createImageView(vk::ImageViewCreateInfo(
+            {}, vkImage.image, vk::ImageViewType::e2D, SHADOW_FORMAT, {},
+            { vk::ImageAspectFlagBits::eDepth, 0, 1, face, 1 })));
+        trackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, views.back(), 0, VULKAN_CALL_SITE);
+    }
+    return views;
+}
+
+static vk::RenderPass createShadowRenderPass(VulkanInitData &vkInitData, bool cachePass) {
+    // Cache: clear, leave ready for copying out
+    // Dynamic: keep copied cache, leave ready for sampling
+    vk::AttachmentDescription depthAttachment(
+        {},
+        SHADOW_FORMAT,
+        vk::SampleCountFlagBits::e1,
+        cachePass ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad,
+        vk::AttachmentStoreOp::eStore,
+        vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        cachePass ? vk::ImageLayout::eUndefined : vk::ImageLayout::eTransferDstOptimal,
+        cachePass ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::eShaderReadOnlyOptimal
+    );
+
+    vk::AttachmentReference depthRef(0, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    vk::SubpassDescription subpass({}, vk::PipelineBindPoint::eGraphics, {}, {}, {}, &depthRef);
+
+    // Cache: previous copies must finish before we overwrite; dynamic: copy must land first
+    vk::PipelineStageFlags depthStages = vk::PipelineStageFlagBits::eEarlyFragmentTests
+                                        | vk::PipelineStageFlagBits::eLateFragmentTests;
+    vk::AccessFlags depthAccess = vk::AccessFlagBits::eDepthStencilAttachmentRead
+                                | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+
+    vector<vk::SubpassDependency> dependencies;
+    dependencies.push_back(vk::SubpassDependency(
+        VK_SUBPASS_EXTERNAL, 0,
+        vk::PipelineStageFlagBits::eTransfer, depthStages,
+        cachePass ? vk::AccessFlags() : vk::AccessFlags(vk::AccessFlagBits::eTransferWrite),
+        depthAccess));
+
+    // Cache: written depth -> transfer read; dynamic: written depth -> fragment shader sampling
+    dependencies.push_back(vk::SubpassDependency(
+        0, VK_SUBPASS_EXTERNAL,
+        vk::PipelineStageFlagBits::eLateFragmentTests,
+        cachePass ? vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer)
+                  : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eFragmentShader),
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        cachePass ? vk::AccessFlags(vk::AccessFlagBits::eTransferRead)
+                  : vk::AccessFlags(vk::AccessFlagBits::eShaderRead)));
+
+    return vkInitData.device.createRenderPass(vk::RenderPassCreateInfo(
+        {}, depthAttachment, subpass, dependencies));
+}
+
+static vector<vk::Framebuffer> createShadowFramebuffers(VulkanInitData &vkInitData, vk::RenderPass &pass,
+                                                        vector<vk::ImageView> &faceViews, unsigned int size) {
+    vector<vk::Framebuffer> framebuffers;
+    for(auto &view : faceViews) {
+        framebuffers.push_back(vkInitData.device.createFramebuffer(
+            vk::FramebufferCreateInfo({}, pass, view, size, size, 1)));
+    }
+    return framebuffers;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create and cleanup
+///////////////////////////////////////////////////////////////////////////////
+
+VulkanShadowCube createVulkanShadowCube(VulkanInitData &vkInitData, unsigned int size,
+                                        float nearPlane, float farPlane) {
+    VulkanShadowCube cube;
+    cube.size = size;
+    cube.nearPlane = nearPlane;
+    cube.farPlane = farPlane;
+
+    cube.cacheImage = createShadowCubeImage(vkInitData, size,
+                                            vk::ImageUsageFlagBits::eDepthStencilAttachment
+                                            | vk::ImageUsageFlagBits::eTransferSrc);
+    cube.image = createShadowCubeImage( vkInitData, size,
+                                        vk::ImageUsageFlagBits::eDepthStencilAttachment
+                                        | vk::ImageUsageFlagBits::eTransferDst
+                                        | vk::ImageUsageFlagBits::eSampled);
+    cube.cacheFaceViews = createShadowFaceViews(vkInitData, cube.cacheImage);
+    cube.faceViews = createShadowFaceViews(vkInitData, cube.image);
+
+    cube.cachePass = createShadowRenderPass(vkInitData, true);
+    cube.dynamicPass = createShadowRenderPass(vkInitData, false);
+    cube.cacheFramebuffers = createShadowFramebuffers(vkInitData, cube.cachePass, cube.cacheFaceViews, size);
+    cube.framebuffers = createShadowFramebuffers(vkInitData, cube.dynamicPass, cube.faceViews, size);
+
+    // Hardware depth comparison (1 = lit)
+    vk::SamplerCreateInfo samplerInfo;
+    samplerInfo.magFilter = vk::Filter::eLinear;
+    samplerInfo.minFilter = vk::Filter::eLinear;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+    samplerInfo.compareEnable = true;
+    samplerInfo.compareOp = vk::CompareOp::eLessOrEqual;
+    samplerInfo.borderColor = vk::BorderColor::eFloatOpaqueWhite;
+    cube.sampler = vkInitData.device.createSampler(samplerInfo);
+
+    cube.cacheDirty = true;
+    return cube;
+}
+
+void cleanupVulkanShadowCube(VulkanInitData &vkInitData, VulkanShadowCube &cube) {
+    vkInitData.device.destroySampler(cube.sampler);
+
+    for(auto &fb : cube.cacheFramebuffers) { vkInitData.device.destroyFramebuffer(fb); }
+    for(auto &fb : cube.framebuffers) { vkInitData.device.destroyFramebuffer(fb); }
+    cube.cacheFramebuffers.clear();
+    cube.framebuffers.clear();
+
+    vkInitData.device.destroyRenderPass(cube.cachePass);
+    vkInitData.device.destroyRenderPass(cube.dynamicPass);
+
+    for(auto &view : cube.cacheFaceViews) {
+        untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, view);
+        vkInitData.device.destroyImageView(view);
+    }
+    for(auto &view : cube.faceViews) {
+        untrackVulkanObject(VULKAN_OBJECT_IMAGE_VIEW, view);
+        vkInitData.device.destroyImageView(view);
+    }
+    cube.cacheFaceViews.clear();
+    cube.faceViews.clear();
+
+    cleanupVulkanImage(vkInitData, cube.cacheImage);
+    cleanupVulkanImage(vkInitData, cube.image);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Per-face matrices and recording
+///////////////////////////////////////////////////////////////////////////////
+
+glm::mat4 getShadowCubeFaceViewProj(const VulkanShadowCube &cube, glm::vec3 lightPos, unsigned int face) {
+    // Standard cube map face orientation
+    static const glm::vec3 dirs[SHADOW_CUBE_FACES] = {
+        glm::vec3( 1, 0, 0), glm::vec3(-1, 0, 0),
+        glm::vec3( 0, 1, 0), glm::vec3( 0,-1, 0),
+        glm::vec3( 0, 0, 1), glm::vec3( 0, 0,-1)
+    };
+    static const glm::vec3 ups[SHADOW_CUBE_FACES] = {
+        glm::vec3(0,-1, 0), glm::vec3(0,-1, 0),
+        glm::vec3(0, 0, 1), glm::vec3(0, 0,-1),
+        glm::vec3(0,-1, 0), glm::vec3(0,-1, 0)
+    };
+
+    glm::mat4 view = glm::lookAt(lightPos, lightPos + dirs[face], ups[face]);
+    glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, cube.nearPlane, cube.farPlane);
+
+    // NO Y flip here: Vulkan's top-left framebuffer origin already matches
+    // the row order cube map sampling expects for these up vectors
+    return proj * view;
+}
+
+void beginShadowCubeFace(vk::CommandBuffer &commandBuffer, VulkanShadowCube &cube,
+                         unsigned int face, bool cachePass) {
+
+    vk::ClearValue clearValue;
+    clearValue.depthStencil = vk::ClearDepthStencilValue(1.0f, 0);
+    vk::Extent2D extent(cube.size, cube.size);
+
+    commandBuffer.beginRenderPass(vk::RenderPassBeginInfo(
+        cachePass ? cube.cachePass : cube.dynamicPass,
+        cachePass ? cube.cacheFramebuffers[face] : cube.framebuffers[face],
+        { {0,0}, extent },
+        clearValue),
+        vk::SubpassContents::eInline);
+
+    vk::Viewport viewports[] = {{0, 0, (float)cube.size, (float)cube.size, 0.0f, 1.0f}};
+    commandBuffer.setViewport(0, viewports);
+
+    vk::Rect2D scissors[] = {{{0,0}, extent}};
+    commandBuffer.setScissor(0, scissors);
+}
+
+void recordShadowCubeCacheCopy(vk::CommandBuffer &commandBuffer, VulkanShadowCube &cube) {
+    vk::ImageSubresourceRange allFaces(vk::ImageAspectFlagBits::eDepth, 0, 1, 0, SHADOW_CUBE_FACES);
+
+    // Previous frame's shading must be done sampling (contents are replaced)
+    vk::ImageMemoryBarrier toTransfer(
+        {}, vk::AccessFlagBits::eTransferWrite,
+        vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+        cube.image.image, allFaces);
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer,
+        {}, {}, {}, toTransfer);
+
+    vk::ImageSubresourceLayers layers(vk::ImageAspectFlagBits::eDepth, 0, 0, SHADOW_CUBE_FACES);
+    vk::ImageCopy region(layers, {0, 0, 0}, layers, {0, 0, 0}, vk::Extent3D(cube.size, cube.size, 1));
+
+    commandBuffer.copyImage(cube.cacheImage.image, vk::ImageLayout::eTransferSrcOptimal,
+                            cube.image.image, vk::ImageLayout::eTransferDstOptimal,
+                            region);
+}
@@ -31,10 +31,12 @@ void cleanupUniformDescriptorSetLayout(VulkanInitData &vkInitData, vk::Descripto
     vkInitData.device.destroyDescriptorSetLayout(layout);
 }
 
-UBOData createVulkanUniformBufferData(vk::Device &device,
+static UBOData createVulkanMappedBufferData(vk::Device &device,
                                 vk::PhysicalDevice &physicalDevice,
                                 size_t bufferSize, 
-                                int maxFramesInFlights) {
+                                int maxFramesInFlights,
+                                vk::BufferUsageFlags usage,
+                                VulkanCallSite site) {
 
     // Create the struct and allocate space
     UBOData data;
@@ -47,8 +49,9 @@ UBOData createVulkanUniformBufferData(vk::Device &device,
                                 physicalDevice,
                                 device,
                                 bufferSize,
-                                vk::BufferUsageFlagBits::eUniformBuffer,
-                                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+                                usage,
+                                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                site);
 
         // Keep the memory mapped
         vkMapMemory(device, data.bufferData[i].memory, 0, bufferSize, 0, &data.mapped[i]);
@@ -57,6 +60,35 @@ UBOData createVulkanUniformBufferData(vk::Device &device,
     return data;
 }
 
+UBOData createVulkanUniformBufferData(vk::Device &device,
+                                vk::PhysicalDevice &physicalDevice,
+                                size_t bufferSize, 
+                                int maxFramesInFlights,
+                                VulkanCallSite site) {
+    return createVulkanMappedBufferData(device, physicalDevice, bufferSize, maxFramesInFlights,
+                                        vk::BufferUsageFlagBits::eUniformBuffer, site);
+}
+
+UBOData createVulkanStorageBufferData(vk::Device &device,
+                                vk::PhysicalDevice &physicalDevice,
+                                size_t bufferSize, 
+                                int maxFramesInFlights,
+                                VulkanCallSite site) {
+    return createVulkanMappedBufferData(device, physicalDevice, bufferSize, maxFramesInFlights,
+                                        vk::BufferUsageFlagBits::eStorageBuffer
+                                        | vk::BufferUsageFlagBits::eTransferDst, site);
+}
+
+UBOData createVulkanIndirectBufferData(vk::Device &device,
+                                vk::PhysicalDevice &physicalDevice,
+                                size_t bufferSize, 
+                                int maxFramesInFlights,
+                                VulkanCallSite site) {
+    return createVulkanMappedBufferData(device, physicalDevice, bufferSize, maxFramesInFlights,
+                                        vk::BufferUsageFlagBits::eStorageBuffer 
+                                        | vk::BufferUsageFlagBits::eIndirectBuffer, site);
+}
+
 void cleanupVulkanUniformBufferData(vk::Device &device, UBOData &uboData) {
     for(unsigned int i = 0; i < uboData.bufferData.size(); i++) {
         cleanupVulkanBuffer(device, uboData.bufferData[i]);
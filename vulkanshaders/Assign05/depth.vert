@@ -0,0 +1,32 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_multiview : enable
+
+// Position-only shader for the depth pre-pass
+// (MUST compute gl_Position exactly like shader.vert for eEqual testing)
+
+// View and projection matrices per view (see shader.vert)
+const int MAX_VIEWS = 4;
+
+struct ViewData {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 eyePos;
+};
+
+layout(binding = 0) uniform UBOVertex {
+    ViewData views[MAX_VIEWS];
+} ubo;
+
+// Vertex attributes
+layout(location = 0) in vec3 inPosition;
+
+// Per-instance attributes (eInstance input rate)
+layout(location = 3) in mat4 instModelMat;  // Uses locations 3-6
+
+invariant gl_Position;
+
+void main() {
+    ViewData view = ubo.views[gl_ViewIndex];
+    gl_Position = view.projMat * view.viewMat * instModelMat * vec4(inPosition, 1.0);
+}
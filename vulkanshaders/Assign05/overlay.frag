@@ -0,0 +1,16 @@
+#version 450
+
+// Font atlas: white, glyph coverage in alpha (one texel is fully set for
+// rectangles)
+layout(binding = 0) uniform sampler2D fontTexture;
+
+// Input from vertex shader
+layout(location = 0) in vec2 interTexCoord;
+layout(location = 1) in vec4 interColor;
+
+// Output color
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = interColor * texture(fontTexture, interTexCoord);
+}
@@ -0,0 +1,23 @@
+#version 450
+
+// Push constants: pixels -> NDC
+layout(push_constant) uniform UPushOverlay {
+    vec2 scale;             // 2 / framebuffer size
+} pushOverlay;
+
+// Vertex attributes (pixels from the top left, font UV, RGBA)
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec4 inColor;
+
+// Output to fragment shader
+layout(location = 0) out vec2 interTexCoord;
+layout(location = 1) out vec4 interColor;
+
+void main() {
+    interTexCoord = inTexCoord;
+    interColor = inColor;
+
+    // Vulkan NDC already has Y pointing down
+    gl_Position = vec4(inPosition * pushOverlay.scale - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,247 @@
+// Body of shader.frag (BINDLESS 1) and shader_nobindless.frag (BINDLESS 0,
+// for devices without descriptor indexing: no set 2, so no textures and
+// scene default metallic/roughness)
+
+// Input from vertex shader
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec4 interPos;
+layout(location = 2) in vec3 interNormal;
+layout(location = 3) in vec4 interClusterPos;
+layout(location = 4) flat in vec3 interEyePos;
+layout(location = 5) in vec3 interObjPos;
+layout(location = 6) in vec3 interObjNormal;
+layout(location = 7) flat in uint interMaterial;
+
+// Output color
+layout(location = 0) out vec4 outColor;
+
+// Constants
+const float PI = 3.14159265359;
+
+// Point light structure (clustered)
+struct ClusterLight {
+    vec4 vposRadius;    // Position in view space (xyz) and radius (w)
+    vec4 color;         // Light color
+};
+
+// UBO for fragment shader data
+layout(set = 0, binding = 1) uniform UBOFragment {
+    uvec4 clusterDims;      // Tiles in x/y, slices in z, light count in w
+    vec4 clusterParams;     // Slice scale, slice bias, unused, unused
+    float metallic;
+    float roughness;    
+    mat4 invViewMat;        // View -> world
+    vec4 shadowParams;      // Far plane, bias, enabled
+} ubo;
+
+// All lights
+layout(std430, set = 0, binding = 2) readonly buffer LightBuffer {
+    ClusterLight lights[];
+};
+
+// Per cluster: (offset, count) into lightIndices
+layout(std430, set = 0, binding = 3) readonly buffer ClusterBuffer {
+    uvec2 clusterRanges[];
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer LightIndexBuffer {
+    uint lightIndices[];
+};
+
+// Main light (index 0) shadow cube: linear distance / far plane
+layout(set = 0, binding = 5) uniform samplerCubeShadow shadowMap;
+
+// Per-material parameters (set 1: pooled set or push descriptor)
+layout(set = 1, binding = 0) uniform MaterialUBO {
+    vec4 baseColor;         // Multiplies vertex color
+} material;
+
+#if BINDLESS
+// Bindless table (set 2): every texture, and every material (indexed per
+// instance, so draws with different materials can be merged)
+const uint NO_TEXTURE = 0xFFFFFFFFu;
+
+struct BindlessMaterial {
+    vec4 baseColor;
+    uint textureIndex;      // NO_TEXTURE = untextured
+    float textureScale;     // Repeats per unit
+    float metallic;         // < 0 = scene default
+    float roughness;        // < 0 = scene default
+};
+
+layout(set = 2, binding = 0) uniform sampler2D textures[];
+
+layout(std430, set = 2, binding = 1) readonly buffer MaterialBuffer {
+    BindlessMaterial materials[];
+};
+#endif
+
+// Surface parameters of this fragment (scene defaults or the material's)
+float surfMetallic;
+float surfRoughness;
+
+// Calculate Fresnel reflectance at angle zero
+vec3 getFresnelAtAngleZero(vec3 albedo, float metallic) {
+    // Start with default value for insulators
+    vec3 F0 = vec3(0.04);
+    // Interpolate between insulator and metal based on metallic value
+    F0 = mix(F0, albedo, metallic);
+    return F0;
+}
+
+// Calculate Fresnel reflectance using Schlick's approximation
+vec3 getFresnel(vec3 F0, vec3 L, vec3 H) {
+    float cosAngle = max(0.0, dot(L, H));
+    // Schlick approximation for Fresnel reflectance
+    return F0 + (1.0 - F0) * pow(1.0 - cosAngle, 5.0);
+}
+
+// Calculate Normal Distribution Function using GGX/Trowbridge-Reitz
+float getNDF(vec3 H, vec3 N, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float NdotH = max(0.0, dot(N, H));
+    float NdotH2 = NdotH * NdotH;
+    
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom;
+    
+    return a2 / denom;
+}
+
+// Schlick's approximation for geometric attenuation
+float getSchlickGeo(vec3 B, vec3 N, float roughness) {
+    float k = (roughness + 1.0) * (roughness + 1.0) / 8.0;
+    float NdotB = max(0.0, dot(N, B));
+    
+    return NdotB / (NdotB * (1.0 - k) + k);
+}
+
+// Calculate Geometry Function for shadowing and masking
+float getGF(vec3 L, vec3 V, vec3 N, float roughness) {
+    float GL = getSchlickGeo(L, N, roughness);
+    float GV = getSchlickGeo(V, N, roughness);
+    
+    return GL * GV;
+}
+
+// Smooth falloff to zero at the light radius
+float getAttenuation(float dist, float radius) {
+    float ratio = dist / radius;
+    float window = clamp(1.0 - ratio*ratio*ratio*ratio, 0.0, 1.0);
+    return window * window;
+}
+
+// Cook-Torrance contribution of ONE light
+vec3 shadeLight(ClusterLight light, vec3 N, vec3 V, vec3 baseColor, vec3 F0) {
+    // Calculate light vector (from fragment to light)
+    vec3 toLight = vec3(light.vposRadius) - vec3(interPos);
+    float dist = length(toLight);
+    float atten = getAttenuation(dist, light.vposRadius.w);
+    if(atten <= 0.0) {
+        return vec3(0.0);
+    }
+    vec3 L = toLight / dist;
+    
+    // Calculate half vector
+    vec3 H = normalize(V + L);
+    
+    // Calculate Fresnel reflectance
+    vec3 F = getFresnel(F0, L, H);
+    
+    // Set specular color
+    vec3 kS = F;
+    
+    // Calculate diffuse color
+    vec3 kD = (1.0 - kS) * (1.0 - surfMetallic) * baseColor / PI;
+    
+    // Calculate specular reflection
+    float NDF = getNDF(H, N, surfRoughness);
+    float G = getGF(L, V, N, surfRoughness);
+    
+    // Complete specular term
+    vec3 specular = kS * NDF * G / (4.0 * max(0.0, dot(N, L)) * max(0.0, dot(N, V)) + 0.0001);
+    
+    // Calculate final color
+    return (kD + specular) * vec3(light.color) * max(0.0, dot(N, L)) * atten;
+}
+
+// 1 = lit, 0 = in shadow (main light only)
+float getShadow(ClusterLight light) {
+    if(ubo.shadowParams.z == 0.0) {
+        return 1.0;
+    }
+    vec3 toFrag = vec3(interPos) - vec3(light.vposRadius);
+    vec3 dir = mat3(ubo.invViewMat) * toFrag;
+    float refDepth = length(toFrag) / ubo.shadowParams.x - ubo.shadowParams.y;
+    return texture(shadowMap, vec4(dir, refDepth));
+}
+
+#if BINDLESS
+// No texture coordinates in the meshes: project along the object-space
+// axes and blend by how much the surface faces each one (triplanar)
+vec3 sampleTriplanar(uint textureIndex, float scale) {
+    vec3 w = pow(abs(normalize(interObjNormal)), vec3(4.0));
+    w /= (w.x + w.y + w.z + 1e-5);
+    vec3 p = interObjPos * scale;
+    vec3 x = texture(textures[nonuniformEXT(textureIndex)], p.yz).rgb;
+    vec3 y = texture(textures[nonuniformEXT(textureIndex)], p.xz).rgb;
+    vec3 z = texture(textures[nonuniformEXT(textureIndex)], p.xy).rgb;
+    return x * w.x + y * w.y + z * w.z;
+}
+#endif
+
+// Index of the cluster containing this fragment
+// (from its position on view 0's screen, so every view uses the same grid)
+uint getClusterIndex() {
+    vec2 ndc = interClusterPos.xy / interClusterPos.w;
+    vec2 tileCoord = clamp((ndc * 0.5 + 0.5) * vec2(ubo.clusterDims.xy), vec2(0.0), vec2(ubo.clusterDims.xy) - 1.0);
+    uvec2 tile = uvec2(tileCoord);
+    float viewDepth = max(-interPos.z, 1e-4);
+    int slice = int(floor(log(viewDepth) * ubo.clusterParams.x + ubo.clusterParams.y));
+    uint z = uint(clamp(slice, 0, int(ubo.clusterDims.z) - 1));
+    return (z * ubo.clusterDims.y + tile.y) * ubo.clusterDims.x + tile.x;
+}
+
+void main() {
+    // Normalize the interpolated normal
+    vec3 N = normalize(interNormal);
+    
+    // Set base color from fragment color (tinted by the material)
+    vec3 baseColor = vec3(fragColor) * material.baseColor.rgb;
+
+#if BINDLESS
+    // Bindless material (entry 0 = untextured white with scene defaults)
+    BindlessMaterial surf = materials[interMaterial];
+    baseColor *= surf.baseColor.rgb;
+    if(surf.textureIndex != NO_TEXTURE) {
+        baseColor *= sampleTriplanar(surf.textureIndex, surf.textureScale);
+    }
+    surfMetallic = (surf.metallic >= 0.0) ? surf.metallic : ubo.metallic;
+    surfRoughness = (surf.roughness >= 0.0) ? surf.roughness : ubo.roughness;
+#else
+    surfMetallic = ubo.metallic;
+    surfRoughness = ubo.roughness;
+#endif
+    
+    // Calculate view vector (from fragment to this view's camera; origin for view 0)
+    vec3 V = normalize(interEyePos - vec3(interPos));
+    
+    // Calculate Fresnel reflectance at angle zero
+    vec3 F0 = getFresnelAtAngleZero(baseColor, surfMetallic);
+
+    // Only loop over the lights that can reach this cluster
+    uvec2 range = clusterRanges[getClusterIndex()];
+    vec3 finalColor = vec3(0.0);
+    for(uint i = 0; i < range.y; i++) {
+        uint index = lightIndices[range.x + i];
+        vec3 color = shadeLight(lights[index], N, V, baseColor, F0);
+        if(index == 0u) {
+            color *= getShadow(lights[index]);
+        }
+        finalColor += color;
+    }
+    
+    // Output final color
+    outColor = vec4(finalColor, 1.0);
+}
@@ -1,41 +1,66 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_multiview : enable
 
-// UBO for view and projection matrices
-layout(binding = 0) uniform UBOVertex {
+// View and projection matrices per view (multiview passes draw every
+// primitive once per view; otherwise gl_ViewIndex is 0)
+// Lighting happens in view 0's space for ALL views, so clustered lights,
+// normals, and shadows are shared; eyePos is each camera in that space.
+const int MAX_VIEWS = 4;
+
+struct ViewData {
     mat4 viewMat;
     mat4 projMat;
-} ubo;
+    vec4 eyePos;
+};
 
-// Push constants for model matrix and vertex data
-layout(push_constant) uniform UPushVertex {
-    vec3 pos;
-    vec4 color;
-    mat4 modelMat;
-    mat4 normMat;  // Added normal matrix
-} pc;
+layout(binding = 0) uniform UBOVertex {
+    ViewData views[MAX_VIEWS];
+} ubo;
 
 // Vertex attributes
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec4 inColor;
 layout(location = 2) in vec3 inNormal;  // Added normal input
 
+// Per-instance attributes (eInstance input rate)
+layout(location = 3) in mat4 instModelMat;  // Uses locations 3-6
+layout(location = 7) in mat4 instNormMat;   // Uses locations 7-10
+layout(location = 11) in vec4 instColor;
+layout(location = 12) in uvec4 instIndices;     // x = bindless material
+
 // Output to fragment shader
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec4 interPos;  // Added interpolated position
 layout(location = 2) out vec3 interNormal;  // Added interpolated normal
+layout(location = 3) out vec4 interClusterPos;  // View 0 clip position (cluster lookup)
+layout(location = 4) flat out vec3 interEyePos; // This view's camera (view 0 space)
+layout(location = 5) out vec3 interObjPos;      // Object space (texture projection)
+layout(location = 6) out vec3 interObjNormal;
+layout(location = 7) flat out uint interMaterial;
+
+// Must match depth.vert bit-for-bit (depth pre-pass uses eEqual)
+invariant gl_Position;
 
 void main() {
     // Transform vertex position using model, view, and projection matrices
     // Apply RIGHT-TO-LEFT multiplication order
-    gl_Position = ubo.projMat * ubo.viewMat * pc.modelMat * vec4(inPosition, 1.0);
+    ViewData view = ubo.views[gl_ViewIndex];
+    gl_Position = view.projMat * view.viewMat * instModelMat * vec4(inPosition, 1.0);
     
-    // Set interpolated position in view coordinates
-    interPos = ubo.viewMat * pc.modelMat * vec4(inPosition, 1.0);
+    // Set interpolated position in (view 0) view coordinates
+    interPos = ubo.views[0].viewMat * instModelMat * vec4(inPosition, 1.0);
+    interClusterPos = ubo.views[0].projMat * interPos;
+    interEyePos = vec3(view.eyePos);
     
     // Set interpolated normal
-    interNormal = mat3(pc.normMat) * inNormal;
+    interNormal = mat3(instNormMat) * inNormal;
     
     // Pass color to fragment shader
-    fragColor = inColor;
+    fragColor = inColor * instColor;
+
+    // Material table entry and what its textures are projected from
+    interObjPos = inPosition;
+    interObjNormal = inNormal;
+    interMaterial = instIndices.x;
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Lit shading without set 2 (descriptor indexing not supported)
+#define BINDLESS 0
+#include "shader.glsl"
@@ -0,0 +1,13 @@
+#version 450
+
+layout(push_constant) uniform ShadowPushConstants {
+    mat4 faceViewProj;
+    vec4 lightPosFar;   // World position (xyz), far plane (w)
+} pc;
+
+layout(location = 0) in vec3 worldPos;
+
+void main() {
+    // Store LINEAR distance (same meaning on every face)
+    gl_FragDepth = length(worldPos - pc.lightPosFar.xyz) / pc.lightPosFar.w;
+}
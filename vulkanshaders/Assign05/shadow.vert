@@ -0,0 +1,22 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// One cube face per pass
+layout(push_constant) uniform ShadowPushConstants {
+    mat4 faceViewProj;
+    vec4 lightPosFar;   // World position (xyz), far plane (w)
+} pc;
+
+// Vertex attributes (only position needed)
+layout(location = 0) in vec3 inPosition;
+
+// Per-instance attributes (eInstance input rate)
+layout(location = 3) in mat4 instModelMat;  // Uses locations 3-6
+
+layout(location = 0) out vec3 worldPos;
+
+void main() {
+    vec4 pos = instModelMat * vec4(inPosition, 1.0);
+    worldPos = vec3(pos);
+    gl_Position = pc.faceViewProj * pos;
+}
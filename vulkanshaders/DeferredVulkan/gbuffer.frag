@@ -0,0 +1,22 @@
+#version 450
+
+// Input from vertex shader
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec3 interNormal;
+
+// G-buffer outputs (order matches render pass attachments)
+layout(location = 0) out vec4 outNormal;    // View-space normal, [-1,1] -> [0,1]
+layout(location = 1) out vec4 outAlbedo;
+layout(location = 2) out vec2 outMaterial;  // Metallic, roughness
+
+layout(set = 0, binding = 0) uniform UBOGeometry {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 material;
+} ubo;
+
+void main() {
+    outNormal = vec4(normalize(interNormal) * 0.5 + 0.5, 1.0);
+    outAlbedo = fragColor;
+    outMaterial = ubo.material.xy;
+}
@@ -0,0 +1,29 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// UBO for view and projection matrices
+layout(set = 0, binding = 0) uniform UBOGeometry {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 material;
+} ubo;
+
+// Vertex attributes
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec3 inNormal;
+
+// Per-instance attributes (eInstance input rate)
+layout(location = 3) in mat4 instModelMat;  // Uses locations 3-6
+layout(location = 7) in mat4 instNormMat;   // Uses locations 7-10
+layout(location = 11) in vec4 instColor;
+
+// Output to fragment shader
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec3 interNormal;
+
+void main() {
+    gl_Position = ubo.projMat * ubo.viewMat * instModelMat * vec4(inPosition, 1.0);
+    interNormal = mat3(instNormMat) * inNormal;
+    fragColor = inColor * instColor;
+}
@@ -0,0 +1,137 @@
+#version 450
+
+// Output color
+layout(location = 0) out vec4 outColor;
+
+// Constants
+const float PI = 3.14159265359;
+
+// Point light structure (clustered)
+struct ClusterLight {
+    vec4 vposRadius;    // Position in view space (xyz) and radius (w)
+    vec4 color;         // Light color
+};
+
+layout(set = 0, binding = 1) uniform UBOLighting {
+    mat4 invProjMat;
+    uvec4 clusterDims;      // Tiles in x/y, slices in z, light count in w
+    vec4 clusterParams;     // Slice scale, slice bias, tile width, tile height
+    vec4 screenParams;      // Width, height, 1/width, 1/height
+    vec4 clearColor;
+} ubo;
+
+// All lights
+layout(std430, set = 0, binding = 2) readonly buffer LightBuffer {
+    ClusterLight lights[];
+};
+
+// Per cluster: (offset, count) into lightIndices
+layout(std430, set = 0, binding = 3) readonly buffer ClusterBuffer {
+    uvec2 clusterRanges[];
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer LightIndexBuffer {
+    uint lightIndices[];
+};
+
+// G-buffer (read at THIS pixel only)
+layout(input_attachment_index = 0, set = 0, binding = 5) uniform subpassInput inNormal;
+layout(input_attachment_index = 1, set = 0, binding = 6) uniform subpassInput inAlbedo;
+layout(input_attachment_index = 2, set = 0, binding = 7) uniform subpassInput inMaterial;
+layout(input_attachment_index = 3, set = 0, binding = 8) uniform subpassInput inDepth;
+
+// Calculate Fresnel reflectance at angle zero
+vec3 getFresnelAtAngleZero(vec3 albedo, float metallic) {
+    return mix(vec3(0.04), albedo, metallic);
+}
+
+// Calculate Fresnel reflectance using Schlick's approximation
+vec3 getFresnel(vec3 F0, vec3 L, vec3 H) {
+    float cosAngle = max(0.0, dot(L, H));
+    return F0 + (1.0 - F0) * pow(1.0 - cosAngle, 5.0);
+}
+
+// Calculate Normal Distribution Function using GGX/Trowbridge-Reitz
+float getNDF(vec3 H, vec3 N, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float NdotH = max(0.0, dot(N, H));
+    float denom = (NdotH * NdotH * (a2 - 1.0) + 1.0);
+    return a2 / (PI * denom * denom);
+}
+
+// Schlick's approximation for geometric attenuation
+float getSchlickGeo(vec3 B, vec3 N, float roughness) {
+    float k = (roughness + 1.0) * (roughness + 1.0) / 8.0;
+    float NdotB = max(0.0, dot(N, B));
+    return NdotB / (NdotB * (1.0 - k) + k);
+}
+
+// Calculate Geometry Function for shadowing and masking
+float getGF(vec3 L, vec3 V, vec3 N, float roughness) {
+    return getSchlickGeo(L, N, roughness) * getSchlickGeo(V, N, roughness);
+}
+
+// Smooth falloff to zero at the light radius
+float getAttenuation(float dist, float radius) {
+    float ratio = dist / radius;
+    float window = clamp(1.0 - ratio*ratio*ratio*ratio, 0.0, 1.0);
+    return window * window;
+}
+
+// Cook-Torrance contribution of ONE light
+vec3 shadeLight(ClusterLight light, vec3 P, vec3 N, vec3 V, 
+                vec3 baseColor, vec3 F0, float metallic, float roughness) {
+    vec3 toLight = vec3(light.vposRadius) - P;
+    float dist = length(toLight);
+    float atten = getAttenuation(dist, light.vposRadius.w);
+    if(atten <= 0.0) {
+        return vec3(0.0);
+    }
+    vec3 L = toLight / dist;
+    vec3 H = normalize(V + L);
+
+    vec3 kS = getFresnel(F0, L, H);
+    vec3 kD = (1.0 - kS) * (1.0 - metallic) * baseColor / PI;
+
+    float NDF = getNDF(H, N, roughness);
+    float G = getGF(L, V, N, roughness);
+    vec3 specular = kS * NDF * G / (4.0 * max(0.0, dot(N, L)) * max(0.0, dot(N, V)) + 0.0001);
+
+    return (kD + specular) * vec3(light.color) * max(0.0, dot(N, L)) * atten;
+}
+
+void main() {
+    float depth = subpassLoad(inDepth).r;
+
+    // Nothing drawn here
+    if(depth >= 1.0) {
+        outColor = ubo.clearColor;
+        return;
+    }
+
+    // Reconstruct view position from depth
+    vec2 ndc = gl_FragCoord.xy * ubo.screenParams.zw * 2.0 - 1.0;
+    vec4 viewPos = ubo.invProjMat * vec4(ndc, depth, 1.0);
+    vec3 P = viewPos.xyz / viewPos.w;
+
+    vec3 N = normalize(subpassLoad(inNormal).xyz * 2.0 - 1.0);
+    vec3 baseColor = subpassLoad(inAlbedo).rgb;
+    vec2 material = subpassLoad(inMaterial).xy;
+    vec3 V = normalize(-P);
+    vec3 F0 = getFresnelAtAngleZero(baseColor, material.x);
+
+    // Cluster containing this pixel
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / ubo.clusterParams.zw), ubo.clusterDims.xy - 1u);
+    int slice = int(floor(log(max(-P.z, 1e-4)) * ubo.clusterParams.x + ubo.clusterParams.y));
+    uint z = uint(clamp(slice, 0, int(ubo.clusterDims.z) - 1));
+    uvec2 range = clusterRanges[(z * ubo.clusterDims.y + tile.y) * ubo.clusterDims.x + tile.x];
+
+    vec3 finalColor = vec3(0.0);
+    for(uint i = 0; i < range.y; i++) {
+        finalColor += shadeLight(lights[lightIndices[range.x + i]], P, N, V, 
+                                 baseColor, F0, material.x, material.y);
+    }
+
+    outColor = vec4(finalColor, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 450
+
+layout(binding = 0) uniform UBOVertex {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 lightDir;          // View space, towards the light
+} ubo;
+
+// Input from vertex shader
+layout(location = 0) in vec3 interPos;
+layout(location = 1) in vec3 interNormal;
+
+// Output color
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec3 N = normalize(interNormal);
+    vec3 L = normalize(vec3(ubo.lightDir));
+    vec3 V = normalize(-interPos);
+    vec3 H = normalize(L + V);
+
+    // Blinn-Phong (a fixed, moderate per-fragment cost)
+    vec3 baseColor = vec3(0.8, 0.6, 0.3);
+    float diffuse = max(0.0, dot(N, L));
+    float specular = pow(max(0.0, dot(N, H)), 32.0);
+    vec3 color = baseColor * (0.1 + diffuse) + vec3(0.3) * specular;
+
+    outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,31 @@
+#version 450
+
+// UBO for view and projection matrices (and the light)
+layout(binding = 0) uniform UBOVertex {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 lightDir;          // View space, towards the light
+} ubo;
+
+// Push constants for model matrix
+layout(push_constant) uniform UPushVertex {
+    mat4 modelMat;
+} pushVertex;
+
+// Vertex attributes
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+// Output to fragment shader
+layout(location = 0) out vec3 interPos;
+layout(location = 1) out vec3 interNormal;
+
+void main() {
+    // Copies only translate, so the upper 3x3 also transforms normals
+    mat4 modelViewMat = ubo.viewMat * pushVertex.modelMat;
+    vec4 vpos = modelViewMat * vec4(inPosition, 1.0);
+
+    interPos = vec3(vpos);
+    interNormal = mat3(modelViewMat) * inNormal;
+    gl_Position = ubo.projMat * vpos;
+}